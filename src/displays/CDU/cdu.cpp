@@ -1,5 +1,6 @@
 #include "cdu.hpp"
 
+#include <algorithm>
 #include <charconv>
 #include <chrono>
 #include <cstddef>
@@ -10,11 +11,14 @@
 #include <libnav/cifp_parser.hpp>
 #include <libnav/str_utils.hpp>
 #include <mutex>
+#include <optional>
 #include <shared_mutex>
 #include <string>
+#include <util/alloc_stats.hpp>
 #include <util/date_time.hpp>
 #include <utility>
 #include <util/geom.hpp>
+#include <util/trace.hpp>
 #include <util/util.hpp>
 
 #include "common.hpp"
@@ -233,11 +237,16 @@ constexpr geom::vect2_t DISPLAY_SZ = {0.717, 0.378};
 constexpr geom::vect2_t CDU_SMALL_TEXT_SZ = {0.7, 0.7};
 constexpr geom::vect2_t CDU_BIG_TEXT_SZ = {0.84, 0.87};
 
+constexpr double CDU_LAT_OVERLAY_FONT_SZ = 12;
+constexpr geom::vect2_t CDU_LAT_OVERLAY_OFFS = {0.01, 0.035};
+
 const std::string NAV_DATA_EXPIRED_MSG = "NAV DATA OUT OF DATE";
 const std::string INVALID_ENTRY_MSG = "INVALID ENTRY";
 const std::string NOT_IN_DB_MSG = "NOT IN DATA BASE";
 const std::string INVALID_DELETE_MSG = "INVALID DELETE";
 const std::string INVALID_RTE_UPLINK_MSG = "INVALID ROUTE UPLINK";
+const std::string RTE_SAVED_MSG = "ROUTE SAVED";
+const std::string RTE_SAVE_FAILED_MSG = "ROUTE SAVE FAILED";
 const std::string DELETE_MSG = "DELETE";
 
 const std::string DISCO_AFTER_SEG = "-- ROUTE DISCONTINUITY -";
@@ -289,6 +298,11 @@ const std::string ERASE_NML = "<ERASE";
 const std::string ACT = "ACT";
 const std::string SEL = "SEL";
 const std::string MOD = "MOD";
+const std::string SEL_STS = "<" + SEL + ">";
+const std::string ACT_STS = "<" + ACT + ">";
+const std::string RTE_NO_ARPT = std::string(4, '@');
+const std::string RTE_NO_RWY = std::string(5, '-');
+const std::string RTE_NO_FIELD = std::string(10, '-');
 const std::string RTE_COPY = "RTE COPY";
 const std::string COMPLETE = "COMPLETE";
 
@@ -343,6 +357,7 @@ CDU::CDU(util::OpaquePointer<fms_core::FPLSys> fs, size_t sd_idx) :
   pos_init_{fs}, menu_{fs}, init_ref_index_{fs}, legs_{fs, 
     util::OpaquePointer{&cntx_}} {
   act_sd_idx_ = sd_idx;
+  bg_msgs_ = std::make_shared<bg_msgs_t>();
 
   airport_db_ = fs->get_arpt_db_ptr();
   navaid_db_ = fs->get_navaid_db_ptr();
@@ -371,8 +386,13 @@ CDU::CDU(util::OpaquePointer<fms_core::FPLSys> fs, size_t sd_idx) :
 }
 
 void CDU::update() noexcept {
-  std::unique_lock lk(main_mutex_);
+  MY_TRACE_SCOPE("CDU::update");
+  MY_ALLOC_SCOPE("CDU::update");
+  MY_LOCK_EXCL(main_mutex_);
 
+  // Infos are read before the lists, so fpl_id_last is never newer than
+  // the lists. has_read_fpl_ids relies on that.
+  update_fpl_infos();
   nd_mode_ = fpl_sys_->get_nd_mode(act_sd_idx_);
   seg_list_ = fpl_sys_->get_seg_list(&n_seg_list_sz_, cntx_.sel_fpl_idx);
   leg_list_ = fpl_sys_->get_leg_list(&n_leg_list_sz_, cntx_.sel_fpl_idx);
@@ -399,12 +419,11 @@ void CDU::update() noexcept {
     curr_subpg_ = 1;
   }
 
-  update_fpl_infos();
   fpl_sys_->set_cdu_sel_fpl_idx(cntx_.sel_fpl_idx, act_sd_idx_);
 }
 
 bool CDU::get_exec_lt() const noexcept {
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   bool e_st = fpl_sys_->get_exec();
   if (cntx_.act_fpl_idx == cntx_.sel_fpl_idx) return e_st;
   return false;
@@ -412,67 +431,77 @@ bool CDU::get_exec_lt() const noexcept {
 
 std::string CDU::on_event(int event_key, std::string scratchpad,
                           std::string* s_out) noexcept {
-  std::unique_lock lk(main_mutex_);
+  MY_LOCK_EXCL(main_mutex_);
 
   return on_event_impl(event_key, scratchpad, s_out);
 }
 
-cdu_pages::cdu_scr_data_t CDU::get_screen_data() const noexcept {
-  std::shared_lock lk(main_mutex_);
+void CDU::get_screen_data(cdu_pages::cdu_scr_data_t& out) const noexcept {
+  MY_LOCK_SHARED(main_mutex_);
+
+  out.clear();
 
   if (cntx_.select_desired.get_state() == 
     cdu_pages::SelectDesired::State::WAIT) { 
-    return cntx_.select_desired.get_screen_data(); 
+    cntx_.select_desired.get_screen_data(out);
+    return;
   }
 
-  if (curr_page_ == CDUPage::MENU) { return menu_.get_screen_data(); }
-
-  if(curr_page_ == CDUPage::IDENT) { return ident_.get_screen_data(); }
-
-  if(curr_page_ == CDUPage::POS_INIT) { return pos_init_.get_screen_data(); }
-
-  if(curr_page_ == CDUPage::INIT_REF_INDEX) { return init_ref_index_.get_screen_data(); }
+  if (curr_page_ == CDUPage::MENU) { menu_.get_screen_data(out); }
 
-  if (curr_page_ == CDUPage::RTE) { return get_rte_page(); }
+  else if(curr_page_ == CDUPage::IDENT) { ident_.get_screen_data(out); }
 
-  if (curr_page_ == CDUPage::DEP_ARR_INTRO) { return get_dep_arr_page(); }
+  else if(curr_page_ == CDUPage::POS_INIT) { pos_init_.get_screen_data(out); }
 
-  if (curr_page_ == CDUPage::DEP1) { return get_dep_page(false); }
+  else if(curr_page_ == CDUPage::INIT_REF_INDEX) { 
+    init_ref_index_.get_screen_data(out); 
+  }
 
-  if (curr_page_ == CDUPage::ARR1) { return get_arr_page(false); }
+  else if (curr_page_ == CDUPage::RTE) { get_rte_page(out); }
 
-  if (curr_page_ == CDUPage::DEP2) { return get_dep_page(true); }
+  else if (curr_page_ == CDUPage::DEP_ARR_INTRO) { get_dep_arr_page(out); }
 
-  if (curr_page_ == CDUPage::ARR2) { return get_arr_page(true); }
+  else if (curr_page_ == CDUPage::DEP1 || curr_page_ == CDUPage::ARR1) {
+    get_dep_arr_proc_page(out, false);
+  }
 
-  if (curr_page_ == CDUPage::LEGS) { return legs_.get_screen_data(); }
+  else if (curr_page_ == CDUPage::DEP2 || curr_page_ == CDUPage::ARR2) {
+    get_dep_arr_proc_page(out, true);
+  }
 
-  return {};
+  else if (curr_page_ == CDUPage::LEGS) { legs_.get_screen_data(out); }
 }
 
-// Private member functions:
+bool CDU::pop_msg(std::string* out) noexcept {
+  std::lock_guard lk(bg_msgs_->mtx);
+  if (bg_msgs_->msgs.empty()) {
+    return false;
+  }
+  *out = std::move(bg_msgs_->msgs.front());
+  bg_msgs_->msgs.pop_front();
+  return true;
+}
 
-std::string CDU::str_align_right(const std::string& str) {
-  if(str.size() > N_CDU_DATA_COLS) {
-    std::size_t diff = str.size() - N_CDU_DATA_COLS;
-    return str.substr(diff);
+CDU::fpl_ids_t CDU::get_fpl_ids() const noexcept {
+  fpl_ids_t out;
+  for (std::size_t i = 0; i < out.size(); i++) {
+    out[i] = fpl_sys_->get_fpln_ptr(i)->get_id();
   }
-  std::size_t diff = N_CDU_DATA_COLS - str.size();
-  std::string out = std::string(diff, ' ') + str;
   return out;
 }
 
-std::string CDU::get_cdu_line(std::string in, std::string line,
-                              bool align_right) {
-  assert(line.size() + in.size() <= N_CDU_DATA_COLS);
-  if (!align_right) {
-    return in;
-  } else {
-    size_t n_sp = N_CDU_DATA_COLS - in.size() - line.size();
-    return line + std::string(n_sp, ' ') + in;
+bool CDU::has_read_fpl_ids(const fpl_ids_t& ids) const noexcept {
+  MY_LOCK_SHARED(main_mutex_);
+  for (std::size_t i = 0; i < ids.size(); i++) {
+    if (fpl_infos_[i].fpl_id_last < ids[i]) {
+      return false;
+    }
   }
+  return true;
 }
 
+// Private member functions:
+
 bool CDU::scratchpad_has_delete(const std::string& scratchpad) {
   if (scratchpad.size() && scratchpad[0] == DELETE_SYMBOL) return 1;
   return 0;
@@ -677,7 +706,18 @@ std::string CDU::load_rte() {
   std::string arr_nm = fpln_->get_arr_icao();
 
   if (dep_nm != "" && arr_nm != "") {
-    std::string file_nm = (fpl_sys_->get_fpln_dir() + (dep_nm + arr_nm)).Get();
+    // The catalog can lag behind the disk: it may not be watching the
+    // directory (no inotify, network file systems) or a save may have just
+    // finished. A miss is checked against the file itself, which also
+    // brings the catalog up to date.
+    std::string rte_nm = dep_nm + arr_nm;
+    util::OpaquePointer<fms_core::RteCatalog> catalog =
+        fpl_sys_->get_rte_catalog();
+    if (catalog.get() != nullptr && !catalog->Find(rte_nm) &&
+        !catalog->Update(rte_nm)) {
+      return NOT_IN_DB_MSG;
+    }
+    std::string file_nm = (fpl_sys_->get_fpln_dir() + rte_nm).Get();
     libnav::DbErr err = fpln_->load_from_fms(file_nm, false);
     if (err != libnav::DbErr::SUCCESS) {
       return INVALID_RTE_UPLINK_MSG;
@@ -687,13 +727,63 @@ std::string CDU::load_rte() {
   return "";
 }
 
+std::string CDU::set_co_rte(std::string name, std::string* s_out) {
+  if (name.size() > RTE_NO_FIELD.size() || scratchpad_has_delete(name))
+    return INVALID_ENTRY_MSG;
+  util::OpaquePointer<fms_core::RteCatalog> catalog =
+      fpl_sys_->get_rte_catalog();
+  if (catalog.get() == nullptr) return NOT_IN_DB_MSG;
+
+  if (name == "") {
+    std::vector<fms_core::rte_catalog_entry_t> found =
+        catalog->FindByCityPair(fpln_->get_dep_icao(), fpln_->get_arr_icao());
+    if (found.empty()) return NOT_IN_DB_MSG;
+    // Entries are sorted by name, so this walks through them one by one
+    std::string curr = fpln_->get_co_rte_nm();
+    *s_out = found[0].name;
+    for (const auto& i : found) {
+      if (i.name > curr) {
+        *s_out = i.name;
+        break;
+      }
+    }
+    return "";
+  }
+
+  std::optional<fms_core::rte_catalog_entry_t> entry = catalog->Find(name);
+  if (!entry && catalog->Update(name)) entry = catalog->Find(name);
+  if (!entry) {
+    std::vector<fms_core::rte_catalog_entry_t> found =
+        catalog->FindByPrefix(name);
+    if (found.empty()) return NOT_IN_DB_MSG;
+    if (found.size() > 1) {
+      *s_out = found[0].name;
+      return "";
+    }
+    entry = found[0];
+  }
+
+  std::string file_nm = (fpl_sys_->get_fpln_dir() + entry->name).Get();
+  libnav::DbErr err = fpln_->load_from_fms(file_nm, true);
+  if (err != libnav::DbErr::SUCCESS) {
+    return INVALID_RTE_UPLINK_MSG;
+  }
+
+  return "";
+}
+
 std::string CDU::save_rte() {
   std::string dep_nm = fpln_->get_dep_icao();
   std::string arr_nm = fpln_->get_arr_icao();
 
   if (dep_nm != "" && arr_nm != "") {
     std::string out_nm = (fpl_sys_->get_fpln_dir() + (dep_nm + arr_nm)).Get();
-    fpln_->save_to_fms(out_nm);
+    std::shared_ptr<bg_msgs_t> bg_msgs = bg_msgs_;
+    fpl_sys_->save_fpln_async(
+        cntx_.sel_fpl_idx, out_nm, [bg_msgs](bool saved) {
+          std::lock_guard lk(bg_msgs->mtx);
+          bg_msgs->msgs.push_back(saved ? RTE_SAVED_MSG : RTE_SAVE_FAILED_MSG);
+        });
   }
 
   return "";
@@ -769,8 +859,8 @@ std::string CDU::delete_to(size_t next_idx) {
 }
 
 void CDU::get_seg_page(cdu_pages::cdu_scr_data_t* in) const noexcept {
-  std::string via_to = " VIA" + std::string(N_CDU_DATA_COLS - 6, ' ') + "TO";
-  in->data_lines.push_back(via_to);
+  in->push_line(" VIA");
+  cdu_pages::put_text_right(in->last_line(), "TO");
 
   size_t i_start = get_seg_start_idx();
   size_t i_end = get_seg_end_idx();
@@ -783,93 +873,97 @@ void CDU::get_seg_page(cdu_pages::cdu_scr_data_t* in) const noexcept {
       seg_nm = std::string(7, '-');
     }
     if (end_nm == "") {
-      in->data_lines[in->data_lines.size() - 1] = std::string(10, ' ') + "THEN";
-      end_nm = std::string(5, '@');
-      std::string curr_seg =
-          seg_nm +
-          std::string(N_CDU_DATA_COLS - seg_nm.size() - end_nm.size(), ' ') +
-          end_nm;
-      in->data_lines.push_back(curr_seg);
-      in->data_lines.push_back(DISCO_AFTER_SEG);
+      cdu_pages::set_line(in->last_line(), "");
+      cdu_pages::put_text(in->last_line(), 10, "THEN");
+      in->push_line(seg_nm);
+      cdu_pages::put_text_right(in->last_line(), "@@@@@");
+      in->push_line(DISCO_AFTER_SEG);
     } else {
-      std::string seg_nm = curr_sg.data.name;
-      std::string curr_seg =
-          seg_nm +
-          std::string(N_CDU_DATA_COLS - seg_nm.size() - end_nm.size(), ' ') +
-          end_nm;
-      in->data_lines.push_back(curr_seg);
-      if (i < i_start + 4) in->data_lines.push_back("");
+      in->push_line(curr_sg.data.name);
+      cdu_pages::put_text_right(in->last_line(), end_nm);
+      if (i < i_start + 4) in->push_line();
     }
   }
-  if (i_end - i_start < N_CDU_ITM_PP) in->data_lines.push_back(SEG_LAST);
+  if (i_end - i_start < N_CDU_ITM_PP) in->push_line(SEG_LAST);
 
-  while (in->data_lines.size() < 10) {
-    in->data_lines.push_back("");
+  while (in->n_lines < 10) {
+    in->push_line();
   }
 }
 
-std::string CDU::get_sts(std::string& cr, std::string& act) const noexcept {
-  std::string sts = "<" + SEL + ">";
-  if (cr == act) sts = "<" + ACT + ">";
-  return sts;
+std::string_view CDU::get_sts(std::string_view cr,
+                              std::string_view act) const noexcept {
+  if (cr == act) return ACT_STS;
+  return SEL_STS;
 }
 
-void CDU::get_procs(cdu_pages::cdu_scr_data_t* in, std::string curr_proc,
-                    std::string curr_trans, std::string act_proc,
-                    std::string act_trans, bool rte2) const noexcept {
+void CDU::get_procs(cdu_pages::cdu_scr_data_t* in,
+                    std::string_view curr_proc, std::string_view curr_trans,
+                    std::string_view act_proc, std::string_view act_trans,
+                    bool rte2) const noexcept {
   size_t start_idx = size_t((curr_subpg_ - 1) * 5);
   size_t j = 1;
 
   if (curr_proc != "" && procedures_[rte2].size() == 1) start_idx = 0;
 
   if (!procedures_[rte2].size()) {
-    in->data_lines[j] = DEP_ARR_NO_PROC;
+    cdu_pages::set_line(in->data_lines[j], DEP_ARR_NO_PROC);
     j += 2;
   }
 
   for (size_t i = start_idx; i < start_idx + 6 && i < procedures_[rte2].size();
        i++) {
-    std::string curr = procedures_[rte2][i];
+    const std::string& curr = procedures_[rte2][i];
+    cdu_pages::set_line(in->data_lines[j], curr);
     if (curr == curr_proc) {
-      curr = curr + std::string(6 - curr.size(), ' ') +
-             get_sts(curr_proc, act_proc);
+      cdu_pages::put_text(in->data_lines[j], 6, get_sts(curr_proc, act_proc));
     }
-
-    in->data_lines[j] = curr;
     j += 2;
   }
   if (transitions_[rte2].size() && procedures_[rte2].size() == 1) {
     size_t trans_start = size_t((curr_subpg_ - 1) * 4);
     if (trans_start < transitions_[rte2].size())
-      in->data_lines[j - 1] = " TRANS";
+      cdu_pages::set_line(in->data_lines[j - 1], " TRANS");
 
     if (curr_trans == "") curr_trans = libnav::NONE_TRANS;
     for (size_t i = trans_start;
          i < trans_start + 4 && i < transitions_[rte2].size(); i++) {
-      std::string curr = transitions_[rte2][i];
+      const std::string& curr = transitions_[rte2][i];
+      cdu_pages::set_line(in->data_lines[j], curr);
       if (curr == curr_trans) {
-        curr = curr + std::string(6 - curr.size(), ' ') +
-               get_sts(curr_trans, act_trans);
+        cdu_pages::put_text(in->data_lines[j], 6, 
+          get_sts(curr_trans, act_trans));
       }
-      in->data_lines[j] = curr;
       j += 2;
     }
   } else if (procedures_[rte2].size() == 1 && dep_arr_proc_filter_[rte2] &&
              curr_subpg_ == 1) {
-    in->data_lines[j - 1] = " TRANS";
-    in->data_lines[j] = DEP_ARR_NO_PROC;
+    cdu_pages::set_line(in->data_lines[j - 1], " TRANS");
+    cdu_pages::set_line(in->data_lines[j], DEP_ARR_NO_PROC);
   }
 }
 
-void CDU::get_rwys(cdu_pages::cdu_scr_data_t* in, std::string curr_rwy,
-                   std::string act_rwy, bool rte2, std::string curr_appr,
-                   std::string curr_via, std::string act_appr,
-                   std::string act_via, bool get_appr) const noexcept {
+void CDU::get_rwys(cdu_pages::cdu_scr_data_t* in, std::string_view curr_rwy,
+                   std::string_view act_rwy, bool rte2,
+                   std::string_view curr_appr, std::string_view curr_via,
+                   std::string_view act_appr, std::string_view act_via,
+                   bool get_appr) const noexcept {
   size_t start_idx = size_t((curr_subpg_ - 1) * 5);
   size_t j = 1;
 
   bool draw_rwys = true;
 
+  // Items are right-aligned. Selected ones are prefixed by their status,
+  // with the item padded to 7 columns.
+  auto put_item = [this](cdu_pages::cdu_line_t& line, const std::string& item,
+                         std::string_view curr, std::string_view act) {
+    cdu_pages::put_text_right(line, item);
+    if (item == curr) {
+      std::string_view sts = get_sts(curr, act);
+      cdu_pages::put_text(line, N_CDU_DATA_COLS - 7 - sts.size(), sts);
+    }
+  };
+
   if (get_appr) {
     draw_rwys = arr_has_rwys(curr_appr, rte2);
     if (!draw_rwys) start_idx = 0;
@@ -877,34 +971,22 @@ void CDU::get_rwys(cdu_pages::cdu_scr_data_t* in, std::string curr_rwy,
     if (curr_appr != "") curr_rwy = "";
     for (size_t i = start_idx;
          i <= start_idx + N_CDU_ITM_PP && i < approaches_[rte2].size(); i++) {
-      std::string curr = approaches_[rte2][i];
-      if (curr == curr_appr) {
-        curr = get_sts(curr_appr, act_appr) +
-               std::string(7 - curr.size(), ' ') + curr;
-      }
-      in->data_lines[j] = get_cdu_line(curr, in->data_lines[j], true);
+      put_item(in->data_lines[j], approaches_[rte2][i], curr_appr, act_appr);
       j += 2;
     }
 
     if (approaches_[rte2].size() == 1 && curr_appr != "") {
       size_t via_idx = 4 * (curr_subpg_ - 1);
       if (j - 1 > 0 && (via_idx < vias_[rte2].size() || curr_subpg_ == 1))
-        in->data_lines[j - 1] =
-            get_cdu_line("TRANS ", in->data_lines[j - 1], true);
+        cdu_pages::put_text_right(in->data_lines[j - 1], "TRANS ");
 
       if (!vias_[rte2].size() && curr_subpg_ == 1) {
-        in->data_lines[j] =
-            get_cdu_line(DEP_ARR_NO_PROC, in->data_lines[j], true);
+        cdu_pages::put_text_right(in->data_lines[j], DEP_ARR_NO_PROC);
         j += 2;
       }
 
       for (size_t i = via_idx; i < via_idx + 4 && i < vias_[rte2].size(); i++) {
-        std::string curr = vias_[rte2][i];
-        if (curr == curr_via) {
-          curr = get_sts(curr_via, act_via) +
-                 std::string(7 - curr.size(), ' ') + curr;
-        }
-        in->data_lines[j] = get_cdu_line(curr, in->data_lines[j], true);
+        put_item(in->data_lines[j], vias_[rte2][i], curr_via, act_via);
         j += 2;
       }
     }
@@ -918,37 +1000,24 @@ void CDU::get_rwys(cdu_pages::cdu_scr_data_t* in, std::string curr_rwy,
     }
     if (j - 1 < in->data_lines.size() && get_appr) {
       if (j - 1) {
-        in->data_lines[j - 1] = ARR_RWYS;
+        cdu_pages::set_line(in->data_lines[j - 1], ARR_RWYS);
       } else {
         if (rte2)
-          in->data_lines[j - 1] = ARR_RWYS_STARS2;
+          cdu_pages::set_line(in->data_lines[j - 1], ARR_RWYS_STARS2);
         else
-          in->data_lines[j - 1] = ARR_RWYS_STARS1;
+          cdu_pages::set_line(in->data_lines[j - 1], ARR_RWYS_STARS1);
       }
     }
 
     for (size_t i = start_idx;
          i <= start_idx + N_CDU_ITM_PP && i < rwys_[rte2].size(); i++) {
       if (j > 11) break;
-      std::string curr = rwys_[rte2][i];
-      if (curr == curr_rwy) {
-        curr = get_sts(curr_rwy, act_rwy) + std::string(7 - curr.size(), ' ') +
-               curr;
-      }
-      in->data_lines[j] = get_cdu_line(curr, in->data_lines[j], true);
+      put_item(in->data_lines[j], rwys_[rte2][i], curr_rwy, act_rwy);
       j += 2;
     }
   }
 }
 
-std::string CDU::get_small_heading() const noexcept {
-  std::string curr_spg = std::to_string(curr_subpg_);
-  std::string n_spg = std::to_string(n_subpg_);
-  std::string out = curr_spg + "/" + n_spg + " ";
-  out = std::string(size_t(N_CDU_DATA_COLS) - out.size(), ' ') + out;
-  return out;
-}
-
 void CDU::set_procs(fms_core::ProcType ptp, bool is_arr, bool rte2) {
   util::OpaquePointer c_fpl = m_rte1_ptr_;
   if (rte2) {
@@ -1041,31 +1110,50 @@ void CDU::get_rte_dep_arr(cdu_pages::cdu_scr_data_t& out, bool rte2) const noexc
   hdg = hdg + act_sts;
 
   if (dep != "" || arr != "") {
-    out.data_lines.push_back(std::string(8, ' ') + hdg);
-    if (dep != "")
-      out.data_lines.push_back(DEP_ARR_DEP_OPT + dep + DEP_ARR_ARR_OPT);
-    else
-      out.data_lines.push_back(DEP_ARR_DEP_OPT + "    " + DEP_ARR_ARR_OPT);
-    out.data_lines.push_back("");
-    if (arr != "")
-      out.data_lines.push_back(std::string(DEP_ARR_DEP_OPT.size(), ' ') + arr +
-                               DEP_ARR_ARR_OPT);
-    else
-      out.data_lines.push_back(std::string(DEP_ARR_DEP_OPT.size(), ' ') +
-                               "    " + DEP_ARR_ARR_OPT);
+    out.push_line();
+    cdu_pages::put_text(out.last_line(), 8, hdg);
+    out.push_line(DEP_ARR_DEP_OPT);
+    size_t col = cdu_pages::put_text(out.last_line(), DEP_ARR_DEP_OPT.size(),
+                                     dep != "" ? dep : "    ");
+    cdu_pages::put_text(out.last_line(), col, DEP_ARR_ARR_OPT);
+    out.push_line();
+    out.push_line();
+    col = cdu_pages::put_text(out.last_line(), DEP_ARR_DEP_OPT.size(),
+                              arr != "" ? arr : "    ");
+    cdu_pages::put_text(out.last_line(), col, DEP_ARR_ARR_OPT);
   } else {
-    out.data_lines.push_back(DEP_ARR_IDX_DASH_L + hdg + DEP_ARR_IDX_DASH_R);
-    out.data_lines.push_back("");
-    out.data_lines.push_back("");
-    out.data_lines.push_back("");
+    out.push_line(DEP_ARR_IDX_DASH_L);
+    size_t col = cdu_pages::put_text(out.last_line(),
+                                     DEP_ARR_IDX_DASH_L.size(), hdg);
+    cdu_pages::put_text(out.last_line(), col, DEP_ARR_IDX_DASH_R);
+    out.push_line();
+    out.push_line();
+    out.push_line();
   }
 }
 
-bool CDU::arr_has_rwys(std::string& cr_appr, bool rte2) const noexcept {
+bool CDU::arr_has_rwys(std::string_view cr_appr,
+                       bool rte2) const noexcept {
   if (dep_arr_proc_filter_[rte2] && cr_appr != "") return false;
   return true;
 }
 
+CDU::dep_arr_key_t CDU::get_dep_arr_key(bool rte2) const noexcept {
+  util::OpaquePointer<flightplan_type> c_fpl = m_rte1_ptr_;
+  if (rte2) {
+    c_fpl = m_rte2_ptr_;
+  }
+
+  return {curr_page_,
+          c_fpl->get_id(),
+          c_fpl->get_dep_icao(),
+          c_fpl->get_arr_icao(),
+          dep_arr_rwy_filter_[rte2],
+          dep_arr_proc_filter_[rte2],
+          dep_arr_trans_filter_[rte2],
+          dep_arr_via_filter_[rte2]};
+}
+
 int CDU::get_n_sel_des_subpg() const noexcept {
   return int(sel_des_data_.size()) / 6 + bool(int(sel_des_data_.size()) % 6);
 }
@@ -1095,14 +1183,21 @@ int CDU::get_n_dep_arr_subpg(bool rte2) noexcept {
     curr_page_ = CDUPage::DEP_ARR_INTRO;
   }
 
+  dep_arr_key_t key = get_dep_arr_key(rte2);
+  bool lists_valid = dep_arr_lists_key_ == key;
+  if (!lists_valid) {
+    dep_arr_lists_key_ = key;
+    dep_arr_lists_ver_++;
+  }
+
   if (curr_page_ == c_dep_pg) {
-    set_procs(fms_core::PROC_TYPE_SID, false, rte2);
+    if (!lists_valid) set_procs(fms_core::PROC_TYPE_SID, false, rte2);
     size_t max_cnt =
         std::max(rwys_[rte2].size(),
                  procedures_[rte2].size() + transitions_[rte2].size());
     return int(max_cnt) / N_DEP_ARR_ROW_DSP + bool(max_cnt % N_DEP_ARR_ROW_DSP);
   } else if (curr_page_ == c_arr_pg) {
-    set_procs(fms_core::PROC_TYPE_STAR, true, rte2);
+    if (!lists_valid) set_procs(fms_core::PROC_TYPE_STAR, true, rte2);
     size_t max_cnt = std::max(
         procedures_[rte2].size() + transitions_[rte2].size(),
         approaches_[rte2].size() + vias_[rte2].size() + rwys_[rte2].size());
@@ -1162,6 +1257,8 @@ std::string CDU::handle_rte(int event_key, std::string scratchpad,
         fpl_sys_->copy_act();
     } else if (event_key == CDU_KEY_LSK_TOP + 1) {
       return set_dep_rwy(scratchpad);
+    } else if (event_key == CDU_KEY_RSK_TOP + 2) {
+      return set_co_rte(scratchpad, s_out);
     } else if (event_key == CDU_KEY_LSK_TOP + 2) {
       return load_rte();
     } else if (event_key == CDU_KEY_LSK_TOP + 4) {
@@ -1304,208 +1401,190 @@ std::size_t CDU::get_seg_end_idx() const noexcept {
   return std::min(n_seg_list_sz_ - 1, stt_idx + N_CDU_ITM_PP);
 }
 
-cdu_pages::cdu_scr_data_t CDU::get_sel_des_page() const noexcept {
-  cdu_pages::cdu_scr_data_t out = {};
-
-  out.heading_small = get_small_heading();
-  out.heading_big = SEL_DES_WPT_HDG;
+void CDU::get_sel_des_page(cdu_pages::cdu_scr_data_t& out) const noexcept {
+  cdu_pages::put_subpage_heading(out.heading_small, curr_subpg_, n_subpg_);
+  cdu_pages::set_line(out.heading_big, SEL_DES_WPT_HDG);
   out.heading_color = CDUColor::WHITE;
 
   size_t start_idx = size_t((curr_subpg_ - 1) * 6);
   size_t end_idx = std::min(sel_des_data_.size(), start_idx + 6);
 
   for (size_t i = start_idx; i < end_idx; i++) {
-    std::string wpt_tp =
-        sel_des_nm_ + " " + libnav::navaid_to_str(sel_des_data_[i].type);
-    std::string lat_str =
-        strutils::lat_to_str(sel_des_data_[i].pos.lat_rad * geo::RAD_TO_DEG);
-    std::string lon_str =
-        strutils::lon_to_str(sel_des_data_[i].pos.lon_rad * geo::RAD_TO_DEG);
-    std::string main_str = lat_str + lon_str;
+    out.push_line(sel_des_nm_);
+    size_t col = cdu_pages::put_text(out.last_line(), sel_des_nm_.size(), " ");
+    cdu_pages::put_text(out.last_line(), col,
+                        libnav::navaid_to_str(sel_des_data_[i].type));
+
+    out.push_line();
+    col = 0;
     if (sel_des_data_[i].navaid) {
-      main_str =
-          strutils::freq_to_str(sel_des_data_[i].navaid->freq) + " " + main_str;
+      col = cdu_pages::put_text(
+          out.last_line(), col,
+          strutils::freq_to_str(sel_des_data_[i].navaid->freq));
+      col = cdu_pages::put_text(out.last_line(), col, " ");
     }
-    out.data_lines.push_back(wpt_tp);
-    out.data_lines.push_back(main_str);
+    col = cdu_pages::put_text(
+        out.last_line(), col,
+        strutils::lat_to_str(sel_des_data_[i].pos.lat_rad * geo::RAD_TO_DEG));
+    cdu_pages::put_text(
+        out.last_line(), col,
+        strutils::lon_to_str(sel_des_data_[i].pos.lon_rad * geo::RAD_TO_DEG));
   }
-
-  return out;
 }
 
-cdu_pages::cdu_scr_data_t CDU::get_rte_page() const noexcept {
+void CDU::get_rte_page(cdu_pages::cdu_scr_data_t& out) const noexcept {
   bool exec_lt = fpl_sys_->get_exec();
 
-  cdu_pages::cdu_scr_data_t out = {};
-
-  out.heading_small = get_small_heading();
-  std::string rte_offs = std::string(2, ' ');
-  std::string act_sts = std::string(4, ' ');
+  cdu_pages::put_subpage_heading(out.heading_small, curr_subpg_, n_subpg_);
 
   out.heading_color = CDUColor::CYAN;
   if (cntx_.sel_fpl_idx == cntx_.act_fpl_idx) {
     if (exec_lt)
-      act_sts = MOD + " ";
+      cdu_pages::put_text(out.heading_big, 2, MOD);
     else
-      act_sts = ACT + " ";
+      cdu_pages::put_text(out.heading_big, 2, ACT);
     out.heading_color = CDUColor::WHITE;
   }
-  std::string c_rte_top = "RTE 1";
-  std::string c_rte_btm = "<RTE 2";
+  std::string_view c_rte_top = "RTE 1";
+  std::string_view c_rte_btm = "<RTE 2";
   if (cntx_.sel_fpl_idx == fms_core::RTE2_IDX) {
     c_rte_top = "RTE 2";
     c_rte_btm = "<RTE 1";
   }
-  out.heading_big = rte_offs + act_sts + c_rte_top;
+  cdu_pages::put_text(out.heading_big, 6, c_rte_top);
 
   if (curr_subpg_ == 1) {
-    std::string dest_offs = std::string(N_CDU_DATA_COLS - 7 - 4, ' ');
-    std::string origin_dest = " ORIGIN" + dest_offs + "DEST";
-    out.data_lines.push_back(origin_dest);
+    // Icao codes, runways and flight numbers fit in the small string
+    // buffer, so the copies below don't allocate.
+    out.push_line(" ORIGIN");
+    cdu_pages::put_text_right(out.last_line(), "DEST");
     std::string origin = fpln_->get_dep_icao();
     std::string dest = fpln_->get_arr_icao();
-    bool incomplete = false;
-
+    bool incomplete = origin == "" || dest == "";
+
+    std::string_view origin_dsp = origin;
+    std::string_view dest_dsp = dest;
+    if (origin == "") origin_dsp = RTE_NO_ARPT;
+    if (dest == "") dest_dsp = RTE_NO_ARPT;
+    out.push_line(origin_dsp);
+    cdu_pages::put_text_right(out.last_line(), dest_dsp);
+    out.push_line(" RUNWAY");
+    cdu_pages::put_text_right(out.last_line(), "FLT NO");
+    out.push_line();
+    if (!incomplete) {
+      std::string dep_rwy = fpln_->get_dep_rwy();
+      if (dep_rwy == "") {
+        cdu_pages::put_text(out.last_line(), 0, RTE_NO_RWY);
+      } else {
+        size_t col = cdu_pages::put_text(out.last_line(), 0, "RW");
+        cdu_pages::put_text(out.last_line(), col, dep_rwy);
+      }
+    }
     std::string flt_nbr = fpl_sys_->get_flt_nbr();
     if (flt_nbr == "")
-      flt_nbr = std::string(10, '-');
+      cdu_pages::put_text_right(out.last_line(), RTE_NO_FIELD);
     else
-      flt_nbr = std::string(N_FLT_NBR_CHR_MAX - flt_nbr.size(), ' ') + flt_nbr;
-
-    if (origin == "") {
-      origin = std::string(4, '@');
-      incomplete = true;
-    }
-    if (dest == "") {
-      dest = std::string(4, '@');
-      incomplete = true;
-    }
-
-    std::string od_data =
-        origin + std::string(N_CDU_DATA_COLS - 4 - 4, ' ') + dest;
-    out.data_lines.push_back(od_data);
-    std::string rwy_flt_no =
-        " RUNWAY" + std::string(N_CDU_DATA_COLS - 7 - 6, ' ') + "FLT NO";
-    out.data_lines.push_back(rwy_flt_no);
-    std::string dep_rwy = "";
-    if (!incomplete) {
-      dep_rwy = fpln_->get_dep_rwy();
-      if (dep_rwy == "")
-        dep_rwy = std::string(5, '-');
-      else
-        dep_rwy = "RW" + dep_rwy;
-    }
-    std::string rf_data =
-        dep_rwy +
-        std::string(size_t(N_CDU_DATA_COLS) - dep_rwy.size() - 10, ' ') +
-        flt_nbr;
-    out.data_lines.push_back(rf_data);
-    out.data_lines.push_back(
-        " ROUTE" + std::string(N_CDU_DATA_COLS - 6 - 8, ' ') + "CO ROUTE");
+      cdu_pages::put_text_right(out.last_line(), flt_nbr);
+    out.push_line(" ROUTE");
+    cdu_pages::put_text_right(out.last_line(), "CO ROUTE");
     std::string co_rte_nm = fpln_->get_co_rte_nm();
-    std::string co_rte_dsp = std::string(10, '-');
-    if (co_rte_nm != "" && co_rte_nm.size() <= 10) {
-      co_rte_dsp = std::string(10 - co_rte_nm.size(), ' ') + co_rte_nm;
+    out.push_line("<REQUEST");
+    if (co_rte_nm != "" && co_rte_nm.size() <= RTE_NO_FIELD.size()) {
+      cdu_pages::put_text_right(out.last_line(), co_rte_nm);
+    } else {
+      cdu_pages::put_text_right(out.last_line(), RTE_NO_FIELD);
     }
-    out.data_lines.push_back(
-        "<REQUEST" + std::string(size_t(N_CDU_DATA_COLS) - 8 - 10, ' ') +
-        co_rte_dsp);
     if (rte_copy_ == fms_core::RTECopySts::READY &&
         cntx_.sel_fpl_idx == cntx_.act_fpl_idx) {
-      out.data_lines.push_back("");
-      size_t cp_pad = size_t(N_CDU_DATA_COLS) - RTE_COPY.size() - 1;
-      out.data_lines.push_back(std::string(cp_pad, ' ') + RTE_COPY + ">");
+      out.push_line();
+      out.push_line();
+      cdu_pages::put_text_right(out.last_line(), ">");
+      cdu_pages::put_text(out.last_line(),
+                          size_t(N_CDU_DATA_COLS) - RTE_COPY.size() - 1,
+                          RTE_COPY);
     } else if (rte_copy_ == fms_core::RTECopySts::COMPLETE &&
                cntx_.sel_fpl_idx == cntx_.act_fpl_idx) {
-      size_t cp_pad1 = size_t(N_CDU_DATA_COLS) - RTE_COPY.size();
-      size_t cp_pad2 = size_t(N_CDU_DATA_COLS) - COMPLETE.size();
-      out.data_lines.push_back(std::string(cp_pad1, ' ') + RTE_COPY);
-      out.data_lines.push_back(std::string(cp_pad2, ' ') + COMPLETE);
+      out.push_line();
+      cdu_pages::put_text_right(out.last_line(), RTE_COPY);
+      out.push_line();
+      cdu_pages::put_text_right(out.last_line(), COMPLETE);
     } else {
-      out.data_lines.push_back("");
-      out.data_lines.push_back("");
+      out.push_line();
+      out.push_line();
     }
 
-    std::string rte_final = " ROUTE ";
-    out.data_lines.push_back(rte_final +
-                             std::string(size_t(N_CDU_DATA_COLS) - 7, '-'));
-    out.data_lines.push_back(
-        "<SAVE" + std::string(size_t(N_CDU_DATA_COLS) - 10, ' ') + "ALTN>");
+    out.push_line(" ROUTE ");
+    cdu_pages::put_text(out.last_line(), 7, ALL_DASH);
+    out.push_line("<SAVE");
+    cdu_pages::put_text_right(out.last_line(), "ALTN>");
   } else {
     get_seg_page(&out);
   }
 
-  if (out.data_lines.size() == 10) {
+  if (out.n_lines == 10) {
     if (curr_subpg_ != 1)
-      out.data_lines.push_back(ALL_DASH);
+      out.push_line(ALL_DASH);
     else
-      out.data_lines.push_back("");
+      out.push_line();
   }
 
-  std::string btm_line_nrm = c_rte_btm;
-  if (cntx_.act_fpl_idx != cntx_.sel_fpl_idx)
-    btm_line_nrm +=
-        std::string(size_t(N_CDU_DATA_COLS) - 15, ' ') + "ACTIVATE>";
-  if (!exec_lt)
-    out.data_lines.push_back(btm_line_nrm);
-  else
-    out.data_lines.push_back(ERASE_NML);
-
-  return out;
+  if (!exec_lt) {
+    out.push_line(c_rte_btm);
+    if (cntx_.act_fpl_idx != cntx_.sel_fpl_idx)
+      cdu_pages::put_text_right(out.last_line(), "ACTIVATE>");
+  } else {
+    out.push_line(ERASE_NML);
+  }
 }
 
-cdu_pages::cdu_scr_data_t CDU::get_dep_arr_page() const noexcept {
-  cdu_pages::cdu_scr_data_t out = {};
-
-  out.heading_small = get_small_heading();
-  std::string hdg_offs =
-      std::string((N_CDU_DATA_COLS - DEP_ARR_HDG.size()) / 2, ' ');
-  out.heading_big = hdg_offs + DEP_ARR_HDG;
+void CDU::get_dep_arr_page(cdu_pages::cdu_scr_data_t& out) const noexcept {
+  cdu_pages::put_subpage_heading(out.heading_small, curr_subpg_, n_subpg_);
+  cdu_pages::put_text(out.heading_big,
+                      (N_CDU_DATA_COLS - DEP_ARR_HDG.size()) / 2, DEP_ARR_HDG);
   out.heading_color = CDUColor::WHITE;
 
   get_rte_dep_arr(out, false);
   get_rte_dep_arr(out, true);
 
-  out.data_lines.push_back(std::string(N_CDU_DATA_COLS, '-'));
-  out.data_lines.push_back("");
-  out.data_lines.push_back(DEP_ARR_IDX_OTHER);
-  out.data_lines.push_back(DEP_ARR_ARROWS);
-
-  return out;
+  out.push_line(ALL_DASH);
+  out.push_line();
+  out.push_line(DEP_ARR_IDX_OTHER);
+  out.push_line(DEP_ARR_ARROWS);
 }
 
 void CDU::dep_arr_set_bottom(cdu_pages::cdu_scr_data_t& out) const noexcept {
-  out.data_lines[10] = std::string(N_CDU_DATA_COLS, '-');
+  cdu_pages::set_line(out.data_lines[10], ALL_DASH);
 
   bool exec_lt = fpl_sys_->get_exec();
   if (exec_lt) {
-    out.data_lines[11] = DEP_ARR_BOTTOM_ACT;
+    cdu_pages::set_line(out.data_lines[11], DEP_ARR_BOTTOM_ACT);
   } else {
-    out.data_lines[11] = DEP_ARR_BOTTOM_INACT;
+    cdu_pages::set_line(out.data_lines[11], DEP_ARR_BOTTOM_INACT);
   }
 }
 
-cdu_pages::cdu_scr_data_t CDU::get_dep_page(bool rte2) const noexcept {
+void CDU::get_dep_page(cdu_pages::cdu_scr_data_t& out,
+                       bool rte2) const noexcept {
   util::OpaquePointer<flightplan_type> c_fpl = m_rte1_ptr_;
   if (rte2) {
     c_fpl = m_rte2_ptr_;
   }
 
   std::string dep = c_fpl->get_dep_icao();
-  cdu_pages::cdu_scr_data_t out = {};
   for (size_t i = 9; i < 14; i++) out.chr_sts[0][i] = CDU_B_WHITE;
 
-  out.heading_small = get_small_heading();
-  out.heading_big = "   " + dep + " DEPARTURES";
+  cdu_pages::put_subpage_heading(out.heading_small, curr_subpg_, n_subpg_);
+  size_t hdg_col = cdu_pages::put_text(out.heading_big, 3, dep);
+  cdu_pages::put_text(out.heading_big, hdg_col, " DEPARTURES");
   out.heading_color = CDUColor::WHITE;
 
   for (int i = 0; i < 12; i++) {
-    out.data_lines.push_back("");
+    out.push_line();
   }
   if (rte2)
-    out.data_lines[0] = DEP_COLS2;
+    cdu_pages::set_line(out.data_lines[0], DEP_COLS2);
   else
-    out.data_lines[0] = DEP_COLS1;
+    cdu_pages::set_line(out.data_lines[0], DEP_COLS1);
 
   std::string curr_sid = c_fpl->get_curr_proc(fms_core::PROC_TYPE_SID);
   std::string curr_trans = c_fpl->get_curr_proc(fms_core::PROC_TYPE_SID, true);
@@ -1519,31 +1598,30 @@ cdu_pages::cdu_scr_data_t CDU::get_dep_page(bool rte2) const noexcept {
   get_rwys(&out, dep_rwy, act_rwy, rte2);
 
   dep_arr_set_bottom(out);
-
-  return out;
 }
 
-cdu_pages::cdu_scr_data_t CDU::get_arr_page(bool rte2) const noexcept {
+void CDU::get_arr_page(cdu_pages::cdu_scr_data_t& out,
+                       bool rte2) const noexcept {
   util::OpaquePointer<flightplan_type> c_fpl = m_rte1_ptr_;
   if (rte2) {
     c_fpl = m_rte2_ptr_;
   }
 
   std::string arr = c_fpl->get_arr_icao();
-  cdu_pages::cdu_scr_data_t out = {};
   for (size_t i = 9; i < 14; i++) out.chr_sts[0][i] = CDU_B_WHITE;
 
-  out.heading_small = get_small_heading();
-  out.heading_big = "   " + arr + " ARRIVALS";
+  cdu_pages::put_subpage_heading(out.heading_small, curr_subpg_, n_subpg_);
+  size_t hdg_col = cdu_pages::put_text(out.heading_big, 3, arr);
+  cdu_pages::put_text(out.heading_big, hdg_col, " ARRIVALS");
   out.heading_color = CDUColor::WHITE;
 
   for (int i = 0; i < 12; i++) {
-    out.data_lines.push_back("");
+    out.push_line();
   }
   if (rte2)
-    out.data_lines[0] = ARR_COLS2;
+    cdu_pages::set_line(out.data_lines[0], ARR_COLS2);
   else
-    out.data_lines[0] = ARR_COLS1;
+    cdu_pages::set_line(out.data_lines[0], ARR_COLS1);
 
   std::string curr_star = c_fpl->get_curr_proc(fms_core::PROC_TYPE_STAR);
   std::string curr_trans = c_fpl->get_curr_proc(fms_core::PROC_TYPE_STAR, true);
@@ -1565,8 +1643,24 @@ cdu_pages::cdu_scr_data_t CDU::get_arr_page(bool rte2) const noexcept {
            true);
 
   dep_arr_set_bottom(out);
+}
 
-  return out;
+void CDU::get_dep_arr_proc_page(cdu_pages::cdu_scr_data_t& out,
+                                bool rte2) const noexcept {
+  std::lock_guard lk(dep_arr_page_mutex_);
+
+  dep_arr_page_key_t key{get_dep_arr_key(rte2), dep_arr_lists_ver_,
+                         m_act_ptr_->get_id(), curr_subpg_, n_subpg_,
+                         fpl_sys_->get_exec()};
+  if (!(dep_arr_page_key_ == key)) {
+    dep_arr_page_.clear();
+    if (curr_page_ == CDUPage::DEP1 || curr_page_ == CDUPage::DEP2)
+      get_dep_page(dep_arr_page_, rte2);
+    else
+      get_arr_page(dep_arr_page_, rte2);
+    dep_arr_page_key_ = key;
+  }
+  out = dep_arr_page_;
 }
 
 // CDUDisplay definitions:
@@ -1595,17 +1689,31 @@ CDUDisplay::CDUDisplay(geom::vect2_t pos, geom::vect2_t sz,
     scale_coeff_ = sz.y / DISPLAY_SZ.y * CDU_RES_COEFF;
   }
 
-  textures_.init(tm);
+  textures_.init(tm, scale_coeff_);
+  screen_sfc_ = cairo_image_surface_create(
+      CAIRO_FORMAT_ARGB32, std::max(1, int(std::round(display_size_.x))),
+      std::max(1, int(std::round(display_size_.y))));
+  cairo_surface_flush(screen_sfc_);
+  cairo_utils::fill_block(screen_sfc_, 0, 0,
+                          cairo_image_surface_get_width(screen_sfc_),
+                          cairo_image_surface_get_height(screen_sfc_),
+                          cairo_utils::BLACK);
+  cairo_surface_mark_dirty(screen_sfc_);
   cdu_ptr_ = cdu;
 
   scratchpad_ = std::string(size_t(N_CDU_DATA_COLS), ' ');
   scratch_curr_ = 0;
 
   last_press_tp_ = std::chrono::steady_clock::now();
+  events_ = std::make_unique<event_queue_t>();
+  latency_ = std::make_unique<util::input_latency_t>();
+  pending_events_.reserve(N_CDU_PENDING_MAX);
 }
 
 void Swap(CDUDisplay& d_a, CDUDisplay& d_b) {
   std::swap(d_a.events_, d_b.events_);
+  std::swap(d_a.latency_, d_b.latency_);
+  std::swap(d_a.pending_events_, d_b.pending_events_);
   std::swap(d_a.display_pos_, d_b.display_pos_);
   std::swap(d_a.display_size_, d_b.display_size_);
   std::swap(d_a.scale_coeff_, d_b.scale_coeff_);
@@ -1614,38 +1722,99 @@ void Swap(CDUDisplay& d_a, CDUDisplay& d_b) {
   std::swap(d_a.last_press_tp_, d_b.last_press_tp_);
   std::swap(d_a.msg_stack_, d_b.msg_stack_);
   std::swap(d_a.textures_, d_b.textures_);
+  std::swap(d_a.screen_sfc_, d_b.screen_sfc_);
+  std::swap(d_a.drawn_rows_, d_b.drawn_rows_);
+  std::swap(d_a.has_drawn_, d_b.has_drawn_);
 }
 
 CDUDisplay::CDUDisplay(CDUDisplay&& other) {
   Swap(*this, other);
 }
 
+CDUDisplay::~CDUDisplay() {
+  if (screen_sfc_ != nullptr) {
+    cairo_surface_destroy(screen_sfc_);
+  }
+}
+
 std::pair<double, double> CDUDisplay::GetDrawSize() const noexcept {
   return {display_size_.x, display_size_.y};
 }
 
-void CDUDisplay::on_event(event_type event) {
-  std::unique_lock lk(main_mutex_);
-  events_.push(event);
+bool CDUDisplay::on_event(event_type event,
+                          std::chrono::steady_clock::time_point enq_tp) {
+  return events_->TryPush({event, enq_tp});
+}
+
+std::uint64_t CDUDisplay::GetDroppedEvents() const noexcept {
+  return events_->GetDropped();
+}
+
+util::input_latency_t& CDUDisplay::GetLatencyStats() noexcept {
+  return *latency_;
 }
 
 void CDUDisplay::draw(cairo_t* cr) {
+  MY_TRACE_SCOPE("CDUDisplay::draw");
+  MY_ALLOC_SCOPE("CDUDisplay::draw");
   std::unique_lock lk(main_mutex_);
   process_events(CNT_CDU_EVENTS_PER_FRAME);
+  std::string msg;
+  while (cdu_ptr_->pop_msg(&msg)) {
+    msg_stack_.push(msg);
+  }
+  // An edit only shows once CDU::update has read the flight plan it
+  // changed, which may be a few frames after the key was handled. Events
+  // are checked before drawing, so a CDU update that lands while drawing
+  // doesn't count for this frame.
+  auto shown_end = std::partition(
+      pending_events_.begin(), pending_events_.end(),
+      [this](const pending_event_t& ev) {
+        return cdu_ptr_->has_read_fpl_ids(ev.fpl_ids);
+      });
   draw_screen(cr);
+
+  auto drawn_tp = std::chrono::steady_clock::now();
+  for (auto it = pending_events_.begin(); it != shown_end; it++) {
+    latency_->total.Record(drawn_tp - it->enq_tp);
+  }
+  pending_events_.erase(pending_events_.begin(), shown_end);
+
+  if (latency_->show_overlay.load(std::memory_order_relaxed)) {
+    draw_latency_overlay(cr);
+  }
 }
 
 // Private member functions:
 
-void CDUDisplay::cdu_textures_t::init(util::OpaquePointer<TextureManager> tm) {
-  cdu_big_white = tm->GetTexture(CDU_WHITE_TEXT_NAME);
+void CDUDisplay::cdu_textures_t::init(util::OpaquePointer<TextureManager> tm,
+                                      double scale_coeff) {
+  geom::vect2_t sc_big = CDU_BIG_TEXT_SZ.scmul(scale_coeff);
+  geom::vect2_t sc_sml = CDU_SMALL_TEXT_SZ.scmul(scale_coeff);
+
+  cdu_big_white = tm->GetScaledTexture(CDU_WHITE_TEXT_NAME, sc_big);
   assert(cdu_big_white != nullptr);
-  cdu_big_green = tm->GetTexture(CDU_GREEN_TEXT_NAME);
+  cdu_big_green = tm->GetScaledTexture(CDU_GREEN_TEXT_NAME, sc_big);
   assert(cdu_big_green != nullptr);
-  cdu_big_cyan = tm->GetTexture(CDU_CYAN_TEXT_NAME);
+  cdu_big_cyan = tm->GetScaledTexture(CDU_CYAN_TEXT_NAME, sc_big);
   assert(cdu_big_cyan != nullptr);
-  cdu_big_magenta = tm->GetTexture(CDU_MAGENTA_TEXT_NAME);
+  cdu_big_magenta = tm->GetScaledTexture(CDU_MAGENTA_TEXT_NAME, sc_big);
   assert(cdu_big_magenta != nullptr);
+  cdu_small_white = tm->GetScaledTexture(CDU_WHITE_TEXT_NAME, sc_sml);
+  assert(cdu_small_white != nullptr);
+  cdu_small_green = tm->GetScaledTexture(CDU_GREEN_TEXT_NAME, sc_sml);
+  assert(cdu_small_green != nullptr);
+  cdu_small_cyan = tm->GetScaledTexture(CDU_CYAN_TEXT_NAME, sc_sml);
+  assert(cdu_small_cyan != nullptr);
+  cdu_small_magenta = tm->GetScaledTexture(CDU_MAGENTA_TEXT_NAME, sc_sml);
+  assert(cdu_small_magenta != nullptr);
+
+  // Glyphs are read from the sheets' pixel data directly
+  for (texture_type sheet : {cdu_big_white, cdu_big_green, cdu_big_cyan,
+                             cdu_big_magenta, cdu_small_white, cdu_small_green,
+                             cdu_small_cyan, cdu_small_magenta}) {
+    cairo_surface_flush(sheet);
+  }
 
   main_font_face =
       tm->GetFontData(fms_display_fonts::MAIN_FONT_NAME)->cairo_face;
@@ -1655,7 +1824,9 @@ void CDUDisplay::handle_event(event_type event) noexcept {
   if (event && (event < CDU_KEY_A || event == CDU_KEY_EXEC)) {
     std::string scratch_proc = strutils::strip(scratchpad_);
     std::string scr_out;
+    auto start_tp = std::chrono::steady_clock::now();
     std::string msg = cdu_ptr_->on_event(event, scratch_proc, &scr_out);
+    latency_->handling.Record(std::chrono::steady_clock::now() - start_tp);
 
     if (scr_out != "") {
       scratch_curr_ = scr_out.size();
@@ -1672,10 +1843,16 @@ void CDUDisplay::handle_event(event_type event) noexcept {
 }
 
 void CDUDisplay::process_events(std::size_t cnt_max) noexcept {
-  while (cnt_max && events_.size()) {
-    event_type curr = events_.front();
-    handle_event(curr);
-    events_.pop();
+  cdu_timed_event_t curr;
+  while (cnt_max && events_->TryPop(curr)) {
+    latency_->queue_wait.Record(std::chrono::steady_clock::now() -
+                                curr.enq_tp);
+    handle_event(curr.event);
+    if (pending_events_.size() == N_CDU_PENDING_MAX) {
+      // The CDU isn't being updated. Give up on the oldest event.
+      pending_events_.erase(pending_events_.begin());
+    }
+    pending_events_.push_back({curr.enq_tp, cdu_ptr_->get_fpl_ids()});
   }
 }
 
@@ -1789,114 +1966,186 @@ bool CDUDisplay::chr_is_big(char c) {
   return true;
 }
 
-CDUDisplay::texture_type CDUDisplay::get_font_sfc(CDUColor cl) {
+CDUDisplay::texture_type CDUDisplay::get_font_sfc(CDUColor cl, bool is_big) {
   texture_type font_sfc;
   if (cl == CDUColor::GREEN)
-    font_sfc = textures_.cdu_big_green;
+    font_sfc = is_big ? textures_.cdu_big_green : textures_.cdu_small_green;
   else if (cl == CDUColor::CYAN)
-    font_sfc = textures_.cdu_big_cyan;
+    font_sfc = is_big ? textures_.cdu_big_cyan : textures_.cdu_small_cyan;
   else if (cl == CDUColor::MAGENTA)
-    font_sfc = textures_.cdu_big_magenta;
+    font_sfc = is_big ? textures_.cdu_big_magenta : textures_.cdu_small_magenta;
   else
-    font_sfc = textures_.cdu_big_white;
+    font_sfc = is_big ? textures_.cdu_big_white : textures_.cdu_small_white;
 
   return font_sfc;
 }
 
-void CDUDisplay::draw_cdu_letter(cairo_t* cr, char c, geom::vect2_t pos,
+void CDUDisplay::draw_cdu_letter(char c, geom::vect2_t pos,
                                  geom::vect2_t scale, texture_type font_sfc) {
   if (scale.x == 0 || scale.y == 0) return;
 
+  // font_sfc is already scaled, so scale is only used to locate the glyph.
+  double l_width = CDU_LETTER_WIDTH * scale.x;
+  int y = int(std::round(pos.y));
+  int y_lo = std::max(y, clip_y_lo_);
+  int y_hi = std::min(y + int(std::round(CDU_LETTER_HEIGHT * scale.y)),
+                      clip_y_hi_);
+  if (y_lo >= y_hi) return;
+
   int idx = get_cdu_letter_idx(c);
-  geom::vect2_t offs = {-CDU_LETTER_WIDTH * scale.x * double(idx), 0};
-  geom::vect2_t img_pos = pos + offs;
-  cairo_save(cr);
-  cairo_scale(cr, scale.x, scale.y);
-  cairo_set_source_surface(cr, font_sfc, img_pos.x / scale.x,
-                           img_pos.y / scale.y);
-  cairo_rectangle(cr, pos.x / scale.x, pos.y / scale.y, CDU_LETTER_WIDTH,
-                  CDU_LETTER_HEIGHT);
-  cairo_clip(cr);
-  cairo_paint(cr);
-  cairo_restore(cr);
-}
-
-void CDUDisplay::draw_cdu_line(cairo_t* cr, const std::string& s,
+  cairo_utils::blit_block_over(
+      screen_sfc_, int(std::round(pos.x)), y_lo, font_sfc,
+      int(std::round(l_width * double(idx))), y_lo - y,
+      int(std::round(l_width)), y_hi - y_lo);
+}
+
+void CDUDisplay::draw_cdu_line(const cdu_pages::cdu_line_t& s,
                                geom::vect2_t pos, double l_intv_px,
-                               std::string sts, geom::vect2_t scale,
+                               const cdu_pages::cdu_line_t* sts, bool is_big,
                                CDUColor clr) {
-  if (sts != "") assert(sts.size() >= s.size());
-
-  cairo_surface_t* sfc_const = get_font_sfc(clr);
-  geom::vect2_t sc_big = CDU_BIG_TEXT_SZ;
-  geom::vect2_t sc_sml = CDU_SMALL_TEXT_SZ;
+  geom::vect2_t sc_big = CDU_BIG_TEXT_SZ.scmul(scale_coeff_);
+  geom::vect2_t sc_sml = CDU_SMALL_TEXT_SZ.scmul(scale_coeff_);
 
-  scale = scale.scmul(scale_coeff_);
-  sc_big = sc_big.scmul(scale_coeff_);
-  sc_sml = sc_sml.scmul(scale_coeff_);
+  cairo_surface_t* sfc_const = get_font_sfc(clr, is_big);
+  geom::vect2_t sc_const = is_big ? sc_big : sc_sml;
 
   for (size_t i = 0; i < s.size(); i++) {
-    cairo_surface_t* sfc = sfc_const;
-    geom::vect2_t sc_cr = scale;
-    if (sts != "") {
-      sfc = get_font_sfc(get_cdu_color(sts[i]));
-      if (chr_is_big(sts[i]))
-        sc_cr = sc_big;
-      else
-        sc_cr = sc_sml;
+    if (s[i] != ' ') {
+      cairo_surface_t* sfc = sfc_const;
+      geom::vect2_t sc_cr = sc_const;
+      if (sts != nullptr) {
+        bool chr_big = chr_is_big((*sts)[i]);
+        sfc = get_font_sfc(get_cdu_color((*sts)[i]), chr_big);
+        if (chr_big)
+          sc_cr = sc_big;
+        else
+          sc_cr = sc_sml;
+      }
+      draw_cdu_letter(s[i], pos, sc_cr, sfc);
     }
-    draw_cdu_letter(cr, s[i], pos, sc_cr, sfc);
     pos.x += l_intv_px;
   }
 }
 
-void CDUDisplay::draw_screen(cairo_t* cr) {
-  geom::vect2_t offs_hdg_small = {0, display_size_.y * CDU_V_OFFS_SMALL_FIRST};
-  geom::vect2_t pos_hdg_small = display_pos_ + offs_hdg_small;
-  geom::vect2_t small_offs = {0, display_size_.y * CDU_V_OFFS_FIRST_SM};
-  geom::vect2_t pos_small = display_pos_ + small_offs;
-  geom::vect2_t big_offs = {
-      0, display_size_.y * (CDU_BIG_TEXT_OFFS + CDU_V_OFFS_FIRST_BIG)};
-  geom::vect2_t pos_big = display_pos_ + big_offs;
-
-  cdu_pages::cdu_scr_data_t curr_screen = cdu_ptr_->get_screen_data();
+void CDUDisplay::set_curr_rows() {
+  cdu_ptr_->get_screen_data(screen_data_);
 
-  // Clear the screen:
-  cairo_utils::draw_rect(cr, display_pos_, display_size_, cairo_utils::BLACK);
+  auto set_row = [this](std::size_t idx, const cdu_pages::cdu_line_t& text,
+                        const cdu_pages::cdu_line_t* sts, CDUColor color,
+                        bool is_big) {
+    cdu_row_t& row = curr_rows_[idx];
+    row.text = text;
+    row.has_sts = sts != nullptr;
+    if (sts != nullptr)
+      row.sts = *sts;
+    else
+      cdu_pages::clear_line(row.sts);
+    row.color = color;
+    row.is_big = is_big;
+  };
 
-  draw_cdu_line(cr, curr_screen.heading_big, display_pos_,
-                CDU_TEXT_INTV * display_size_.x, "", CDU_BIG_TEXT_SZ,
-                curr_screen.heading_color);
+  set_row(0, screen_data_.heading_big, nullptr, screen_data_.heading_color,
+          true);
+  set_row(1, screen_data_.heading_small, nullptr, CDUColor::WHITE, false);
+  for (std::size_t i = 0; i < cdu_pages::N_CDU_SCR_LINES; i++) {
+    set_row(i + 2, screen_data_.data_lines[i], &screen_data_.chr_sts[i],
+            CDUColor::WHITE, true);
+  }
 
-  draw_cdu_line(cr, curr_screen.heading_small, pos_hdg_small,
-                CDU_TEXT_INTV * display_size_.x, "", CDU_SMALL_TEXT_SZ);
+  const std::string* tgt_scratch = &scratchpad_;
+  if (msg_stack_.size()) {
+    tgt_scratch = &msg_stack_.top();
+  } else if (scratchpad_[0] == DELETE_SYMBOL) {
+    tgt_scratch = &DELETE_MSG;
+  }
+  cdu_row_t& scratch_row = curr_rows_[N_CDU_SCR_ROWS - 1];
+  cdu_pages::set_line(scratch_row.text, *tgt_scratch);
+  cdu_pages::clear_line(scratch_row.sts);
+  scratch_row.has_sts = false;
+  scratch_row.color = CDUColor::WHITE;
+  scratch_row.is_big = true;
+}
 
-  size_t j = 0;
-  for (size_t i = 0; i < size_t(N_CDU_DATA_LINES); i++) {
-    if (j < curr_screen.data_lines.size()) {
-      draw_cdu_line(cr, curr_screen.data_lines[j], pos_small,
-                    CDU_TEXT_INTV * display_size_.x, curr_screen.chr_sts[j]);
+void CDUDisplay::draw_screen(cairo_t* cr) {
+  MY_TRACE_SCOPE("CDUDisplay::draw_screen");
+  set_curr_rows();
+
+  // Positions of rows relative to the screen, in the same order as the rows:
+  std::array<geom::vect2_t, N_CDU_SCR_ROWS> row_pos;
+  row_pos[0] = {0, 0};
+  row_pos[1] = {0, display_size_.y * CDU_V_OFFS_SMALL_FIRST};
+  geom::vect2_t pos_small = {0, display_size_.y * CDU_V_OFFS_FIRST_SM};
+  geom::vect2_t pos_big = {
+      0, display_size_.y * (CDU_BIG_TEXT_OFFS + CDU_V_OFFS_FIRST_BIG)};
+  for (std::size_t i = 0; i < N_CDU_DATA_LINES; i++) {
+    row_pos[2 * i + 2] = pos_small;
+    row_pos[2 * i + 3] = pos_big;
+    pos_small.y += CDU_V_OFFS_REG * display_size_.y;
+    pos_big.y += CDU_V_OFFS_REG * display_size_.y;
+  }
+  row_pos[N_CDU_SCR_ROWS - 1] = pos_small;
+
+  // Glyphs of neighboring rows overlap vertically, so every row is given the
+  // height of big text. A changed row clears its band, and every row that
+  // reaches into a cleared band gets redrawn, clipped to that band.
+  int row_h = int(std::round(CDU_LETTER_HEIGHT * CDU_BIG_TEXT_SZ.y *
+                             scale_coeff_));
+  int scr_w = cairo_image_surface_get_width(screen_sfc_);
+  double l_intv_px = CDU_TEXT_INTV * display_size_.x;
+
+  cairo_surface_flush(screen_sfc_);
+  bool is_dirty = false;
+  std::size_t i = 0;
+  while (i < N_CDU_SCR_ROWS) {
+    if (has_drawn_ && curr_rows_[i] == drawn_rows_[i]) {
+      i++;
+      continue;
     }
-    if (j + 1 < curr_screen.data_lines.size()) {
-      draw_cdu_line(cr, curr_screen.data_lines[j + 1], pos_big,
-                    CDU_TEXT_INTV * display_size_.x,
-                    curr_screen.chr_sts[j + 1]);
+    // Rows are sorted by y, so the band grows downwards only.
+    int band_lo = int(std::round(row_pos[i].y));
+    int band_hi = band_lo + row_h;
+    std::size_t last = i;
+    for (std::size_t k = i + 1; k < N_CDU_SCR_ROWS; k++) {
+      if (int(std::round(row_pos[k].y)) >= band_hi) break;
+      if (!has_drawn_ || !(curr_rows_[k] == drawn_rows_[k])) {
+        band_hi = int(std::round(row_pos[k].y)) + row_h;
+        last = k;
+      }
     }
 
-    pos_small.y += CDU_V_OFFS_REG * display_size_.y;
-    pos_big.y += CDU_V_OFFS_REG * display_size_.y;
-    j += 2;
+    cairo_utils::fill_block(screen_sfc_, 0, band_lo, scr_w, band_hi - band_lo,
+                            cairo_utils::BLACK);
+    clip_y_lo_ = band_lo;
+    clip_y_hi_ = band_hi;
+    for (std::size_t k = 0; k < N_CDU_SCR_ROWS; k++) {
+      int k_y = int(std::round(row_pos[k].y));
+      if (k_y >= band_hi || k_y + row_h <= band_lo) continue;
+      const cdu_row_t& row = curr_rows_[k];
+      draw_cdu_line(row.text, row_pos[k], l_intv_px,
+                    row.has_sts ? &row.sts : nullptr, row.is_big, row.color);
+    }
+    is_dirty = true;
+    i = last + 1;
   }
 
-  std::string tgt_scratch;
-  if (msg_stack_.size()) {
-    tgt_scratch = msg_stack_.top();
-  } else if (scratchpad_[0] == DELETE_SYMBOL) {
-    tgt_scratch = DELETE_MSG;
-  } else {
-    tgt_scratch = scratchpad_;
+  if (is_dirty) {
+    cairo_surface_mark_dirty(screen_sfc_);
+    std::swap(drawn_rows_, curr_rows_);
+    has_drawn_ = true;
   }
-  draw_cdu_line(cr, tgt_scratch, pos_small, CDU_TEXT_INTV * display_size_.x, "",
-                CDU_BIG_TEXT_SZ);
+  cairo_utils::blit_image(cr, screen_sfc_, display_pos_, false);
+}
+
+void CDUDisplay::draw_latency_overlay(cairo_t* cr) {
+  const util::LatencyHistogram& total = latency_->total;
+  std::string txt = std::format("P50 {:.1f} P95 {:.1f} P99 {:.1f} MS N {}",
+                                total.GetPercentileMs(50),
+                                total.GetPercentileMs(95),
+                                total.GetPercentileMs(99), total.GetCount());
+  fms_display_fonts::draw_left_text(
+      cr, textures_.main_font_face, txt,
+      display_pos_ + display_size_ * CDU_LAT_OVERLAY_OFFS, cairo_utils::GREEN,
+      CDU_LAT_OVERLAY_FONT_SZ, display_size_,
+      fms_display_fonts::kSmallTextSlope);
 }
 }  // namespace fms_displays
@@ -1,13 +1,18 @@
 #pragma once
 
+#include <cstdint>
+
+#include <array>
 #include <chrono>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <optional>
-#include <queue>
 #include <shared_mutex>
 #include <stack>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include <displays/common/cairo_utils.hpp>
 #include <displays/common/texture_manager.hpp>
@@ -15,6 +20,9 @@
 #include <fpln/flightpln_int.hpp>
 #include <libnav/cifp_parser.hpp>
 #include <util/geom.hpp>
+#include <util/instr_mutex.hpp>
+#include <util/latency_hist.hpp>
+#include <util/spsc_ring.hpp>
 #include <util/util.hpp>
 
 #include "cdu_context.hpp"
@@ -42,6 +50,7 @@ const std::vector<CDUPage> CDU_PAGE_FACES = {
 class CDU final {
  public:
   using flightplan_type = typename fms_core::FPLSys::flightplan_type;
+  using fpl_ids_t = std::array<double, fms_core::N_FPL_SYS_RTES>;
 
   CDU(util::OpaquePointer<fms_core::FPLSys> fs, size_t sd_idx);
 
@@ -52,10 +61,22 @@ class CDU final {
   std::string on_event(int event_key, std::string scratchpad,
                        std::string* s_out) noexcept;
 
-  cdu_pages::cdu_scr_data_t get_screen_data() const noexcept;
+  // Overwrites out with the current screen
+  void get_screen_data(cdu_pages::cdu_scr_data_t& out) const noexcept;
+
+  // Takes the oldest scratchpad message left by a background job, such as
+  // a route save. Returns false if there is none.
+  bool pop_msg(std::string* out) noexcept;
+
+  // Ids of the flight plans as they are now
+  fpl_ids_t get_fpl_ids() const noexcept;
+
+  // Whether the last update read every flight plan at an id no older than
+  // the one in ids, i.e. the screen shows the edits made up to ids.
+  bool has_read_fpl_ids(const fpl_ids_t& ids) const noexcept;
 
  private:
-  mutable std::shared_mutex main_mutex_;
+  mutable util::InstrSharedMutex main_mutex_{"CDU"};
 
   std::size_t act_sd_idx_;
 
@@ -124,6 +145,38 @@ class CDU final {
   std::vector<std::vector<std::string>> rwys_;
   std::vector<std::vector<std::string>> vias_;
 
+  /*
+      The lists above and the formatted DEP/ARR page are only rebuilt when
+      the state they were made from changes. The id of a flight plan changes
+      with every edit to it, so it stands for the selected procedures and
+      runways.
+  */
+  struct dep_arr_key_t {
+    CDUPage page;
+    double fpl_id;
+    std::string dep_icao, arr_icao;
+    bool rwy_filter, proc_filter, trans_filter, via_filter;
+
+    bool operator==(const dep_arr_key_t& other) const = default;
+  };
+
+  struct dep_arr_page_key_t {
+    dep_arr_key_t lists;
+    std::size_t lists_ver;
+    double act_fpl_id;
+    int curr_subpg, n_subpg;
+    bool exec;
+
+    bool operator==(const dep_arr_page_key_t& other) const = default;
+  };
+
+  std::optional<dep_arr_key_t> dep_arr_lists_key_;
+  std::size_t dep_arr_lists_ver_ = 0;
+  // get_screen_data only holds a shared lock, so the page cache has its own
+  mutable std::mutex dep_arr_page_mutex_;
+  mutable std::optional<dep_arr_page_key_t> dep_arr_page_key_;
+  mutable cdu_pages::cdu_scr_data_t dep_arr_page_;
+
   // LEGS data:
   bool leg_sel_pr_ = false;
   size_t n_seg_list_sz_, n_leg_list_sz_;
@@ -138,10 +191,13 @@ class CDU final {
   std::vector<libnav::waypoint_entry_t> sel_des_data_;
   std::string sel_des_nm_ = "";
 
-  static std::string str_align_right(const std::string& str);
-
-  static std::string get_cdu_line(std::string in, std::string line,
-                                  bool align_right = false);
+  // Messages from jobs on the I/O worker. Shared with the jobs, so that one
+  // finishing after the CDU is gone doesn't write to freed memory.
+  struct bg_msgs_t {
+    std::mutex mtx;
+    std::deque<std::string> msgs;
+  };
+  std::shared_ptr<bg_msgs_t> bg_msgs_;
 
   static bool scratchpad_has_delete(const std::string& scratchpad);
 
@@ -172,6 +228,11 @@ class CDU final {
 
   std::string save_rte();
 
+  // Loads a company route from the catalog by name or by a unique name
+  // prefix. An ambiguous prefix puts the first match into the scratchpad.
+  // An empty entry offers the next route for the current city pair.
+  std::string set_co_rte(std::string name, std::string* s_out);
+
   std::string add_via(size_t next_idx, std::string name);
 
   std::string delete_via(size_t next_idx);
@@ -182,18 +243,18 @@ class CDU final {
 
   void get_seg_page(cdu_pages::cdu_scr_data_t* in) const noexcept;
 
-  std::string get_sts(std::string& cr, std::string& act) const noexcept;
+  std::string_view get_sts(std::string_view cr,
+                           std::string_view act) const noexcept;
 
-  void get_procs(cdu_pages::cdu_scr_data_t* in, std::string curr_proc,
-                 std::string curr_trans, std::string act_proc,
-                 std::string act_trans, bool rte2) const noexcept;
+  void get_procs(cdu_pages::cdu_scr_data_t* in, std::string_view curr_proc,
+                 std::string_view curr_trans, std::string_view act_proc,
+                 std::string_view act_trans, bool rte2) const noexcept;
 
-  void get_rwys(cdu_pages::cdu_scr_data_t* in, std::string curr_rwy, std::string act_rwy,
-                bool rte2, std::string curr_appr = "",
-                std::string curr_via = "", std::string act_appr = "",
-                std::string act_via = "", bool get_appr = false) const noexcept;
-
-  std::string get_small_heading() const noexcept;
+  void get_rwys(cdu_pages::cdu_scr_data_t* in, std::string_view curr_rwy,
+                std::string_view act_rwy, bool rte2,
+                std::string_view curr_appr = "", std::string_view curr_via = "",
+                std::string_view act_appr = "", std::string_view act_via = "",
+                bool get_appr = false) const noexcept;
 
   void set_procs(fms_core::ProcType ptp, bool is_arr, bool rte2);
 
@@ -201,7 +262,9 @@ class CDU final {
 
   void get_rte_dep_arr(cdu_pages::cdu_scr_data_t& out, bool rte2) const noexcept;
 
-  bool arr_has_rwys(std::string& cr_appr, bool rte2) const noexcept;
+  bool arr_has_rwys(std::string_view cr_appr, bool rte2) const noexcept;
+
+  dep_arr_key_t get_dep_arr_key(bool rte2) const noexcept;
 
   // Per-page fetching of the number of subpages:
 
@@ -231,17 +294,21 @@ class CDU final {
   // Per-page content fetching. The CDU displays exactly what these functions
   // output:
 
-  cdu_pages::cdu_scr_data_t get_sel_des_page() const noexcept;
+  void get_sel_des_page(cdu_pages::cdu_scr_data_t& out) const noexcept;
 
-  cdu_pages::cdu_scr_data_t get_rte_page() const noexcept;
+  void get_rte_page(cdu_pages::cdu_scr_data_t& out) const noexcept;
 
-  cdu_pages::cdu_scr_data_t get_dep_arr_page() const noexcept;
+  void get_dep_arr_page(cdu_pages::cdu_scr_data_t& out) const noexcept;
 
   void dep_arr_set_bottom(cdu_pages::cdu_scr_data_t& out) const noexcept;
 
-  cdu_pages::cdu_scr_data_t get_dep_page(bool rte2) const noexcept;
+  void get_dep_page(cdu_pages::cdu_scr_data_t& out, bool rte2) const noexcept;
 
-  cdu_pages::cdu_scr_data_t get_arr_page(bool rte2) const noexcept;
+  void get_arr_page(cdu_pages::cdu_scr_data_t& out, bool rte2) const noexcept;
+
+  // Outputs the current DEP or ARR page, formatting it only if it changed
+  void get_dep_arr_proc_page(cdu_pages::cdu_scr_data_t& out,
+                             bool rte2) const noexcept;
 };
 
 class CDUDisplay final {
@@ -260,32 +327,91 @@ class CDUDisplay final {
 
   CDUDisplay(CDUDisplay&& other);
 
+  ~CDUDisplay();
+
   std::pair<double, double> GetDrawSize() const noexcept;
 
-  void on_event(event_type event);
+  // May be called from a single input thread, concurrently with draw.
+  // enq_tp is when the key was pressed.
+  // Returns false if the event was dropped because the queue was full.
+  bool on_event(event_type event, std::chrono::steady_clock::time_point
+                enq_tp = std::chrono::steady_clock::now());
+
+  // Number of events dropped by on_event so far
+  std::uint64_t GetDroppedEvents() const noexcept;
+
+  util::input_latency_t& GetLatencyStats() noexcept;
 
   void draw(cairo_t* cr);
 
  private:
+  // Font sheets are pre-scaled to the on-screen size of big and small text.
   struct cdu_textures_t {
     texture_type cdu_big_white;
     texture_type cdu_big_green;
     texture_type cdu_big_cyan;
     texture_type cdu_big_magenta;
+    texture_type cdu_small_white;
+    texture_type cdu_small_green;
+    texture_type cdu_small_cyan;
+    texture_type cdu_small_magenta;
 
     cairo_font_face_t* main_font_face;
 
-    void init(util::OpaquePointer<TextureManager> tm);
+    void init(util::OpaquePointer<TextureManager> tm, double scale_coeff);
   };
 
+  // One text row of the CDU screen as it is drawn
+  struct cdu_row_t {
+    cdu_pages::cdu_line_t text;
+    cdu_pages::cdu_line_t sts;  // Per-character color and size
+    bool has_sts;  // Whether sts is used. Otherwise color and is_big apply
+    CDUColor color;
+    bool is_big;
+
+    bool operator==(const cdu_row_t& other) const = default;
+  };
+
+  // Headings, data lines and the scratchpad, in the order they are drawn
+  static constexpr std::size_t N_CDU_SCR_ROWS = 2 * N_CDU_DATA_LINES + 3;
+
+  using cdu_rows_t = std::array<cdu_row_t, N_CDU_SCR_ROWS>;
+
+  static constexpr std::size_t N_CDU_EVENT_QUEUE_SZ = 64;
+
+  using event_queue_t = util::SPSCRing<cdu_timed_event_t, N_CDU_EVENT_QUEUE_SZ>;
+
   mutable std::mutex main_mutex_;
-  std::queue<event_type> events_;
+  // Written by on_event, read by draw. Not guarded by main_mutex_.
+  std::unique_ptr<event_queue_t> events_;
+  std::unique_ptr<util::input_latency_t> latency_;
+  // Events that were handled but whose result isn't on the screen yet
+  struct pending_event_t {
+    std::chrono::steady_clock::time_point enq_tp;
+    CDU::fpl_ids_t fpl_ids;  // Flight plan ids right after handling
+  };
+
+  static constexpr std::size_t N_CDU_PENDING_MAX = 4 * N_CDU_EVENT_QUEUE_SZ;
+
+  std::vector<pending_event_t> pending_events_;
 
   geom::vect2_t display_pos_;  // position of the CDU display on the screen
   geom::vect2_t display_size_;
   double scale_coeff_;
 
   cdu_textures_t textures_;
+  // Whole CDU screen. Glyphs are copied into it straight from the font
+  // sheets and it is then painted onto the target once per frame.
+  texture_type screen_sfc_ = nullptr;
+  // Rows currently in screen_sfc_. Only rows that differ from these get
+  // redrawn.
+  cdu_rows_t drawn_rows_;
+  cdu_rows_t curr_rows_;
+  // Filled in place by the CDU every frame
+  cdu_pages::cdu_scr_data_t screen_data_;
+  bool has_drawn_ = false;
+  // Vertical range of screen_sfc_ that glyphs are clipped to
+  int clip_y_lo_ = 0, clip_y_hi_ = 0;
   util::OpaquePointer<CDU> cdu_ptr_;
 
   std::string scratchpad_;
@@ -311,15 +437,23 @@ class CDUDisplay final {
 
   static bool chr_is_big(char c);
 
-  texture_type get_font_sfc(CDUColor cl);
+  texture_type get_font_sfc(CDUColor cl, bool is_big = true);
+
+  // Positions passed to these are relative to the CDU screen.
 
-  void draw_cdu_letter(cairo_t* cr, char c, geom::vect2_t pos,
-                       geom::vect2_t scale, texture_type font_sfc);
+  void draw_cdu_letter(char c, geom::vect2_t pos, geom::vect2_t scale,
+                       texture_type font_sfc);
 
-  void draw_cdu_line(cairo_t* cr, const std::string& s, geom::vect2_t pos,
-                     double l_intv_px, std::string sts = "",
-                     geom::vect2_t scale = {}, CDUColor clr = CDUColor::WHITE);
+  // sts may be nullptr, in which case is_big and clr apply to all of s
+  void draw_cdu_line(const cdu_pages::cdu_line_t& s, geom::vect2_t pos,
+                     double l_intv_px,
+                     const cdu_pages::cdu_line_t* sts = nullptr,
+                     bool is_big = true, CDUColor clr = CDUColor::WHITE);
+
+  void set_curr_rows();
 
   void draw_screen(cairo_t* cr);
+
+  void draw_latency_overlay(cairo_t* cr);
 };
 }  // namespace fms_displays
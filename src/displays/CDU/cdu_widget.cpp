@@ -62,7 +62,7 @@ void CDUWidget::on_click(geom::vect2_t pos) {
   if (pos.x >= 0 && pos.y >= 0 && pos.x < texture_size_.x && pos.y < texture_size_.y) {
     int event = int(key_map_->get_at(size_t(pos.x), size_t(pos.y)));
 
-    cdu_displ_->on_event(event);
+    cdu_displ_->on_event(event, curr_tp);
   }
 }
 
@@ -2,6 +2,9 @@
 
 #include <cstddef>
 
+#include <chrono>
+#include <string>
+
 namespace fms_displays {
 
 constexpr char DELETE_SYMBOL = 'd';
@@ -61,6 +64,11 @@ constexpr cdu_event_type CDU_KEY_0 = 67;
 constexpr cdu_event_type CDU_KEY_PM = 68;  // +/- key
 constexpr cdu_event_type CDU_KEY_EXEC = 69;
 
+struct cdu_timed_event_t {
+  cdu_event_type event;
+  std::chrono::steady_clock::time_point enq_tp;  // When the key was pressed
+};
+
 // CDU char states:
 constexpr char CDU_S_WHITE = 'w';
 constexpr char CDU_B_WHITE = 'W';
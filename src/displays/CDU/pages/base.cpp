@@ -1,6 +1,11 @@
 #include "base.hpp"
 
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
 #include <string>
+#include <string_view>
 
 #include <displays/CDU/common.hpp>
 #include <libnav/geo_utils.hpp>
@@ -8,10 +13,29 @@
 
 namespace {
 
-const std::string CDU_ALL_S_WHITE = std::string(fms_displays::N_CDU_DATA_COLS, 
-  fms_displays::CDU_S_WHITE);
-const std::string CDU_ALL_B_WHITE = std::string(fms_displays::N_CDU_DATA_COLS, 
-  fms_displays::CDU_B_WHITE);
+// Writes a coordinate as hemisphere, degrees padded to n_deg_digits and
+// minutes to a tenth, e.g. N47°27.0 or W122°18.5. Returns the end of the
+// written text.
+char* put_coord(char* out, double deg, char pos_hem, char neg_hem,
+                int n_deg_digits) noexcept {
+  *out++ = deg < 0 ? neg_hem : pos_hem;
+  long tenths = std::lround(std::abs(deg) * 600);  // Tenths of a minute
+  long whole_deg = tenths / 600;
+  long min_tenths = tenths % 600;
+  char deg_buf[4] = {};
+  char* deg_end = std::to_chars(deg_buf, deg_buf + sizeof(deg_buf), 
+    whole_deg).ptr;
+  for (long i = deg_end - deg_buf; i < n_deg_digits; i++) {
+    *out++ = '0';
+  }
+  out = std::copy(deg_buf, deg_end, out);
+  *out++ = strutils::DEGREE_SYMBOL;
+  *out++ = char('0' + min_tenths / 100);
+  *out++ = char('0' + min_tenths / 10 % 10);
+  *out++ = '.';
+  *out++ = char('0' + min_tenths % 10);
+  return out;
+}
 } // namespace
 
 namespace cdu_pages {
@@ -51,39 +75,90 @@ std::string get_scratchpad_pos(geo::point pos) noexcept {
   return res;
 }
 
-std::string str_align_right(const std::string& str) {
-  if(str.size() > fms_displays::N_CDU_DATA_COLS) {
-    std::size_t diff = str.size() - fms_displays::N_CDU_DATA_COLS;
-    return str.substr(diff);
-  }
-  std::size_t diff = fms_displays::N_CDU_DATA_COLS - str.size();
-  std::string out = std::string(diff, ' ') + str;
-  return out;
+void put_pos_right(cdu_line_t& line, geo::point pos) noexcept {
+  char buf[fms_displays::N_CDU_DATA_COLS];
+  char* curr = put_coord(buf, pos.lat_rad * geo::RAD_TO_DEG, 'N', 'S', 2);
+  *curr++ = ' ';
+  curr = put_coord(curr, pos.lon_rad * geo::RAD_TO_DEG, 'E', 'W', 3);
+  put_text_right(line, std::string_view(buf, std::size_t(curr - buf)));
 }
 
-std::string get_displayed_pos(geo::point pos) noexcept {
-  return strutils::lat_to_str(pos.lat_rad * geo::RAD_TO_DEG) + " " + 
-    strutils::lon_to_str(pos.lon_rad * geo::RAD_TO_DEG);
+void clear_line(cdu_line_t& line) noexcept {
+  line.fill(' ');
 }
 
-std::string get_small_heading(
-  unsigned subpage, unsigned cnt_subpages) noexcept {
-  std::string curr_spg = std::to_string(subpage);
-  std::string n_spg = std::to_string(cnt_subpages);
-  std::string out = curr_spg + "/" + n_spg + " ";
-  out = std::string(std::size_t(fms_displays::N_CDU_DATA_COLS) - out.size(), 
-    ' ') + out;
-  return out;
+void set_line(cdu_line_t& line, std::string_view s) noexcept {
+  clear_line(line);
+  put_text(line, 0, s);
 }
 
+std::size_t put_text(cdu_line_t& line, std::size_t col, 
+    std::string_view s) noexcept {
+  if(col >= line.size()) {
+    return line.size();
+  }
+  std::size_t n = std::min(s.size(), line.size() - col);
+  std::copy_n(s.begin(), n, line.begin() + col);
+  return col + n;
+}
+
+void put_text_right(cdu_line_t& line, std::string_view s) noexcept {
+  if(s.size() > line.size()) {
+    s.remove_prefix(s.size() - line.size());
+  }
+  put_text(line, line.size() - s.size(), s);
+}
+
+void put_subpage_heading(cdu_line_t& line, unsigned subpage, 
+    unsigned cnt_subpages) noexcept {
+  char buf[2 * fms_displays::N_CDU_DATA_COLS];
+  char* end = buf + sizeof(buf);
+  char* curr = std::to_chars(buf, end, subpage).ptr;
+  *curr++ = '/';
+  curr = std::to_chars(curr, end, cnt_subpages).ptr;
+  *curr++ = ' ';
+  put_text_right(line, std::string_view(buf, std::size_t(curr - buf)));
+}
 
 cdu_scr_data_t::cdu_scr_data_t() {
-  data_lines.reserve(fms_displays::N_CDU_DATA_LINES * 2);
-  chr_sts.reserve(fms_displays::N_CDU_DATA_LINES * 2);
-  for (unsigned i = 0; i < fms_displays::N_CDU_DATA_LINES; i++) {
-    chr_sts.push_back(CDU_ALL_S_WHITE);
-    chr_sts.push_back(CDU_ALL_B_WHITE);
+  clear();
+}
+
+void cdu_scr_data_t::clear() noexcept {
+  clear_line(heading_big);
+  clear_line(heading_small);
+  heading_color = fms_displays::CDUColor::WHITE;
+  for (std::size_t i = 0; i < N_CDU_SCR_LINES; i++) {
+    clear_line(data_lines[i]);
+    if(i % 2) {
+      chr_sts[i].fill(fms_displays::CDU_B_WHITE);
+    } else {
+      chr_sts[i].fill(fms_displays::CDU_S_WHITE);
+    }
+  }
+  n_lines = 0;
+}
+
+void cdu_scr_data_t::push_line(std::string_view s) noexcept {
+  if(n_lines < N_CDU_SCR_LINES) {
+    set_line(data_lines[n_lines], s);
   }
+  n_lines++;
+}
+
+void cdu_scr_data_t::pop_line() noexcept {
+  if(n_lines == 0) {
+    return;
+  }
+  n_lines--;
+  if(n_lines < N_CDU_SCR_LINES) {
+    clear_line(data_lines[n_lines]);
+  }
+}
+
+cdu_line_t& cdu_scr_data_t::last_line() noexcept {
+  std::size_t idx = std::min(n_lines, N_CDU_SCR_LINES);
+  return data_lines[idx ? idx - 1 : 0];
 }
 
 void PageBase::update() noexcept {}
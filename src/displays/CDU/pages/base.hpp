@@ -1,7 +1,9 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <string>
-#include <vector>
+#include <string_view>
 
 #include <displays/CDU/common.hpp>
 #include <libnav/geo_utils.hpp>
@@ -14,20 +16,59 @@ bool scratchpad_has_delete(const std::string& scratchpad) noexcept;
 
 std::string get_scratchpad_pos(geo::point pos) noexcept;
 
-std::string str_align_right(const std::string& str);
+constexpr std::size_t N_CDU_SCR_LINES = 2 * fms_displays::N_CDU_DATA_LINES;
 
-std::string get_displayed_pos(geo::point pos) noexcept;
+// One line of CDU characters. Unused cells hold spaces.
+using cdu_line_t = std::array<char, fms_displays::N_CDU_DATA_COLS>;
 
-std::string get_small_heading(unsigned subpage, 
+// Writes pos as e.g. "N47°27.0 W122°18.5" so that it ends in the last
+// column of line. Formats in place, without building strings.
+void put_pos_right(cdu_line_t& line, geo::point pos) noexcept;
+
+void clear_line(cdu_line_t& line) noexcept;
+
+// Replaces the contents of line with s
+void set_line(cdu_line_t& line, std::string_view s) noexcept;
+
+// Writes s into line starting at column col and keeps the other cells.
+// Text past the end of the line is cut off. Returns the column right
+// after s, so that consecutive pieces of a line can be chained.
+std::size_t put_text(cdu_line_t& line, std::size_t col, 
+  std::string_view s) noexcept;
+
+// Writes s so that it ends in the last column. If s is too long, 
+// its beginning is cut off.
+void put_text_right(cdu_line_t& line, std::string_view s) noexcept;
+
+// Writes "subpage/cnt_subpages " to the right side of line
+void put_subpage_heading(cdu_line_t& line, unsigned subpage, 
   unsigned cnt_subpages) noexcept;
 
+/*
+  Contents of the CDU screen as a fixed grid of characters and their states
+  (see CDU char states in common.hpp). Pages write into it in place, so
+  generating a screen doesn't allocate.
+*/
 struct cdu_scr_data_t {
-  std::string heading_big, heading_small;
+  cdu_line_t heading_big, heading_small;
   fms_displays::CDUColor heading_color;
-  std::vector<std::string> data_lines;
-  std::vector<std::string> chr_sts;
+  std::array<cdu_line_t, N_CDU_SCR_LINES> data_lines;
+  std::array<cdu_line_t, N_CDU_SCR_LINES> chr_sts;
+  // Number of lines added by push_line. Lines past N_CDU_SCR_LINES are 
+  // dropped but still counted, so that pop_line stays balanced.
+  std::size_t n_lines;
 
   cdu_scr_data_t();
+
+  // Resets everything to blank lines with default character states
+  void clear() noexcept;
+
+  void push_line(std::string_view s = {}) noexcept;
+
+  void pop_line() noexcept;
+
+  // Line most recently added by push_line
+  cdu_line_t& last_line() noexcept;
 };
 
 struct cdu_event_res_t {
@@ -49,7 +90,8 @@ public:
   // with select desired need to override this.
   virtual void on_page_change(fms_displays::CDUPage) noexcept;
 
-  virtual cdu_scr_data_t get_screen_data() const noexcept = 0;
+  // out is expected to be cleared by the caller
+  virtual void get_screen_data(cdu_scr_data_t& out) const noexcept = 0;
 
   virtual ~PageBase() = default;
 };
@@ -2,8 +2,10 @@
 
 #include <cassert>
 
+#include <algorithm>
 #include <optional>
 #include <string>
+#include <string_view>
 
 #include <fpln/fpln_sys.hpp>
 #include <util/date_time.hpp>
@@ -66,16 +68,17 @@ std::string Ident::get_ident_date_airac_string(unsigned airac) noexcept {
   return base_md + exp_md + std::string{"/"} + std::string{out_year};
 }
 
-std::string Ident::get_ident_aircraft_string(
+void Ident::put_ident_aircraft(cdu_line_t& line,
   const fms_core::aircraft_info_t& ac_inf) noexcept {
   if(ac_inf.model.size() + ac_inf.engine_model.size() >= 
     std::size_t{fms_displays::N_CDU_DATA_COLS}) {
-    std::string raw = ac_inf.model + " " + ac_inf.engine_model;
-    return raw.substr(0, std::size_t{fms_displays::N_CDU_DATA_COLS});
+    std::size_t col = put_text(line, 0, ac_inf.model);
+    col = put_text(line, col, " ");
+    put_text(line, col, ac_inf.engine_model);
+    return;
   }
-  std::size_t n_spaces = std::size_t{fms_displays::N_CDU_DATA_COLS} - 
-    ac_inf.model.size() - ac_inf.engine_model.size();
-  return ac_inf.model + std::string(n_spaces, ' ') + ac_inf.engine_model;
+  put_text(line, 0, ac_inf.model);
+  put_text_right(line, ac_inf.engine_model);
 }
 
 std::string Ident::get_ident_airac_string(unsigned airac) noexcept {
@@ -105,12 +108,16 @@ void Ident::fill_drag_ff_num(int num, char out_buff[5]) noexcept {
   out_buff[1] = '0' + abs(num % 10);
 }
 
-std::string Ident::get_ident_drag_ff() const noexcept {
+void Ident::put_ident_drag_ff(cdu_line_t& line) const noexcept {
   char drag[5];
   char ff[5];
   fill_drag_ff_num(drag_, drag);
   fill_drag_ff_num(fuel_flow_, ff);
-  return std::string{drag} + "/" + std::string{ff};
+  char drag_ff[9];
+  std::copy_n(drag, 4, drag_ff);
+  drag_ff[4] = '/';
+  std::copy_n(ff, 4, drag_ff + 5);
+  put_text_right(line, std::string_view(drag_ff, sizeof(drag_ff)));
 }
 
 std::optional<int> Ident::get_ident_entry_number(const std::string& scratchpad) noexcept {
@@ -153,6 +160,7 @@ Ident::Ident(util::OpaquePointer<fms_core::FPLSys> fpl_sys) {
   ac_info_ = fpl_sys->get_aircraft_info();
   airac_cycle_ = static_cast<unsigned>(
     fpl_sys->get_awy_db_ptr()->get_airac());
+  airac_line_ = get_ident_airac_string(airac_cycle_);
 }
 
 fms_displays::CDUPage Ident::get_page_number() const noexcept {
@@ -202,30 +210,26 @@ cdu_event_res_t Ident::on_event(fms_displays::cdu_event_type event,
   return res;
 }
 
-cdu_scr_data_t Ident::get_screen_data() const noexcept {
-  cdu_pages::cdu_scr_data_t out = {};
-  out.heading_big = IDENT_PAGE_HEADING;
+void Ident::get_screen_data(cdu_scr_data_t& out) const noexcept {
+  set_line(out.heading_big, IDENT_PAGE_HEADING);
   out.heading_color = fms_displays::CDUColor::WHITE;
-  out.data_lines.push_back(IDENT_LINE_1);
-  out.data_lines.push_back(get_ident_aircraft_string(ac_info_));
-  out.data_lines.push_back(IDENT_LINE_3);
-  out.data_lines.push_back(get_ident_airac_string(airac_cycle_));
-  out.data_lines.push_back("");
-  out.data_lines.push_back("");
-  out.data_lines.push_back("");
-  out.data_lines.push_back("");
+  out.push_line(IDENT_LINE_1);
+  out.push_line();
+  put_ident_aircraft(out.last_line(), ac_info_);
+  out.push_line(IDENT_LINE_3);
+  out.push_line(airac_line_);
+  out.push_line();
+  out.push_line();
+  out.push_line();
+  out.push_line();
   if(is_armed_) {
-    out.data_lines.push_back(ARM_IDENT_LINE_9);
+    out.push_line(ARM_IDENT_LINE_9);
   } else {
-    out.data_lines.push_back(IDENT_LINE_9);
+    out.push_line(IDENT_LINE_9);
   }
-  std::string drag_ff = get_ident_drag_ff();
-  assert(drag_ff.size() < fms_displays::N_CDU_DATA_COLS);
-  std::string drag_offset = std::string(
-    fms_displays::N_CDU_DATA_COLS - drag_ff.size(), ' ');
-  out.data_lines.push_back(drag_offset + drag_ff);
-  out.data_lines.push_back(fms_displays::ALL_DASH);
-  out.data_lines.push_back(IDENT_LINE_12);
-  return out;
+  out.push_line();
+  put_ident_drag_ff(out.last_line());
+  out.push_line(fms_displays::ALL_DASH);
+  out.push_line(IDENT_LINE_12);
 }
 } // namespace cdu_pages
@@ -17,13 +17,15 @@ class Ident final : public PageBase {
   int drag_ = 0;
   int fuel_flow_ = 0;
   bool is_armed_ = false;
+  // AIRAC line doesn't change, so it's formatted once
+  std::string airac_line_;
 
   static std::string month_date_to_str(std::chrono::month_day md) noexcept;
 
   static std::string get_ident_date_airac_string(
     unsigned airac) noexcept;
 
-  static std::string get_ident_aircraft_string(
+  static void put_ident_aircraft(cdu_line_t& line,
     const fms_core::aircraft_info_t& ac_inf) noexcept;
 
   static std::string get_ident_airac_string(
@@ -34,7 +36,7 @@ class Ident final : public PageBase {
   static std::optional<int> get_ident_entry_number(
     const std::string& scratchpad) noexcept;
 
-  std::string get_ident_drag_ff() const noexcept;
+  void put_ident_drag_ff(cdu_line_t& line) const noexcept;
 
 public:
   explicit Ident(util::OpaquePointer<fms_core::FPLSys> fpl_sys);
@@ -44,6 +46,6 @@ public:
   cdu_event_res_t on_event(fms_displays::cdu_event_type event, 
     const std::string& scratchpad, std::string& s_out) noexcept override;
 
-  cdu_scr_data_t get_screen_data() const noexcept override;
+  void get_screen_data(cdu_scr_data_t& out) const noexcept override;
 };
 } // namespace cdu_pages
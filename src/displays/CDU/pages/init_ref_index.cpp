@@ -61,13 +61,11 @@ cdu_event_res_t InitRefIndex::on_event(fms_displays::cdu_event_type event,
   return res;
 }
 
-cdu_scr_data_t InitRefIndex::get_screen_data() const noexcept {
-  cdu_pages::cdu_scr_data_t out = {};
-  out.heading_big = INIT_REF_INDEX_HEADING;
+void InitRefIndex::get_screen_data(cdu_scr_data_t& out) const noexcept {
+  set_line(out.heading_big, INIT_REF_INDEX_HEADING);
   out.heading_color = fms_displays::CDUColor::WHITE;
   for(std::size_t i = 0; i < MY_ARRAY_SIZE(INIT_REF_INDEX_LINES); ++i) {
-    out.data_lines.push_back(std::string{INIT_REF_INDEX_LINES[i]});
+    out.push_line(INIT_REF_INDEX_LINES[i]);
   }
-  return out;
 }
 } // namespace cdu_pages
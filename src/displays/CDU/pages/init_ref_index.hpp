@@ -20,6 +20,6 @@ public:
   cdu_event_res_t on_event(fms_displays::cdu_event_type event, 
     const std::string& scratchpad, std::string& s_out) noexcept override;
 
-  cdu_scr_data_t get_screen_data() const noexcept override;
+  void get_screen_data(cdu_scr_data_t& out) const noexcept override;
 };
 } // namespace cdu_pages
@@ -1,8 +1,12 @@
 #include "legs.hpp"
 
 #include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <cmath>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <displays/CDU/common.hpp>
@@ -64,7 +68,7 @@ const std::string DISCO_AFTER_SEG = "-- ROUTE DISCONTINUITY -";
 
 namespace cdu_pages {
 
-std::string Legs::get_cdu_leg_nm(
+std::string_view Legs::get_cdu_leg_nm(
     const fms_core::list_node_ref_t<fms_core::leg_list_data_t>& src) const noexcept {
   if (src.data.is_discon) {
     return DISCO_LEG_NM;
@@ -76,7 +80,7 @@ std::string Legs::get_cdu_leg_nm(
   if (src.data.misc_data.has_calc_wpt) {
     return src.data.misc_data.calc_wpt.id;
   }
-  return "";
+  return {};
 }
 
 std::size_t Legs::get_leg_start_idx() const noexcept {
@@ -299,55 +303,58 @@ void Legs::update_fpl_infos() noexcept {
   }
 }
 
-std::string Legs::get_cdu_leg_prop(
+void Legs::put_cdu_leg_prop(cdu_line_t& line,
     const fms_core::list_node_ref_t<fms_core::leg_list_data_t>& src) noexcept {
   if (src.data.is_discon) {
-    return DISCO_THEN;
+    put_text(line, 0, DISCO_THEN);
+    return;
   }
   if (src.data.leg.leg_type[0] == 'H') {
-    return HOLD_DESC;
+    put_text(line, 0, HOLD_DESC);
+    return;
   }
   double crs_deg = src.data.misc_data.true_trk_deg + 360.0;
   if (crs_deg > 360) crs_deg -= 360;
-  std::string deg_str = std::string(1, strutils::DEGREE_SYMBOL);
-  std::string crs_st = strutils::double_to_str(crs_deg, 0) + deg_str;
-  assert(crs_st.size() <= N_LEG_CRS_ROWS);
-  size_t crs_offs = N_LEG_CRS_ROWS - crs_st.size();
-  crs_st = std::string(crs_offs, ' ') + crs_st;
+  char buf[fms_displays::N_CDU_DATA_COLS];
+  char* end = std::to_chars(buf, buf + sizeof(buf), 
+    std::lround(crs_deg)).ptr;
+  *end++ = strutils::DEGREE_SYMBOL;
+  std::size_t crs_sz = std::size_t(end - buf);
+  assert(crs_sz <= N_LEG_CRS_ROWS);
+  put_text(line, N_LEG_CRS_ROWS - crs_sz, std::string_view(buf, crs_sz));
 
-  std::string out = "";
   bool is_bp = src.data.misc_data.is_bypassed;
   if (is_bp) {
-    size_t offs = std::size_t(fms_displays::N_CDU_DATA_COLS) - 
-      crs_st.size() - LEG_BYPASS.size();
-    out = crs_st + std::string(offs, ' ') + LEG_BYPASS;
+    put_text_right(line, LEG_BYPASS);
   } else {
-    double dist_nm = src.data.leg.outbd_dist_time;
-    std::string dist_st = strutils::double_to_str(dist_nm, 0) + NAUT_MILES;
-    assert(dist_st.size() + crs_st.size() <= N_LEG_PROP_ROWS);
-    size_t offs = N_LEG_PROP_ROWS - dist_st.size() - crs_st.size();
-    out = crs_st + std::string(offs, ' ') + dist_st;
+    end = std::to_chars(buf, buf + sizeof(buf), 
+      std::lround(src.data.leg.outbd_dist_time)).ptr;
+    std::size_t dist_sz = std::size_t(end - buf);
+    assert(dist_sz + NAUT_MILES.size() + crs_sz <= N_LEG_PROP_ROWS);
+    std::size_t col = N_LEG_PROP_ROWS - dist_sz - NAUT_MILES.size();
+    col = put_text(line, col, std::string_view(buf, dist_sz));
+    put_text(line, col, NAUT_MILES);
   }
-
-  return out;
 }
 
-std::string Legs::get_cdu_leg_spdcstr(
+char* Legs::put_leg_spdcstr(char* out,
     const fms_core::list_node_ref_t<fms_core::leg_list_data_t>& src) noexcept {
-  if (src.data.leg.spd_lim_kias == 0) return LEG_NO_SPD;
+  if (src.data.leg.spd_lim_kias == 0) {
+    return std::copy(LEG_NO_SPD.begin(), LEG_NO_SPD.end(), out);
+  }
 
-  std::string spd =
-      strutils::double_to_str(double(src.data.leg.spd_lim_kias), 0);
+  out = std::to_chars(out, out + fms_displays::N_CDU_DATA_COLS, 
+    int(src.data.leg.spd_lim_kias)).ptr;
 
   if (src.data.leg.speed_desc == libnav::SpeedMode::AT_OR_ABOVE)
-    return spd + "A";
-  if (src.data.leg.speed_desc == libnav::SpeedMode::AT_OR_BELOW)
-    return spd + "B";
+    *out++ = LEGS_CSTR_ABV;
+  else if (src.data.leg.speed_desc == libnav::SpeedMode::AT_OR_BELOW)
+    *out++ = LEGS_CSTR_BLW;
 
-  return spd;
+  return out;
 }
 
-std::string Legs::get_leg_alt(
+char* Legs::put_leg_alt(char* out,
     const fms_core::list_node_ref_t<fms_core::leg_list_data_t>& src, bool alt2,
     bool fl) noexcept {
   int tgt_alt = src.data.leg.alt1_ft;
@@ -355,66 +362,77 @@ std::string Legs::get_leg_alt(
   int tr_alt = src.data.leg.trans_alt;
   bool fl_act = tgt_alt > tr_alt;
   if (fl_act || fl) tgt_alt /= 100;
-  std::string alt_str = strutils::double_to_str(double(tgt_alt), 0);
-  if ((fl_act || fl) && alt_str.size() < 3)
-    alt_str = std::string(3 - alt_str.size(), '0') + alt_str;
-  if (fl_act && !fl) alt_str = "FL" + alt_str;
-  return alt_str;
+  if (fl_act && !fl) {
+    *out++ = 'F';
+    *out++ = 'L';
+  }
+  // Flight levels are padded to 3 digits
+  char buf[fms_displays::N_CDU_DATA_COLS];
+  char* end = std::to_chars(buf, buf + sizeof(buf), tgt_alt).ptr;
+  for (long i = end - buf; (fl_act || fl) && i < 3; i++) {
+    *out++ = '0';
+  }
+  return std::copy(buf, end, out);
 }
 
-std::string Legs::get_cdu_leg_vcstr(
+char* Legs::put_leg_vcstr(char* out,
     const fms_core::list_node_ref_t<fms_core::leg_list_data_t>& src) noexcept {
   if (src.data.leg.alt1_ft == 0 && src.data.leg.alt2_ft == 0) {
-    return LEG_NO_ALT;
-  }
-
-  if (src.data.leg.alt_desc == libnav::AltMode::AT_OR_ABOVE ||
-      src.data.leg.alt_desc == libnav::AltMode::GS_AT_OR_ABOVE) {
-    return get_leg_alt(src) + "A";
-  }
-  if (src.data.leg.alt_desc == libnav::AltMode::SID_AT_OR_ABOVE ||
-      src.data.leg.alt_desc == libnav::AltMode::ALT_STEPDOWN_AT_AT_OR_ABOVE) {
-    return get_leg_alt(src, true) + "A";
-  }
-
-  if (src.data.leg.alt_desc == libnav::AltMode::AT ||
-      src.data.leg.alt_desc == libnav::AltMode::GS_AT) {
-    return get_leg_alt(src);
-  }
-  if (src.data.leg.alt_desc == libnav::AltMode::GS_INTC_AT ||
-      src.data.leg.alt_desc == libnav::AltMode::ALT_STEPDOWN_AT_AT) {
-    return get_leg_alt(src, true);
-  }
-
-  if (src.data.leg.alt_desc == libnav::AltMode::AT_OR_BELOW) {
-    return get_leg_alt(src) + "B";
-  }
-  if (src.data.leg.alt_desc == libnav::AltMode::ALT_STEPDOWN_AT_AT_OR_BELOW) {
-    return get_leg_alt(src, true) + "B";
+    return std::copy(LEG_NO_ALT.begin(), LEG_NO_ALT.end(), out);
+  }
+
+  libnav::AltMode desc = src.data.leg.alt_desc;
+  if (desc == libnav::AltMode::AT_OR_ABOVE ||
+      desc == libnav::AltMode::GS_AT_OR_ABOVE) {
+    out = put_leg_alt(out, src);
+    *out++ = LEGS_CSTR_ABV;
+  } else if (desc == libnav::AltMode::SID_AT_OR_ABOVE ||
+      desc == libnav::AltMode::ALT_STEPDOWN_AT_AT_OR_ABOVE) {
+    out = put_leg_alt(out, src, true);
+    *out++ = LEGS_CSTR_ABV;
+  } else if (desc == libnav::AltMode::AT ||
+      desc == libnav::AltMode::GS_AT) {
+    out = put_leg_alt(out, src);
+  } else if (desc == libnav::AltMode::GS_INTC_AT ||
+      desc == libnav::AltMode::ALT_STEPDOWN_AT_AT) {
+    out = put_leg_alt(out, src, true);
+  } else if (desc == libnav::AltMode::AT_OR_BELOW) {
+    out = put_leg_alt(out, src);
+    *out++ = LEGS_CSTR_BLW;
+  } else if (desc == libnav::AltMode::ALT_STEPDOWN_AT_AT_OR_BELOW) {
+    out = put_leg_alt(out, src, true);
+    *out++ = LEGS_CSTR_BLW;
+  } else {
+    out = put_leg_alt(out, src, false, true);
+    *out++ = LEGS_CSTR_ABV;
+    out = put_leg_alt(out, src, true, true);
+    *out++ = LEGS_CSTR_BLW;
   }
-  return get_leg_alt(src, false, true) + "A" + get_leg_alt(src, true, true) +
-         "B";
+  return out;
 }
 
-std::string Legs::get_legs_bottom() const noexcept {
+void Legs::put_legs_bottom(cdu_line_t& line) const noexcept {
   bool is_act = cdu_cntx_->sel_fpl_idx == cdu_cntx_->act_fpl_idx;
   bool exec_lt = fpl_sys_->get_exec();
 
-  std::string c_legs_btm = "<RTE 2";
+  std::string_view c_legs_btm = "<RTE 2";
   if (cdu_cntx_->sel_fpl_idx == fms_core::RTE2_IDX) {
     c_legs_btm = "<RTE 1";
   }
 
   if(nd_mode_ == fms_core::NDMode::PLAN) {
-    return c_legs_btm + std::string{LEGS_BTM_PLN};
+    put_text(line, put_text(line, 0, c_legs_btm), LEGS_BTM_PLN);
+    return;
   }
 
   if (!is_act && !exec_lt) {
-    return c_legs_btm + LEGS_BTM_INACT;
+    put_text(line, put_text(line, 0, c_legs_btm), LEGS_BTM_INACT);
+    return;
   } else if (is_act && exec_lt) {
-    return LEGS_BTM_MOD;
+    put_text(line, 0, LEGS_BTM_MOD);
+    return;
   }
-  return c_legs_btm + LEGS_BTM_ACT;
+  put_text(line, put_text(line, 0, c_legs_btm), LEGS_BTM_ACT);
 }
 
 Legs::Legs(util::OpaquePointer<fms_core::FPLSys> fpl_sys,
@@ -539,27 +557,26 @@ void Legs::on_page_change(fms_displays::CDUPage page) noexcept {
   }
 }
 
-cdu_scr_data_t Legs::get_screen_data() const noexcept {
-  cdu_pages::cdu_scr_data_t out = {};
-
-  out.heading_small = get_small_heading(curr_subpg_, cnt_subpg_);
-  out.heading_color = fms_displays::CDUColor::WHITE;
+void Legs::get_screen_data(cdu_scr_data_t& out) const noexcept {
+  put_subpage_heading(out.heading_small, curr_subpg_, cnt_subpg_);
 
   out.heading_color = fms_displays::CDUColor::CYAN;
   bool exec_lt = fpl_sys_->get_exec();
-  std::string act_sts = std::string(4, ' ');
+  std::string_view act_sts = "    ";
   if (cdu_cntx_->sel_fpl_idx == cdu_cntx_->act_fpl_idx) {
     if (exec_lt)
-      act_sts = MOD + " ";
+      act_sts = MOD;
     else
-      act_sts = ACT + " ";
+      act_sts = ACT;
     out.heading_color = fms_displays::CDUColor::WHITE;
   }
-  std::string c_legs_top = "RTE 1 LEGS";
+  std::string_view c_legs_top = "RTE 1 LEGS";
   if (cdu_cntx_->sel_fpl_idx == fms_core::RTE2_IDX) {
     c_legs_top = "RTE 2 LEGS";
   }
-  out.heading_big = "  " + act_sts + c_legs_top;
+  // Status is followed by a space, so it always takes 4 columns
+  put_text(out.heading_big, 2, act_sts);
+  put_text(out.heading_big, 6, c_legs_top);
 
   assert(leg_list_.size());
   size_t i_start = get_leg_start_idx();
@@ -572,60 +589,75 @@ cdu_scr_data_t Legs::get_screen_data() const noexcept {
     ].map_ctr_idx[cdu_cntx_->side_index];
 
   for (size_t i = i_start; i < i_end; i++) {
-    if (!disc_pr) out.data_lines.push_back(get_cdu_leg_prop(leg_list_[i]));
+    if (!disc_pr) {
+      out.push_line();
+      put_cdu_leg_prop(out.last_line(), leg_list_[i]);
+    }
     if (leg_list_[i].data.is_discon) {
       disc_pr = true;
-      out.data_lines.push_back("@@@@@");
-      out.data_lines.push_back(DISCO_AFTER_SEG);
+      out.push_line("@@@@@");
+      out.push_line(DISCO_AFTER_SEG);
     } else {
       disc_pr = false;
 
-      std::string cr_name = get_cdu_leg_nm(leg_list_[i]);
-      if (cr_name == act_info.name) {
+      std::string_view cr_name = get_cdu_leg_nm(leg_list_[i]);
+      if (cr_name == act_info.name && sts_idx < N_CDU_SCR_LINES) {
         for (size_t j = 0; j < 5; j++) {
           out.chr_sts[sts_idx][j] = fms_displays::CDU_B_MAGENTA;
         }
       }
-      // get leg constraints
-      std::string spdcstr = get_cdu_leg_spdcstr(leg_list_[i]);
-      std::string vcstr = get_cdu_leg_vcstr(leg_list_[i]);
-      if (vcstr.size() < N_LEG_VCSTR_ROWS)
-        vcstr = std::string(N_LEG_VCSTR_ROWS - vcstr.size(), ' ') + vcstr;
-      std::string cstr = spdcstr + "/" + vcstr;
-      
-      if(i == map_ctr_idx && nd_mode_ == fms_core::NDMode::PLAN) {
-        cstr = std::string{LEG_MAP_CTR} + cstr;
+      out.push_line(cr_name);
+      cdu_line_t& line = out.last_line();
+
+      // Leg constraints are written from the right. Altitude constraint
+      // is padded to N_LEG_VCSTR_ROWS.
+      char spd_buf[fms_displays::N_CDU_DATA_COLS];
+      char vc_buf[fms_displays::N_CDU_DATA_COLS];
+      std::string_view spdcstr(spd_buf, std::size_t(
+        put_leg_spdcstr(spd_buf, leg_list_[i]) - spd_buf));
+      std::string_view vcstr(vc_buf, std::size_t(
+        put_leg_vcstr(vc_buf, leg_list_[i]) - vc_buf));
+      // Columns stop at 0 rather than wrapping around, so long constraints
+      // get cut off instead of being written past the end of line.
+      auto left_of = [](std::size_t col, std::size_t n) {
+        return col - std::min(col, n);
+      };
+      put_text_right(line, vcstr);
+      std::size_t col = left_of(line.size(), std::max(vcstr.size(), 
+        N_LEG_VCSTR_ROWS) + 1);
+      if(col < line.size()) {
+        line[col] = LEGS_CSTR_SEP;
       }
+      col = left_of(col, spdcstr.size());
+      put_text(line, col, spdcstr);
 
-      cr_name =
-          cr_name +
-          std::string(fms_displays::N_CDU_DATA_COLS - cr_name.size() - 
-          cstr.size(), ' ') + cstr;
-      out.data_lines.push_back(cr_name);
+      if(i == map_ctr_idx && nd_mode_ == fms_core::NDMode::PLAN && 
+        col >= sizeof(LEG_MAP_CTR) - 1) {
+        put_text(line, col - (sizeof(LEG_MAP_CTR) - 1), LEG_MAP_CTR);
+      }
     }
     sts_idx += 2;
   }
 
   if (i_end - i_start < fms_displays::N_CDU_ITM_PP) {
-    out.data_lines.push_back("");
-    out.data_lines.push_back(LEG_LAST);
+    out.push_line();
+    out.push_line(LEG_LAST);
   }
 
-  while (out.data_lines.size() < 10) {
-    out.data_lines.push_back("");
+  while (out.n_lines < 10) {
+    out.push_line();
   }
 
-  while (out.data_lines.size() > 10) {
-    out.data_lines.pop_back();
+  while (out.n_lines > 10) {
+    out.pop_line();
   }
 
   if(nd_mode_ == fms_core::NDMode::PLAN) {
-    out.data_lines.push_back(std::string{LEGS_MAP_CTR_BORD});
+    out.push_line(LEGS_MAP_CTR_BORD);
   } else {
-    out.data_lines.push_back(std::string(fms_displays::N_CDU_DATA_COLS, '-'));
+    out.push_line(fms_displays::ALL_DASH);
   }
-  out.data_lines.push_back(get_legs_bottom());
-
-  return out;
+  out.push_line();
+  put_legs_bottom(out.last_line());
 }
 } // namespace cdu_pages
@@ -4,6 +4,7 @@
 
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <fpln/fpln_sys.hpp>
@@ -38,7 +39,8 @@ class Legs final : public PageBase {
   std::size_t pln_ctr_idx_[fms_displays::N_CDU_RTES];
   geo::point pln_ctr_pos_[fms_displays::N_CDU_RTES];
 
-  std::string get_cdu_leg_nm(
+  // Points into src or into a constant, so nothing is copied
+  std::string_view get_cdu_leg_nm(
     const fms_core::list_node_ref_t<fms_core::leg_list_data_t>& src) const noexcept;
   
   std::size_t get_leg_start_idx() const noexcept;
@@ -68,20 +70,23 @@ class Legs final : public PageBase {
 
   void update_fpl_infos() noexcept;
 
-  static std::string get_cdu_leg_prop(
+  static void put_cdu_leg_prop(cdu_line_t& line,
     const fms_core::list_node_ref_t<fms_core::leg_list_data_t>& src) noexcept;
 
-  static std::string get_cdu_leg_spdcstr(
+  // The constraint formatters below write to out, which has room for
+  // N_CDU_DATA_COLS characters, and return the end of the written text.
+
+  static char* put_leg_spdcstr(char* out,
     const fms_core::list_node_ref_t<fms_core::leg_list_data_t>& src) noexcept;
 
-  static std::string get_leg_alt(
+  static char* put_leg_alt(char* out,
     const fms_core::list_node_ref_t<fms_core::leg_list_data_t>& src, 
     bool alt2=false, bool fl=false) noexcept;
 
-  static std::string get_cdu_leg_vcstr(
+  static char* put_leg_vcstr(char* out,
     const fms_core::list_node_ref_t<fms_core::leg_list_data_t>& src) noexcept;
 
-  std::string get_legs_bottom() const noexcept;
+  void put_legs_bottom(cdu_line_t& line) const noexcept;
 public:
   explicit Legs(util::OpaquePointer<fms_core::FPLSys> fpl_sys, 
     util::OpaquePointer<fms_displays::cdu_context_t> cntx);
@@ -95,6 +100,6 @@ public:
 
   void on_page_change(fms_displays::CDUPage page) noexcept override;
 
-  cdu_scr_data_t get_screen_data() const noexcept override;
+  void get_screen_data(cdu_scr_data_t& out) const noexcept override;
 };
 } // namespace cdu_pages
@@ -47,15 +47,13 @@ cdu_event_res_t Menu::on_event(fms_displays::cdu_event_type event,
   return res;
 }
 
-cdu_scr_data_t Menu::get_screen_data() const noexcept {
-  cdu_pages::cdu_scr_data_t out = {};
-  out.heading_big = std::string{MENU_PAGE_HEADING};
-  out.data_lines.push_back(MENU_LINE_1);
-  out.data_lines.push_back(MENU_LINE_2);
-  out.data_lines.push_back("");
-  out.data_lines.push_back(MENU_LINE_4);
-  out.data_lines.push_back(MENU_LINE_5);
-  out.data_lines.push_back(MENU_LINE_6);
-  return out;
+void Menu::get_screen_data(cdu_scr_data_t& out) const noexcept {
+  set_line(out.heading_big, MENU_PAGE_HEADING);
+  out.push_line(MENU_LINE_1);
+  out.push_line(MENU_LINE_2);
+  out.push_line();
+  out.push_line(MENU_LINE_4);
+  out.push_line(MENU_LINE_5);
+  out.push_line(MENU_LINE_6);
 }
 } // namespace cdu_pages
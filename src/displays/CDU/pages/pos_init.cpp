@@ -6,6 +6,7 @@
 #include <format>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <libnav/arpt_db.hpp>
@@ -31,31 +32,27 @@ const char POS_INIT_INERTIAL_POS_BLANK_STR[] = {
 
 namespace cdu_pages {
 
-std::string PosInit::get_pos_init_airport_str() const noexcept {
+void PosInit::put_pos_init_airport(cdu_line_t& line) const noexcept {
   if(!ref_airport_) {
-    return "----";
+    put_text(line, 0, "----");
+    return;
   }
-  std::string res_icao = ref_airport_->icao;
-  std::string res_pos = get_displayed_pos(ref_airport_->data.pos);
-  assert(res_icao.size() + res_pos.size() <= fms_displays::N_CDU_DATA_COLS);
-  std::size_t diff = fms_displays::N_CDU_DATA_COLS - res_icao.size() - 
-    res_pos.size();
-  std::string spaces(diff, ' ');
-  return res_icao + spaces + res_pos;
+  put_text(line, 0, ref_airport_->icao);
+  put_pos_right(line, ref_airport_->data.pos);
 }
 
-std::string PosInit::get_pos_init_gps_pos_str() const noexcept {
+void PosInit::put_pos_init_gps_pos(cdu_line_t& line) const noexcept {
   auto now_utc = std::chrono::utc_clock::now();
-  std::string utc_str = std::format("{:%H%M}", now_utc);
-  std::string pos_str = get_displayed_pos(fpl_sys_->get_ac_pos());
-  assert(fms_displays::N_CDU_DATA_COLS >= utc_str.size() + pos_str.size());
-  std::size_t cnt_spaces = fms_displays::N_CDU_DATA_COLS - utc_str.size() - 
-    pos_str.size();
-  return utc_str + std::string(cnt_spaces, ' ') + pos_str;
+  char utc_buf[fms_displays::N_CDU_DATA_COLS];
+  auto utc_res = std::format_to_n(utc_buf, sizeof(utc_buf), "{:%H%M}", 
+    now_utc);
+  put_text(line, 0, std::string_view(utc_buf, std::size_t(utc_res.out - 
+    utc_buf)));
+  put_pos_right(line, fpl_sys_->get_ac_pos());
 }
 
-std::string PosInit::get_pos_init_inertial_pos_str() const noexcept {
-  return str_align_right(std::string{POS_INIT_INERTIAL_POS_BLANK_STR});
+void PosInit::put_pos_init_inertial_pos(cdu_line_t& line) const noexcept {
+  put_text_right(line, POS_INIT_INERTIAL_POS_BLANK_STR);
 }
 
 PosInit::PosInit(util::OpaquePointer<fms_core::FPLSys> fpl_sys) : 
@@ -127,23 +124,24 @@ cdu_event_res_t PosInit::on_event(fms_displays::cdu_event_type event,
   return res;
 }
 
-cdu_scr_data_t PosInit::get_screen_data() const noexcept {
-  cdu_scr_data_t out = {};
-  out.heading_big = POS_INIT_HEADING;
+void PosInit::get_screen_data(cdu_scr_data_t& out) const noexcept {
+  set_line(out.heading_big, POS_INIT_HEADING);
   out.heading_color = fms_displays::CDUColor::WHITE;
-  out.data_lines.push_back(POS_INIT_LINE_1);
-  out.data_lines.push_back(str_align_right(
-    get_displayed_pos(last_pos_)));
-  out.data_lines.push_back(POS_INIT_LINE_3);
-  out.data_lines.push_back(get_pos_init_airport_str());
-  out.data_lines.push_back(POS_INIT_LINE_5);
-  out.data_lines.push_back("");
-  out.data_lines.push_back(POS_INIT_LINE_7);
-  out.data_lines.push_back(get_pos_init_gps_pos_str());
-  out.data_lines.push_back(POS_INIT_LINE_9);
-  out.data_lines.push_back(get_pos_init_inertial_pos_str());
-  out.data_lines.push_back(fms_displays::ALL_DASH);
-  out.data_lines.push_back(POS_INIT_LINE_12);
-  return out;
+  out.push_line(POS_INIT_LINE_1);
+  out.push_line();
+  put_pos_right(out.last_line(), last_pos_);
+  out.push_line(POS_INIT_LINE_3);
+  out.push_line();
+  put_pos_init_airport(out.last_line());
+  out.push_line(POS_INIT_LINE_5);
+  out.push_line();
+  out.push_line(POS_INIT_LINE_7);
+  out.push_line();
+  put_pos_init_gps_pos(out.last_line());
+  out.push_line(POS_INIT_LINE_9);
+  out.push_line();
+  put_pos_init_inertial_pos(out.last_line());
+  out.push_line(fms_displays::ALL_DASH);
+  out.push_line(POS_INIT_LINE_12);
 }
 } // namespace cdu_pages
\ No newline at end of file
@@ -21,11 +21,11 @@ class PosInit final : public PageBase {
   util::OpaquePointer<libnav::ArptDB> airport_db_;
   util::OpaquePointer<fms_core::FPLSys> fpl_sys_;
 
-  std::string get_pos_init_airport_str() const noexcept;
+  void put_pos_init_airport(cdu_line_t& line) const noexcept;
 
-  std::string get_pos_init_gps_pos_str() const noexcept;
+  void put_pos_init_gps_pos(cdu_line_t& line) const noexcept;
 
-  std::string get_pos_init_inertial_pos_str() const noexcept;
+  void put_pos_init_inertial_pos(cdu_line_t& line) const noexcept;
 public:
   explicit PosInit(util::OpaquePointer<fms_core::FPLSys> fpl_sys);
 
@@ -36,6 +36,6 @@ public:
   cdu_event_res_t on_event(fms_displays::cdu_event_type event, 
     const std::string& scratchpad, std::string& s_out) noexcept override;
 
-  cdu_scr_data_t get_screen_data() const noexcept override;
+  void get_screen_data(cdu_scr_data_t& out) const noexcept override;
 };
 } // namespace cdu_pages
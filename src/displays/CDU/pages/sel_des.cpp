@@ -120,32 +120,31 @@ void SelectDesired::on_page_change(fms_displays::CDUPage page) noexcept {
   }
 }
 
-cdu_scr_data_t SelectDesired::get_screen_data() const noexcept {
-  cdu_pages::cdu_scr_data_t out = {};
-
-  out.heading_small = get_small_heading(curr_subpg_, cnt_subpg_);
-  out.heading_big = SEL_DES_WPT_HDG;
+void SelectDesired::get_screen_data(cdu_scr_data_t& out) const noexcept {
+  put_subpage_heading(out.heading_small, curr_subpg_, cnt_subpg_);
+  set_line(out.heading_big, SEL_DES_WPT_HDG);
   out.heading_color = fms_displays::CDUColor::WHITE;
 
   std::size_t start_idx = std::size_t((curr_subpg_ - 1) * 6);
   std::size_t end_idx = std::min(sel_des_data_.size(), start_idx + 6);
 
   for (std::size_t i = start_idx; i < end_idx; i++) {
-    std::string wpt_tp =
-        sel_des_nm_ + " " + libnav::navaid_to_str(sel_des_data_[i].type);
-    std::string lat_str =
-        strutils::lat_to_str(sel_des_data_[i].pos.lat_rad * geo::RAD_TO_DEG);
-    std::string lon_str =
-        strutils::lon_to_str(sel_des_data_[i].pos.lon_rad * geo::RAD_TO_DEG);
-    std::string main_str = lat_str + lon_str;
+    out.push_line(sel_des_nm_);
+    std::size_t col = put_text(out.last_line(), sel_des_nm_.size(), " ");
+    put_text(out.last_line(), col, 
+      libnav::navaid_to_str(sel_des_data_[i].type));
+
+    out.push_line();
+    col = 0;
     if (sel_des_data_[i].navaid) {
-      main_str =
-          strutils::freq_to_str(sel_des_data_[i].navaid->freq) + " " + main_str;
+      col = put_text(out.last_line(), col, 
+        strutils::freq_to_str(sel_des_data_[i].navaid->freq));
+      col = put_text(out.last_line(), col, " ");
     }
-    out.data_lines.push_back(wpt_tp);
-    out.data_lines.push_back(main_str);
+    col = put_text(out.last_line(), col, 
+      strutils::lat_to_str(sel_des_data_[i].pos.lat_rad * geo::RAD_TO_DEG));
+    put_text(out.last_line(), col, 
+      strutils::lon_to_str(sel_des_data_[i].pos.lon_rad * geo::RAD_TO_DEG));
   }
-
-  return out;
 }
 } // namespace cdu_pages
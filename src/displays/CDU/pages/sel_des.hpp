@@ -65,6 +65,6 @@ public:
 
   void on_page_change(fms_displays::CDUPage page) noexcept override;
 
-  cdu_scr_data_t get_screen_data() const noexcept override;
+  void get_screen_data(cdu_scr_data_t& out) const noexcept override;
 };
 } // namespace cdu_pages
@@ -24,7 +24,9 @@
 #include <displays/common/texture_manager.hpp>
 #include <displays/common/font_names.hpp>
 #include <fpln/fpln_sys.hpp>
+#include <util/alloc_stats.hpp>
 #include <util/geom.hpp>
+#include <util/trace.hpp>
 #include <libnav/str_utils.hpp>
 #include <util/util.hpp>
 
@@ -135,6 +137,10 @@ constexpr geom::vect2_t MAP_AC_TRI_SC = {2, 2};
 constexpr geom::vect2_t MAP_HTK_BOX_SC = {0.034, 0.073};
 constexpr geom::vect2_t MAP_HTK_TXT_POS = {0.5, 0.029};
 constexpr geom::vect2_t MAP_HDG_TRI_SC = {1, 0.8};
+constexpr double MAP_HDG_ROSE_SC = 1.41;
+// Number of rotated renders kept per display:
+constexpr std::size_t ND_ROSE_RENDER_CACHE_SZ = 4;
+constexpr std::size_t ND_SYMBOL_RENDER_CACHE_SZ = 32;
 constexpr geom::vect2_t MCP_HDG_DIAL_SC = {0.8, 0.66};
 constexpr geom::vect2_t MCP_TRK_DIAL_SC = {0.8, 0.66};
 constexpr geom::vect2_t MAP_RNG_OFFS = {-0.014, -0.012};
@@ -443,7 +449,7 @@ NDData::NDData(util::OpaquePointer<fms_core::FPLSys> fpl_sys,
 }
 
 bool NDData::init() {
-  std::unique_lock lk(main_mutex_);
+  MY_LOCK_EXCL(main_mutex_);
   for (size_t i = 0; i < fms_core::N_FPL_SYS_RTES; i++) {
     leg_data_[i] = new fms_core::nd_leg_data_t[N_LEG_PROJ_CACHE_SZ];
     if (leg_data_[i] == nullptr) {
@@ -465,36 +471,36 @@ bool NDData::init() {
 }
 
 nd_global_config_t NDData::get_global_config() const noexcept {
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   return nd_all_config_;
 }
 
 nd_local_config_t NDData::get_local_config(
   std::size_t sd_idx) const noexcept {
   assert(sd_idx < N_ND_SDS);
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   return nd_configs_[sd_idx];
 }
 
 std::vector<int> NDData::get_rte_draw_seq(size_t sd_idx) {
   assert(sd_idx < N_ND_SDS);
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   return rte_draw_seq_[sd_idx];
 }
 
 size_t NDData::get_proj_legs(leg_proj_t** out, size_t sd_idx, size_t dt_idx) {
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   *out = mp_data_[sd_idx + dt_idx * N_ND_SDS].proj_legs;
   return mp_data_[sd_idx + dt_idx * N_ND_SDS].n_act_proj_legs;
 }
 
 int NDData::get_act_leg_idx(size_t sd_idx) { 
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   return act_leg_idx_sd_[sd_idx]; 
 }
 
 bool NDData::get_ac_pos(geom::vect2_t* out, size_t sd_idx) {
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   if (!ac_pos_ok_[sd_idx]) return false;
 
   *out = ac_pos_projected_[sd_idx];
@@ -502,75 +508,77 @@ bool NDData::get_ac_pos(geom::vect2_t* out, size_t sd_idx) {
 }
 
 double NDData::get_hdg_trk() const { 
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   return get_cr_rot(); 
 }
 
 fms_core::hdg_info_t NDData::get_hdg_data() { 
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   return heading_data_; 
 }
 
 fms_core::spd_info_t NDData::get_spd_data() {
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   return fpl_sys_ptr_->get_spd_info();
 }
 
 fms_core::act_leg_info_t NDData::get_act_leg_info() {
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   return fpl_sys_ptr_->get_act_leg_info();
 }
 
 // POI functions
 
 size_t NDData::get_num_poi_arpts() { 
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   return poi_data_.n_arpts; 
 }
 
 size_t NDData::get_num_poi_waypts() { 
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   return poi_data_.n_waypts; 
 }
 
 size_t NDData::get_num_poi_vordmes() { 
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   return poi_data_.n_vordmes; 
 }
 
 size_t NDData::get_num_poi_vhf_not_vordmes() { 
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   return poi_data_.n_vors_dmes; 
 }
 
 // Get ith POI
 
 labeled_point_with_dist_t NDData::get_arpt(size_t i) {
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   assert(i < pois_projected_[idx_proj_act_].n_arpts);
   return pois_projected_[idx_proj_act_].arpts[i];
 }
 
 labeled_point_with_dist_t NDData::get_waypt(size_t i) {
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   assert(i < pois_projected_[idx_proj_act_].n_waypts);
   return pois_projected_[idx_proj_act_].waypts[i];
 }
 
 labeled_point_with_dist_t NDData::get_vordme(size_t i) {
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   assert(i < pois_projected_[idx_proj_act_].n_vordmes);
   return pois_projected_[idx_proj_act_].vordmes[i];
 }
 
 labeled_point_with_dist_t NDData::get_vhf_not_vordme(size_t i) {
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   assert(i < pois_projected_[idx_proj_act_].n_vors_dmes);
   return pois_projected_[idx_proj_act_].vors_dmes[i];
 }
 
 void NDData::update() {
-  std::unique_lock lk(main_mutex_);
+  MY_TRACE_SCOPE("NDData::update");
+  MY_ALLOC_SCOPE("NDData::update");
+  MY_LOCK_EXCL(main_mutex_);
   update_configs();
   heading_data_ = fpl_sys_ptr_->get_hdg_info();
   update_rte_draw_seq();
@@ -583,15 +591,17 @@ void NDData::update() {
   double abs_diff = abs(curr_pos.lat_rad - ac_pos_last_.lat_rad) +
                     abs(curr_pos.lon_rad - ac_pos_last_.lon_rad);
   if (abs_diff > EFIS_REFRESH_ABSD) {
+    MY_TRACE_SCOPE("POIData::fetch");
     poi_data_.fetch(curr_pos);
   }
   poi_data_.project(pois_projected_[!idx_proj_act_], curr_pos, get_cr_rot());
   idx_proj_act_ = !idx_proj_act_;
   ac_pos_last_ = curr_pos;
+  export_configs();
 }
 
 void NDData::destroy() {
-  std::unique_lock lk(main_mutex_);
+  MY_LOCK_EXCL(main_mutex_);
   for (size_t i = 0; i < fms_core::N_FPL_SYS_RTES; i++) delete[] leg_data_[i];
   for (size_t i = 0; i < N_MP_DATA_SZ; i++) mp_data_[i].destroy();
   pois_projected_[0].destroy();
@@ -624,6 +634,8 @@ void NDData::update_global_config() noexcept {
   MY_SET_OPT(nd_all_config_.hdg_sel_is_trk, mcp_hdg_is_trk);
   auto hdg_ref_is_true = env_map_->Get<bool>(fms_environment::ND_HDG_IS_TRUE_VAR);
   MY_SET_OPT(nd_all_config_.hdg_ref_true, hdg_ref_is_true);
+  auto rot_quantum = env_map_->Get<double>(fms_environment::ND_ROT_QUANTUM_DEG_VAR);
+  MY_SET_OPT(nd_all_config_.rot_quantum_deg, rot_quantum);
   nd_all_config_.has_dep_rwy = has_dep_rwy_;
   nd_all_config_.has_arr_rwy = has_arr_rwy_;
 }
@@ -668,6 +680,30 @@ void NDData::update_configs() noexcept {
   update_local_configs();
 }
 
+void NDData::export_configs() noexcept {
+  static_assert(N_ND_SDS == fms_core::SHM_EXPORT_N_ND);
+  fms_core::shm_nd_global_t glob = {};
+  glob.is_track_up = nd_all_config_.is_track_up;
+  glob.hdg_ref_true = nd_all_config_.hdg_ref_true;
+  glob.hdg_sel_is_trk = nd_all_config_.hdg_sel_is_trk;
+  glob.has_dep_rwy_mask = std::uint8_t(nd_all_config_.has_dep_rwy.to_ulong());
+  glob.has_arr_rwy_mask = std::uint8_t(nd_all_config_.has_arr_rwy.to_ulong());
+  glob.hdg_sel_deg = nd_all_config_.hdg_sel_deg;
+  glob.nm_mcp_alt_to_go = nd_all_config_.nm_mcp_alt_to_go;
+  glob.rot_quantum_deg = nd_all_config_.rot_quantum_deg;
+
+  fms_core::shm_nd_local_t loc[N_ND_SDS] = {};
+  for (std::size_t i = 0; i < N_ND_SDS; i++) {
+    loc[i].efis_airport_on = nd_configs_[i].efis_airport_on;
+    loc[i].efis_station_on = nd_configs_[i].efis_station_on;
+    loc[i].efis_waypoint_on = nd_configs_[i].efis_waypoint_on;
+    loc[i].mode_is_ctr = nd_configs_[i].mode_is_ctr;
+    loc[i].mode = static_cast<std::int32_t>(nd_configs_[i].mode);
+    loc[i].range_idx = nd_configs_[i].range_idx;
+  }
+  fpl_sys_ptr_->set_export_nd_config(glob, loc);
+}
+
 double NDData::get_range_impl(std::size_t sd_idx) const noexcept {
   return ND_RANGES_NM[nd_configs_[sd_idx].range_idx];
 }
@@ -761,6 +797,7 @@ void NDData::update_ctr(std::size_t sd_idx) {
 }
 
 void NDData::project_legs(std::size_t gn_idx) {
+  MY_TRACE_SCOPE("NDData::project_legs");
   nd_util_idx_t idxs = get_util_idx(gn_idx);
 
   std::pair<geo::point, double> mp_prm = get_proj_params(idxs.sd_idx);
@@ -919,6 +956,7 @@ void NDData::fetch_legs(std::size_t dt_idx) {
 }
 
 void NDData::update_fpl(std::size_t idx) {
+  MY_TRACE_SCOPE("NDData::update_fpl");
   double id_curr = fpl_sys_ptr_->get_rte_id(idx);
 
   if (id_curr != fpl_id_last_[idx]) {
@@ -940,9 +978,13 @@ void NDData::update_fpl(std::size_t idx) {
 NDDisplay::NDDisplay(util::OpaquePointer<NDData> data, 
                     util::OpaquePointer<TextureManager> mngr,
                     geom::vect2_t pos, geom::vect2_t sz,
-                    size_t sd_idx) : nd_data_{data}, scr_pos_{pos},
+                    size_t sd_idx) : nd_data_{data}, 
+                    rose_renders_{ND_ROSE_RENDER_CACHE_SZ},
+                    symbol_renders_{ND_SYMBOL_RENDER_CACHE_SZ}, scr_pos_{pos},
                     size_{sz}, side_idx_{sd_idx} {
-  textures_.init(mngr);
+  textures_.init(mngr, size_);
+  label_text_ = std::make_unique<fms_display_fonts::TextEngine>(
+    textures_.font_face, size_);
 
   all_config_ = data->get_global_config();
   config_ = data->get_local_config(side_idx_);
@@ -953,10 +995,14 @@ std::pair<double, double> NDDisplay::GetDrawSize() const noexcept {
 }
 
 void NDDisplay::draw(cairo_t* cr) {
+  MY_TRACE_SCOPE("NDDisplay::draw");
+  MY_ALLOC_SCOPE("NDDisplay::draw");
   all_config_ = nd_data_->get_global_config();
   config_ = nd_data_->get_local_config(side_idx_);
   hdg_data_ = nd_data_->get_hdg_data();
   update_map_params();
+  rose_renders_.SetQuantum(all_config_.rot_quantum_deg);
+  symbol_renders_.SetQuantum(all_config_.rot_quantum_deg);
 
   cairo_utils::draw_rect(cr, scr_pos_, size_, ND_BCKGRND_CLR);
 
@@ -974,48 +1020,88 @@ void NDDisplay::draw(cairo_t* cr) {
 // Private member functions:
 
 void NDDisplay::nd_textures_t::init(
-  util::OpaquePointer<TextureManager> tex_manager) {
-  wpt_inact = tex_manager->GetTexture(ND_WPT_INACT_NAME);
+  util::OpaquePointer<TextureManager> tex_manager, geom::vect2_t sz) {
+  auto get_tex_sz = [tex_manager](const char* name) -> geom::vect2_t {
+    TextureManager::texture_t tex = tex_manager->GetTexture(name);
+    if(tex == nullptr) {
+      return {};
+    }
+    return cairo_utils::get_surf_sz(tex);
+  };
+  // Scale that stretches a texture over the whole display:
+  auto get_fill_scale = [&get_tex_sz, sz](const char* name) -> geom::vect2_t {
+    geom::vect2_t tex_sz = get_tex_sz(name);
+    if(tex_sz.x == 0 || tex_sz.y == 0) {
+      return {};
+    }
+    return sz / tex_sz;
+  };
+  geom::vect2_t wpt_scale = sz.scmul(1 / WPT_SCALE_FACT);
+  geom::vect2_t efis_mode_scale = sz.scmul(EFIS_MODE_SCALE).scdiv(WPT_SCALE_FACT);
+  geom::vect2_t htrk_box_scale = get_tex_sz(ND_HTRK_BOX_NAME) * wpt_scale * 
+    MAP_HTK_BOX_SC;
+
+  wpt_inact = tex_manager->GetScaledTexture(ND_WPT_INACT_NAME, wpt_scale);
   assert(wpt_inact != nullptr);
-  wpt_act = tex_manager->GetTexture(ND_WPT_ACT_NAME);
+  wpt_act = tex_manager->GetScaledTexture(ND_WPT_ACT_NAME, wpt_scale);
   assert(wpt_act != nullptr);
-  airplane = tex_manager->GetTexture(ND_AIRPLANE_NAME);
+  airplane = tex_manager->GetScaledTexture(ND_AIRPLANE_NAME, wpt_scale);
   assert(airplane != nullptr);
-  pln_back_inner = tex_manager->GetTexture(ND_PLN_BACKGND_INNER_NAME);
+  pln_back_inner = tex_manager->GetScaledTexture(ND_PLN_BACKGND_INNER_NAME, 
+    get_fill_scale(ND_PLN_BACKGND_INNER_NAME));
   assert(pln_back_inner != nullptr);
-  pln_back_outer = tex_manager->GetTexture(ND_PLN_BACKGND_OUTER_NAME);
+  pln_back_outer = tex_manager->GetScaledTexture(ND_PLN_BACKGND_OUTER_NAME, 
+    get_fill_scale(ND_PLN_BACKGND_OUTER_NAME));
   assert(pln_back_outer != nullptr);
-  map_back = tex_manager->GetTexture(ND_MAP_BACKGND_NAME);
+  map_back = tex_manager->GetScaledTexture(ND_MAP_BACKGND_NAME, 
+    get_fill_scale(ND_MAP_BACKGND_NAME));
   assert(map_back != nullptr);
-  map_hdg = tex_manager->GetTexture(ND_MAP_HDG_NAME);
+  map_hdg = tex_manager->GetScaledTexture(ND_MAP_HDG_NAME, 
+    get_fill_scale(ND_MAP_HDG_NAME).scmul(MAP_HDG_ROSE_SC));
   assert(map_hdg != nullptr);
-  map_ac_ico = tex_manager->GetTexture(ND_MAP_AC_TRI_NAME);
+  map_ac_ico = tex_manager->GetScaledTexture(ND_MAP_AC_TRI_NAME, 
+    MAP_AC_TRI_SC * wpt_scale);
   assert(map_ac_ico != nullptr);
-  hdg_trk_box = tex_manager->GetTexture(ND_HTRK_BOX_NAME);
+  map_hdg_tri = tex_manager->GetScaledTexture(ND_MAP_AC_TRI_NAME, 
+    MAP_HDG_TRI_SC * wpt_scale);
+  assert(map_hdg_tri != nullptr);
+  hdg_trk_box = tex_manager->GetScaledTexture(ND_HTRK_BOX_NAME, htrk_box_scale);
   assert(hdg_trk_box != nullptr);
-  normal_arpt_sign = tex_manager->GetTexture(ND_ARPT_NML_POI_NAME);
+  normal_arpt_sign = tex_manager->GetScaledTexture(ND_ARPT_NML_POI_NAME, 
+    wpt_scale.scmul(EFIS_ARPT_SC));
   assert(normal_arpt_sign != nullptr);
-  altn_arpt_sign = tex_manager->GetTexture(ND_ARPT_ALTN_POI_NAME);
+  altn_arpt_sign = tex_manager->GetScaledTexture(ND_ARPT_ALTN_POI_NAME, 
+    wpt_scale.scmul(EFIS_ARPT_SC));
   assert(altn_arpt_sign != nullptr);
-  dme = tex_manager->GetTexture(ND_DME_POI_NAME);
+  dme = tex_manager->GetScaledTexture(ND_DME_POI_NAME, 
+    wpt_scale.scmul(EFIS_VHF_SC));
   assert(dme != nullptr);
-  vordme = tex_manager->GetTexture(ND_VORDME_POI_NAME);
+  vordme = tex_manager->GetScaledTexture(ND_VORDME_POI_NAME, 
+    wpt_scale.scmul(EFIS_VHF_SC));
   assert(vordme != nullptr);
-  waypoint = tex_manager->GetTexture(ND_WAYPOINT_POI_NAME);
+  waypoint = tex_manager->GetScaledTexture(ND_WAYPOINT_POI_NAME, 
+    wpt_scale.scmul(EFIS_WAYPT_SC));
   assert(waypoint != nullptr);
-  excess_data_msg = tex_manager->GetTexture(ND_EXCESS_DATA_MSG_NAME);
+  excess_data_msg = tex_manager->GetScaledTexture(ND_EXCESS_DATA_MSG_NAME, 
+    EXCESS_DATA_MSG_SCALE * wpt_scale);
   assert(excess_data_msg != nullptr);
-  hdg_sel_box = tex_manager->GetTexture(ND_AP_HDG_SEL_BOX_NAME);
+  hdg_sel_box = tex_manager->GetScaledTexture(ND_AP_HDG_SEL_BOX_NAME, 
+    MCP_HDG_DIAL_SC * wpt_scale);
   assert(hdg_sel_box != nullptr);
-  trk_sel_box = tex_manager->GetTexture(ND_AP_TRK_SEL_BOX_NAME);
+  trk_sel_box = tex_manager->GetScaledTexture(ND_AP_TRK_SEL_BOX_NAME, 
+    MCP_TRK_DIAL_SC * wpt_scale);
   assert(trk_sel_box != nullptr);
-  arpt_efis_filter = tex_manager->GetTexture(ND_EFIS_ARPT_FILTER_NAME);
+  arpt_efis_filter = tex_manager->GetScaledTexture(ND_EFIS_ARPT_FILTER_NAME, 
+    efis_mode_scale);
   assert(arpt_efis_filter != nullptr);
-  sta_efis_filter = tex_manager->GetTexture(ND_EFIS_STA_FILTER_NAME);
+  sta_efis_filter = tex_manager->GetScaledTexture(ND_EFIS_STA_FILTER_NAME, 
+    efis_mode_scale);
   assert(sta_efis_filter != nullptr);
-  wpt_efis_filter = tex_manager->GetTexture(ND_EFIS_WPT_FILTER_NAME);
+  wpt_efis_filter = tex_manager->GetScaledTexture(ND_EFIS_WPT_FILTER_NAME, 
+    efis_mode_scale);
   assert(wpt_efis_filter != nullptr);
-  tfc_efis_filter = tex_manager->GetTexture(ND_EFIS_TFC_FILTER_NAME);
+  tfc_efis_filter = tex_manager->GetScaledTexture(ND_EFIS_TFC_FILTER_NAME, 
+    efis_mode_scale);
   assert(tfc_efis_filter != nullptr);
 
   font_face = tex_manager->GetFontData(fms_display_fonts::MAIN_FONT_NAME)->cairo_face;
@@ -1061,17 +1147,31 @@ std::optional<geom::vect2_t> NDDisplay::strict_get_screen_coords(
   return std::nullopt;
 }
 
+void NDDisplay::draw_rotated_symbol(cairo_t* cr, texture_type tex, 
+  geom::vect2_t pos, double rot_rad) {
+  // The render has to fit the symbol at any angle:
+  double diag = std::ceil(cairo_utils::get_surf_sz(tex).absval());
+  double half_diag = std::floor(diag / 2);
+  geom::vect2_t ctr = {half_diag, half_diag};
+  texture_type render = symbol_renders_.GetRotated(tex, rot_rad, 
+    {diag, diag}, ctr);
+  if(render == nullptr) {
+    cairo_utils::draw_rotated_image(cr, tex, pos, cairo_utils::NO_SCALE, 
+      rot_rad);
+    return;
+  }
+  cairo_utils::blit_image(cr, render, pos - ctr, false);
+}
+
 void NDDisplay::draw_heading_trk_rotary(cairo_t* cr, texture_type tex, 
-  geom::vect2_t scale, double rot_rad, double radius, bool flip) const noexcept {
-  geom::vect2_t wpt_scale = size_.scmul(1 / WPT_SCALE_FACT);
-  geom::vect2_t sc_act = wpt_scale * scale;
+  double rot_rad, double radius, bool flip) {
   geom::vect2_t tr_vec = {sin(rot_rad), cos(rot_rad)};
   geom::vect2_t pos =
       scr_pos_ + map_ctr_ - tr_vec.scmul(size_.x * radius);
   if(flip) {
-    cairo_utils::draw_rotated_image(cr, tex, pos, sc_act, -rot_rad);
+    draw_rotated_symbol(cr, tex, pos, -rot_rad);
   } else {
-    cairo_utils::draw_rotated_image(cr, tex, pos, sc_act, 1.0 / M_1_PI - rot_rad);
+    draw_rotated_symbol(cr, tex, pos, 1.0 / M_1_PI - rot_rad);
   }
 }
 
@@ -1104,6 +1204,7 @@ void NDDisplay::draw_line_joint(cairo_t* cr, geom::line_joint_t lj,
 
 void NDDisplay::draw_flight_plan(cairo_t* cr, bool draw_labels,
                                  geom::vect3_t ln_clr, size_t idx) {
+  MY_TRACE_SCOPE("NDDisplay::draw_flight_plan");
   leg_proj_t* buf;
   size_t buf_size = nd_data_->get_proj_legs(&buf, side_idx_, idx);
   int act_leg_idx = -1;
@@ -1155,18 +1256,15 @@ void NDDisplay::draw_flight_plan(cairo_t* cr, bool draw_labels,
           tgt_color = cairo_utils::MAGENTA;
         }
 
-        fms_display_fonts::draw_left_text(cr, textures_.font_face, name_draw, text_pos,
-                                    tgt_color, ND_WPT_FONT_SZ, size_, 
-                                    fms_display_fonts::kSmallTextSlope);
+        label_text_->AddText(name_draw, text_pos, tgt_color, ND_WPT_FONT_SZ,
+                             fms_display_fonts::TextAlign::LEFT,
+                             fms_display_fonts::kSmallTextSlope);
 
         if (!buf[i].is_rwy && buf[i].end_nm[0] != '(') {
-          geom::vect2_t scale = size_.scmul(1 / WPT_SCALE_FACT);
           if (is_active) {
-            cairo_utils::draw_image(cr, textures_.wpt_act, ew_trans,
-                                    scale, true);
+            cairo_utils::blit_image(cr, textures_.wpt_act, ew_trans, true);
           } else {
-            cairo_utils::draw_image(cr, textures_.wpt_inact,
-                                    ew_trans, scale, true);
+            cairo_utils::blit_image(cr, textures_.wpt_inact, ew_trans, true);
           }
         } else if (!buf[i].is_rwy) {
           cairo_utils::draw_circle(cr, ew_trans, size_.x * PSEUDO_WPT_RADIUS_RAT,
@@ -1177,6 +1275,7 @@ void NDDisplay::draw_flight_plan(cairo_t* cr, bool draw_labels,
   }
 
   if (draw_dash) cairo_restore(cr);
+  if (draw_labels) label_text_->Flush(cr);
 }
 
 void NDDisplay::draw_ext_rwy_ctr_line(cairo_t* cr, leg_proj_t rnw_proj) {
@@ -1228,6 +1327,7 @@ void NDDisplay::draw_runway(cairo_t* cr, leg_proj_t rnw_proj) {
 }
 
 void NDDisplay::draw_runways(cairo_t* cr, size_t idx) {
+  MY_TRACE_SCOPE("NDDisplay::draw_runways");
   leg_proj_t* buf;
   size_t buf_size = nd_data_->get_proj_legs(&buf, side_idx_, idx);
   UNUSED(buf_size);
@@ -1242,6 +1342,8 @@ void NDDisplay::draw_runways(cairo_t* cr, size_t idx) {
 }
 
 void NDDisplay::draw_all_fplns(cairo_t* cr) {
+  MY_TRACE_SCOPE("NDDisplay::draw_all_fplns");
+  MY_ALLOC_SCOPE("NDDisplay::draw_all_fplns");
   std::vector<int> fpl_draw_seq = nd_data_->get_rte_draw_seq(side_idx_);
   for (size_t i = 0; i < fms_core::N_FPL_SYS_RTES; i++) {
     if (fpl_draw_seq[i] == -1) continue;
@@ -1252,24 +1354,21 @@ void NDDisplay::draw_all_fplns(cairo_t* cr) {
 }
 
 void NDDisplay::draw_airplane(cairo_t* cr) {
-  geom::vect2_t wpt_scale = size_.scmul(1 / WPT_SCALE_FACT);
+  MY_TRACE_SCOPE("NDDisplay::draw_airplane");
   if (config_.mode == fms_core::NDMode::PLAN) {
     geom::vect2_t pos;
     bool do_drawing = nd_data_->get_ac_pos(&pos, side_idx_);
     if (do_drawing) {
       geom::vect2_t pos_trans = get_screen_coords(pos);
-      cairo_utils::draw_rotated_image(cr, textures_.airplane,
-                                      pos_trans, wpt_scale,
-                                      hdg_data_.brng_tru_rad);
+      draw_rotated_symbol(cr, textures_.airplane, pos_trans, 
+                          hdg_data_.brng_tru_rad);
     }
   } else {
     cairo_surface_t* tgt = textures_.map_ac_ico;
-    geom::vect2_t act_scale = MAP_AC_TRI_SC * wpt_scale;
-    geom::vect2_t sz =
-        cairo_utils::get_surf_sz(tgt) * act_scale;
+    geom::vect2_t sz = cairo_utils::get_surf_sz(tgt);
     geom::vect2_t sz_shift = {0, 0.5};
     geom::vect2_t pos = scr_pos_ + map_ctr_ + sz * sz_shift;
-    cairo_utils::draw_image(cr, tgt, pos, act_scale, true);
+    cairo_utils::blit_image(cr, tgt, pos, true);
   }
 }
 
@@ -1309,8 +1408,8 @@ void NDDisplay::draw_hdg_tri(cairo_t* cr) {
   if (config_.mode == fms_core::NDMode::MAP) {
     double rot_rad = 0;
     if (all_config_.is_track_up) rot_rad = -hdg_data_.slip_rad;
-    draw_heading_trk_rotary(cr, textures_.map_ac_ico, MAP_HDG_TRI_SC, 
-      rot_rad, MAP_HDG_TRI_VOFFS);
+    draw_heading_trk_rotary(cr, textures_.map_hdg_tri, rot_rad, 
+      MAP_HDG_TRI_VOFFS);
   }
 }
 
@@ -1319,11 +1418,11 @@ void NDDisplay::draw_mcp_heading(cairo_t* cr) {
     double rot_rad = -static_cast<double>(all_config_.hdg_sel_deg) * geom::DEG_TO_RAD -
       nd_data_->get_hdg_trk();
     if(all_config_.hdg_sel_is_trk) {
-      draw_heading_trk_rotary(cr, textures_.trk_sel_box, MCP_TRK_DIAL_SC, 
-        rot_rad, MAP_TRK_DIAL_VOFFS, true);
+      draw_heading_trk_rotary(cr, textures_.trk_sel_box, rot_rad, 
+        MAP_TRK_DIAL_VOFFS, true);
     } else {
-      draw_heading_trk_rotary(cr, textures_.hdg_sel_box, MCP_HDG_DIAL_SC, 
-        rot_rad, MAP_HDG_DIAL_VOFFS, true);
+      draw_heading_trk_rotary(cr, textures_.hdg_sel_box, rot_rad, 
+        MAP_HDG_DIAL_VOFFS, true);
     }
   }
 }
@@ -1366,6 +1465,7 @@ void NDDisplay::draw_tfc_arcs(cairo_t* cr) {
 }
 
 void NDDisplay::draw_background(cairo_t* cr, bool draw_inner) {
+  MY_TRACE_SCOPE("NDDisplay::draw_background");
   cairo_surface_t* back_surf;
 
   if (config_.mode == fms_core::NDMode::PLAN) {
@@ -1379,24 +1479,27 @@ void NDDisplay::draw_background(cairo_t* cr, bool draw_inner) {
 
   if ((!draw_inner && config_.mode == fms_core::NDMode::MAP) ||
       config_.mode == fms_core::NDMode::PLAN) {
-    geom::vect2_t scale_back = size_ / cairo_utils::get_surf_sz(back_surf);
-    cairo_utils::draw_image(cr, back_surf, scr_pos_, scale_back, false);
+    cairo_utils::blit_image(cr, back_surf, scr_pos_, false);
   }
 
   if (config_.mode == fms_core::NDMode::MAP) {
     if (!draw_inner) {
-      cairo_surface_t* map_hdg_surf = textures_.map_hdg;
-      geom::vect2_t scale_hdg =
-          (size_ / cairo_utils::get_surf_sz(map_hdg_surf)).scmul(1.41);
-      geom::vect2_t hdg_pos = scr_pos_ + map_ctr_;
-      cairo_utils::draw_rotated_image(cr, map_hdg_surf, hdg_pos, scale_hdg,
-                                      nd_data_->get_hdg_trk());
+      // The rose is rendered clipped to the display, so that a cached
+      // render stays the size of the display rather than of the rose.
+      double hdg_trk = nd_data_->get_hdg_trk();
+      texture_type rose = rose_renders_.GetRotated(textures_.map_hdg, 
+        hdg_trk, size_, map_ctr_);
+      if (rose != nullptr) {
+        cairo_utils::blit_image(cr, rose, scr_pos_, false);
+      } else {
+        geom::vect2_t hdg_pos = scr_pos_ + map_ctr_;
+        cairo_utils::draw_rotated_image(cr, textures_.map_hdg, hdg_pos, 
+                                        cairo_utils::NO_SCALE, hdg_trk);
+      }
       cairo_surface_t* htrk_box = textures_.hdg_trk_box;
-      geom::vect2_t box_sz = cairo_utils::get_surf_sz(htrk_box);
-      geom::vect2_t scale_box = (box_sz * size_.scdiv(900)) * MAP_HTK_BOX_SC;
-      double hht = box_sz.y * 0.5 * scale_box.y;
+      double hht = cairo_utils::get_surf_sz(htrk_box).y * 0.5;
       geom::vect2_t box_pos = scr_pos_ + geom::vect2_t{size_.x / 2, hht};
-      cairo_utils::draw_image(cr, htrk_box, box_pos, scale_box, true);
+      cairo_utils::blit_image(cr, htrk_box, box_pos, true);
       draw_htrk(cr);
       draw_hdg_tri(cr);
       draw_mcp_heading(cr);
@@ -1408,6 +1511,8 @@ void NDDisplay::draw_background(cairo_t* cr, bool draw_inner) {
 }
 
 void NDDisplay::draw_act_leg_info(cairo_t* cr) {
+  MY_TRACE_SCOPE("NDDisplay::draw_act_leg_info");
+  MY_ALLOC_SCOPE("NDDisplay::draw_act_leg_info");
   fms_core::act_leg_info_t leg_info = nd_data_->get_act_leg_info();
 
   geom::vect2_t act_name_pos = scr_pos_ + size_ * ACT_LEG_NAME_OFFS;
@@ -1432,6 +1537,7 @@ void NDDisplay::draw_act_leg_info(cairo_t* cr) {
 }
 
 void NDDisplay::draw_spd_info(cairo_t* cr) {
+  MY_TRACE_SCOPE("NDDisplay::draw_spd_info");
   fms_core::spd_info_t spd_info = nd_data_->get_spd_data();
 
   geom::vect2_t gs_text_pos = scr_pos_ + size_ * GS_TEXT_OFFS;
@@ -1467,6 +1573,7 @@ void NDDisplay::draw_spd_info(cairo_t* cr) {
 }
 
 void NDDisplay::draw_range(cairo_t* cr) {
+  MY_TRACE_SCOPE("NDDisplay::draw_range");
   uint8_t half_pr = 0, full_pr = 0;
 
   if (curr_rng_ <= RNG_DEC_1_NM)  // Range can never be < 2.5
@@ -1522,9 +1629,9 @@ std::size_t NDDisplay::draw_airports(cairo_t* cr) {
       break;
     }
     if (i < N_EFIS_MAP_ALTN_APTS) {
-      cnt += draw_labeled_point(cr, surf_altn, cr_point.point, EFIS_ARPT_SC);
+      cnt += draw_labeled_point(cr, surf_altn, cr_point.point);
     } else {
-      cnt += draw_labeled_point(cr, surf_norm, cr_point.point, EFIS_ARPT_SC);
+      cnt += draw_labeled_point(cr, surf_norm, cr_point.point);
     }
   }
   return cnt;
@@ -1538,7 +1645,7 @@ std::size_t NDDisplay::draw_vordmes(cairo_t* cr) {
     if (cr_point.dist_ctr > curr_rng_) {
       break;
     }
-    cnt += draw_labeled_point(cr, tgt_surf, cr_point.point, EFIS_VHF_SC);
+    cnt += draw_labeled_point(cr, tgt_surf, cr_point.point);
   }
   return cnt;
 }
@@ -1551,7 +1658,7 @@ std::size_t NDDisplay::draw_vors_dmes(cairo_t* cr) {
     if (cr_point.dist_ctr > curr_rng_) {
       break;
     }
-    cnt += draw_labeled_point(cr, tgt_surf, cr_point.point, EFIS_VHF_SC);
+    cnt += draw_labeled_point(cr, tgt_surf, cr_point.point);
   }
   return cnt;
 }
@@ -1564,16 +1671,14 @@ std::size_t NDDisplay::draw_waypoints(cairo_t* cr) {
     if (cr_point.dist_ctr > curr_rng_) {
       break;
     }
-    cnt += draw_labeled_point(cr, tgt_surf, cr_point.point, EFIS_WAYPT_SC);
+    cnt += draw_labeled_point(cr, tgt_surf, cr_point.point);
   }
   return cnt;
 }
 
 void NDDisplay::draw_efis_excess_data(cairo_t* cr) {
   geom::vect2_t pos_local = scr_pos_ + size_ * EXCESS_DATA_MSG_POS;
-  geom::vect2_t scale_fact_vec = (size_ * EXCESS_DATA_MSG_SCALE).scdiv(WPT_SCALE_FACT);
-  cairo_utils::draw_image(cr, textures_.excess_data_msg, pos_local, 
-    scale_fact_vec, false);
+  cairo_utils::blit_image(cr, textures_.excess_data_msg, pos_local, false);
 }
 
 void NDDisplay::draw_efis_modes(cairo_t* cr) const noexcept {
@@ -1585,25 +1690,26 @@ void NDDisplay::draw_efis_modes(cairo_t* cr) const noexcept {
   geom::vect2_t bounding_rect_size = EFIS_MODES_BOUNDING_RECT_SIZE * size_;
   cairo_utils::draw_rect(cr, bounding_rect_pos, bounding_rect_size, 
     cairo_utils::BLACK);
-  geom::vect2_t scale_fact_vec = (size_.scmul(EFIS_MODE_SCALE)).scdiv(WPT_SCALE_FACT);
   if(config_.efis_airport_on) {
     geom::vect2_t pos_local = scr_pos_ + size_ * EFIS_ARPT_MODE_POS;
-    cairo_utils::draw_image(cr, textures_.arpt_efis_filter, pos_local, 
-      scale_fact_vec, false);
+    cairo_utils::blit_image(cr, textures_.arpt_efis_filter, pos_local, 
+      false);
   }
   if(config_.efis_waypoint_on) {
     geom::vect2_t pos_local = scr_pos_ + size_ * EFIS_WPT_MODE_POS;
-    cairo_utils::draw_image(cr, textures_.wpt_efis_filter, pos_local, 
-      scale_fact_vec, false);
+    cairo_utils::blit_image(cr, textures_.wpt_efis_filter, pos_local, 
+      false);
   }
   if(config_.efis_station_on) {
     geom::vect2_t pos_local = scr_pos_ + size_ * EFIS_STA_MODE_POS;
-    cairo_utils::draw_image(cr, textures_.sta_efis_filter, pos_local, 
-      scale_fact_vec, false);
+    cairo_utils::blit_image(cr, textures_.sta_efis_filter, pos_local, 
+      false);
   }
 }
 
 void NDDisplay::draw_efis_filters(cairo_t* cr) {
+  MY_TRACE_SCOPE("NDDisplay::draw_efis_filters");
+  MY_ALLOC_SCOPE("NDDisplay::draw_efis_filters");
   std::size_t n_drawn = 0;
   if (config_.mode == fms_core::NDMode::MAP) {
     if (config_.efis_airport_on) {
@@ -1617,6 +1723,7 @@ void NDDisplay::draw_efis_filters(cairo_t* cr) {
       n_drawn += draw_waypoints(cr);
     }
   }
+  label_text_->Flush(cr);
   if(n_drawn > EXCESS_DATA_CNT_THRESH) {
     draw_efis_excess_data(cr);
   }
@@ -1624,21 +1731,18 @@ void NDDisplay::draw_efis_filters(cairo_t* cr) {
 }
 
 bool NDDisplay::draw_labeled_point(cairo_t* cr, cairo_surface_t* img,
-                                   labeled_point_t& src_point,
-                                   double img_scale) const noexcept {
+                                   labeled_point_t& src_point) {
   auto pos_local_data = strict_get_screen_coords(src_point.pos);
   if(!pos_local_data) {
     return false;
   }
   geom::vect2_t pos_local = *pos_local_data;
-  geom::vect2_t scale_fact_vec = size_.scmul(img_scale).scdiv(WPT_SCALE_FACT);
-  geom::vect2_t img_sz = cairo_utils::get_surf_sz(img) * scale_fact_vec;
+  geom::vect2_t img_sz = cairo_utils::get_surf_sz(img);
   geom::vect2_t pos_text = pos_local + img_sz * EFIS_POI_TEXT_OFFSET;
-  cairo_utils::draw_image(cr, img, pos_local, scale_fact_vec, true);
-  fms_display_fonts::draw_left_text(cr, textures_.font_face, src_point.name, pos_text,
-                              cairo_utils::ND_CYAN,
-                              EFIS_POI_NAME_FNT_SZ, size_, 
-                              fms_display_fonts::kSmallTextSlope);
+  cairo_utils::blit_image(cr, img, pos_local, true);
+  label_text_->AddText(src_point.name, pos_text, cairo_utils::ND_CYAN,
+                       EFIS_POI_NAME_FNT_SZ, fms_display_fonts::TextAlign::LEFT,
+                       fms_display_fonts::kSmallTextSlope);
   return true;
 }
 }  // namespace fms_displays
@@ -22,12 +22,15 @@
 #include <vector>
 
 #include <displays/common/cairo_utils.hpp>
+#include <displays/common/rotation_cache.hpp>
+#include <displays/common/text_engine.hpp>
 #include <displays/common/texture_manager.hpp>
 #include <fpln/environment.hpp>
 #include <fpln/fpln_sys.hpp>
 #include <libnav/str_utils.hpp>
 
 #include <util/geom.hpp>
+#include <util/instr_mutex.hpp>
 #include <util/util.hpp>
 
 namespace fms_displays {
@@ -136,6 +139,7 @@ struct nd_global_config_t {
   double nm_mcp_alt_to_go = 0.0;
   std::int64_t hdg_sel_deg = 0.0;
   bool hdg_sel_is_trk = false;
+  double rot_quantum_deg = fms_environment::ND_ROT_QUANTUM_DEG_DEF;
 
   nd_global_config_t();
 };
@@ -201,7 +205,7 @@ class NDData final {
   void destroy();
 
  private:
-  mutable std::shared_mutex main_mutex_;
+  mutable util::InstrSharedMutex main_mutex_{"NDData"};
 
   nd_global_config_t nd_all_config_;
   nd_local_config_t nd_configs_[N_ND_SDS];
@@ -248,6 +252,9 @@ class NDData final {
 
   void update_configs() noexcept;
 
+  // Hands the configuration over to FPLSys for the shared memory export
+  void export_configs() noexcept;
+
   double get_range_impl(std::size_t sd_idx) const noexcept;
 
   double get_cr_rot() const noexcept;
@@ -286,6 +293,7 @@ class NDDisplay final {
   void draw(cairo_t* cr);
 
  private:
+  // All textures are pre-scaled to this display's size and painted 1:1.
   struct nd_textures_t {
     texture_type wpt_inact;
     texture_type wpt_act;
@@ -295,6 +303,7 @@ class NDDisplay final {
     texture_type map_back;
     texture_type map_hdg;
     texture_type map_ac_ico;
+    texture_type map_hdg_tri;
     texture_type hdg_trk_box;
     texture_type normal_arpt_sign;
     texture_type altn_arpt_sign;
@@ -311,7 +320,8 @@ class NDDisplay final {
 
     cairo_font_face_t* font_face;
 
-    void init(util::OpaquePointer<TextureManager> tex_manager);
+    void init(util::OpaquePointer<TextureManager> tex_manager, 
+      geom::vect2_t sz);
   };
 
   util::OpaquePointer<NDData> nd_data_;
@@ -321,6 +331,13 @@ class NDDisplay final {
   bool has_tfc_ = false;
 
   nd_textures_t textures_;
+  // Renders of the compass rose, which is as big as the display, and of the
+  // small rotating symbols.
+  RotationCache rose_renders_;
+  RotationCache symbol_renders_;
+  // Waypoint and POI labels. Queued while drawing and flushed once per
+  // layer, so each label set costs one glyph draw per color.
+  std::unique_ptr<fms_display_fonts::TextEngine> label_text_;
 
   geom::vect2_t scr_pos_;
   geom::vect2_t size_;
@@ -339,8 +356,11 @@ class NDDisplay final {
   std::optional<geom::vect2_t> strict_get_screen_coords(
     geom::vect2_t src) const noexcept;
 
-  void draw_heading_trk_rotary(cairo_t* cr, texture_type tex, geom::vect2_t scale,
-    double rot_rad, double radius, bool flip=false) const noexcept;
+  void draw_rotated_symbol(cairo_t* cr, texture_type tex, geom::vect2_t pos,
+    double rot_rad);
+
+  void draw_heading_trk_rotary(cairo_t* cr, texture_type tex,
+    double rot_rad, double radius, bool flip=false);
 
   void draw_line_joint(cairo_t* cr, geom::line_joint_t lj,
                        geom::vect3_t ln_clr);
@@ -391,6 +411,6 @@ class NDDisplay final {
   void draw_efis_filters(cairo_t* cr);
 
   bool draw_labeled_point(cairo_t* cr, cairo_surface_t* img,
-                          labeled_point_t& src_point, double img_scale) const noexcept;
+                          labeled_point_t& src_point);
 };
 }  // namespace fms_displays
@@ -17,6 +17,9 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <map>
 #include <string>
 #include <vector>
@@ -36,6 +39,8 @@ constexpr geom::vect3_t RED = {1, 0, 0};
 constexpr geom::vect3_t GREEN = {0, 1, 0};
 constexpr geom::vect3_t BLUE = {0, 0, 1};
 
+constexpr geom::vect2_t NO_SCALE = {1, 1};
+
 inline bool load_font(const std::string& font_path, FT_Library ft_lib,
                       FT_Face* font_face, cairo_font_face_t** cr_font) {
   FT_Error err = FT_New_Face(ft_lib, font_path.c_str(), 0, font_face);
@@ -216,4 +221,112 @@ inline void draw_rotated_image(cairo_t* cr, cairo_surface_t* surf,
   cairo_paint(cr);
   cairo_restore(cr);
 }
+
+// Returns a new image surface containing surf resampled by scale.
+// The caller owns the returned surface.
+
+inline cairo_surface_t* create_scaled_surface(cairo_surface_t* surf,
+                                              geom::vect2_t scale) {
+  geom::vect2_t surf_sz = get_surf_sz(surf);
+  int width = std::max(1, int(std::round(surf_sz.x * scale.x)));
+  int height = std::max(1, int(std::round(surf_sz.y * scale.y)));
+  cairo_surface_t* out =
+      cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+  cairo_t* cr = cairo_create(out);
+
+  cairo_scale(cr, scale.x, scale.y);
+  cairo_set_source_surface(cr, surf, 0, 0);
+  cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_BEST);
+  cairo_paint(cr);
+
+  cairo_destroy(cr);
+  return out;
+}
+
+// Paints surf without scaling. The position is snapped to whole pixels, so
+// cairo can copy the surface instead of resampling it.
+
+inline void blit_image(cairo_t* cr, cairo_surface_t* surf, geom::vect2_t pos,
+                       bool centered) {
+  if (centered) {
+    pos = pos - get_surf_sz(surf).scmul(0.5);
+  }
+
+  cairo_set_source_surface(cr, surf, std::round(pos.x), std::round(pos.y));
+  cairo_paint(cr);
+}
+
+// Sets a w x h block of an ARGB32 image surface to an opaque color by writing
+// pixels directly. The same flush/mark_dirty rules as for blit_block_over apply.
+
+inline void fill_block(cairo_surface_t* dst, int x, int y, int w, int h,
+                       geom::vect3_t color) {
+  int dst_w = cairo_image_surface_get_width(dst);
+  int dst_h = cairo_image_surface_get_height(dst);
+  int x_lo = std::max(0, x), x_hi = std::min(dst_w, x + w);
+  int y_lo = std::max(0, y), y_hi = std::min(dst_h, y + h);
+  if (x_lo >= x_hi || y_lo >= y_hi) return;
+
+  auto to_byte = [](double c) {
+    return uint32_t(std::clamp(std::round(c * 255), 0.0, 255.0));
+  };
+  uint32_t px = 0xFF000000 | to_byte(color.x) << 16 | to_byte(color.y) << 8 |
+                to_byte(color.z);
+  unsigned char* dst_data = cairo_image_surface_get_data(dst);
+  int dst_stride = cairo_image_surface_get_stride(dst);
+  for (int i = y_lo; i < y_hi; i++) {
+    uint32_t* d_row = reinterpret_cast<uint32_t*>(dst_data + i * dst_stride);
+    std::fill(d_row + x_lo, d_row + x_hi, px);
+  }
+}
+
+// Composites a w x h block of src at (src_x, src_y) over dst at (dst_x, dst_y)
+// by writing pixels directly, without going through a cairo context. Both
+// surfaces must be ARGB32 image surfaces. The block is clipped to both of them.
+// Call cairo_surface_flush on both surfaces before and cairo_surface_mark_dirty
+// on dst after a series of blits.
+
+inline void blit_block_over(cairo_surface_t* dst, int dst_x, int dst_y,
+                            cairo_surface_t* src, int src_x, int src_y,
+                            int w, int h) {
+  int src_w = cairo_image_surface_get_width(src);
+  int src_h = cairo_image_surface_get_height(src);
+  int dst_w = cairo_image_surface_get_width(dst);
+  int dst_h = cairo_image_surface_get_height(dst);
+
+  int x_lo = std::max({0, -src_x, -dst_x});
+  int y_lo = std::max({0, -src_y, -dst_y});
+  int x_hi = std::min({w, src_w - src_x, dst_w - dst_x});
+  int y_hi = std::min({h, src_h - src_y, dst_h - dst_y});
+  if (x_lo >= x_hi || y_lo >= y_hi) return;
+
+  unsigned char* src_data = cairo_image_surface_get_data(src);
+  unsigned char* dst_data = cairo_image_surface_get_data(dst);
+  int src_stride = cairo_image_surface_get_stride(src);
+  int dst_stride = cairo_image_surface_get_stride(dst);
+
+  for (int y = y_lo; y < y_hi; y++) {
+    const uint32_t* s_row = reinterpret_cast<const uint32_t*>(
+        src_data + (src_y + y) * src_stride) + src_x;
+    uint32_t* d_row = reinterpret_cast<uint32_t*>(
+        dst_data + (dst_y + y) * dst_stride) + dst_x;
+    for (int x = x_lo; x < x_hi; x++) {
+      uint32_t s_px = s_row[x];
+      uint32_t s_a = s_px >> 24;
+      if (s_a == 0xFF) {
+        d_row[x] = s_px;
+      } else if (s_a != 0) {
+        // Pixels are premultiplied, so OVER is s + d * (1 - s_a)
+        uint32_t d_px = d_row[x];
+        uint32_t out = 0;
+        for (int sh = 0; sh < 32; sh += 8) {
+          uint32_t d_c = (d_px >> sh) & 0xFF;
+          uint32_t c = ((s_px >> sh) & 0xFF) + (d_c * (0xFF - s_a) + 127) / 0xFF;
+          out |= std::min(c, uint32_t(0xFF)) << sh;
+        }
+        d_row[x] = out;
+      }
+    }
+  }
+}
 }  // namespace cairo_utils
@@ -9,6 +9,9 @@
 namespace {
 
 constexpr double kRefPx = 900.0;
+} // namespace
+
+namespace fms_display_fonts {
 
 double GetScaledFontSize(double font_sz, geom::vect2_t canvas_sz, 
   double slope) noexcept {
@@ -16,9 +19,6 @@ double GetScaledFontSize(double font_sz, geom::vect2_t canvas_sz,
   double delta = (min_dim - kRefPx) * slope;
   return delta + font_sz;
 }
-} // namespace
-
-namespace fms_display_fonts {
 
 void draw_left_text(cairo_t* cr, cairo_font_face_t* font_face,
                         std::string txt, geom::vect2_t pos,
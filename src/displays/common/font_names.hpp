@@ -16,6 +16,10 @@ constexpr double kSmallTextSlope = 0.02195121951219512;
 constexpr double kMediumTextSlope = 0.036585365853658534;
 constexpr double kLargeTextSlope = 0.05121951219512195;
 
+// Font size in pixels for a canvas of canvas_sz
+double GetScaledFontSize(double font_sz, geom::vect2_t canvas_sz, 
+  double slope) noexcept;
+
 void draw_left_text(cairo_t* cr, cairo_font_face_t* font_face,
                         std::string txt, geom::vect2_t pos,
                         geom::vect3_t color, double font_sz, 
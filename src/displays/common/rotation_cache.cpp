@@ -0,0 +1,123 @@
+#include "rotation_cache.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <functional>
+#include <list>
+#include <unordered_map>
+
+#include <cairo.h>
+
+#include <util/geom.hpp>
+
+#include "cairo_utils.hpp"
+
+namespace {
+constexpr double kFullCircleDeg = 360;
+}  // namespace
+
+namespace fms_displays {
+
+RotationCache::RotationCache(std::size_t capacity, double quantum_deg)
+    : capacity_{capacity}, quantum_deg_{0}, n_buckets_{0} {
+  if (capacity_ == 0) {
+    capacity_ = 1;
+  }
+  SetQuantum(quantum_deg);
+}
+
+double RotationCache::GetQuantum() const noexcept {
+  return quantum_deg_;
+}
+
+void RotationCache::SetQuantum(double quantum_deg) noexcept {
+  if (!(quantum_deg >= kMinQuantumDeg)) {
+    quantum_deg = kMinQuantumDeg;
+  }
+  if (quantum_deg == quantum_deg_) {
+    return;
+  }
+  Clear();
+  quantum_deg_ = quantum_deg;
+  n_buckets_ = std::max(std::int64_t(1),
+    std::int64_t(std::llround(kFullCircleDeg / quantum_deg_)));
+}
+
+RotationCache::texture_t RotationCache::GetRotated(texture_t src,
+  double rot_rad, geom::vect2_t view_sz, geom::vect2_t ctr) noexcept {
+  if (src == nullptr) {
+    return nullptr;
+  }
+  key_t key{src, get_bucket(rot_rad), int(std::round(view_sz.x)),
+    int(std::round(view_sz.y)), int(std::round(ctr.x)), int(std::round(ctr.y))};
+  if (key.view_w <= 0 || key.view_h <= 0) {
+    return nullptr;
+  }
+
+  auto it = renders_.find(key);
+  if (it != renders_.end()) {
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return it->second->render;
+  }
+
+  texture_t out = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, key.view_w,
+    key.view_h);
+  if (cairo_surface_status(out) != CAIRO_STATUS_SUCCESS) {
+    cairo_surface_destroy(out);
+    return nullptr;
+  }
+  double q_rad = double(key.bucket) * quantum_deg_ * geom::DEG_TO_RAD;
+  cairo_t* cr = cairo_create(out);
+  cairo_utils::draw_rotated_image(cr, src, {double(key.ctr_x),
+    double(key.ctr_y)}, cairo_utils::NO_SCALE, q_rad);
+  cairo_destroy(cr);
+
+  if (lru_.size() == capacity_) {
+    entry_t& last = lru_.back();
+    cairo_surface_destroy(last.render);
+    renders_.erase(last.key);
+    lru_.pop_back();
+  }
+  lru_.push_front({key, out});
+  renders_[key] = lru_.begin();
+
+  return out;
+}
+
+void RotationCache::Clear() noexcept {
+  for (auto& i : lru_) {
+    cairo_surface_destroy(i.render);
+  }
+  lru_.clear();
+  renders_.clear();
+}
+
+RotationCache::~RotationCache() {
+  Clear();
+}
+
+// Private member functions:
+
+std::size_t RotationCache::key_hash_t::operator()(
+  const key_t& key) const noexcept {
+  std::size_t h = std::hash<texture_t>{}(key.src);
+  for (std::int64_t v : {key.bucket, std::int64_t(key.view_w),
+    std::int64_t(key.view_h), std::int64_t(key.ctr_x),
+    std::int64_t(key.ctr_y)}) {
+    h ^= std::hash<std::int64_t>{}(v) + 0x9e3779b9 + (h << 6) + (h >> 2);
+  }
+  return h;
+}
+
+std::int64_t RotationCache::get_bucket(double rot_rad) const noexcept {
+  std::int64_t bucket = std::llround(rot_rad * geom::RAD_TO_DEG / quantum_deg_);
+  bucket %= n_buckets_;
+  if (bucket < 0) {
+    bucket += n_buckets_;
+  }
+  return bucket;
+}
+}  // namespace fms_displays
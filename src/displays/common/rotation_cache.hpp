@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <list>
+#include <unordered_map>
+
+#include <cairo.h>
+
+#include <util/geom.hpp>
+
+namespace fms_displays {
+
+/*
+  Keeps renders of rotated textures. Angles are rounded to a multiple of the
+  quantum, so the same render is reused while the rotation stays within a
+  bucket. The least recently used render is evicted once the cache is full.
+  Not thread safe: meant to be owned by a single display.
+*/
+class RotationCache final {
+public:
+  using texture_t = cairo_surface_t*;
+
+  static constexpr double kDefaultQuantumDeg = 0.25;
+  static constexpr double kMinQuantumDeg = 0.01;
+
+  RotationCache(std::size_t capacity,
+    double quantum_deg = kDefaultQuantumDeg);
+
+  RotationCache(const RotationCache& other) = delete;
+
+  RotationCache(RotationCache&& other) = delete;
+
+  RotationCache& operator=(const RotationCache& other) = delete;
+
+  RotationCache& operator=(RotationCache&& other) = delete;
+
+  double GetQuantum() const noexcept;
+
+  // Drops all renders if the quantum changes
+  void SetQuantum(double quantum_deg) noexcept;
+
+  /*
+    Returns a surface of size view_sz with src drawn so that its center lands
+    at ctr, rotated by rot_rad rounded to the quantum. Paint the result at
+    (pos - ctr) to place the center of src at pos.
+    Returns nullptr if the render fails.
+  */
+  texture_t GetRotated(texture_t src, double rot_rad, geom::vect2_t view_sz,
+    geom::vect2_t ctr) noexcept;
+
+  void Clear() noexcept;
+
+  ~RotationCache();
+
+private:
+  struct key_t {
+    texture_t src;
+    std::int64_t bucket;
+    int view_w, view_h;
+    int ctr_x, ctr_y;
+
+    bool operator==(const key_t& other) const = default;
+  };
+
+  struct key_hash_t {
+    std::size_t operator()(const key_t& key) const noexcept;
+  };
+
+  struct entry_t {
+    key_t key;
+    texture_t render;
+  };
+
+  std::size_t capacity_;
+  double quantum_deg_;
+  std::int64_t n_buckets_;
+
+  std::list<entry_t> lru_;  // Most recently used at the front
+  std::unordered_map<key_t, std::list<entry_t>::iterator, key_hash_t> renders_;
+
+  std::int64_t get_bucket(double rot_rad) const noexcept;
+};
+}  // namespace fms_displays
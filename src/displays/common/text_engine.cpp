@@ -0,0 +1,149 @@
+#include "text_engine.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <cairo.h>
+
+#include <util/geom.hpp>
+
+#include "font_names.hpp"
+
+namespace {
+
+// Font sizes are keyed in 1/64 of a pixel
+constexpr double kSizeKeyRes = 64.0;
+// Upper bound on cached label strings per font size. The cache is dropped
+// once this is exceeded, so that it can't grow without bounds.
+constexpr std::size_t kMaxRunsPerFont = 4096;
+
+bool IsSameColor(geom::vect3_t a, geom::vect3_t b) noexcept {
+  return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+}  // namespace
+
+namespace fms_display_fonts {
+
+TextEngine::TextEngine(cairo_font_face_t* font_face, geom::vect2_t canvas_sz)
+    : font_face_{font_face}, canvas_sz_{canvas_sz} {}
+
+void TextEngine::AddText(const std::string& txt, geom::vect2_t pos,
+                         geom::vect3_t color, double font_sz, TextAlign align,
+                         double slope) {
+  if (txt.empty()) {
+    return;
+  }
+  std::int64_t size_key = std::llround(
+      GetScaledFontSize(font_sz, canvas_sz_, slope) * kSizeKeyRes);
+  scaled_font_t* font = get_scaled_font(size_key);
+  if (font == nullptr) {
+    return;
+  }
+  const glyph_run_t* run = get_glyph_run(*font, txt);
+  if (run == nullptr) {
+    return;
+  }
+
+  const cairo_text_extents_t& ext = run->extents;
+  geom::vect2_t origin = pos;
+  if (align == TextAlign::RIGHT) {
+    origin.x -= ext.width + ext.x_bearing;
+  } else if (align == TextAlign::CENTER) {
+    origin.x -= ext.width / 2 + ext.x_bearing;
+    origin.y -= ext.height / 2 + ext.y_bearing;
+  }
+
+  batch_t& batch = get_batch(size_key, color, font->font);
+  for (const cairo_glyph_t& gl : run->glyphs) {
+    batch.glyphs.push_back({gl.index, gl.x + origin.x, gl.y + origin.y});
+  }
+}
+
+void TextEngine::Flush(cairo_t* cr) {
+  for (batch_t& batch : batches_) {
+    if (batch.glyphs.empty()) {
+      continue;
+    }
+    cairo_set_scaled_font(cr, batch.font);
+    cairo_set_source_rgb(cr, batch.color.x, batch.color.y, batch.color.z);
+    cairo_show_glyphs(cr, batch.glyphs.data(), int(batch.glyphs.size()));
+    batch.glyphs.clear();
+  }
+}
+
+TextEngine::~TextEngine() {
+  for (auto& i : fonts_) {
+    cairo_scaled_font_destroy(i.second.font);
+  }
+}
+
+// Private member functions:
+
+TextEngine::scaled_font_t* TextEngine::get_scaled_font(std::int64_t size_key) {
+  auto it = fonts_.find(size_key);
+  if (it != fonts_.end()) {
+    return &it->second;
+  }
+
+  double font_sz = double(size_key) / kSizeKeyRes;
+  cairo_matrix_t font_mtx, ctm;
+  cairo_matrix_init_scale(&font_mtx, font_sz, font_sz);
+  cairo_matrix_init_identity(&ctm);
+  cairo_font_options_t* opts = cairo_font_options_create();
+  cairo_scaled_font_t* font =
+      cairo_scaled_font_create(font_face_, &font_mtx, &ctm, opts);
+  cairo_font_options_destroy(opts);
+  if (cairo_scaled_font_status(font) != CAIRO_STATUS_SUCCESS) {
+    cairo_scaled_font_destroy(font);
+    return nullptr;
+  }
+
+  scaled_font_t& out = fonts_[size_key];
+  out.font = font;
+  return &out;
+}
+
+const TextEngine::glyph_run_t* TextEngine::get_glyph_run(
+    scaled_font_t& font, const std::string& txt) {
+  auto it = font.runs.find(txt);
+  if (it != font.runs.end()) {
+    return &it->second;
+  }
+  if (font.runs.size() >= kMaxRunsPerFont) {
+    font.runs.clear();
+  }
+
+  cairo_glyph_t* glyphs = nullptr;
+  int n_glyphs = 0;
+  cairo_status_t status = cairo_scaled_font_text_to_glyphs(
+      font.font, 0, 0, txt.c_str(), int(txt.size()), &glyphs, &n_glyphs,
+      nullptr, nullptr, nullptr);
+  if (status != CAIRO_STATUS_SUCCESS) {
+    return nullptr;
+  }
+
+  glyph_run_t run;
+  run.glyphs.assign(glyphs, glyphs + n_glyphs);
+  cairo_scaled_font_glyph_extents(font.font, glyphs, n_glyphs, &run.extents);
+  cairo_glyph_free(glyphs);
+
+  return &(font.runs[txt] = std::move(run));
+}
+
+TextEngine::batch_t& TextEngine::get_batch(std::int64_t size_key,
+                                           geom::vect3_t color,
+                                           cairo_scaled_font_t* font) {
+  for (batch_t& batch : batches_) {
+    if (batch.size_key == size_key && IsSameColor(batch.color, color)) {
+      return batch;
+    }
+  }
+  batches_.push_back({size_key, color, font, {}});
+  return batches_.back();
+}
+}  // namespace fms_display_fonts
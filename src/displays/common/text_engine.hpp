@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <cairo.h>
+
+#include <util/geom.hpp>
+
+#include "font_names.hpp"
+
+namespace fms_display_fonts {
+
+enum class TextAlign {
+  LEFT,
+  RIGHT,
+  CENTER
+};
+
+/*
+  Draws batches of labels with cairo's glyph API. Keeps a scaled font for
+  every font size in use, and the glyphs and extents of every label string
+  drawn with it. Labels are queued by AddText and drawn by Flush with one
+  cairo_show_glyphs call per (font size, color).
+  Assumes that the transformation matrix of the target context is identity.
+  Not thread safe: meant to be owned by a single display.
+*/
+class TextEngine final {
+public:
+  TextEngine(cairo_font_face_t* font_face, geom::vect2_t canvas_sz);
+
+  TextEngine(const TextEngine& other) = delete;
+
+  TextEngine(TextEngine&& other) = delete;
+
+  TextEngine& operator=(const TextEngine& other) = delete;
+
+  TextEngine& operator=(TextEngine&& other) = delete;
+
+  // font_sz and slope have the same meaning as in draw_left_text
+  void AddText(const std::string& txt, geom::vect2_t pos, geom::vect3_t color,
+    double font_sz, TextAlign align = TextAlign::LEFT,
+    double slope = kMediumTextSlope);
+
+  // Draws and clears everything queued since the last call
+  void Flush(cairo_t* cr);
+
+  ~TextEngine();
+
+private:
+  struct glyph_run_t {
+    std::vector<cairo_glyph_t> glyphs;  // Relative to the text origin
+    cairo_text_extents_t extents;
+  };
+
+  struct scaled_font_t {
+    cairo_scaled_font_t* font;
+    std::unordered_map<std::string, glyph_run_t> runs;
+  };
+
+  struct batch_t {
+    std::int64_t size_key;
+    geom::vect3_t color;
+    cairo_scaled_font_t* font;
+    std::vector<cairo_glyph_t> glyphs;
+  };
+
+  cairo_font_face_t* font_face_;
+  geom::vect2_t canvas_sz_;
+
+  std::unordered_map<std::int64_t, scaled_font_t> fonts_;
+  // Batches are kept between frames, so their buffers get reused
+  std::vector<batch_t> batches_;
+
+  scaled_font_t* get_scaled_font(std::int64_t size_key);
+
+  const glyph_run_t* get_glyph_run(scaled_font_t& font,
+    const std::string& txt);
+
+  batch_t& get_batch(std::int64_t size_key, geom::vect3_t color,
+    cairo_scaled_font_t* font);
+};
+}  // namespace fms_display_fonts
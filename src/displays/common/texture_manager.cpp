@@ -1,5 +1,10 @@
 #include "texture_manager.hpp"
 
+#include <cmath>
+#include <cstdint>
+
+#include <functional>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <unordered_map>
@@ -10,6 +15,7 @@
 #include FT_FREETYPE_H
 #include <nlohmann/json.hpp>
 
+#include <util/geom.hpp>
 #include <util/pathlib.hpp>
 
 #include "cairo_utils.hpp"
@@ -21,6 +27,8 @@ const char kFontType[] = "font";
 const char kTextureType[] = "texture";
 const char kFontDirName[] = "fonts";
 const char kTextureDirName[] = "textures";
+// Scales closer than this share a cache entry
+constexpr double kScaleQuantum = 1e-4;
 }
 
 namespace fms_displays {
@@ -87,6 +95,39 @@ TextureManager::texture_t TextureManager::GetTexture(
   return it->second;
 }
 
+TextureManager::texture_t TextureManager::GetScaledTexture(
+  const std::string& tex_name, geom::vect2_t scale) const noexcept {
+  texture_t src = GetTexture(tex_name);
+  if(src == nullptr || scale.x <= 0 || scale.y <= 0) {
+    return nullptr;
+  }
+  scaled_key_t key{tex_name, std::llround(scale.x / kScaleQuantum), 
+    std::llround(scale.y / kScaleQuantum)};
+
+  std::lock_guard<std::mutex> lock(scaled_mutex_);
+  auto it = scaled_textures_.find(key);
+  if(it != scaled_textures_.end()) {
+    return it->second;
+  }
+  geom::vect2_t sc_quant = {double(key.sc_x) * kScaleQuantum, 
+    double(key.sc_y) * kScaleQuantum};
+  texture_t out = cairo_utils::create_scaled_surface(src, sc_quant);
+  if(cairo_surface_status(out) != CAIRO_STATUS_SUCCESS) {
+    cairo_surface_destroy(out);
+    return nullptr;
+  }
+  scaled_textures_[key] = out;
+  return out;
+}
+
+std::size_t TextureManager::scaled_key_hash_t::operator()(
+  const scaled_key_t& key) const noexcept {
+  std::size_t h = std::hash<std::string>{}(key.name);
+  h ^= std::hash<std::int64_t>{}(key.sc_x) + 0x9e3779b9 + (h << 6) + (h >> 2);
+  h ^= std::hash<std::int64_t>{}(key.sc_y) + 0x9e3779b9 + (h << 6) + (h >> 2);
+  return h;
+}
+
 TextureManager::~TextureManager() {
   for(auto i: fonts_) {
     cairo_font_face_destroy(i.second.cairo_face);
@@ -95,5 +136,8 @@ TextureManager::~TextureManager() {
   for(auto i: textures_) {
     cairo_surface_destroy(i.second);
   }
+  for(auto i: scaled_textures_) {
+    cairo_surface_destroy(i.second);
+  }
 }
 } // namespace fms_displays
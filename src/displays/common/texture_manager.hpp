@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdint>
+
+#include <mutex>
 #include <optional>
 #include <string>
 #include <unordered_map>
@@ -10,6 +13,7 @@
 #include FT_FREETYPE_H
 #include <nlohmann/json.hpp>
 
+#include <util/geom.hpp>
 #include <util/pathlib.hpp>
 
 namespace fms_displays {
@@ -21,9 +25,23 @@ public:
     FT_Face ft_face;
   };
 private:
+  struct scaled_key_t {
+    std::string name;
+    std::int64_t sc_x, sc_y;
+
+    bool operator==(const scaled_key_t& other) const = default;
+  };
+
+  struct scaled_key_hash_t {
+    std::size_t operator()(const scaled_key_t& key) const noexcept;
+  };
 
   std::unordered_map<std::string, font_data_t> fonts_;
   std::unordered_map<std::string, cairo_surface_t*> textures_;
+
+  mutable std::mutex scaled_mutex_;
+  mutable std::unordered_map<scaled_key_t, cairo_surface_t*,
+    scaled_key_hash_t> scaled_textures_;
 public:
   static bool CheckMainFont(const nlohmann::json& data) noexcept;
 
@@ -48,6 +66,14 @@ public:
 
   texture_t GetTexture(const std::string& tex_name) const noexcept;
 
+  /*
+    Returns tex_name resampled by scale, so that it can be painted 1:1.
+    The copy is made on the first request and cached by (name, scale).
+    The manager keeps ownership of the returned surface.
+  */
+  texture_t GetScaledTexture(const std::string& tex_name, 
+    geom::vect2_t scale) const noexcept;
+
   ~TextureManager();
 };
 } // namespace fms_displays {
\ No newline at end of file
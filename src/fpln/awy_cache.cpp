@@ -0,0 +1,160 @@
+/*
+        This project is licensed under
+        Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+   Public License (CC BY-NC-SA 4.0).
+
+        A SUMMARY OF THIS LICENSE CAN BE FOUND HERE:
+   https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+        Author: discord/bruh4096#4512
+
+        This file contains definitions of member functions for AwyPathCache
+    class.
+*/
+
+#include "awy_cache.hpp"
+
+namespace {
+
+struct awy_cache_reg_t {
+  std::mutex mtx;
+  std::unordered_map<const libnav::AwyDB*,
+                     std::weak_ptr<fms_core::AwyPathCache>>
+      caches;
+};
+
+// Never destroyed: a cache may be released after static destructors ran
+awy_cache_reg_t& get_cache_reg() {
+  static awy_cache_reg_t* reg = new awy_cache_reg_t;
+  return *reg;
+}
+}  // namespace
+
+namespace fms_core {
+
+AwyPathCache::AwyPathCache(util::OpaquePointer<libnav::AwyDB> awy_db,
+                           std::size_t max_sz)
+    : awy_db_{awy_db}, max_sz_{max_sz} {}
+
+std::shared_ptr<AwyPathCache> AwyPathCache::GetShared(
+    util::OpaquePointer<libnav::AwyDB> awy_db) {
+  awy_cache_reg_t& reg = get_cache_reg();
+  const libnav::AwyDB* key = awy_db.get();
+
+  std::lock_guard lk(reg.mtx);
+  std::weak_ptr<AwyPathCache>& ref = reg.caches[key];
+  std::shared_ptr<AwyPathCache> out = ref.lock();
+  if (out == nullptr) {
+    // The entry goes away along with the cache. By then another cache may
+    // have been registered for the same data base, that one is kept.
+    out = std::shared_ptr<AwyPathCache>(
+        new AwyPathCache(awy_db), [key](AwyPathCache* cache) {
+          delete cache;
+          awy_cache_reg_t& reg = get_cache_reg();
+          std::lock_guard lk(reg.mtx);
+          auto it = reg.caches.find(key);
+          if (it != reg.caches.end() && it->second.expired()) {
+            reg.caches.erase(it);
+          }
+        });
+    ref = out;
+  }
+  return out;
+}
+
+bool AwyPathCache::IsInAwy(const std::string& awy, const std::string& wpt_id) {
+  std::string key = get_key(QueryType::IN_AWY, awy, wpt_id, "");
+  result_t res;
+  if (!find(key, &res)) {
+    res.n_pts = std::size_t(awy_db_->is_in_awy(awy, wpt_id));
+    insert(std::move(key), res);
+  }
+  return res.n_pts != 0;
+}
+
+std::size_t AwyPathCache::GetWwPath(const std::string& awy,
+                                    const std::string& start_id,
+                                    const std::string& end_id,
+                                    std::vector<libnav::awy_point_t>* out) {
+  std::string key = get_key(QueryType::WW_PATH, awy, start_id, end_id);
+  result_t res;
+  if (!find(key, &res)) {
+    res.n_pts =
+        std::size_t(awy_db_->get_ww_path(awy, start_id, end_id, &res.pts));
+    insert(std::move(key), res);
+  }
+  *out = std::move(res.pts);
+  return res.n_pts;
+}
+
+std::size_t AwyPathCache::GetAaPath(const std::string& awy,
+                                    const std::string& start_id,
+                                    const std::string& next_awy,
+                                    std::vector<libnav::awy_point_t>* out) {
+  std::string key = get_key(QueryType::AA_PATH, awy, start_id, next_awy);
+  result_t res;
+  if (!find(key, &res)) {
+    res.n_pts =
+        std::size_t(awy_db_->get_aa_path(awy, start_id, next_awy, &res.pts));
+    insert(std::move(key), res);
+  }
+  *out = std::move(res.pts);
+  return res.n_pts;
+}
+
+awy_cache_stats_t AwyPathCache::GetStats() {
+  std::lock_guard lk(mtx_);
+  return {n_hits_.load(std::memory_order_relaxed),
+          n_misses_.load(std::memory_order_relaxed), map_.size()};
+}
+
+void AwyPathCache::Clear() {
+  std::lock_guard lk(mtx_);
+  map_.clear();
+  lru_.clear();
+}
+
+// Private functions:
+
+std::string AwyPathCache::get_key(QueryType tp, const std::string& a,
+                                  const std::string& b, const std::string& c) {
+  // Ids never contain '\0', so the fields can't run into each other
+  std::string out;
+  out.reserve(a.size() + b.size() + c.size() + 3);
+  out.push_back(char(tp));
+  out.append(a);
+  out.push_back('\0');
+  out.append(b);
+  out.push_back('\0');
+  out.append(c);
+  return out;
+}
+
+bool AwyPathCache::find(const std::string& key, result_t* out) {
+  std::lock_guard lk(mtx_);
+  auto it = map_.find(key);
+  if (it == map_.end()) {
+    n_misses_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  n_hits_.fetch_add(1, std::memory_order_relaxed);
+  lru_.splice(lru_.begin(), lru_, it->second);
+  *out = it->second->second;
+  return true;
+}
+
+void AwyPathCache::insert(std::string key, result_t res) {
+  // The data base is queried without holding the lock, so another thread
+  // may have inserted the same key in the mean time.
+  std::lock_guard lk(mtx_);
+  if (map_.find(key) != map_.end()) {
+    return;
+  }
+  lru_.emplace_front(key, std::move(res));
+  map_.emplace(std::move(key), lru_.begin());
+  while (map_.size() > max_sz_) {
+    map_.erase(lru_.back().first);
+    lru_.pop_back();
+  }
+}
+}  // namespace fms_core
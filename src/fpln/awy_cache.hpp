@@ -0,0 +1,102 @@
+/*
+        This project is licensed under
+        Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+   Public License (CC BY-NC-SA 4.0).
+
+        A SUMMARY OF THIS LICENSE CAN BE FOUND HERE:
+   https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+        Author: discord/bruh4096#4512
+
+        This file contains declarations of the AwyPathCache class. It keeps
+    the results of airway queries made while editing the enroute part of a
+    flight plan, so that route loads and repeated edits don't walk the same
+    airways again.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <libnav/awy_db.hpp>
+#include <util/util.hpp>
+
+namespace fms_core {
+
+constexpr std::size_t N_AWY_CACHE_SZ = 4096;  // Entries kept per data base
+
+struct awy_cache_stats_t {
+  std::uint64_t n_hits, n_misses;
+  std::size_t n_entries;
+};
+
+// Safe to use from several threads. Entries that weren't used for the
+// longest time are evicted first.
+class AwyPathCache final {
+ public:
+  explicit AwyPathCache(util::OpaquePointer<libnav::AwyDB> awy_db,
+                        std::size_t max_sz = N_AWY_CACHE_SZ);
+
+  AwyPathCache(const AwyPathCache& other) = delete;
+
+  AwyPathCache& operator=(const AwyPathCache& other) = delete;
+
+  // Returns the cache shared by everyone using awy_db. It lives as long as
+  // someone holds it, so a data base that's loaded again at the same
+  // address doesn't get stale entries once the old flight plans are gone.
+  static std::shared_ptr<AwyPathCache> GetShared(
+      util::OpaquePointer<libnav::AwyDB> awy_db);
+
+  // Same as the AwyDB functions of the same name
+  bool IsInAwy(const std::string& awy, const std::string& wpt_id);
+
+  std::size_t GetWwPath(const std::string& awy, const std::string& start_id,
+                        const std::string& end_id,
+                        std::vector<libnav::awy_point_t>* out);
+
+  std::size_t GetAaPath(const std::string& awy, const std::string& start_id,
+                        const std::string& next_awy,
+                        std::vector<libnav::awy_point_t>* out);
+
+  awy_cache_stats_t GetStats();
+
+  void Clear();
+
+ private:
+  enum class QueryType : char { IN_AWY = 'I', WW_PATH = 'W', AA_PATH = 'A' };
+
+  struct result_t {
+    std::size_t n_pts = 0;  // For IN_AWY: 1 if the waypoint is on the airway
+    std::vector<libnav::awy_point_t> pts;
+  };
+
+  using lru_list_t = std::list<std::pair<std::string, result_t>>;
+
+  util::OpaquePointer<libnav::AwyDB> awy_db_;
+  std::size_t max_sz_;
+
+  std::mutex mtx_;
+  lru_list_t lru_;  // Most recently used first
+  std::unordered_map<std::string, lru_list_t::iterator> map_;
+
+  std::atomic<std::uint64_t> n_hits_{0};
+  std::atomic<std::uint64_t> n_misses_{0};
+
+  static std::string get_key(QueryType tp, const std::string& a,
+                             const std::string& b, const std::string& c);
+
+  // Copies the cached result to out. Returns false on a miss.
+  bool find(const std::string& key, result_t* out);
+
+  void insert(std::string key, result_t res);
+};
+}  // namespace fms_core
@@ -0,0 +1,363 @@
+/*
+        This project is licensed under
+        Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+   Public License (CC BY-NC-SA 4.0).
+
+        A SUMMARY OF THIS LICENSE CAN BE FOUND HERE:
+   https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+        Author: discord/bruh4096#4512
+
+        This file contains definitions of member functions for AwyGraph
+    class.
+*/
+
+#include "awy_graph.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <string_view>
+
+#include <libnav/awy_db.hpp>
+#include <libnav/common.hpp>
+#include <util/mapped_file.hpp>
+#include <util/trace.hpp>
+
+namespace {
+
+// Words of a line of the X-Plane airway file
+enum AwyWord {
+  AWY_START_ID,
+  AWY_START_REG,
+  AWY_START_TP,
+  AWY_END_ID,
+  AWY_END_REG,
+  AWY_END_TP,
+  AWY_DIR,
+  AWY_TP,
+  AWY_BASE_FL,
+  AWY_TOP_FL,
+  AWY_NAMES,
+  N_AWY_WORDS
+};
+
+constexpr char AWY_NAME_SEP = '-';
+constexpr char AWY_DIR_FWD = 'F';  // Only from start to end
+constexpr char AWY_DIR_BWD = 'B';  // Only from end to start
+
+// Length of one radian of latitude
+constexpr double NM_PER_RAD = 3437.746770784939;
+
+// Returns the number of words in line. Only the first n_max are stored.
+std::size_t split_awy_line(std::string_view line, std::string_view* out,
+                           std::size_t n_max) {
+  std::size_t n_words = 0;
+  std::size_t i = 0;
+  while (i < line.size()) {
+    while (i < line.size() &&
+           (line[i] == ' ' || line[i] == '\t' || line[i] == '\r')) {
+      i++;
+    }
+    std::size_t start = i;
+    while (i < line.size() && line[i] != ' ' && line[i] != '\t' &&
+           line[i] != '\r') {
+      i++;
+    }
+    if (i > start) {
+      if (n_words < n_max) {
+        out[n_words] = line.substr(start, i - start);
+      }
+      n_words++;
+    }
+  }
+  return n_words;
+}
+
+int parse_awy_int(std::string_view word) {
+  int out = 0;
+  if (std::from_chars(word.data(), word.data() + word.size(), out).ec !=
+      std::errc{}) {
+    return 0;
+  }
+  return out;
+}
+}  // namespace
+
+namespace fms_core {
+
+AwyGraph::AwyGraph(const pathlib::Path& awy_path,
+                   util::OpaquePointer<libnav::NavaidDB> navaid_db)
+    : offsets_(1, 0) {
+  MY_TRACE_SCOPE("AwyGraph::AwyGraph");
+  util::MappedFile file;
+  if (!file.Open(awy_path.Get())) {
+    return;
+  }
+  std::string_view data = file.GetView();
+
+  struct raw_edge_t {
+    node_idx_t from, to;
+    std::uint32_t awy_idx;
+  };
+
+  // Fixes are told apart by their airway id, i.e. id, region and type
+  std::unordered_map<std::string, node_idx_t> node_map;
+  std::unordered_map<std::string, std::uint32_t> awy_map;
+  std::vector<raw_edge_t> raw_edges;
+  std::vector<libnav::waypoint_entry_t> cand;
+
+  auto get_node = [&](std::string_view id, std::string_view reg,
+                      std::string_view tp) {
+    libnav::NavaidType nav_tp = libnav::xp_fix_type_to_libnav(
+        libnav::navaid_type_t(parse_awy_int(tp)));
+    std::string uid =
+        libnav::awy_point_t(std::string(id), nav_tp, std::string(reg))
+            .get_uid();
+    auto it = node_map.find(uid);
+    if (it != node_map.end()) {
+      return it->second;
+    }
+
+    // Segments to fixes that aren't in the data base are dropped
+    node_idx_t idx = NO_NODE;
+    cand.clear();
+    if (navaid_db->get_wpt_by_awy_str(uid, &cand)) {
+      idx = node_idx_t(node_ids_.size());
+      node_ids_.emplace_back(id);
+      node_uids_.push_back(uid);
+      node_pos_.push_back(cand[0].pos);
+    }
+    node_map.emplace(std::move(uid), idx);
+    return idx;
+  };
+
+  std::string_view words[N_AWY_WORDS];
+  std::size_t pos = 0;
+  while (pos < data.size()) {
+    std::size_t nl = data.find('\n', pos);
+    if (nl == std::string_view::npos) {
+      nl = data.size();
+    }
+    std::size_t n_words =
+        split_awy_line(data.substr(pos, nl - pos), words, N_AWY_WORDS);
+    pos = nl + 1;
+    if (n_words != N_AWY_WORDS) {
+      continue;  // Header or end of file
+    }
+
+    node_idx_t start = get_node(words[AWY_START_ID], words[AWY_START_REG],
+                                words[AWY_START_TP]);
+    node_idx_t end =
+        get_node(words[AWY_END_ID], words[AWY_END_REG], words[AWY_END_TP]);
+    if (start == NO_NODE || end == NO_NODE || start == end) {
+      continue;
+    }
+
+    // One segment may be shared by several airways
+    std::string_view names = words[AWY_NAMES];
+    while (!names.empty()) {
+      std::size_t sep = names.find(AWY_NAME_SEP);
+      std::string name{names.substr(0, sep)};
+      names.remove_prefix(sep == std::string_view::npos ? names.size()
+                                                        : sep + 1);
+      if (name == "") {
+        continue;
+      }
+      auto [it, is_new] =
+          awy_map.try_emplace(std::move(name), std::uint32_t(awy_names_.size()));
+      if (is_new) {
+        awy_names_.push_back(it->first);
+      }
+
+      char dir = words[AWY_DIR][0];
+      if (dir != AWY_DIR_BWD) {
+        raw_edges.push_back({start, end, it->second});
+      }
+      if (dir != AWY_DIR_FWD) {
+        raw_edges.push_back({end, start, it->second});
+      }
+    }
+  }
+
+  std::size_t n_nodes = node_ids_.size();
+  offsets_.assign(n_nodes + 1, 0);
+  for (const auto& i : raw_edges) {
+    offsets_[i.from + 1]++;
+  }
+  for (std::size_t i = 0; i < n_nodes; i++) {
+    offsets_[i + 1] += offsets_[i];
+  }
+  std::vector<std::uint32_t> next(offsets_.begin(), offsets_.end() - 1);
+  edges_.resize(raw_edges.size());
+  for (const auto& i : raw_edges) {
+    float dist_nm = float(node_pos_[i.from].get_gc_dist_nm(node_pos_[i.to]));
+    edges_[next[i.from]++] = {i.to, i.awy_idx, dist_nm};
+  }
+
+  nodes_by_id_.reserve(n_nodes);
+  for (std::size_t i = 0; i < n_nodes; i++) {
+    nodes_by_id_.emplace(node_ids_[i], node_idx_t(i));
+  }
+}
+
+std::size_t AwyGraph::GetNodeCount() const noexcept {
+  return node_ids_.size();
+}
+
+std::size_t AwyGraph::GetEdgeCount() const noexcept {
+  return edges_.size();
+}
+
+std::vector<AwyGraph::node_idx_t> AwyGraph::GetNodes(
+    const std::string& id) const {
+  std::vector<node_idx_t> out;
+  auto range = nodes_by_id_.equal_range(id);
+  for (auto it = range.first; it != range.second; it++) {
+    out.push_back(it->second);
+  }
+  return out;
+}
+
+const std::string& AwyGraph::GetNodeId(node_idx_t idx) const noexcept {
+  return node_ids_[idx];
+}
+
+geo::point AwyGraph::GetNodePos(node_idx_t idx) const noexcept {
+  return node_pos_[idx];
+}
+
+bool AwyGraph::FindRoute(const awy_route_end_t& from,
+                         const awy_route_end_t& to, awy_route_t* out) const {
+  MY_TRACE_SCOPE("AwyGraph::FindRoute");
+  *out = {};
+  std::vector<std::pair<node_idx_t, double>> starts = get_end_nodes(from);
+  std::vector<std::pair<node_idx_t, double>> goals = get_end_nodes(to);
+  if (starts.empty() || goals.empty()) {
+    return false;
+  }
+
+  constexpr double INF = std::numeric_limits<double>::infinity();
+  std::size_t n_nodes = node_ids_.size();
+  std::vector<double> g(n_nodes, INF);
+  // Cost of going from a node to the end of the route
+  std::vector<double> exit_cost(n_nodes, INF);
+  std::vector<node_idx_t> parent(n_nodes, NO_NODE);
+  std::vector<std::uint32_t> parent_awy(n_nodes, 0);
+  std::vector<bool> is_closed(n_nodes, false);
+
+  std::vector<geo::point> goal_pos;
+  if (to.is_arpt) {
+    goal_pos.push_back(to.pos);
+  }
+  for (const auto& i : goals) {
+    exit_cost[i.first] = std::min(exit_cost[i.first], i.second);
+    if (!to.is_arpt) {
+      goal_pos.push_back(node_pos_[i.first]);
+    }
+  }
+  // Never more than the true cost: every path to the end is at least as
+  // long as the great circle to it.
+  auto get_h = [this, &goal_pos](node_idx_t idx) {
+    double out = INF;
+    for (const auto& i : goal_pos) {
+      out = std::min(out, node_pos_[idx].get_gc_dist_nm(i));
+    }
+    return out;
+  };
+
+  using open_entry_t = std::pair<double, node_idx_t>;
+  std::priority_queue<open_entry_t, std::vector<open_entry_t>,
+                      std::greater<open_entry_t>>
+      open;
+  for (const auto& i : starts) {
+    if (i.second < g[i.first]) {
+      g[i.first] = i.second;
+      open.push({i.second + get_h(i.first), i.first});
+    }
+  }
+
+  double best_cost = INF;
+  node_idx_t best_node = NO_NODE;
+  while (!open.empty()) {
+    auto [f, curr] = open.top();
+    open.pop();
+    if (f >= best_cost) {
+      break;
+    }
+    if (is_closed[curr]) {
+      continue;
+    }
+    is_closed[curr] = true;
+    out->n_expanded++;
+
+    if (g[curr] + exit_cost[curr] < best_cost) {
+      best_cost = g[curr] + exit_cost[curr];
+      best_node = curr;
+    }
+
+    for (std::uint32_t i = offsets_[curr]; i < offsets_[curr + 1]; i++) {
+      const edge_t& e = edges_[i];
+      double n_g = g[curr] + double(e.dist_nm);
+      if (n_g < g[e.to]) {
+        g[e.to] = n_g;
+        parent[e.to] = curr;
+        parent_awy[e.to] = e.awy_idx;
+        open.push({n_g + get_h(e.to), e.to});
+      }
+    }
+  }
+
+  if (best_node == NO_NODE) {
+    return false;
+  }
+
+  std::vector<node_idx_t> path;
+  for (node_idx_t i = best_node; i != NO_NODE; i = parent[i]) {
+    path.push_back(i);
+  }
+  std::reverse(path.begin(), path.end());
+
+  out->dist_nm = best_cost;
+  out->legs.push_back({"", node_ids_[path[0]], node_uids_[path[0]]});
+  for (std::size_t i = 1; i < path.size(); i++) {
+    std::uint32_t awy = parent_awy[path[i]];
+    if (i + 1 == path.size() || parent_awy[path[i + 1]] != awy) {
+      out->legs.push_back(
+          {awy_names_[awy], node_ids_[path[i]], node_uids_[path[i]]});
+    }
+  }
+  return true;
+}
+
+// Private functions:
+
+std::vector<std::pair<AwyGraph::node_idx_t, double>> AwyGraph::get_end_nodes(
+    const awy_route_end_t& end) const {
+  std::vector<std::pair<node_idx_t, double>> out;
+  if (!end.is_arpt) {
+    auto range = nodes_by_id_.equal_range(end.id);
+    for (auto it = range.first; it != range.second; it++) {
+      out.push_back({it->second, 0});
+    }
+    return out;
+  }
+
+  for (std::size_t i = 0; i < node_pos_.size(); i++) {
+    // Cheap check first: most fixes are too far north or south
+    double d_lat_nm = std::abs(node_pos_[i].lat_rad - end.pos.lat_rad) *
+                      NM_PER_RAD;
+    if (d_lat_nm > AWY_ARPT_JOIN_NM) {
+      continue;
+    }
+    double dist_nm = end.pos.get_gc_dist_nm(node_pos_[i]);
+    if (dist_nm <= AWY_ARPT_JOIN_NM) {
+      out.push_back({node_idx_t(i), dist_nm});
+    }
+  }
+  return out;
+}
+}  // namespace fms_core
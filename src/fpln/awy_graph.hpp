@@ -0,0 +1,123 @@
+/*
+        This project is licensed under
+        Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+   Public License (CC BY-NC-SA 4.0).
+
+        A SUMMARY OF THIS LICENSE CAN BE FOUND HERE:
+   https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+        Author: discord/bruh4096#4512
+
+        This file contains declarations of the AwyGraph class. It holds the
+    airway network as a graph in compressed sparse row form and finds the
+    shortest airway routing between two fixes or airports.
+
+        The graph is built from the same X-Plane airway file as libnav's
+    AwyDB, since AwyDB doesn't give access to all of its segments. Positions
+    of the fixes are taken from NavaidDB. Once built, the graph is only read,
+    so it can be shared by any number of threads.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <libnav/geo_utils.hpp>
+#include <libnav/navaid_db.hpp>
+#include <util/pathlib.hpp>
+#include <util/util.hpp>
+
+namespace fms_core {
+
+// Airway fixes within this distance of an airport are tried as the first or
+// the last fix of a route.
+constexpr double AWY_ARPT_JOIN_NM = 60;
+
+// Where a route starts or ends. Every fix on an airway whose id matches is
+// tried, the one that gives the shortest route is used.
+struct awy_route_end_t {
+  std::string id;  // Fix id or airport icao
+  bool is_arpt = false;
+  geo::point pos;  // Only used for airports
+};
+
+struct awy_route_leg_t {
+  std::string awy;  // Empty for a direct leg
+  std::string wpt_id;
+  std::string wpt_uid;  // Id that awy_insert_str accepts
+};
+
+struct awy_route_t {
+  // Legs between fixes on the same airway are merged, so each leg ends
+  // where the route joins another airway. The first leg is always direct.
+  std::vector<awy_route_leg_t> legs;
+  double dist_nm = 0;
+  std::size_t n_expanded = 0;  // Nodes taken off the open set
+};
+
+class AwyGraph final {
+ public:
+  using node_idx_t = std::uint32_t;
+
+  // Leaves the graph empty if awy_path can't be read
+  AwyGraph(const pathlib::Path& awy_path,
+           util::OpaquePointer<libnav::NavaidDB> navaid_db);
+
+  AwyGraph(const AwyGraph& other) = delete;
+
+  AwyGraph& operator=(const AwyGraph& other) = delete;
+
+  std::size_t GetNodeCount() const noexcept;
+
+  std::size_t GetEdgeCount() const noexcept;
+
+  // Returns the nodes of the airway fixes called id
+  std::vector<node_idx_t> GetNodes(const std::string& id) const;
+
+  const std::string& GetNodeId(node_idx_t idx) const noexcept;
+
+  geo::point GetNodePos(node_idx_t idx) const noexcept;
+
+  /*
+      Function: FindRoute
+      Description:
+      A* search over the airway network. The cost of an edge is its great
+      circle length and the heuristic is the great circle distance to the
+      closest end, so the route found is the shortest one.
+      @return false if the ends aren't connected
+  */
+
+  bool FindRoute(const awy_route_end_t& from, const awy_route_end_t& to,
+                 awy_route_t* out) const;
+
+ private:
+  static constexpr node_idx_t NO_NODE = node_idx_t(-1);
+
+  struct edge_t {
+    node_idx_t to;
+    std::uint32_t awy_idx;
+    float dist_nm;
+  };
+
+  // Node i has the edges in [offsets_[i], offsets_[i + 1])
+  std::vector<std::uint32_t> offsets_;
+  std::vector<edge_t> edges_;
+
+  std::vector<std::string> node_ids_;
+  std::vector<std::string> node_uids_;
+  std::vector<geo::point> node_pos_;
+  std::unordered_multimap<std::string, node_idx_t> nodes_by_id_;
+
+  std::vector<std::string> awy_names_;
+
+  // Start nodes along with the cost of reaching them from the end itself
+  std::vector<std::pair<node_idx_t, double>> get_end_nodes(
+      const awy_route_end_t& end) const;
+};
+}  // namespace fms_core
@@ -0,0 +1,327 @@
+/*
+        This project is licensed under
+        Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+   Public License (CC BY-NC-SA 4.0).
+
+        A SUMMARY OF THIS LICENSE CAN BE FOUND HERE:
+   https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+        Author: discord/bruh4096#4512
+
+        This file contains definitions of member functions for CommandServer
+    class.
+*/
+
+#include "cmd_server.hpp"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <libnav/geo_utils.hpp>
+#include <libnav/str_utils.hpp>
+#include <nlohmann/json.hpp>
+
+namespace {
+
+constexpr std::size_t RECV_BUF_SZ = 4096;
+constexpr int LISTEN_BACKLOG = 16;
+constexpr int SELECT_TIMEOUT_MS = 30000;
+const std::string SELECT_CMD = "select";
+
+enum class ReadSts { LINE, TIMEOUT, CLOSED };
+
+// Splits the byte stream of a client into lines. Lines that are already
+// buffered are returned without a system call, so pipelined requests are
+// cheap.
+class line_reader_t {
+ public:
+  explicit line_reader_t(int fd) : fd_{fd} {}
+
+  // timeout_ms < 0 waits forever
+  ReadSts read_line(std::string* out, int timeout_ms = -1) {
+    if (pending_) {
+      *out = std::move(*pending_);
+      pending_.reset();
+      return ReadSts::LINE;
+    }
+    while (true) {
+      std::size_t nl = buf_.find('\n', pos_);
+      if (nl != std::string::npos) {
+        out->assign(buf_, pos_, nl - pos_);
+        if (!out->empty() && out->back() == '\r') {
+          out->pop_back();
+        }
+        pos_ = nl + 1;
+        if (pos_ == buf_.size()) {
+          buf_.clear();
+          pos_ = 0;
+        }
+        return ReadSts::LINE;
+      }
+      if (timeout_ms >= 0) {
+        pollfd pfd{fd_, POLLIN, 0};
+        int ret = poll(&pfd, 1, timeout_ms);
+        if (ret == 0) {
+          return ReadSts::TIMEOUT;
+        }
+        if (ret < 0 && errno != EINTR) {
+          return ReadSts::CLOSED;
+        }
+      }
+      char tmp[RECV_BUF_SZ];
+      ssize_t n = recv(fd_, tmp, sizeof(tmp), 0);
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n <= 0) {
+        return ReadSts::CLOSED;
+      }
+      if (pos_) {
+        buf_.erase(0, pos_);
+        pos_ = 0;
+      }
+      buf_.append(tmp, std::size_t(n));
+    }
+  }
+
+  bool has_line() const noexcept {
+    return pending_ || buf_.find('\n', pos_) != std::string::npos;
+  }
+
+  // The next read_line returns line
+  void unread(std::string line) { pending_ = std::move(line); }
+
+ private:
+  int fd_;
+  std::string buf_;
+  std::size_t pos_ = 0;
+  std::optional<std::string> pending_;
+};
+
+bool send_all(int fd, const std::string& data) {
+  std::size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    sent += std::size_t(n);
+  }
+  return true;
+}
+
+void add_reply(std::string* out, const nlohmann::json& js) {
+  out->append(js.dump(-1, ' ', false,
+                      nlohmann::json::error_handler_t::replace));
+  out->push_back('\n');
+}
+}  // namespace
+
+namespace fms_commands {
+
+CommandServer::CommandServer(command_res_t cmd_resources,
+                             std::string socket_path)
+    : cmd_resources_{cmd_resources}, socket_path_{std::move(socket_path)} {}
+
+bool CommandServer::Start() {
+  if (is_running_) {
+    return true;
+  }
+  sockaddr_un addr = {};
+  addr.sun_family = AF_UNIX;
+  if (socket_path_.size() >= sizeof(addr.sun_path)) {
+    return false;
+  }
+  std::memcpy(addr.sun_path, socket_path_.c_str(), socket_path_.size() + 1);
+
+  listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (listen_fd_ < 0) {
+    return false;
+  }
+  // A socket file left behind by a previous run would make bind fail
+  unlink(socket_path_.c_str());
+  if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+      chmod(socket_path_.c_str(), S_IRUSR | S_IWUSR) != 0 ||
+      listen(listen_fd_, LISTEN_BACKLOG) != 0) {
+    close(listen_fd_);
+    listen_fd_ = -1;
+    return false;
+  }
+
+  is_running_ = true;
+  accept_thr_ = std::thread(&CommandServer::accept_main, this);
+  return true;
+}
+
+void CommandServer::Stop() {
+  if (!is_running_) {
+    return;
+  }
+  is_running_ = false;
+  shutdown(listen_fd_, SHUT_RDWR);
+  accept_thr_.join();
+  close(listen_fd_);
+  listen_fd_ = -1;
+  unlink(socket_path_.c_str());
+
+  {
+    std::lock_guard lk(clients_mtx_);
+    for (auto& i : clients_) {
+      shutdown(i->fd, SHUT_RDWR);
+    }
+  }
+  reap_clients(true);
+}
+
+CommandServer::~CommandServer() {
+  Stop();
+}
+
+// Private member functions:
+
+void CommandServer::accept_main() {
+  while (is_running_) {
+    int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      return;
+    }
+    reap_clients(false);
+
+    auto cl = std::make_unique<client_t>();
+    cl->fd = fd;
+    client_t* cl_ptr = cl.get();
+    std::lock_guard lk(clients_mtx_);
+    clients_.push_back(std::move(cl));
+    cl_ptr->thr = std::thread(&CommandServer::client_main, this, cl_ptr);
+  }
+}
+
+void CommandServer::reap_clients(bool all) {
+  std::vector<std::unique_ptr<client_t>> done;
+  {
+    std::lock_guard lk(clients_mtx_);
+    for (std::size_t i = 0; i < clients_.size();) {
+      if (all || clients_[i]->is_done) {
+        done.push_back(std::move(clients_[i]));
+        clients_[i] = std::move(clients_.back());
+        clients_.pop_back();
+      } else {
+        i++;
+      }
+    }
+  }
+  for (auto& i : done) {
+    i->thr.join();
+    close(i->fd);
+  }
+}
+
+void CommandServer::client_main(client_t* cl) {
+  line_reader_t reader{cl->fd};
+  std::string replies;
+  std::string curr_id;
+  std::unique_lock cmd_lk(cmd_mtx_, std::defer_lock);
+
+  // Asks the client to pick a waypoint of the request that is being run
+  wpt_select_t select_wpt = [&](const std::string& name,
+    const std::vector<libnav::waypoint_entry_t>& wpts)
+    -> std::optional<std::size_t> {
+    nlohmann::json options = nlohmann::json::array();
+    for (std::size_t i = 0; i < wpts.size(); i++) {
+      options.push_back({{"n", i + 1},
+                         {"lat_deg", wpts[i].pos.lat_rad * geo::RAD_TO_DEG},
+                         {"lon_deg", wpts[i].pos.lon_rad * geo::RAD_TO_DEG}});
+    }
+    add_reply(&replies, {{"id", curr_id},
+                         {"select", {{"name", name}, {"options", options}}}});
+
+    // Commands of other clients may run while this one waits for the
+    // answer, so a slow client doesn't hold everyone up.
+    cmd_lk.unlock();
+    bool is_sent = send_all(cl->fd, replies);
+    replies.clear();
+    std::string line;
+    ReadSts sts = ReadSts::CLOSED;
+    if (is_sent) {
+      sts = reader.read_line(&line, SELECT_TIMEOUT_MS);
+    }
+    cmd_lk.lock();
+    if (sts != ReadSts::LINE) {
+      return std::nullopt;
+    }
+    std::vector<std::string> split = strutils::str_split(line, ' ');
+    if (split.size() == 3 && split[0] == curr_id && split[1] == SELECT_CMD) {
+      std::size_t n = std::size_t(strutils::stoi_with_strip(split[2]));
+      if (n != 0 && n <= wpts.size()) {
+        return n - 1;
+      }
+      return std::nullopt;
+    }
+    reader.unread(std::move(line));
+    return std::nullopt;
+  };
+
+  command_res_t cmd_resources = cmd_resources_;
+  cmd_resources.select_wpt = &select_wpt;
+  std::ostringstream out;
+  cmd_resources.out = &out;
+
+  std::string line;
+  while (reader.read_line(&line) == ReadSts::LINE) {
+    std::string in_proc = strutils::strip(line, ' ');
+    if (in_proc.empty()) {
+      continue;
+    }
+    std::vector<std::string> line_split = strutils::str_split(in_proc, ' ');
+    curr_id = line_split[0];
+    if (line_split.size() < 2) {
+      add_reply(&replies,
+                {{"id", curr_id}, {"ok", false}, {"error", "Empty command"}});
+    } else {
+      std::vector<std::string> args =
+          std::vector<std::string>(line_split.begin() + 2, line_split.end());
+      out.str("");
+      cmd_lk.lock();
+      bool is_valid = invoke(line_split[1], cmd_resources, args);
+      cmd_lk.unlock();
+      if (is_valid) {
+        add_reply(&replies,
+                  {{"id", curr_id}, {"ok", true}, {"output", out.str()}});
+      } else {
+        add_reply(&replies, {{"id", curr_id}, {"ok", false},
+                             {"error", "Invalid command name"}});
+      }
+    }
+
+    // Replies to pipelined requests are sent together
+    if (!reader.has_line()) {
+      if (!send_all(cl->fd, replies)) {
+        break;
+      }
+      replies.clear();
+    }
+  }
+  cl->is_done = true;
+}
+}  // namespace fms_commands
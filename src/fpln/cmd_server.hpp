@@ -0,0 +1,89 @@
+/*
+        This project is licensed under
+        Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+   Public License (CC BY-NC-SA 4.0).
+
+        A SUMMARY OF THIS LICENSE CAN BE FOUND HERE:
+   https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+        Author: discord/bruh4096#4512
+
+        This file contains declarations of the command server. The server
+    listens on a unix domain socket and runs command lines of any number of
+    clients through fms_commands::invoke.
+
+    Protocol: every request is one line, "<id> <command> <args...>", where id
+    is any token without spaces chosen by the client. Requests may be
+    pipelined. Every reply is one line of JSON carrying the same id:
+      {"id":"7","ok":true,"output":"..."}
+      {"id":"7","ok":false,"error":"..."}
+    If a command needs to pick one of several waypoints with the same name,
+    the server sends
+      {"id":"7","select":{"name":"ABC","options":[{"n":1,"lat_deg":..,
+        "lon_deg":..},...]}}
+    and waits for "7 select <n>". Any other line cancels the selection and is
+    then handled as a normal request. Commands of other clients keep running
+    while the server waits.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fpl_cmds.hpp"
+
+namespace fms_commands {
+
+class CommandServer final {
+ public:
+  // cmd_resources is used for every command, out and select_wpt are set
+  // for each client.
+  CommandServer(command_res_t cmd_resources, std::string socket_path);
+
+  CommandServer(const CommandServer& other) = delete;
+
+  CommandServer& operator=(const CommandServer& other) = delete;
+
+  // Binds the socket and starts accepting clients on a thread of its own.
+  // Returns false if the socket couldn't be set up.
+  bool Start();
+
+  // Disconnects every client and joins all threads
+  void Stop();
+
+  ~CommandServer();
+
+ private:
+  struct client_t {
+    int fd;
+    std::thread thr;
+    std::atomic<bool> is_done{false};
+  };
+
+  command_res_t cmd_resources_;
+  std::string socket_path_;
+  int listen_fd_ = -1;
+  std::atomic<bool> is_running_{false};
+  std::thread accept_thr_;
+
+  std::mutex clients_mtx_;
+  std::vector<std::unique_ptr<client_t>> clients_;
+
+  // Commands keep some of their settings in globals, so they run one at a
+  // time. A command that waits for a client to pick a waypoint lets go of
+  // it until the answer arrives.
+  std::mutex cmd_mtx_;
+
+  void accept_main();
+
+  // Joins and closes clients that have disconnected
+  void reap_clients(bool all);
+
+  void client_main(client_t* cl);
+};
+}  // namespace fms_commands
@@ -84,7 +84,7 @@ namespace fms_environment {
 
 bool EnvDataRefMap::SetFromString(const str_type& key,
                                   const std::string& val) noexcept {
-  std::unique_lock cr_lock(mtx_);
+  MY_LOCK_EXCL(mtx_);
   auto it = values_.find(key);
   if (it == values_.end()) {
     return false;
@@ -102,7 +102,7 @@ bool EnvDataRefMap::SetFromString(const str_type& key,
 
 std::optional<std::string> EnvDataRefMap::GetString(
     const str_type& key) noexcept {
-  std::shared_lock cr_lock(mtx_);
+  MY_LOCK_SHARED(mtx_);
   auto it = values_.find(key);
   if (it == values_.end()) {
     return std::nullopt;
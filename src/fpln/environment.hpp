@@ -18,6 +18,7 @@ const char AC_SLIP_DEG_VAR[] = "ac_slip_deg";
 const char AC_MAGVAR_DEG_VAR[] = "ac_magvar_deg";
 const char AC_GS_KTS_VAR[] = "ac_gs_kts";
 const char AC_TAS_KTS_VAR[] = "ac_tas_kts";
+const char AC_STATE_TIME_S_VAR[] = "ac_state_time_s";
 const char ND_IS_TRACK_UP_VAR[] = "nd_is_track_up";
 const char ND_HDG_IS_TRUE_VAR[] = "nd_hdg_is_true";
 const char ND_EFIS_AIRPORT_ON_VAR[] = "nd_efis_airport_on";
@@ -27,6 +28,7 @@ const char AUTOPILOT_HDG_SEL_DEG_VAR[] = "ap_hdg_sel_deg";
 const char AUTOPILOT_HDG_IS_TRACK_VAR[] = "ap_hdg_is_track";
 const char ND_MODE_VAR[] = "nd_mode";
 const char ND_RANGE_IDX_VAR[] = "nd_range_idx";
+const char ND_ROT_QUANTUM_DEG_VAR[] = "nd_rot_quantum_deg";
 const char FPL_SEL_VAR[] = "fpl_sel";
 
 constexpr double AC_LAT_DEF = 45.588670483;
@@ -36,6 +38,8 @@ constexpr double AC_SLIP_DEF = 0;
 constexpr double AC_MAGVAR_DEF = 0;
 constexpr double AC_GS_KTS_DEF = 0;
 constexpr double AC_TAS_KTS_DEF = 0;
+constexpr double AC_STATE_TIME_S_DEF = 0;
+constexpr double ND_ROT_QUANTUM_DEG_DEF = 0.25;
 
 using val_ref_t = std::string;
 using env_base_t = fms_environment::EnvVarMap<val_ref_t, 
@@ -63,6 +67,7 @@ const fms_environment::reference_desc_t kBaseVariables[] = {
      {AC_MAGVAR_DEG_VAR, AC_MAGVAR_DEF},
      {AC_GS_KTS_VAR, AC_GS_KTS_DEF},
      {AC_TAS_KTS_VAR, AC_TAS_KTS_DEF},
+     {AC_STATE_TIME_S_VAR, AC_STATE_TIME_S_DEF},
      {AUTOPILOT_HDG_SEL_DEG_VAR, std::int64_t{340}},
      {AUTOPILOT_HDG_IS_TRACK_VAR, false},
      {ND_IS_TRACK_UP_VAR, true},
@@ -77,6 +82,7 @@ const fms_environment::reference_desc_t kBaseVariables[] = {
      {std::string{ND_MODE_VAR} + "_1", std::int64_t{2}},
      {std::string{ND_RANGE_IDX_VAR} + "_0", std::int64_t{0}},
      {std::string{ND_RANGE_IDX_VAR} + "_1", std::int64_t{0}},
+     {ND_ROT_QUANTUM_DEG_VAR, ND_ROT_QUANTUM_DEG_DEF},
      {FPL_SEL_VAR, std::int64_t{1}}
 };
 } // fms_environment
@@ -20,8 +20,11 @@
 #include <cstddef>
 #include <cstdint>
 
+#include <algorithm>
+#include <charconv>
 #include <memory>
 #include <set>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -31,12 +34,16 @@
 #include <libnav/navaid_db.hpp>
 #include <libnav/str_utils.hpp>
 #include <util/geom.hpp>
+#include <util/io_worker.hpp>
+#include <util/mapped_file.hpp>
+#include <util/trace.hpp>
+
+#include "fpl_bin.hpp"
 
 namespace {
 
 constexpr std::size_t N_PROC_DB_SZ = 5;
 constexpr std::size_t N_ARR_DB_OFFSET = 2;
-constexpr std::size_t N_DFMS_ENRT_WORDS = 6;
 constexpr double DEFAULT_VS_FPM = 2000;
 constexpr double DEFAULT_GS_KTS = 250;
 constexpr double CLB_RATE_FT_PER_NM = 500;
@@ -64,8 +71,9 @@ const std::string DFMS_STAR_TRANS_NM = "STARTRANS";
 const std::string DFMS_N_ENRT_NM = "NUMENR";
 
 const std::string DFMS_DIR_SEG_NM = "DRCT";
+// Caps the allocation made for the entry count given in a file
+constexpr int N_DFMS_ENRT_RESERVE_MAX = 1024;
 
-const std::string DFMS_FILE_POSTFIX = ".fms";
 
 const std::set<std::string> NOT_FOLLOWED_BY_DF = {"AF", "CI", "PI", "RF", "VI"};
 const std::set<std::string> AFTER_INTC = {"AF", "CF", "FA", "FC",
@@ -105,7 +113,12 @@ double get_cf_big_turn_isect(fms_core::leg_seg_t curr, fms_core::leg_t next, dou
 
 std::string get_appr_rwy(std::string& appr);
 
-std::string get_dfms_rwy(std::string& rwy_nm);
+std::string get_dfms_rwy(std::string_view rwy_nm);
+
+void split_dfms_line(std::string_view line, fms_core::dfms_line_t* out);
+
+template <typename T>
+T parse_dfms_num(std::string_view word);
 
 geo::point get_xa_end_point(geo::point prev, float brng_deg, float va_alt_ft,
                             double clb_ft_nm = CLB_RATE_FT_PER_NM);
@@ -223,15 +236,46 @@ std::string get_appr_rwy(std::string& appr) {
   return strutils::normalize_rnw_id(rw);
 }
 
-std::string get_dfms_rwy(std::string& rwy_nm) {
-  if (rwy_nm[0] == 'R' && rwy_nm[1] == 'W') {
-    std::string ret = rwy_nm.substr(2, rwy_nm.size() - 2);
-
-    return ret;
+std::string get_dfms_rwy(std::string_view rwy_nm) {
+  if (rwy_nm.size() >= 2 && rwy_nm[0] == 'R' && rwy_nm[1] == 'W') {
+    return std::string(rwy_nm.substr(2));
   }
   return "";
 }
 
+void split_dfms_line(std::string_view line, fms_core::dfms_line_t* out) {
+  out->n_words = 0;
+  std::size_t i = 0;
+  while (i < line.size()) {
+    while (i < line.size() &&
+           (line[i] == ' ' || line[i] == '\t' || line[i] == '\r')) {
+      i++;
+    }
+    std::size_t start = i;
+    while (i < line.size() && line[i] != ' ' && line[i] != '\t' &&
+           line[i] != '\r') {
+      i++;
+    }
+    if (i > start) {
+      if (out->n_words < fms_core::N_DFMS_ENRT_WORDS) {
+        out->words[out->n_words] = line.substr(start, i - start);
+      }
+      out->n_words++;
+    }
+  }
+}
+
+// Returns 0 if word isn't a number, same as strutils::stof_with_strip
+template <typename T>
+T parse_dfms_num(std::string_view word) {
+  T out = 0;
+  if (std::from_chars(word.data(), word.data() + word.size(), out).ec !=
+      std::errc{}) {
+    return 0;
+  }
+  return out;
+}
+
 geo::point get_xa_end_point(geo::point prev, float brng_deg, float va_alt_ft,
                             double clb_ft_nm) {
   double clb_nm = va_alt_ft / clb_ft_nm;
@@ -297,13 +341,76 @@ double get_rnp(fms_core::leg_list_node_t* leg) {
 } // namespace
 
 namespace fms_core {
+
+const char* GetStrOf(DfmsErr err) {
+  switch (err)
+  {
+  case DfmsErr::FILE:
+    return "FILE NOT FOUND";
+  case DfmsErr::AIRAC:
+    return "AIRAC MISMATCH";
+  case DfmsErr::DEP:
+    return "DEPARTURE";
+  case DfmsErr::DEP_RWY:
+    return "DEP RWY";
+  case DfmsErr::SID:
+    return "SID";
+  case DfmsErr::SID_TRANS:
+    return "SID TRANS";
+  case DfmsErr::ARR:
+    return "ARRIVAL";
+  case DfmsErr::ARR_RWY:
+    return "ARR RWY";
+  case DfmsErr::STAR:
+    return "STAR";
+  case DfmsErr::STAR_TRANS:
+    return "STAR TRANS";
+  case DfmsErr::WPT:
+    return "WAYPOINT";
+  default:
+    return "";
+  }
+}
+
+bool read_dfms_summary(std::string_view data, dfms_summary_t* out) {
+  *out = {};
+  bool read_enrt = false;
+  dfms_line_t line;
+  std::size_t pos = 0;
+  while (pos < data.size()) {
+    std::size_t nl = data.find('\n', pos);
+    if (nl == std::string_view::npos) {
+      nl = data.size();
+    }
+    split_dfms_line(data.substr(pos, nl - pos), &line);
+    pos = nl + 1;
+
+    if (!read_enrt && line.n_words > 1) {
+      if (line.words[0] == DFMS_N_ENRT_NM) {
+        read_enrt = true;
+      } else if (line.words[0] == DFMS_AIRAC_CYCLE_NM) {
+        out->airac_cycle = parse_dfms_num<int>(line.words[1]);
+      } else if (line.words[0] == DFMS_DEP_NM) {
+        out->dep_icao = std::string(line.words[1]);
+      } else if (line.words[0] == DFMS_ARR_NM) {
+        out->arr_icao = std::string(line.words[1]);
+      }
+    } else if (read_enrt && line.n_words == N_DFMS_ENRT_WORDS &&
+               line.words[2] != DFMS_DEP_NM && line.words[2] != DFMS_ARR_NM) {
+      out->n_wpts++;
+    }
+  }
+  return out->dep_icao != "" && out->arr_icao != "";
+}
+
 // FplnInt member functions:
 // Public functions:
 
 FplnInt::FplnInt(util::OpaquePointer<libnav::ArptDB> apt_db,
                  util::OpaquePointer<libnav::NavaidDB> nav_db,
                  util::OpaquePointer<libnav::AwyDB> aw_db, pathlib::Path cifp_path)
-    : FlightPlanBase(apt_db, nav_db, cifp_path), awy_db_{aw_db}, navaid_db_{nav_db} {
+    : FlightPlanBase(apt_db, nav_db, cifp_path), awy_db_{aw_db}, navaid_db_{nav_db},
+      awy_cache_{AwyPathCache::GetShared(aw_db)} {
   proc_db_.resize(N_PROC_DB_SZ);
 
   fpl_id_calc_ = 0;
@@ -375,19 +482,33 @@ libnav::DbErr FplnInt::load_from_fms(const std::string& file_nm, bool set_arpts)
   if (out != libnav::DbErr::SUCCESS) {
     reset_fpln();
   } else {
-    co_rte_nm_ = departure_->get_icao() + arrival_->get_icao();
+    // Company routes are named after their file, which isn't always the
+    // city pair
+    co_rte_nm_ = file_nm.substr(file_nm.find_last_of("/\\") + 1);
   }
   return out;
 }
 
-void FplnInt::save_to_fms(const std::string& file_nm, bool save_sid_star) const {
+dfms_err_t FplnInt::get_dfms_err() const noexcept {
+  return dfms_err_;
+}
+
+bool FplnInt::save_to_fms(const std::string& file_nm, bool save_sid_star) const {
+  std::string data = get_fms_str(save_sid_star);
+  if (data == "") {
+    return false;
+  }
+  return util::WriteFileAtomic(file_nm + DFMS_FILE_POSTFIX, data);
+}
+
+std::string FplnInt::get_fms_str(bool save_sid_star) const {
   if (!is_apt_valid(departure_) || !is_apt_valid(arrival_)) {
-    return;
+    return "";
   }
 
   co_rte_nm_ = departure_->get_icao() + arrival_->get_icao();
 
-  std::ofstream out(file_nm + DFMS_FILE_POSTFIX, std::ofstream::out);
+  std::ostringstream out;
 
   out << DFMS_PADDING;
   std::string curr_cycle = std::to_string(navaid_db_->get_wpt_cycle());
@@ -451,13 +572,191 @@ void FplnInt::save_to_fms(const std::string& file_nm, bool save_sid_star) const
     out << vec[i] << "\n";
   }
 
-  out.close();
+  return out.str();
 }
 
 std::string FplnInt::get_co_rte_nm() const noexcept {
   return co_rte_nm_;
 }
 
+bool FplnInt::save_to_bin(const std::string& file_nm) const {
+  MY_TRACE_SCOPE("FplnInt::save_to_bin");
+  if (!is_apt_valid(departure_) || !is_apt_valid(arrival_)) {
+    return false;
+  }
+
+  // Index 0 is the head of the segment list
+  std::vector<const seg_list_node_t*> segs = {&seg_list_.head};
+  segs.reserve(N_FPL_SEG_CACHE_SZ + 1);
+  for (const seg_list_node_t* seg = seg_list_.head.next;
+       seg != &seg_list_.tail; seg = seg->next) {
+    if (seg->data.end != nullptr) {
+      segs.push_back(seg);
+    }
+  }
+
+  FplBinWriter wr;
+  wr.Reset();
+  wr.PutStr(departure_->get_icao());
+  wr.PutStr(arrival_->get_icao());
+  wr.PutStr(arr_rwy_);
+  wr.Put(std::uint8_t(appr_is_rwy_));
+
+  // Refs are stored as indices into segs, -1 if a ref doesn't have a segment
+  for (std::size_t i = 1; i < fpl_refs_.size(); i++) {
+    auto it = std::find(segs.begin(), segs.end(), fpl_refs_[i].ptr);
+    std::int32_t seg_idx = -1;
+    if (fpl_refs_[i].ptr != nullptr && it != segs.end()) {
+      seg_idx = std::int32_t(it - segs.begin());
+    }
+    wr.PutStr(fpl_refs_[i].name);
+    wr.Put(seg_idx);
+  }
+
+  // Segments without an end have no legs, so the legs of segs[i] start
+  // right after the end of segs[i - 1].
+  std::size_t n_legs = 0;
+  for (std::size_t i = 1; i < segs.size(); i++) {
+    std::size_t n_seg_legs = 0;
+    for (const leg_list_node_t* leg = segs[i - 1]->data.end->next;
+         leg != segs[i]->data.end->next; leg = leg->next) {
+      n_seg_legs++;
+    }
+    wr.PutSeg(segs[i]->data, n_seg_legs);
+    n_legs += n_seg_legs;
+  }
+  for (const leg_list_node_t* leg = leg_list_.head.next;
+       leg != &leg_list_.tail; leg = leg->next) {
+    wr.PutLegData(leg->data);
+  }
+
+  wr.SetHdr({FPL_BIN_MAGIC, FPL_BIN_VERSION, 0, fix_airac_version_,
+             std::uint32_t(segs.size() - 1), std::uint32_t(n_legs), 0});
+
+  return util::WriteFileAtomic(file_nm + FPL_BIN_FILE_POSTFIX, wr.GetData());
+}
+
+libnav::DbErr FplnInt::load_from_bin(const std::string& file_nm) {
+  MY_TRACE_SCOPE("FplnInt::load_from_bin");
+  dfms_err_ = {};
+  util::MappedFile file;
+  if (!file.Open(file_nm + FPL_BIN_FILE_POSTFIX)) {
+    dfms_err_.tp = DfmsErr::FILE;
+    return libnav::DbErr::FILE_NOT_FOUND;
+  }
+
+  // The whole file is read before the flight plan is touched, so a broken
+  // file leaves it as it was.
+  FplBinReader rd(file.GetView(), navaid_db_);
+  fpl_bin_hdr_t hdr;
+  if (!rd.GetHdr(&hdr) || hdr.n_segs > N_FPL_SEG_CACHE_SZ ||
+      hdr.n_legs > N_FPL_LEG_CACHE_SZ) {
+    dfms_err_.tp = DfmsErr::FILE;
+    return libnav::DbErr::DATA_BASE_ERROR;
+  }
+  if (airac_mismatch_ || hdr.airac_cycle != fix_airac_version_) {
+    dfms_err_ = {DfmsErr::AIRAC, std::to_string(hdr.airac_cycle)};
+    return libnav::DbErr::DATA_BASE_ERROR;
+  }
+
+  std::string dep_icao, arr_icao, arr_rwy;
+  std::uint8_t appr_is_rwy;
+  bool ok = rd.GetStr(&dep_icao) && rd.GetStr(&arr_icao) &&
+            rd.GetStr(&arr_rwy) && rd.Get(&appr_is_rwy);
+
+  std::vector<fpl_ref_t> refs(N_FPL_REF_SZ, EmptyRef);
+  std::vector<std::int32_t> ref_segs(N_FPL_REF_SZ, -1);
+  for (std::size_t i = 1; ok && i < N_FPL_REF_SZ; i++) {
+    ok = rd.GetStr(&refs[i].name) && rd.Get(&ref_segs[i]) &&
+         ref_segs[i] >= -1 && ref_segs[i] <= std::int32_t(hdr.n_segs);
+  }
+
+  std::vector<fpl_bin_seg_t> segs(ok ? hdr.n_segs : 0);
+  std::size_t n_legs = 0;
+  for (std::size_t i = 0; ok && i < segs.size(); i++) {
+    ok = rd.GetSeg(&segs[i]);
+    n_legs += segs[i].n_legs;
+  }
+  ok = ok && n_legs == hdr.n_legs;
+
+  std::vector<leg_list_data_t> legs(ok ? n_legs : 0);
+  for (std::size_t i = 0; ok && i < legs.size(); i++) {
+    ok = rd.GetLegData(&legs[i]);
+  }
+  // There's nothing to continue after the last discontinuity
+  if (!ok || legs.empty() || legs.back().is_discon) {
+    dfms_err_.tp = DfmsErr::FILE;
+    return libnav::DbErr::DATA_BASE_ERROR;
+  }
+
+  // Airports that are already loaded are kept, so their procedures aren't
+  // parsed again.
+  if (departure_ == nullptr || departure_->get_icao() != dep_icao) {
+    libnav::DbErr err = set_dep(dep_icao);
+    if (err != libnav::DbErr::SUCCESS && err != libnav::DbErr::PARTIAL_LOAD) {
+      dfms_err_ = {DfmsErr::DEP, dep_icao};
+      reset_fpln();
+      return err;
+    }
+  }
+  if (arrival_ == nullptr || arrival_->get_icao() != arr_icao) {
+    libnav::DbErr err = set_arr(arr_icao);
+    if (err != libnav::DbErr::SUCCESS && err != libnav::DbErr::PARTIAL_LOAD) {
+      dfms_err_ = {DfmsErr::ARR, arr_icao};
+      reset_fpln();
+      return err;
+    }
+  }
+  reset_fpln();
+
+  // Segments are inserted back to front, so that a discontinuity always
+  // has a leg after it.
+  std::vector<seg_list_node_t*> seg_nodes(segs.size() + 1);
+  seg_nodes[0] = &seg_list_.head;
+  seg_list_node_t* next = &seg_list_.tail;
+  std::size_t leg_end = legs.size();
+  for (std::size_t i = segs.size(); i-- > 0;) {
+    std::size_t leg_start = leg_end - segs[i].n_legs;
+    next = insert_segment(segs[i].data, legs.data() + leg_start,
+                          segs[i].n_legs, next);
+    if (next == nullptr) {
+      dfms_err_.tp = DfmsErr::FILE;
+      reset_fpln();
+      return libnav::DbErr::DATA_BASE_ERROR;
+    }
+    seg_nodes[i + 1] = next;
+    leg_end = leg_start;
+  }
+
+  for (std::size_t i = 1; i < N_FPL_REF_SZ; i++) {
+    fpl_refs_[i].name = refs[i].name;
+    fpl_refs_[i].ptr = ref_segs[i] < 0 ? nullptr : seg_nodes[ref_segs[i]];
+  }
+
+  const std::string& dep_rwy = get_cref_for(FplSegment::DEP_RWY).name;
+  has_dep_rnw_data_ =
+      dep_rwy != "" &&
+      arpt_db_ptr_->get_rnw_data(dep_icao, dep_rwy, &dep_rnw_data_);
+  if (!has_dep_rnw_data_) {
+    dep_rnw_data_ = {};
+  }
+  arr_rwy_ = arr_rwy;
+  appr_is_rwy_ = appr_is_rwy;
+  has_arr_rnw_data_ =
+      arr_rwy_ != "" &&
+      arpt_db_ptr_->get_rnw_data(arr_icao, arr_rwy_, &arr_rnw_data_);
+  if (!has_arr_rnw_data_) {
+    arr_rnw_data_ = {};
+  }
+  co_rte_nm_ = dep_icao + arr_icao;
+
+  // Leg geometry came from the file, so update doesn't need to redo it
+  update_id();
+  fpl_id_calc_ = fpl_id_curr_;
+
+  return libnav::DbErr::SUCCESS;
+}
+
 libnav::DbErr FplnInt::set_dep(std::string icao) {
   libnav::DbErr out = set_arpt(icao, &departure_, false, departure_legs_);
   if (departure_ != nullptr && departure_->get_icao() == icao &&
@@ -781,7 +1080,7 @@ bool FplnInt::add_enrt_seg(timed_ptr_t<seg_list_node_t> next,
           libnav::waypoint_t end_fix = end_leg->data.leg.main_fix;
           if (end_fix.data.area_code == "ENRT") {
             std::string end_leg_awy_id = end_fix.get_awy_id();
-            add_seg = awy_db_->is_in_awy(name, end_leg_awy_id);
+            add_seg = awy_cache_->IsInAwy(name, end_leg_awy_id);
           }
         } else if (prev->prev->data.seg_type > FplSegment::DEP_RWY) {
           leg_list_node_t* base_end_leg = prev->prev->data.end;
@@ -789,8 +1088,8 @@ bool FplnInt::add_enrt_seg(timed_ptr_t<seg_list_node_t> next,
             std::string base_awy_id =
                 base_end_leg->data.leg.main_fix.get_awy_id();
             std::vector<libnav::awy_point_t> awy_pts;
-            std::size_t n_pts = awy_db_->get_aa_path(prev->data.name, base_awy_id,
-                                               name, &awy_pts);
+            std::size_t n_pts = awy_cache_->GetAaPath(
+                prev->data.name, base_awy_id, name, &awy_pts);
 
             if (n_pts) {
               delete_segment(prev);
@@ -826,15 +1125,15 @@ bool FplnInt::add_enrt_seg(timed_ptr_t<seg_list_node_t> next,
         std::string end_leg_awy_id = end_fix.get_awy_id();
 
         if (end_fix.data.area_code == "ENRT" &&
-            awy_db_->is_in_awy(name, end_leg_awy_id)) {
+            awy_cache_->IsInAwy(name, end_leg_awy_id)) {
           if (prev_end_leg != nullptr && !(prev->data.is_discon)) {
             libnav::waypoint_t prev_end_fix = prev_end_leg->data.leg.main_fix;
             std::string prev_end_leg_awy_id = prev_end_fix.get_awy_id();
 
-            if (awy_db_->is_in_awy(name, prev_end_leg_awy_id)) {
+            if (awy_cache_->IsInAwy(name, prev_end_leg_awy_id)) {
               std::vector<libnav::awy_point_t> awy_pts;
-              std::size_t n_pts = awy_db_->get_ww_path(name, end_leg_awy_id,
-                                                 prev_end_leg_awy_id, &awy_pts);
+              std::size_t n_pts = awy_cache_->GetWwPath(
+                  name, end_leg_awy_id, prev_end_leg_awy_id, &awy_pts);
 
               if (n_pts) {
                 delete_segment(prev);
@@ -904,15 +1203,15 @@ bool FplnInt::awy_insert(timed_ptr_t<seg_list_node_t> next,
         std::string end_id = end.get_awy_id();
 
         bool in_awy = end.data.area_code == "ENRT" &&
-                      awy_db_->is_in_awy(prev_name, end_id);
+                      awy_cache_->IsInAwy(prev_name, end_id);
         if (prev_full->data.end != nullptr && in_awy) {
           leg_list_node_t* prev_leg = prev_full->data.end;
           libnav::waypoint_t start_fix = prev_leg->data.leg.main_fix;
           std::string start_id = start_fix.get_awy_id();
 
           std::vector<libnav::awy_point_t> awy_pts;
-          std::size_t n_pts = std::size_t(
-              awy_db_->get_ww_path(prev_name, start_id, end_id, &awy_pts));
+          std::size_t n_pts =
+              awy_cache_->GetWwPath(prev_name, start_id, end_id, &awy_pts);
 
           if (n_pts) {
             delete_segment(prev, true, true);
@@ -936,6 +1235,45 @@ bool FplnInt::awy_insert(timed_ptr_t<seg_list_node_t> next,
   return false;
 }
 
+awy_route_ins_t FplnInt::add_awy_route(const awy_route_t& route) {
+  awy_route_ins_t out;
+  if (route.legs.empty()) {
+    out.err = AwyRouteErr::EMPTY;
+    return out;
+  }
+  // add_enrt_seg only joins airways after enroute segments, so anything
+  // appended after a STAR or an approach would end up as directs.
+  for (const seg_list_node_t* seg = seg_list_.head.next;
+       seg != &(seg_list_.tail); seg = seg->next) {
+    if (seg->data.seg_type > FplSegment::ENRT) {
+      out.err = AwyRouteErr::HAS_ARR;
+      return out;
+    }
+  }
+
+  // Same steps as for the enroute part of a .fms file
+  for (std::size_t i = 0; i < route.legs.size(); i++) {
+    const awy_route_leg_t& leg = route.legs[i];
+    bool is_added = false;
+    if (i != 0 && leg.awy != "" &&
+        add_enrt_seg({nullptr, seg_list_.id}, leg.awy)) {
+      is_added =
+          awy_insert_str({&(seg_list_.tail), seg_list_.id}, leg.wpt_uid);
+    } else {
+      if (i != 0) {
+        out.dct_legs.push_back(i);
+      }
+      is_added = awy_insert_str({nullptr, seg_list_.id}, leg.wpt_uid);
+    }
+    if (!is_added) {
+      out.err = AwyRouteErr::INSERT;
+      return out;
+    }
+    out.n_legs_added++;
+  }
+  return out;
+}
+
 bool FplnInt::delete_via(timed_ptr_t<seg_list_node_t> curr) {
   if (curr.id == seg_list_.id && curr.ptr != &(seg_list_.head) &&
       curr.ptr != nullptr && curr.ptr->prev != &(seg_list_.head)) {
@@ -1015,6 +1353,7 @@ void FplnInt::set_alt_cstr(timed_ptr_t<leg_list_node_t> node, alt_cstr_t cst) {
 }
 
 void FplnInt::update(double hdg_trk_diff) {
+  MY_TRACE_SCOPE("FplnInt::update");
   if (!is_apt_valid(departure_) || !is_apt_valid(arrival_)) {
     co_rte_nm_ = "";
     return;
@@ -1226,34 +1565,42 @@ void FplnInt::update_act_leg() {
   }
 }
 
-libnav::DbErr FplnInt::process_dfms_proc_line(std::vector<std::string>& l_split,
+libnav::DbErr FplnInt::process_dfms_proc_line(const dfms_line_t& line,
                                               bool set_arpts,
                                               dfms_arr_data_t* arr_data) {
   bool db_err = false;
+  DfmsErr err_tp = DfmsErr::NONE;
+  std::string_view key = line.words[0];
+  std::string val{line.words[1]};
 
-  if (set_arpts && l_split[0] == DFMS_DEP_NM) {
-    libnav::DbErr err = set_dep(l_split[1]);
+  if (set_arpts && key == DFMS_DEP_NM) {
+    libnav::DbErr err = set_dep(val);
     if (err != libnav::DbErr::SUCCESS && err != libnav::DbErr::PARTIAL_LOAD) {
+      dfms_err_ = {DfmsErr::DEP, val};
       return err;
     }
-  } else if (l_split[0] == DFMS_DEP_RWY_NM) {
-    std::string tmp_rwy = get_dfms_rwy(l_split[1]);
+  } else if (key == DFMS_DEP_RWY_NM) {
+    std::string tmp_rwy = get_dfms_rwy(val);
     db_err = !set_dep_rwy(tmp_rwy);
-  } else if (l_split[0] == DFMS_SID_NM) {
-    db_err = !set_arpt_proc(PROC_TYPE_SID, l_split[1]);
-  } else if (l_split[0] == DFMS_SID_TRANS_NM) {
-    db_err = !set_arpt_proc_trans(PROC_TYPE_SID, l_split[1]);
-  } else if (set_arpts && l_split[0] == DFMS_ARR_NM) {
-    arr_data->arr_icao = l_split[1];
-  } else if (l_split[0] == DFMS_ARR_RWY_NM) {
-    arr_data->arr_rwy = l_split[1];
-  } else if (l_split[0] == DFMS_STAR_NM) {
-    arr_data->star = l_split[1];
-  } else if (l_split[0] == DFMS_SID_TRANS_NM) {
-    arr_data->star_trans = l_split[1];
+    err_tp = DfmsErr::DEP_RWY;
+  } else if (key == DFMS_SID_NM) {
+    db_err = !set_arpt_proc(PROC_TYPE_SID, val);
+    err_tp = DfmsErr::SID;
+  } else if (key == DFMS_SID_TRANS_NM) {
+    db_err = !set_arpt_proc_trans(PROC_TYPE_SID, val);
+    err_tp = DfmsErr::SID_TRANS;
+  } else if (set_arpts && key == DFMS_ARR_NM) {
+    arr_data->arr_icao = val;
+  } else if (key == DFMS_ARR_RWY_NM) {
+    arr_data->arr_rwy = val;
+  } else if (key == DFMS_STAR_NM) {
+    arr_data->star = val;
+  } else if (key == DFMS_SID_TRANS_NM) {
+    arr_data->star_trans = val;
   }
 
   if (db_err) {
+    dfms_err_ = {err_tp, val};
     return libnav::DbErr::DATA_BASE_ERROR;
   }
 
@@ -1265,49 +1612,114 @@ libnav::DbErr FplnInt::set_dfms_arr_data(dfms_arr_data_t* arr_data,
   if (set_arpt && arr_data->arr_icao != "") {
     libnav::DbErr err = set_arr(arr_data->arr_icao);
     if (err != libnav::DbErr::SUCCESS && err != libnav::DbErr::PARTIAL_LOAD) {
+      dfms_err_ = {DfmsErr::ARR, arr_data->arr_icao};
       return err;
     }
   }
+  // The rest needs both airports, so a file without them is rejected here
+  // rather than after the import.
+  if (departure_ == nullptr) {
+    dfms_err_ = {DfmsErr::DEP, ""};
+    return libnav::DbErr::DATA_BASE_ERROR;
+  }
+  if (arrival_ == nullptr) {
+    dfms_err_ = {DfmsErr::ARR, arr_data->arr_icao};
+    return libnav::DbErr::DATA_BASE_ERROR;
+  }
   std::string tmp_rwy = get_dfms_rwy(arr_data->arr_rwy);
-  if (tmp_rwy != "" && !set_arr_rwy(tmp_rwy))
+  if (tmp_rwy != "" && !set_arr_rwy(tmp_rwy)) {
+    dfms_err_ = {DfmsErr::ARR_RWY, arr_data->arr_rwy};
     return libnav::DbErr::DATA_BASE_ERROR;
+  }
 
   if (arr_data->star != "" &&
-      !set_arpt_proc(PROC_TYPE_STAR, arr_data->star, true))
+      !set_arpt_proc(PROC_TYPE_STAR, arr_data->star, true)) {
+    dfms_err_ = {DfmsErr::STAR, arr_data->star};
     return libnav::DbErr::DATA_BASE_ERROR;
+  }
 
   if (arr_data->star_trans != "" &&
-      !set_arpt_proc_trans(PROC_TYPE_STAR, arr_data->star_trans, true))
+      !set_arpt_proc_trans(PROC_TYPE_STAR, arr_data->star_trans, true)) {
+    dfms_err_ = {DfmsErr::STAR_TRANS, arr_data->star_trans};
     return libnav::DbErr::DATA_BASE_ERROR;
+  }
 
   return libnav::DbErr::SUCCESS;
 }
 
-bool FplnInt::get_dfms_wpt(std::vector<std::string>& l_split,
+bool FplnInt::get_dfms_wpt(const dfms_line_t& line,
+                           std::vector<libnav::waypoint_entry_t>* buf,
                            libnav::waypoint_t* out) {
   libnav::navaid_type_t tp =
-      libnav::navaid_type_t(strutils::stoi_with_strip(l_split[0]));
+      libnav::navaid_type_t(parse_dfms_num<int>(line.words[0]));
   libnav::NavaidType nav_tp = libnav::xp_fix_type_to_libnav(tp);
 
-  std::vector<libnav::waypoint_entry_t> wpt_entrs;
-  std::size_t n_ent =
-      navaid_db_->get_wpt_data(l_split[1], &wpt_entrs, "", "", nav_tp);
+  // Waypoint ids fit into the small string buffer, so this doesn't
+  // allocate.
+  std::string id{line.words[1]};
+  buf->clear();
+  std::size_t n_ent = navaid_db_->get_wpt_data(id, buf, "", "", nav_tp);
 
   if (n_ent) {
-    double p_lat_rad =
-        double(strutils::stof_with_strip(l_split[4])) * geo::DEG_TO_RAD;
-    double p_lon_rad =
-        double(strutils::stof_with_strip(l_split[5])) * geo::DEG_TO_RAD;
+    double p_lat_rad = parse_dfms_num<double>(line.words[4]) * geo::DEG_TO_RAD;
+    double p_lon_rad = parse_dfms_num<double>(line.words[5]) * geo::DEG_TO_RAD;
 
-    libnav::sort_wpt_entry_by_dist(&wpt_entrs, {p_lat_rad, p_lon_rad});
+    if (buf->size() > 1) {
+      libnav::sort_wpt_entry_by_dist(buf, {p_lat_rad, p_lon_rad});
+    }
 
-    *out = {l_split[1], wpt_entrs[0]};
+    *out = {id, (*buf)[0]};
     return true;
   }
 
   return false;
 }
 
+bool FplnInt::resolve_dfms_wpts(std::vector<dfms_enrt_entry_t>* entries) {
+  MY_TRACE_SCOPE("FplnInt::resolve_dfms_wpts");
+  std::vector<libnav::waypoint_entry_t> buf;
+  for (auto& i : *entries) {
+    if (!i.is_arpt && !get_dfms_wpt(i.line, &buf, &i.wpt)) {
+      dfms_err_ = {DfmsErr::WPT, std::string(i.line.words[1])};
+      return false;
+    }
+  }
+  return true;
+}
+
+void FplnInt::add_dfms_enrt(const std::vector<dfms_enrt_entry_t>& entries) {
+  std::string_view awy_last = "";
+  std::string end_last = "";
+  for (const auto& i : entries) {
+    std::string_view awy = i.line.words[2];
+    std::string wpt_id = "";
+    bool add_awy_seg = false;
+    if (!i.is_arpt) {
+      wpt_id = i.wpt.get_awy_id();
+
+      if (awy == DFMS_DIR_SEG_NM || (awy != awy_last && awy_last != "")) {
+        add_awy_seg = true;
+      } else {
+        awy_last = awy;
+        end_last = wpt_id;
+      }
+    } else {
+      add_awy_seg = true;
+    }
+
+    if (add_awy_seg) {
+      if (awy_last != "" && end_last != "") {
+        add_enrt_seg({nullptr, seg_list_.id}, std::string(awy_last));
+        awy_insert_str({&(seg_list_.tail), seg_list_.id}, end_last);
+      }
+      awy_last = "";
+      end_last = "";
+
+      if (wpt_id != "") awy_insert_str({nullptr, seg_list_.id}, wpt_id);
+    }
+  }
+}
+
 std::string FplnInt::get_dfms_arpt_leg(bool is_arr) const {
   const libnav::Airport* ptr = departure_;
   std::string seg_nm = DFMS_DEP_NM;
@@ -1376,76 +1788,60 @@ std::size_t FplnInt::get_dfms_enrt_legs(std::vector<std::string>* out) const {
 }
 
 libnav::DbErr FplnInt::load_fms_fpln(const std::string& file_nm, bool set_arpts) {
-  if (libnav::does_file_exist(file_nm + DFMS_FILE_POSTFIX)) {
-    std::ifstream file(file_nm + DFMS_FILE_POSTFIX);
-    if (file.is_open()) {
-      std::string line;
-      bool read_enrt = false;
-      dfms_arr_data_t arr_data;
-      std::string awy_last = "";
-      std::string end_last = "";
-      while (getline(file, line)) {
-        std::vector<std::string> ln_split = strutils::str_split(line);
-
-        if (!read_enrt && ln_split.size() > 1) {
-          if (ln_split[0] == DFMS_N_ENRT_NM) {
-            read_enrt = true;
-          } else if (ln_split[0] == DFMS_AIRAC_CYCLE_NM) {
-            int fpl_cycle = strutils::stoi_with_strip(ln_split[1]);
-            if (airac_mismatch_ || fix_airac_version_ != fpl_cycle)
-              return libnav::DbErr::DATA_BASE_ERROR;
-          } else {
-            libnav::DbErr err =
-                process_dfms_proc_line(ln_split, set_arpts, &arr_data);
-
-            if (err != libnav::DbErr::SUCCESS) {
-              return err;
-            }
-          }
-        } else if (read_enrt && ln_split.size() == N_DFMS_ENRT_WORDS) {
-          std::string wpt_id = "";
-          bool add_awy_seg = false;
-          if (ln_split[2] != DFMS_DEP_NM && ln_split[2] != DFMS_ARR_NM) {
-            libnav::waypoint_t wpt;
-            bool ret = get_dfms_wpt(ln_split, &wpt);
-            wpt_id = wpt.get_awy_id();
-
-            if (ret) {
-              if (ln_split[2] == DFMS_DIR_SEG_NM ||
-                  (ln_split[2] != awy_last && awy_last != "")) {
-                add_awy_seg = true;
-              } else {
-                awy_last = ln_split[2];
-                end_last = wpt_id;
-              }
-            } else {
-              return libnav::DbErr::DATA_BASE_ERROR;
-            }
-          } else {
-            add_awy_seg = true;
-          }
-
-          if (add_awy_seg) {
-            if (awy_last != "" && end_last != "") {
-              add_enrt_seg({nullptr, seg_list_.id}, awy_last);
-              awy_insert_str({&(seg_list_.tail), seg_list_.id}, end_last);
-            }
-            awy_last = "";
-            end_last = "";
+  MY_TRACE_SCOPE("FplnInt::load_fms_fpln");
+  dfms_err_ = {};
+  util::MappedFile file;
+  if (!file.Open(file_nm + DFMS_FILE_POSTFIX)) {
+    dfms_err_.tp = DfmsErr::FILE;
+    return libnav::DbErr::FILE_NOT_FOUND;
+  }
+  std::string_view data = file.GetView();
+
+  bool read_enrt = false;
+  dfms_arr_data_t arr_data;
+  std::vector<dfms_enrt_entry_t> enrt;
+  dfms_line_t line;
+  std::size_t pos = 0;
+  while (pos < data.size()) {
+    std::size_t nl = data.find('\n', pos);
+    if (nl == std::string_view::npos) {
+      nl = data.size();
+    }
+    split_dfms_line(data.substr(pos, nl - pos), &line);
+    pos = nl + 1;
+
+    if (!read_enrt && line.n_words > 1) {
+      if (line.words[0] == DFMS_N_ENRT_NM) {
+        read_enrt = true;
+        int n_enrt = parse_dfms_num<int>(line.words[1]);
+        enrt.reserve(std::size_t(std::clamp(n_enrt, 0, N_DFMS_ENRT_RESERVE_MAX)));
+      } else if (line.words[0] == DFMS_AIRAC_CYCLE_NM) {
+        int fpl_cycle = parse_dfms_num<int>(line.words[1]);
+        if (airac_mismatch_ || fix_airac_version_ != fpl_cycle) {
+          dfms_err_ = {DfmsErr::AIRAC, std::string(line.words[1])};
+          return libnav::DbErr::DATA_BASE_ERROR;
+        }
+      } else {
+        libnav::DbErr err = process_dfms_proc_line(line, set_arpts, &arr_data);
 
-            if (wpt_id != "") awy_insert_str({nullptr, seg_list_.id}, wpt_id);
-          }
+        if (err != libnav::DbErr::SUCCESS) {
+          return err;
         }
       }
-
-      file.close();
-
-      return set_dfms_arr_data(&arr_data, set_arpts);
+    } else if (read_enrt && line.n_words == N_DFMS_ENRT_WORDS) {
+      dfms_enrt_entry_t& entry = enrt.emplace_back();
+      entry.line = line;
+      entry.is_arpt =
+          line.words[2] == DFMS_DEP_NM || line.words[2] == DFMS_ARR_NM;
     }
+  }
 
-    file.close();
+  if (!resolve_dfms_wpts(&enrt)) {
+    return libnav::DbErr::DATA_BASE_ERROR;
   }
-  return libnav::DbErr::FILE_NOT_FOUND;
+  add_dfms_enrt(enrt);
+
+  return set_dfms_arr_data(&arr_data, set_arpts);
 }
 
 // Other auxiliury functions:
@@ -17,6 +17,8 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <string_view>
 #include <vector>
 
 #include <libnav/awy_db.hpp>
@@ -27,15 +29,82 @@
 #include <util/pathlib.hpp>
 #include <util/util.hpp>
 
+#include "awy_cache.hpp"
+#include "awy_graph.hpp"
 #include "fpln_base.hpp"
 
 namespace fms_core {
 enum ProcType { PROC_TYPE_SID = 0, PROC_TYPE_STAR = 1, PROC_TYPE_APPCH = 2 };
 
+constexpr std::size_t N_DFMS_ENRT_WORDS = 6;
+const std::string DFMS_FILE_POSTFIX = ".fms";
+
 struct dfms_arr_data_t {
   std::string star, star_trans, arr_rwy, arr_icao;
 };
 
+// Words of one line of a .fms file. They point into the mapped file.
+struct dfms_line_t {
+  std::size_t n_words = 0;  // Words past the last one stored are only counted
+  std::string_view words[N_DFMS_ENRT_WORDS];
+};
+
+struct dfms_enrt_entry_t {
+  dfms_line_t line;
+  bool is_arpt = false;
+  libnav::waypoint_t wpt;  // Not set for airports
+};
+
+// What made the last import from .fms or the binary format fail
+enum class DfmsErr {
+  NONE,
+  FILE,
+  AIRAC,
+  DEP,
+  DEP_RWY,
+  SID,
+  SID_TRANS,
+  ARR,
+  ARR_RWY,
+  STAR,
+  STAR_TRANS,
+  WPT
+};
+
+const char* GetStrOf(DfmsErr err);
+
+// What the route catalog keeps about a .fms file
+struct dfms_summary_t {
+  int airac_cycle = 0;
+  std::string dep_icao, arr_icao;
+  std::size_t n_wpts = 0;  // Enroute entries other than the airports
+};
+
+// Reads the header of a .fms file and counts its enroute entries. Nothing
+// is looked up in the data bases. Returns false if either airport is
+// missing.
+bool read_dfms_summary(std::string_view data, dfms_summary_t* out);
+
+enum class AwyRouteErr {
+  NONE,
+  EMPTY,
+  HAS_ARR,  // The flight plan has a STAR or an approach
+  INSERT    // A fix of the route couldn't be added
+};
+
+struct awy_route_ins_t {
+  AwyRouteErr err = AwyRouteErr::NONE;
+  std::size_t n_legs_added = 0;
+  // Indices into the legs of the route of those that were flown direct,
+  // because their airway couldn't be joined
+  std::vector<std::size_t> dct_legs;
+};
+
+struct dfms_err_t {
+  DfmsErr tp = DfmsErr::NONE;
+  std::string item;  // Name of the airport, procedure etc that failed
+};
+
 struct spd_cstr_t {
   int magnitude;
   libnav::SpeedMode mode;
@@ -62,14 +131,32 @@ class FplnInt : public FlightPlanBase {
   libnav::DbErr load_from_fms(const std::string& file_nm, bool set_arpts = true);
   MY_ATTR_UNIQUE(load_from_fms)
 
-  // Export to .fms file:
+  dfms_err_t get_dfms_err() const noexcept;
+  MY_ATTR_SHARED(get_dfms_err)
+
+  // Export to .fms file. The file is replaced atomically.
 
-  void save_to_fms(const std::string& file_nm, bool save_sid_star = true) const;
+  bool save_to_fms(const std::string& file_nm, bool save_sid_star = true) const;
   MY_ATTR_UNIQUE(save_to_fms)
 
+  // Contents of the .fms file, "" if there are no valid airports. Lets
+  // callers write the file without holding the flight plan lock.
+
+  std::string get_fms_str(bool save_sid_star = true) const;
+  MY_ATTR_UNIQUE(get_fms_str)
+
   std::string get_co_rte_nm() const noexcept;
   MY_ATTR_SHARED(get_co_rte_nm)
 
+  // Export to/import from the native binary format, see fpl_bin.hpp.
+  // Unlike .fms, it keeps constraints and calculated leg geometry.
+
+  bool save_to_bin(const std::string& file_nm) const;
+  MY_ATTR_SHARED(save_to_bin)
+
+  libnav::DbErr load_from_bin(const std::string& file_nm);
+  MY_ATTR_UNIQUE(load_from_bin)
+
   // Airport functions:
 
   libnav::DbErr set_dep(std::string icao);
@@ -147,6 +234,13 @@ class FplnInt : public FlightPlanBase {
   bool awy_insert(timed_ptr_t<seg_list_node_t> next, libnav::waypoint_t end);
   MY_ATTR_UNIQUE(awy_insert)
 
+  // Appends a route found by AwyGraph::FindRoute to the enroute part. Legs
+  // whose airway can't be joined are flown direct. The flight plan isn't
+  // touched if it has arrival procedures, since airways can only be
+  // appended after the last enroute segment.
+  awy_route_ins_t add_awy_route(const awy_route_t& route);
+  MY_ATTR_UNIQUE(add_awy_route)
+
   bool delete_via(timed_ptr_t<seg_list_node_t> next);
   MY_ATTR_UNIQUE(delete_via)
 
@@ -186,6 +280,8 @@ class FplnInt : public FlightPlanBase {
   std::vector<libnav::str_umap_t> proc_db_;
   util::OpaquePointer<libnav::AwyDB> awy_db_;
   util::OpaquePointer<libnav::NavaidDB> navaid_db_;
+  // Shared with every flight plan that uses awy_db_
+  std::shared_ptr<AwyPathCache> awy_cache_;
 
   libnav::arinc_rwy_db_t dep_rnw_, arr_rnw_;
   bool has_dep_rnw_data_, has_arr_rnw_data_;
@@ -195,6 +291,8 @@ class FplnInt : public FlightPlanBase {
 
   bool airac_mismatch_;
 
+  dfms_err_t dfms_err_;
+
   // Static member functions:
 
   static size_t get_proc_db_idx(ProcType tp, bool is_arr = false);
@@ -232,17 +330,26 @@ class FplnInt : public FlightPlanBase {
       Function: process_dfms_term_line
       Description:
       Processes a single line of .fms file describing airports/procedures
-      @param l_split: reference to the target split line
+      @param line: reference to the target split line
       @return error code
   */
 
-  libnav::DbErr process_dfms_proc_line(std::vector<std::string>& l_split,
+  libnav::DbErr process_dfms_proc_line(const dfms_line_t& line,
                                        bool set_arpts,
                                        dfms_arr_data_t* arr_data);
 
   libnav::DbErr set_dfms_arr_data(dfms_arr_data_t* arr_data, bool set_arpt);
 
-  bool get_dfms_wpt(std::vector<std::string>& l_split, libnav::waypoint_t* out);
+  // buf is reused between calls to save allocations
+  bool get_dfms_wpt(const dfms_line_t& line,
+                    std::vector<libnav::waypoint_entry_t>* buf,
+                    libnav::waypoint_t* out);
+
+  // Looks up the waypoints of all enroute entries at once, before anything
+  // is added to the flight plan. Returns false if one wasn't found.
+  bool resolve_dfms_wpts(std::vector<dfms_enrt_entry_t>* entries);
+
+  void add_dfms_enrt(const std::vector<dfms_enrt_entry_t>& entries);
 
   // Auxiliury functions for export to .fms:
 
@@ -0,0 +1,273 @@
+/*
+        This project is licensed under
+        Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+   Public License (CC BY-NC-SA 4.0).
+
+        A SUMMARY OF THIS LICENSE CAN BE FOUND HERE:
+   https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+        Author: discord/bruh4096#4512
+
+        This file contains definitions of member functions for FplBinWriter
+    and FplBinReader classes.
+*/
+
+#include "fpl_bin.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+
+namespace fms_core {
+
+namespace {
+
+enum LegSegFlags : std::uint8_t {
+  LEG_SEG_IS_ARC = 1 << 0,
+  LEG_SEG_IS_FINITE = 1 << 1,
+  LEG_SEG_IS_RWY = 1 << 2,
+  LEG_SEG_IS_BYPASSED = 1 << 3,
+  LEG_SEG_IS_TO_INHIBITED = 1 << 4,
+  LEG_SEG_HAS_DISC = 1 << 5,
+  LEG_SEG_HAS_CALC_WPT = 1 << 6
+};
+
+// libnav's enums count up from 0, so the last enumerator that the flight
+// plan code uses bounds the values a leg can hold. Extend these if it
+// starts using newer ones.
+constexpr libnav::TurnDir TURN_DIR_MAX = std::max(
+    {libnav::TurnDir::LEFT, libnav::TurnDir::RIGHT, libnav::TurnDir::EITHER});
+constexpr libnav::SpeedMode SPEED_MODE_MAX =
+    std::max({libnav::SpeedMode::AT, libnav::SpeedMode::AT_OR_ABOVE,
+              libnav::SpeedMode::AT_OR_BELOW});
+constexpr libnav::AltMode ALT_MODE_MAX = std::max(
+    {libnav::AltMode::AT, libnav::AltMode::AT_OR_ABOVE,
+     libnav::AltMode::AT_OR_BELOW, libnav::AltMode::GS_AT,
+     libnav::AltMode::GS_AT_OR_ABOVE, libnav::AltMode::GS_INTC_AT,
+     libnav::AltMode::SID_AT_OR_ABOVE,
+     libnav::AltMode::ALT_STEPDOWN_AT_AT,
+     libnav::AltMode::ALT_STEPDOWN_AT_AT_OR_ABOVE,
+     libnav::AltMode::ALT_STEPDOWN_AT_AT_OR_BELOW});
+
+// NavaidType is a set of bits, none of them above the highest one in use
+constexpr std::uint32_t NAVAID_TYPE_MASK =
+    (std::bit_floor(std::uint32_t(libnav::NavaidType::WAYPOINT) |
+                    std::uint32_t(libnav::NavaidType::RWY) |
+                    std::uint32_t(libnav::NavaidType::VHF_NAVAID) |
+                    std::uint32_t(libnav::NavaidType::VOR_DME) |
+                    std::uint32_t(libnav::NavaidType::ILS_DME))
+     << 1) - 1;
+}  // namespace
+
+// FplBinWriter definitions:
+
+void FplBinWriter::Reset() {
+  buf_.assign(sizeof(fpl_bin_hdr_t), '\0');
+}
+
+void FplBinWriter::SetHdr(const fpl_bin_hdr_t& hdr) noexcept {
+  std::memcpy(buf_.data(), &hdr, sizeof(hdr));
+}
+
+void FplBinWriter::PutStr(const std::string& str) {
+  std::uint16_t sz = std::uint16_t(std::min(
+      str.size(), std::size_t(std::numeric_limits<std::uint16_t>::max())));
+  Put(sz);
+  buf_.append(str.data(), sz);
+}
+
+void FplBinWriter::PutWpt(const libnav::waypoint_t& wpt) {
+  PutStr(wpt.id);
+  Put(std::int32_t(wpt.data.type));
+  Put(std::uint8_t(wpt.data.arinc_type));
+  Put(wpt.data.pos.lat_rad);
+  Put(wpt.data.pos.lon_rad);
+  PutStr(wpt.data.area_code);
+  PutStr(wpt.data.country_code);
+  Put(std::uint8_t(wpt.data.navaid != nullptr));
+}
+
+void FplBinWriter::PutSeg(const fpl_seg_t& seg, std::size_t n_legs) {
+  Put(std::uint8_t(seg.seg_type));
+  Put(std::uint8_t(seg.is_direct));
+  Put(std::uint8_t(seg.is_discon));
+  PutStr(seg.name);
+  Put(std::uint32_t(n_legs));
+}
+
+void FplBinWriter::PutLegData(const leg_list_data_t& data) {
+  Put(std::uint8_t(data.is_discon));
+  if (!data.is_discon) {
+    put_leg(data.leg);
+    put_leg_seg(data.misc_data);
+  }
+}
+
+const std::string& FplBinWriter::GetData() const noexcept {
+  return buf_;
+}
+
+// Private functions:
+
+void FplBinWriter::put_leg(const leg_t& leg) {
+  PutStr(leg.leg_type);
+  PutWpt(leg.main_fix);
+  PutWpt(leg.recd_navaid);
+  PutWpt(leg.center_fix);
+  Put(std::int32_t(leg.turn_dir));
+  Put(double(leg.rnp));
+  Put(double(leg.outbd_crs_deg));
+  Put(double(leg.outbd_dist_time));
+  Put(std::uint8_t(leg.outbd_crs_true));
+  Put(std::uint8_t(leg.outbd_dist_as_time));
+  Put(std::int32_t(leg.alt_desc));
+  Put(std::int32_t(leg.alt1_ft));
+  Put(std::int32_t(leg.alt2_ft));
+  Put(std::int32_t(leg.speed_desc));
+  Put(std::int32_t(leg.spd_lim_kias));
+}
+
+void FplBinWriter::put_leg_seg(const leg_seg_t& seg) {
+  std::uint8_t flags = 0;
+  if (seg.is_arc) flags |= LEG_SEG_IS_ARC;
+  if (seg.is_finite) flags |= LEG_SEG_IS_FINITE;
+  if (seg.is_rwy) flags |= LEG_SEG_IS_RWY;
+  if (seg.is_bypassed) flags |= LEG_SEG_IS_BYPASSED;
+  if (seg.is_to_inhibited) flags |= LEG_SEG_IS_TO_INHIBITED;
+  if (seg.has_disc) flags |= LEG_SEG_HAS_DISC;
+  if (seg.has_calc_wpt) flags |= LEG_SEG_HAS_CALC_WPT;
+  Put(flags);
+  Put(seg.start.lat_rad);
+  Put(seg.start.lon_rad);
+  Put(seg.end.lat_rad);
+  Put(seg.end.lon_rad);
+  Put(seg.turn_rad_nm);
+  Put(seg.true_trk_deg);
+  if (seg.has_calc_wpt) {
+    PutWpt(seg.calc_wpt);
+  }
+}
+
+// FplBinReader definitions:
+
+FplBinReader::FplBinReader(std::string_view data,
+                           util::OpaquePointer<libnav::NavaidDB> nav_db)
+    : data_{data}, nav_db_{nav_db} {}
+
+bool FplBinReader::GetHdr(fpl_bin_hdr_t* out) noexcept {
+  return Get(out) && out->magic == FPL_BIN_MAGIC &&
+         out->version == FPL_BIN_VERSION;
+}
+
+bool FplBinReader::GetStr(std::string* out) {
+  std::uint16_t sz;
+  if (!Get(&sz) || data_.size() - pos_ < sz) {
+    return false;
+  }
+  out->assign(data_.data() + pos_, sz);
+  pos_ += sz;
+  return true;
+}
+
+bool FplBinReader::GetWpt(libnav::waypoint_t* out) {
+  std::int32_t tp;
+  std::uint8_t has_navaid;
+  bool ok = GetStr(&out->id) && Get(&tp) &&
+            get_as<std::uint8_t>(&out->data.arinc_type) &&
+            Get(&out->data.pos.lat_rad) && Get(&out->data.pos.lon_rad) &&
+            GetStr(&out->data.area_code) && GetStr(&out->data.country_code) &&
+            Get(&has_navaid);
+  if (!ok || tp < 0 || (std::uint32_t(tp) & ~NAVAID_TYPE_MASK) != 0) {
+    return false;
+  }
+  out->data.type = libnav::NavaidType(tp);
+
+  // Navaid data lives in the data base, so it's looked up again. The cycle
+  // of the file matches the data base, so the position is an exact match
+  // and a navaid that isn't found means the file is broken.
+  out->data.navaid = nullptr;
+  if (has_navaid) {
+    wpt_buf_.clear();
+    nav_db_->get_wpt_data(out->id, &wpt_buf_, out->data.area_code,
+                          out->data.country_code, out->data.type);
+    for (const auto& i : wpt_buf_) {
+      if (i.pos.lat_rad == out->data.pos.lat_rad &&
+          i.pos.lon_rad == out->data.pos.lon_rad) {
+        out->data.navaid = i.navaid;
+        break;
+      }
+    }
+    return out->data.navaid != nullptr;
+  }
+  return true;
+}
+
+bool FplBinReader::GetSeg(fpl_bin_seg_t* out) {
+  std::uint8_t seg_tp;
+  std::uint32_t n_legs;
+  bool ok = Get(&seg_tp) && get_as<std::uint8_t>(&out->data.is_direct) &&
+            get_as<std::uint8_t>(&out->data.is_discon) &&
+            GetStr(&out->data.name) && Get(&n_legs);
+  // Only a discontinuity at the very start has no segment type
+  if (!ok || seg_tp > std::uint8_t(FplSegment::APPCH) ||
+      (seg_tp == std::uint8_t(FplSegment::NONE) && !out->data.is_discon) ||
+      n_legs == 0) {
+    return false;
+  }
+  out->data.seg_type = FplSegment(seg_tp);
+  out->data.end = nullptr;
+  out->n_legs = n_legs;
+  return true;
+}
+
+bool FplBinReader::GetLegData(leg_list_data_t* out) {
+  if (!get_as<std::uint8_t>(&out->is_discon)) {
+    return false;
+  }
+  out->seg = nullptr;
+  if (out->is_discon) {
+    return true;
+  }
+  return get_leg(&out->leg) && get_leg_seg(&out->misc_data);
+}
+
+// Private functions:
+
+bool FplBinReader::get_leg(leg_t* out) {
+  return GetStr(&out->leg_type) && GetWpt(&out->main_fix) &&
+         GetWpt(&out->recd_navaid) && GetWpt(&out->center_fix) &&
+         get_enum(&out->turn_dir, TURN_DIR_MAX) && get_as<double>(&out->rnp) &&
+         get_as<double>(&out->outbd_crs_deg) &&
+         get_as<double>(&out->outbd_dist_time) &&
+         get_as<std::uint8_t>(&out->outbd_crs_true) &&
+         get_as<std::uint8_t>(&out->outbd_dist_as_time) &&
+         get_enum(&out->alt_desc, ALT_MODE_MAX) &&
+         get_as<std::int32_t>(&out->alt1_ft) &&
+         get_as<std::int32_t>(&out->alt2_ft) &&
+         get_enum(&out->speed_desc, SPEED_MODE_MAX) &&
+         get_as<std::int32_t>(&out->spd_lim_kias);
+}
+
+bool FplBinReader::get_leg_seg(leg_seg_t* out) {
+  std::uint8_t flags;
+  bool ok = Get(&flags) && Get(&out->start.lat_rad) &&
+            Get(&out->start.lon_rad) && Get(&out->end.lat_rad) &&
+            Get(&out->end.lon_rad) && Get(&out->turn_rad_nm) &&
+            Get(&out->true_trk_deg);
+  if (!ok) {
+    return false;
+  }
+  out->is_arc = flags & LEG_SEG_IS_ARC;
+  out->is_finite = flags & LEG_SEG_IS_FINITE;
+  out->is_rwy = flags & LEG_SEG_IS_RWY;
+  out->is_bypassed = flags & LEG_SEG_IS_BYPASSED;
+  out->is_to_inhibited = flags & LEG_SEG_IS_TO_INHIBITED;
+  out->has_disc = flags & LEG_SEG_HAS_DISC;
+  out->has_calc_wpt = flags & LEG_SEG_HAS_CALC_WPT;
+  if (out->has_calc_wpt) {
+    return GetWpt(&out->calc_wpt);
+  }
+  return true;
+}
+}  // namespace fms_core
@@ -0,0 +1,160 @@
+/*
+        This project is licensed under
+        Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+   Public License (CC BY-NC-SA 4.0).
+
+        A SUMMARY OF THIS LICENSE CAN BE FOUND HERE:
+   https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+        Author: discord/bruh4096#4512
+
+        This file contains declarations of the native binary flight plan
+    format along with the classes that encode and decode its records.
+
+        A file starts with fpl_bin_hdr_t. It's followed by the airports and
+    the arrival runway, the refs, the segments and finally the legs of every
+    segment in order. Legs are stored together with their calculated
+    geometry, so a loaded flight plan can be displayed right away. Strings are
+    prefixed with their length. Everything is stored in the byte order of the
+    host, a file from a host with another byte order fails the magic check.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <libnav/navaid_db.hpp>
+#include <util/util.hpp>
+
+#include "fpln_base.hpp"
+
+namespace fms_core {
+
+constexpr std::uint32_t FPL_BIN_MAGIC = 0x46504c42;  // "FPLB"
+// Increment on every change to the layout
+constexpr std::uint16_t FPL_BIN_VERSION = 1;
+const std::string FPL_BIN_FILE_POSTFIX = ".fplb";
+
+struct fpl_bin_hdr_t {
+  std::uint32_t magic;
+  std::uint16_t version;
+  std::uint16_t reserved;
+  std::int32_t airac_cycle;
+  std::uint32_t n_segs;
+  std::uint32_t n_legs;
+  std::uint32_t reserved2;
+};
+
+static_assert(sizeof(fpl_bin_hdr_t) == 24);
+
+struct fpl_bin_seg_t {
+  fpl_seg_t data;  // end isn't set
+  std::size_t n_legs = 0;
+};
+
+// Appends records to a buffer that's written out in one go
+class FplBinWriter final {
+ public:
+  // Starts a new file. The header is filled in by SetHdr.
+  void Reset();
+
+  void SetHdr(const fpl_bin_hdr_t& hdr) noexcept;
+
+  template <typename T>
+  void Put(T val) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    buf_.append(reinterpret_cast<const char*>(&val), sizeof(T));
+  }
+
+  void PutStr(const std::string& str);
+
+  void PutWpt(const libnav::waypoint_t& wpt);
+
+  void PutSeg(const fpl_seg_t& seg, std::size_t n_legs);
+
+  // Only the fields of arinc_leg_t that the flight plan uses are stored
+  void PutLegData(const leg_list_data_t& data);
+
+  const std::string& GetData() const noexcept;
+
+ private:
+  std::string buf_;
+
+  void put_leg(const leg_t& leg);
+
+  void put_leg_seg(const leg_seg_t& seg);
+};
+
+// Reads records from a buffer. Every function returns false once it would
+// read past the end of the buffer.
+class FplBinReader final {
+ public:
+  // nav_db is used to find the navaids that waypoints refer to
+  FplBinReader(std::string_view data,
+               util::OpaquePointer<libnav::NavaidDB> nav_db);
+
+  bool GetHdr(fpl_bin_hdr_t* out) noexcept;
+
+  template <typename T>
+  bool Get(T* out) noexcept {
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (data_.size() - pos_ < sizeof(T)) {
+      return false;
+    }
+    std::memcpy(out, data_.data() + pos_, sizeof(T));
+    pos_ += sizeof(T);
+    return true;
+  }
+
+  bool GetStr(std::string* out);
+
+  // Also fails if the type is out of range or the navaid that the waypoint
+  // refers to isn't in the data base
+  bool GetWpt(libnav::waypoint_t* out);
+
+  // Also fails if the segment type is out of range or it has no legs
+  bool GetSeg(fpl_bin_seg_t* out);
+
+  // Also fails if an enum is out of range
+  bool GetLegData(leg_list_data_t* out);
+
+ private:
+  std::string_view data_;
+  std::size_t pos_ = 0;
+  util::OpaquePointer<libnav::NavaidDB> nav_db_;
+  std::vector<libnav::waypoint_entry_t> wpt_buf_;
+
+  bool get_leg(leg_t* out);
+
+  bool get_leg_seg(leg_seg_t* out);
+
+  // Reads a value stored as W into a field of type T
+  template <typename W, typename T>
+  bool get_as(T* out) noexcept {
+    W val;
+    if (!Get(&val)) {
+      return false;
+    }
+    *out = static_cast<T>(val);
+    return true;
+  }
+
+  // Reads an enum stored as std::int32_t. Fails if it's outside [0, max].
+  template <typename T>
+  bool get_enum(T* out, T max) noexcept {
+    std::int32_t val;
+    if (!Get(&val) || val < 0 || val > std::int32_t(max)) {
+      return false;
+    }
+    *out = static_cast<T>(val);
+    return true;
+  }
+};
+}  // namespace fms_core
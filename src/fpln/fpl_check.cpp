@@ -0,0 +1,76 @@
+/*
+        This project is licensed under
+        Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+   Public License (CC BY-NC-SA 4.0).
+
+        A SUMMARY OF THIS LICENSE CAN BE FOUND HERE:
+   https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+        Author: discord/bruh4096#4512
+
+        This file contains definitions of functions that check the flight
+    plans in a directory.
+*/
+
+#include "fpl_check.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <system_error>
+
+#include <util/thread_pool.hpp>
+#include <util/trace.hpp>
+
+namespace {
+
+std::vector<std::string> get_fms_names(const pathlib::Path& dir) {
+  std::vector<std::string> out;
+  std::error_code ec;
+  for (const auto& i : std::filesystem::directory_iterator(dir.Get(), ec)) {
+    if (i.is_regular_file(ec) &&
+        i.path().extension() == fms_core::DFMS_FILE_POSTFIX) {
+      out.push_back(i.path().stem().string());
+    }
+  }
+  std::sort(out.begin(), out.end());
+  return out;
+}
+}  // namespace
+
+namespace fms_core {
+
+fpl_dir_check_t check_fpl_dir(util::OpaquePointer<libnav::ArptDB> arpt_db,
+                              util::OpaquePointer<libnav::NavaidDB> navaid_db,
+                              util::OpaquePointer<libnav::AwyDB> awy_db,
+                              const pathlib::Path& cifp_path,
+                              const pathlib::Path& fpl_dir,
+                              std::size_t n_threads) {
+  MY_TRACE_SCOPE("check_fpl_dir");
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::string> names = get_fms_names(fpl_dir);
+  // Every file writes only its own slot, so no locking is needed
+  std::vector<std::optional<fpl_check_t>> res(names.size());
+
+  util::ThreadPool pool{n_threads > 1 ? n_threads - 1 : 0};
+  pool.ParallelFor(names.size(), [&](std::size_t i) {
+    FplnInt fpl{arpt_db, navaid_db, awy_db, cifp_path};
+    libnav::DbErr err = fpl.load_from_fms((fpl_dir + names[i]).Get(), true);
+    if (err != libnav::DbErr::SUCCESS && err != libnav::DbErr::PARTIAL_LOAD) {
+      res[i] = fpl_check_t{names[i], err, fpl.get_dfms_err()};
+    }
+  });
+
+  fpl_dir_check_t out;
+  out.n_files = names.size();
+  for (auto& i : res) {
+    if (i) {
+      out.failed.push_back(std::move(*i));
+    }
+  }
+  out.elapsed_s = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+  return out;
+}
+}  // namespace fms_core
@@ -0,0 +1,59 @@
+/*
+        This project is licensed under
+        Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+   Public License (CC BY-NC-SA 4.0).
+
+        A SUMMARY OF THIS LICENSE CAN BE FOUND HERE:
+   https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+        Author: discord/bruh4096#4512
+
+        This file contains declarations of functions that check whether the
+    flight plans in a directory still load with the current navigation data.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+#include <string>
+#include <vector>
+
+#include <libnav/arpt_db.hpp>
+#include <libnav/awy_db.hpp>
+#include <libnav/navaid_db.hpp>
+#include <util/pathlib.hpp>
+#include <util/util.hpp>
+
+#include "flightpln_int.hpp"
+
+namespace fms_core {
+
+struct fpl_check_t {
+  std::string name;  // File name without the .fms extension
+  libnav::DbErr err;
+  dfms_err_t dfms_err;
+};
+
+struct fpl_dir_check_t {
+  std::size_t n_files = 0;
+  double elapsed_s = 0;
+  std::vector<fpl_check_t> failed;  // Sorted by name
+};
+
+/*
+    Function: check_fpl_dir
+    Description:
+    Loads every .fms file in fpl_dir into a scratch flight plan. The files are
+    spread over n_threads threads, the calling thread being one of them. The
+    navigation data bases are only read, so they're shared by all threads.
+    @return the files that failed to load
+*/
+
+fpl_dir_check_t check_fpl_dir(util::OpaquePointer<libnav::ArptDB> arpt_db,
+                              util::OpaquePointer<libnav::NavaidDB> navaid_db,
+                              util::OpaquePointer<libnav::AwyDB> awy_db,
+                              const pathlib::Path& cifp_path,
+                              const pathlib::Path& fpl_dir,
+                              std::size_t n_threads);
+}  // namespace fms_core
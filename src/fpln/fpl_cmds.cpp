@@ -4,14 +4,28 @@
 #include <cstddef>
 #include <cstdint>
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <optional>
+#include <ostream>
 #include <libnav/navaid_db.hpp>
 #include <libnav/str_utils.hpp>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <utility>
 
+#include <util/alloc_stats.hpp>
+#include <util/instr_mutex.hpp>
+#include <util/trace.hpp>
 #include <util/util.hpp>
 
+#include "fpl_check.hpp"
+#ifndef _WIN32
+#include "state_bridge.hpp"
+#endif
+
 namespace {
 
 std::unordered_map<std::string, fms_commands::cmd_t> glob_cmd_map = {
@@ -22,6 +36,8 @@ std::unordered_map<std::string, fms_commands::cmd_t> glob_cmd_map = {
     {"q", fms_commands::quit},
     {"load", fms_commands::load_fpln},
     {"save", fms_commands::save_fpln},
+    {"loadbin", fms_commands::load_fpln_bin},
+    {"savebin", fms_commands::save_fpln_bin},
     {"setfilt", fms_commands::set_filter},
     {"fplinfo", fms_commands::fplinfo},
     {"setdep", fms_commands::set_fpl_dep},
@@ -41,8 +57,24 @@ std::unordered_map<std::string, fms_commands::cmd_t> glob_cmd_map = {
     {"plegs", fms_commands::print_legs},
     {"pseg", fms_commands::print_seg},
     {"prefs", fms_commands::print_refs},
+    {"latstats", fms_commands::latstats},
+    {"trace", fms_commands::trace},
+    {"allocstats", fms_commands::allocstats},
+    {"lockstats", fms_commands::lockstats},
+    {"awystats", fms_commands::awystats},
+    {"bridgestats", fms_commands::bridgestats},
+    {"checkfpls", fms_commands::check_fpls},
+    {"autoroute", fms_commands::autoroute},
+    {"corte", fms_commands::find_co_rte},
     {"help", fms_commands::help}};
 
+// City pairs that "autoroute bench" finds routes for
+const std::vector<std::pair<std::string, std::string>> AUTOROUTE_BENCH_PAIRS =
+    {{"EGLL", "LIRF"}, {"EDDF", "LEMD"}, {"LFPG", "EPWA"}, {"EHAM", "LGAV"},
+     {"EKCH", "LPPT"}, {"ESSA", "LIMC"}, {"EIDW", "LOWW"}, {"EBBR", "LTFM"},
+     {"ENGM", "LEBL"}, {"EFHK", "LFMN"}, {"LSZH", "EGPH"}, {"LKPR", "LPPR"}};
+constexpr std::size_t N_AUTOROUTE_BENCH_DFLT = 10;
+
 bool glob_rwy_filter = false;
 bool glob_proc_filter = false;
 bool glob_trans_filter = false;
@@ -54,21 +86,39 @@ std::size_t get_cmd_fpln_idx(
   return static_cast<std::size_t>(*res);
 }
 
-libnav::waypoint_entry_t select_desired(
-    std::string& name, std::vector<libnav::waypoint_entry_t>& wpts) {
+std::ostream& get_out(const fms_commands::command_res_t& cmd_resources) {
+  if (cmd_resources.out != nullptr) {
+    return *cmd_resources.out;
+  }
+  return std::cout;
+}
+
+// Returns nullopt if the selection was cancelled
+std::optional<libnav::waypoint_entry_t> select_desired(
+    const fms_commands::command_res_t& cmd_resources, std::string& name,
+    std::vector<libnav::waypoint_entry_t>& wpts) {
   if (wpts.size() == 0) {
-    return {};
+    return libnav::waypoint_entry_t{};
   }
   if (wpts.size() == 1) {
     return wpts[0];
   }
-  std::cout << "Select desired " << name << "\n";
+  if (cmd_resources.select_wpt != nullptr) {
+    std::optional<std::size_t> idx = (*cmd_resources.select_wpt)(name, wpts);
+    if (!idx || *idx >= wpts.size()) {
+      return std::nullopt;
+    }
+    return wpts[*idx];
+  }
+
+  std::ostream& out = get_out(cmd_resources);
+  out << "Select desired " << name << "\n";
   for (size_t i = 0; i < wpts.size(); i++) {
-    std::cout << i + 1 << ". "
-              << strutils::lat_to_str(wpts[i].pos.lat_rad * geo::RAD_TO_DEG)
-              << " "
-              << strutils::lat_to_str(wpts[i].pos.lon_rad * geo::RAD_TO_DEG)
-              << "\n";
+    out << i + 1 << ". "
+        << strutils::lat_to_str(wpts[i].pos.lat_rad * geo::RAD_TO_DEG)
+        << " "
+        << strutils::lat_to_str(wpts[i].pos.lon_rad * geo::RAD_TO_DEG)
+        << "\n";
   }
   while (1) {
     std::string tmp;
@@ -80,6 +130,53 @@ libnav::waypoint_entry_t select_desired(
     }
   }
 }
+
+// id is taken as an airport if there's one with that icao, as a fix
+// otherwise
+fms_core::awy_route_end_t get_route_end(
+    const fms_commands::command_res_t& cmd_resources, const std::string& id) {
+  fms_core::awy_route_end_t out;
+  out.id = id;
+  util::OpaquePointer<libnav::ArptDB> arpt_db =
+      cmd_resources.fpl_sys->get_arpt_db_ptr();
+  if (arpt_db->is_airport(id)) {
+    libnav::airport_data_t arpt_data;
+    arpt_db->get_airport_data(id, &arpt_data);
+    out.is_arpt = true;
+    out.pos = arpt_data.pos;
+  }
+  return out;
+}
+
+void autoroute_bench(const fms_commands::command_res_t& cmd_resources,
+                     const fms_core::AwyGraph& graph, std::size_t n_runs) {
+  std::ostream& out = get_out(cmd_resources);
+  for (const auto& i : AUTOROUTE_BENCH_PAIRS) {
+    fms_core::awy_route_end_t from = get_route_end(cmd_resources, i.first);
+    fms_core::awy_route_end_t to = get_route_end(cmd_resources, i.second);
+    fms_core::awy_route_t rte;
+    bool found = false;
+    double max_ms = 0;
+    double sum_ms = 0;
+    for (std::size_t j = 0; j < n_runs; j++) {
+      auto start = std::chrono::steady_clock::now();
+      found = graph.FindRoute(from, to, &rte);
+      std::chrono::duration<double, std::milli> dur =
+          std::chrono::steady_clock::now() - start;
+      max_ms = std::max(max_ms, dur.count());
+      sum_ms += dur.count();
+    }
+    out << i.first << "-" << i.second << ": ";
+    if (found) {
+      out << rte.dist_nm << " nm, " << rte.legs.size() << " legs, "
+          << rte.n_expanded << " fixes expanded, ";
+    } else {
+      out << "no route, ";
+    }
+    out << "mean " << sum_ms / double(n_runs) << " ms, max " << max_ms
+        << " ms\n";
+  }
+}
 }  // namespace
 
 namespace fms_commands {
@@ -95,8 +192,10 @@ bool invoke(const std::string& cmd_name,
 }
 
 void set_var(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
   if (in.size() != 2) {
-    std::cout << "Command expects 2 arguments: <variable name>, <value>\n";
+    out << "Command expects 2 arguments: <variable name>, <value>\n";
     return;
   }
 
@@ -104,32 +203,106 @@ void set_var(command_res_t cmd_resources, std::vector<std::string>& in) {
 }
 
 void print(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
   if (in.size() != 1) {
-    std::cout << "Command expects 1 argument: <variable name>\n";
+    out << "Command expects 1 argument: <variable name>\n";
     return;
   }
 
   auto val = cmd_resources.env_map->GetString(in[0]);
   if (val) {
-    std::cout << *val << "\n";
+    out << *val << "\n";
   } else {
-    std::cout << "Variable not found\n";
+    out << "Variable not found\n";
   }
 }
 
 void quit(command_res_t cmd_resources, std::vector<std::string>& in) {
-  UNUSED(cmd_resources);
+  std::ostream& out = get_out(cmd_resources);
 
   if (in.size()) {
-    std::cout << "Too many arguments provided\n";
+    out << "Too many arguments provided\n";
     return;
   }
   std::exit(0);
 }
 
 void load_fpln(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
+  if (in.size() > 1) {
+    out << "Command expects 0-1 arguments: <route name or prefix>\n";
+    return;
+  }
+
+  size_t c_idx = get_cmd_fpln_idx(cmd_resources);
+
+  util::OpaquePointer<flightplan_type> curr_fpln =
+      cmd_resources.fpl_sys->get_fpln_ptr(c_idx);
+  std::string dep_nm = curr_fpln->get_dep_icao();
+  std::string arr_nm = curr_fpln->get_arr_icao();
+
+  std::string rte_nm;
+  util::OpaquePointer<fms_core::RteCatalog> catalog =
+      cmd_resources.fpl_sys->get_rte_catalog();
+  if (in.size() == 1 && catalog.get() == nullptr) {
+    rte_nm = in[0];
+  } else if (in.size() == 1) {
+    std::optional<fms_core::rte_catalog_entry_t> entry = catalog->Find(in[0]);
+    if (!entry && catalog->Update(in[0])) entry = catalog->Find(in[0]);
+    if (entry) {
+      rte_nm = entry->name;
+    } else {
+      std::vector<fms_core::rte_catalog_entry_t> res =
+          catalog->FindByPrefix(in[0]);
+      if (res.size() != 1) {
+        out << res.size() << " routes match " << in[0] << "\n";
+        for (const auto& i : res) {
+          out << i.name << ": " << i.dep_icao << " " << i.arr_icao << "\n";
+        }
+        return;
+      }
+      rte_nm = res[0].name;
+    }
+  } else if (dep_nm != "" && arr_nm != "") {
+    rte_nm = dep_nm + arr_nm;
+    // Fall back to the only route for the city pair if it's named otherwise
+    if (catalog.get() != nullptr && !catalog->Find(rte_nm)) {
+      std::vector<fms_core::rte_catalog_entry_t> res =
+          catalog->FindByCityPair(dep_nm, arr_nm);
+      if (res.size() > 1) {
+        out << res.size() << " routes for " << dep_nm << " " << arr_nm
+            << ", pick one by name:\n";
+        for (const auto& i : res) {
+          out << i.name << "\n";
+        }
+        return;
+      } else if (res.size() == 1) {
+        rte_nm = res[0].name;
+      }
+    }
+  } else {
+    return;
+  }
+
+  std::string file_nm =
+      (cmd_resources.fpl_sys->get_fpln_dir() + rte_nm).Get();
+  // Named routes bring their own airports
+  libnav::DbErr err = curr_fpln->load_from_fms(file_nm, in.size() == 1);
+
+  if (err != libnav::DbErr::SUCCESS && err != libnav::DbErr::PARTIAL_LOAD) {
+    fms_core::dfms_err_t dfms_err = curr_fpln->get_dfms_err();
+    out << "Failed to load flight plan: " << fms_core::GetStrOf(dfms_err.tp)
+        << " " << dfms_err.item << "\n";
+  }
+}
+
+void save_fpln(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
   if (in.size()) {
-    std::cout << "Command expects 0 arguments\n";
+    out << "Command expects 0 arguments\n";
     return;
   }
 
@@ -141,19 +314,55 @@ void load_fpln(command_res_t cmd_resources, std::vector<std::string>& in) {
   std::string arr_nm = curr_fpln->get_arr_icao();
 
   if (dep_nm != "" && arr_nm != "") {
-    std::string file_nm =
+    std::string out_nm =
         (cmd_resources.fpl_sys->get_fpln_dir() + (dep_nm + arr_nm)).Get();
-    libnav::DbErr err = curr_fpln->load_from_fms(file_nm, false);
+    // out may belong to a client that's gone by the time the write is done
+    cmd_resources.fpl_sys->save_fpln_async(c_idx, out_nm, [out_nm](bool saved) {
+      if (!saved) {
+        std::cout << "Failed to save flight plan to " << out_nm << "\n";
+      }
+    });
+  }
+}
+
+void load_fpln_bin(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
 
-    if (err != libnav::DbErr::SUCCESS && err != libnav::DbErr::PARTIAL_LOAD) {
-      std::cout << "Failed to load flight plan\n";
+  if (in.size()) {
+    out << "Command expects 0 arguments\n";
+    return;
+  }
+
+  size_t c_idx = get_cmd_fpln_idx(cmd_resources);
+
+  util::OpaquePointer<flightplan_type> curr_fpln =
+      cmd_resources.fpl_sys->get_fpln_ptr(c_idx);
+  std::string dep_nm = curr_fpln->get_dep_icao();
+  std::string arr_nm = curr_fpln->get_arr_icao();
+
+  if (dep_nm != "" && arr_nm != "") {
+    std::string file_nm =
+        (cmd_resources.fpl_sys->get_fpln_dir() + (dep_nm + arr_nm)).Get();
+    auto start = std::chrono::steady_clock::now();
+    libnav::DbErr err = curr_fpln->load_from_bin(file_nm);
+    std::chrono::duration<double, std::micro> dur =
+        std::chrono::steady_clock::now() - start;
+
+    if (err != libnav::DbErr::SUCCESS) {
+      fms_core::dfms_err_t dfms_err = curr_fpln->get_dfms_err();
+      out << "Failed to load flight plan: " << fms_core::GetStrOf(dfms_err.tp)
+          << " " << dfms_err.item << "\n";
+    } else {
+      out << "Loaded in " << dur.count() << " us\n";
     }
   }
 }
 
-void save_fpln(command_res_t cmd_resources, std::vector<std::string>& in) {
+void save_fpln_bin(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
   if (in.size()) {
-    std::cout << "Command expects 0 arguments\n";
+    out << "Command expects 0 arguments\n";
     return;
   }
 
@@ -167,14 +376,23 @@ void save_fpln(command_res_t cmd_resources, std::vector<std::string>& in) {
   if (dep_nm != "" && arr_nm != "") {
     std::string out_nm =
         (cmd_resources.fpl_sys->get_fpln_dir() + (dep_nm + arr_nm)).Get();
-    curr_fpln->save_to_fms(out_nm);
+    auto start = std::chrono::steady_clock::now();
+    bool saved = curr_fpln->save_to_bin(out_nm);
+    std::chrono::duration<double, std::micro> dur =
+        std::chrono::steady_clock::now() - start;
+
+    if (!saved) {
+      out << "Failed to save flight plan\n";
+    } else {
+      out << "Saved in " << dur.count() << " us\n";
+    }
   }
 }
 
 void set_filter(command_res_t cmd_resources, std::vector<std::string>& in) {
-  UNUSED(cmd_resources);
+  std::ostream& out = get_out(cmd_resources);
   if (in.size() != 1) {
-    std::cout << "Command expects 1 argument: {filter type(0 - runway, 1 - "
+    out << "Command expects 1 argument: {filter type(0 - runway, 1 - "
                  "procedure, 2 - transition)}\n";
     return;
   }
@@ -187,13 +405,15 @@ void set_filter(command_res_t cmd_resources, std::vector<std::string>& in) {
   } else if (flt_type == 2) {
     glob_trans_filter = !(glob_trans_filter);
   } else {
-    std::cout << "Filter type out of range\n";
+    out << "Filter type out of range\n";
   }
 }
 
 void fplinfo(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
   if (in.size()) {
-    std::cout << "Too many arguments provided\n";
+    out << "Too many arguments provided\n";
     return;
   }
 
@@ -201,15 +421,17 @@ void fplinfo(command_res_t cmd_resources, std::vector<std::string>& in) {
   util::OpaquePointer<flightplan_type> curr_fpln =
       cmd_resources.fpl_sys->get_fpln_ptr(c_idx);
 
-  std::cout << "Departure: " << curr_fpln->get_dep_icao() << "\n";
-  std::cout << "Arrival: " << curr_fpln->get_arr_icao() << "\n";
-  std::cout << "Departure runway: " << curr_fpln->get_dep_rwy() << "\n";
-  std::cout << "Arrival runway: " << curr_fpln->get_arr_rwy() << "\n";
+  out << "Departure: " << curr_fpln->get_dep_icao() << "\n";
+  out << "Arrival: " << curr_fpln->get_arr_icao() << "\n";
+  out << "Departure runway: " << curr_fpln->get_dep_rwy() << "\n";
+  out << "Arrival runway: " << curr_fpln->get_arr_rwy() << "\n";
 }
 
 void set_fpl_dep(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
   if (in.size() != 1) {
-    std::cout << "Command expects 1 argument: icao code\n";
+    out << "Command expects 1 argument: icao code\n";
     return;
   }
 
@@ -219,15 +441,17 @@ void set_fpl_dep(command_res_t cmd_resources, std::vector<std::string>& in) {
 
   libnav::DbErr err = curr_fpln->set_dep(in[0]);
   if (err != libnav::DbErr::SUCCESS && err != libnav::DbErr::PARTIAL_LOAD) {
-    std::cout << "Invalid entry\n";
+    out << "Invalid entry\n";
   } else if (err == libnav::DbErr::PARTIAL_LOAD) {
-    std::cout << "Airport partially loaded\n";
+    out << "Airport partially loaded\n";
   }
 }
 
 void set_fpl_arr(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
   if (in.size() != 1) {
-    std::cout << "Command expects 1 argument: icao code\n";
+    out << "Command expects 1 argument: icao code\n";
     return;
   }
 
@@ -237,15 +461,17 @@ void set_fpl_arr(command_res_t cmd_resources, std::vector<std::string>& in) {
 
   libnav::DbErr err = curr_fpl->set_arr(in[0]);
   if (err != libnav::DbErr::SUCCESS && err != libnav::DbErr::PARTIAL_LOAD) {
-    std::cout << "Invalid entry\n";
+    out << "Invalid entry\n";
   } else if (err == libnav::DbErr::PARTIAL_LOAD) {
-    std::cout << "Airport partially loaded\n";
+    out << "Airport partially loaded\n";
   }
 }
 
 void set_dep_rwy(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
   if (in.size() != 1) {
-    std::cout << "Command expects 1 argument: icao code\n";
+    out << "Command expects 1 argument: icao code\n";
     return;
   }
 
@@ -256,13 +482,15 @@ void set_dep_rwy(command_res_t cmd_resources, std::vector<std::string>& in) {
   bool rwy_set = curr_fpl->set_dep_rwy(in[0]);
 
   if (!rwy_set) {
-    std::cout << "Runway not set";
+    out << "Runway not set";
   }
 }
 
 void set_arr_rwy(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
   if (in.size() != 1) {
-    std::cout << "Command expects 1 argument: icao code\n";
+    out << "Command expects 1 argument: icao code\n";
     return;
   }
 
@@ -273,13 +501,15 @@ void set_arr_rwy(command_res_t cmd_resources, std::vector<std::string>& in) {
   bool rwy_set = curr_fpl->set_arr_rwy(in[0]);
 
   if (!rwy_set) {
-    std::cout << "Runway not set";
+    out << "Runway not set";
   }
 }
 
 void get_dep_rwys(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
   if (in.size() != 0) {
-    std::cout << "Command expects 0 arguments\n";
+    out << "Command expects 0 arguments\n";
     return;
   }
 
@@ -290,13 +520,15 @@ void get_dep_rwys(command_res_t cmd_resources, std::vector<std::string>& in) {
   std::vector<std::string> rwys =
       curr_fpl->get_dep_rwys(glob_rwy_filter, glob_proc_filter);
   for (auto i : rwys) {
-    std::cout << i << "\n";
+    out << i << "\n";
   }
 }
 
 void get_arr_rwys(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
   if (in.size() != 0) {
-    std::cout << "Command expects 0 arguments\n";
+    out << "Command expects 0 arguments\n";
     return;
   }
 
@@ -306,13 +538,15 @@ void get_arr_rwys(command_res_t cmd_resources, std::vector<std::string>& in) {
 
   std::vector<std::string> rwys = curr_fpl->get_arr_rwys();
   for (auto i : rwys) {
-    std::cout << i << "\n";
+    out << i << "\n";
   }
 }
 
 void get_proc(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
   if (in.size() != 3) {
-    std::cout << "Command expects 3 arguments: {procedure type}, {DEP/ARR}, \
+    out << "Command expects 3 arguments: {procedure type}, {DEP/ARR}, \
             {PROC/TRANS}\n";
     return;
   }
@@ -320,7 +554,7 @@ void get_proc(command_res_t cmd_resources, std::vector<std::string>& in) {
   int tmp = strutils::stoi_with_strip(in[0]);
 
   if (tmp < 0 || tmp > 2) {
-    std::cout << "procedure type entry out of range\n";
+    out << "procedure type entry out of range\n";
     return;
   }
 
@@ -342,14 +576,16 @@ void get_proc(command_res_t cmd_resources, std::vector<std::string>& in) {
     }
 
     for (auto i : procs) {
-      std::cout << i << "\n";
+      out << i << "\n";
     }
   }
 }
 
 void set_proc(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
   if (in.size() != 4) {
-    std::cout << "Command expects 4 arguments: {procedure type}, {proc name}, \
+    out << "Command expects 4 arguments: {procedure type}, {proc name}, \
                 {DEP/ARR}, {TRANS/PROC}\n";
     return;
   }
@@ -361,7 +597,7 @@ void set_proc(command_res_t cmd_resources, std::vector<std::string>& in) {
   int tmp = strutils::stoi_with_strip(in[0]);
 
   if (tmp < 0 || tmp > 2) {
-    std::cout << "procedure type entry out of range\n";
+    out << "procedure type entry out of range\n";
     return;
   }
 
@@ -375,13 +611,15 @@ void set_proc(command_res_t cmd_resources, std::vector<std::string>& in) {
   }
 
   if (!ret) {
-    std::cout << "Failed to set procedure/trantition\n";
+    out << "Failed to set procedure/trantition\n";
   }
 }
 
 void print_legs(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
   if (in.size() != 1) {
-    std::cout << "Command expects 1 argument: layout{1/2}\n";
+    out << "Command expects 1 argument: layout{1/2}\n";
     return;
   }
 
@@ -397,9 +635,9 @@ void print_legs(command_res_t cmd_resources, std::vector<std::string>& in) {
   size_t cnt = 0;
   for (auto i : legs) {
     if (cnt && cnt < size_t(n_legs - 1)) {
-      std::cout << cnt - 1 << ". ";
+      out << cnt - 1 << ". ";
       if (i.data.is_discon) {
-        std::cout << "DISCONTINUITY\n";
+        out << "DISCONTINUITY\n";
         cnt++;
         continue;
       }
@@ -411,9 +649,9 @@ void print_legs(command_res_t cmd_resources, std::vector<std::string>& in) {
           float dist_nm = i.data.leg.outbd_dist_time;
           std::string brng_str = strutils::double_to_str(double(brng_deg), 6);
           std::string dist_str = strutils::double_to_str(double(dist_nm), 6);
-          std::cout << brng_str << " " << dist_str << "\n";
+          out << brng_str << " " << dist_str << "\n";
         } else {
-          std::cout << "--- ---\n";
+          out << "--- ---\n";
         }
       }
       std::string pos = "";
@@ -423,15 +661,17 @@ void print_legs(command_res_t cmd_resources, std::vector<std::string>& in) {
       std::string misc_data =
           i.data.misc_data.calc_wpt.id + " " + i.data.leg.leg_type;
 
-      std::cout << misc_data + " " + pos << "\n";
+      out << misc_data + " " + pos << "\n";
     }
     cnt++;
   }
 }
 
 void add_via(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
   if (in.size() != 2) {
-    std::cout
+    out
         << "Command expects 2 arguments: {Next segment index}, {Airway name}\n";
     return;
   }
@@ -453,13 +693,15 @@ void add_via(command_res_t cmd_resources, std::vector<std::string>& in) {
   bool retval = curr_fpl->add_enrt_seg({s_ptr, id}, in[1]);
 
   if (!retval) {
-    std::cout << "Invalid entry\n";
+    out << "Invalid entry\n";
   }
 }
 
 void delete_via(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
   if (in.size() != 1) {
-    std::cout << "Command expects 1 argument: {Next segment index}\n";
+    out << "Command expects 1 argument: {Next segment index}\n";
     return;
   }
 
@@ -480,13 +722,15 @@ void delete_via(command_res_t cmd_resources, std::vector<std::string>& in) {
   bool retval = curr_fpl->delete_via({s_ptr, id});
 
   if (!retval) {
-    std::cout << "INVALID DELETE\n";
+    out << "INVALID DELETE\n";
   }
 }
 
 void add_to(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
   if (in.size() != 2) {
-    std::cout << "Command expects 2 arguments: {Next segment index}, {End "
+    out << "Command expects 2 arguments: {Next segment index}, {End "
                  "waypoint name}\n";
     return;
   }
@@ -503,9 +747,14 @@ void add_to(command_res_t cmd_resources, std::vector<std::string>& in) {
   libnav::waypoint_entry_t tgt;
 
   if (n_found == 0) {
-    std::cout << "Invalid waypoint id\n";
+    out << "Invalid waypoint id\n";
   } else {
-    tgt = select_desired(in[1], wpt_entr);
+    auto sel = select_desired(cmd_resources, in[1], wpt_entr);
+    if (!sel) {
+      out << "Selection cancelled\n";
+      return;
+    }
+    tgt = *sel;
   }
 
   size_t idx = size_t(strutils::stoi_with_strip(in[0]));
@@ -521,14 +770,16 @@ void add_to(command_res_t cmd_resources, std::vector<std::string>& in) {
   bool retval = curr_fpl->awy_insert_str({s_ptr, id}, tgt_wpt.get_awy_id());
 
   if (!retval) {
-    std::cout << "Invalid entry\n";
+    out << "Invalid entry\n";
   }
 }
 
 inline void delete_to(command_res_t cmd_resources,
                       std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
   if (in.size() != 1) {
-    std::cout << "Command expects 1 argument: {Next segment index}\n";
+    out << "Command expects 1 argument: {Next segment index}\n";
     return;
   }
 
@@ -549,14 +800,16 @@ inline void delete_to(command_res_t cmd_resources,
   bool retval = curr_fpl->delete_seg_end({s_ptr, id});
 
   if (!retval) {
-    std::cout << "INVALID DELETE\n";
+    out << "INVALID DELETE\n";
   }
 }
 
 inline void legs_set(command_res_t cmd_resources,
                      std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
   if (in.size() != 3 && in.size() != 4) {
-    std::cout << "Command expects 3 arguments: {index}, {L/R CDU}, {L/R "
+    out << "Command expects 3 arguments: {index}, {L/R CDU}, {L/R "
                  "Field}, (optional){Scratch pad content. If not empty}\n";
     return;
   }
@@ -573,7 +826,7 @@ inline void legs_set(command_res_t cmd_resources,
   auto legs = cmd_resources.fpl_sys->get_leg_list(&n_legs, c_idx);
 
   if (idx >= n_legs) {
-    std::cout << "Index out of range\n";
+    out << "Index out of range\n";
     return;
   }
 
@@ -581,7 +834,7 @@ inline void legs_set(command_res_t cmd_resources,
   if (in[1] == "R") {
     is_rt = true;
   } else if (in[1] != "L") {
-    std::cout << "Invalid second parameter\n";
+    out << "Invalid second parameter\n";
     return;
   }
   std::pair<std::size_t, double> sel_leg =
@@ -596,9 +849,14 @@ inline void legs_set(command_res_t cmd_resources,
       libnav::waypoint_entry_t tgt;
 
       if (n_found == 0) {
-        std::cout << "Invalid waypoint id\n";
+        out << "Invalid waypoint id\n";
       } else {
-        tgt = select_desired(in[3], wpt_entr);
+        auto sel = select_desired(cmd_resources, in[3], wpt_entr);
+        if (!sel) {
+          out << "Selection cancelled\n";
+          return;
+        }
+        tgt = *sel;
       }
 
       curr_fpl->add_direct({in[3], tgt}, {legs[idx].ptr, f_inf.leg_list_id});
@@ -630,8 +888,10 @@ inline void legs_set(command_res_t cmd_resources,
 }
 
 void delete_leg(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
   if (in.size() != 1) {
-    std::cout << "Command expects 1 argument: {leg number}\n";
+    out << "Command expects 1 argument: {leg number}\n";
     return;
   }
 
@@ -645,20 +905,22 @@ void delete_leg(command_res_t cmd_resources, std::vector<std::string>& in) {
   auto legs = cmd_resources.fpl_sys->get_leg_list(&n_legs, c_idx);
 
   if (idx >= n_legs - 1) {
-    std::cout << "Index out of range\n";
+    out << "Index out of range\n";
     return;
   }
 
   bool ret = curr_fpl->delete_leg({legs[idx].ptr, f_inf.leg_list_id});
 
   if (!ret) {
-    std::cout << "INVALID DELETE\n";
+    out << "INVALID DELETE\n";
   }
 }
 
 void print_seg(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
   if (in.size() != 0) {
-    std::cout << "Command expects 0 arguments\n";
+    out << "Command expects 0 arguments\n";
     return;
   }
 
@@ -674,14 +936,16 @@ void print_seg(command_res_t cmd_resources, std::vector<std::string>& in) {
     if (end_leg != nullptr) {
       end_nm = end_leg->data.leg.main_fix.id;
     }
-    std::cout << curr_sg.data.name << " " << end_nm << " "
+    out << curr_sg.data.name << " " << end_nm << " "
               << static_cast<std::size_t>(curr_sg.data.seg_type) << "\n";
   }
 }
 
 void print_refs(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
   if (in.size() != 0) {
-    std::cout << "Command expects 0 arguments\n";
+    out << "Command expects 0 arguments\n";
     return;
   }
 
@@ -691,16 +955,295 @@ void print_refs(command_res_t cmd_resources, std::vector<std::string>& in) {
   curr_fpl->print_refs();
 }
 
+void latstats(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
+  if (cmd_resources.input_lat == nullptr) {
+    out << "Latency statistics are not available\n";
+    return;
+  }
+  util::input_latency_t& lat = *cmd_resources.input_lat;
+
+  if (in.size() == 1 && in[0] == "reset") {
+    lat.queue_wait.Reset();
+    lat.handling.Reset();
+    lat.total.Reset();
+    return;
+  }
+  if (in.size() == 1 && in[0] == "overlay") {
+    lat.show_overlay = !lat.show_overlay;
+    return;
+  }
+  if (in.size() != 0) {
+    out << "Command expects 0 arguments or one of: reset, overlay\n";
+    return;
+  }
+
+  std::pair<const char*, const util::LatencyHistogram*> hists[] = {
+      {"queue", &lat.queue_wait},
+      {"handling", &lat.handling},
+      {"total", &lat.total}};
+  out << "Input latency, ms (count/p50/p95/p99/max):\n";
+  for (auto& i : hists) {
+    out << i.first << ": " << i.second->GetCount() << " "
+              << i.second->GetPercentileMs(50) << " "
+              << i.second->GetPercentileMs(95) << " "
+              << i.second->GetPercentileMs(99) << " "
+              << i.second->GetMaxMs() << "\n";
+  }
+}
+
+void trace(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
+  if (in.size() == 1 && in[0] == "start") {
+    util::TraceStart();
+    return;
+  }
+  if (in.size() == 2 && in[0] == "stop") {
+    if (!util::TraceStop(in[1])) {
+      out << "Failed to write " << in[1] << "\n";
+    }
+    return;
+  }
+  out << "Command expects arguments: start | stop <file name>\n";
+}
+
+void allocstats(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
+  if (in.size() == 1 && in[0] == "reset") {
+    util::AllocReset();
+    return;
+  }
+  if (in.size() != 0) {
+    out << "Command expects 0 arguments or: reset\n";
+    return;
+  }
+  util::AllocPrintReport(out);
+}
+
+void lockstats(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
+  if (in.size() == 1 && in[0] == "on") {
+    util::LockStatsSetOn(true);
+    return;
+  }
+  if (in.size() == 1 && in[0] == "off") {
+    util::LockStatsSetOn(false);
+    return;
+  }
+  if (in.size() == 1 && in[0] == "reset") {
+    util::LockStatsReset();
+    return;
+  }
+  if (in.size() != 0) {
+    out << "Command expects 0 arguments or one of: on, off, reset\n";
+    return;
+  }
+  util::LockStatsPrintReport(out);
+}
+
+void awystats(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
+  std::shared_ptr<fms_core::AwyPathCache> cache =
+      fms_core::AwyPathCache::GetShared(
+          cmd_resources.fpl_sys->get_awy_db_ptr());
+  if (in.size() == 1 && in[0] == "clear") {
+    cache->Clear();
+    return;
+  }
+  if (in.size() != 0) {
+    out << "Command expects 0 arguments or: clear\n";
+    return;
+  }
+  fms_core::awy_cache_stats_t stats = cache->GetStats();
+  std::uint64_t n_total = stats.n_hits + stats.n_misses;
+  out << "Airway path cache: " << stats.n_entries << " entries, "
+      << stats.n_hits << "/" << n_total << " hits\n";
+}
+
+void bridgestats(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
+  if (in.size() != 0) {
+    out << "Command expects 0 arguments\n";
+    return;
+  }
+#ifdef _WIN32
+  // The bridge isn't built without POSIX sockets
+  out << "State bridge isn't running\n";
+#else
+  if (cmd_resources.state_bridge == nullptr) {
+    out << "State bridge isn't running\n";
+    return;
+  }
+  fms_environment::state_bridge_stats_t stats =
+      cmd_resources.state_bridge->GetStats();
+  out << "State bridge: " << stats.n_recv << " received, " << stats.n_applied
+      << " applied, " << stats.n_lost << " lost, " << stats.n_stale
+      << " stale, " << stats.n_bad << " bad\n";
+#endif
+}
+
+void check_fpls(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
+  std::size_t n_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  if (in.size() == 1) {
+    int n = strutils::stoi_with_strip(in[0]);
+    if (n <= 0) {
+      out << "Number of threads must be positive\n";
+      return;
+    }
+    n_threads = std::size_t(n);
+  } else if (in.size() != 0) {
+    out << "Command expects 0 or 1 arguments: <number of threads>\n";
+    return;
+  }
+
+  fms_core::FPLSys* fpl_sys = cmd_resources.fpl_sys;
+  fms_core::fpl_dir_check_t res = fms_core::check_fpl_dir(
+      fpl_sys->get_arpt_db_ptr(), fpl_sys->get_navaid_db_ptr(),
+      fpl_sys->get_awy_db_ptr(), fpl_sys->get_cifp_dir(),
+      fpl_sys->get_fpln_dir(), n_threads);
+
+  for (const auto& i : res.failed) {
+    out << i.name << ": " << fms_core::GetStrOf(i.dfms_err.tp) << " "
+        << i.dfms_err.item << "\n";
+  }
+  out << res.failed.size() << "/" << res.n_files << " flight plans failed to "
+      << "load. " << res.elapsed_s << " s with " << n_threads << " threads, "
+      << (res.elapsed_s > 0 ? double(res.n_files) / res.elapsed_s : 0)
+      << " files/s\n";
+}
+
+void find_co_rte(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
+  util::OpaquePointer<fms_core::RteCatalog> catalog =
+      cmd_resources.fpl_sys->get_rte_catalog();
+  if (catalog.get() == nullptr) {
+    out << "No route catalog\n";
+    return;
+  }
+  std::vector<fms_core::rte_catalog_entry_t> res;
+  auto start = std::chrono::steady_clock::now();
+  if (in.size() == 0) {
+    size_t c_idx = get_cmd_fpln_idx(cmd_resources);
+    util::OpaquePointer<flightplan_type> curr_fpln =
+        cmd_resources.fpl_sys->get_fpln_ptr(c_idx);
+    res = catalog->FindByCityPair(curr_fpln->get_dep_icao(),
+                                  curr_fpln->get_arr_icao());
+  } else if (in.size() == 1) {
+    res = catalog->FindByPrefix(in[0]);
+  } else if (in.size() == 2) {
+    res = catalog->FindByCityPair(in[0], in[1]);
+  } else {
+    out << "Command expects 0-2 arguments: <name prefix> or "
+        << "<departure icao> <arrival icao>\n";
+    return;
+  }
+  std::chrono::duration<double, std::micro> dur =
+      std::chrono::steady_clock::now() - start;
+
+  for (const auto& i : res) {
+    out << i.name << ": " << i.dep_icao << " " << i.arr_icao << ", "
+        << i.n_wpts << " waypoints, cycle " << i.airac_cycle << "\n";
+  }
+  out << res.size() << "/" << catalog->GetSize() << " routes in "
+      << dur.count() << " us\n";
+  if (!catalog->IsReady()) {
+    out << "Flight plan directory is still being scanned\n";
+  }
+}
+
+void autoroute(command_res_t cmd_resources, std::vector<std::string>& in) {
+  std::ostream& out = get_out(cmd_resources);
+
+  util::OpaquePointer<const fms_core::AwyGraph> graph =
+      cmd_resources.fpl_sys->get_awy_graph();
+  if (graph.get() == nullptr || graph->GetNodeCount() == 0) {
+    out << "Airway graph isn't loaded\n";
+    return;
+  }
+
+  if (in.size() && in[0] == "bench") {
+    int n_runs = int(N_AUTOROUTE_BENCH_DFLT);
+    if (in.size() == 2) {
+      n_runs = strutils::stoi_with_strip(in[1]);
+    }
+    if (in.size() > 2 || n_runs <= 0) {
+      out << "Command expects: bench <positive number of runs>\n";
+      return;
+    }
+    autoroute_bench(cmd_resources, *graph, std::size_t(n_runs));
+    return;
+  }
+
+  size_t c_idx = get_cmd_fpln_idx(cmd_resources);
+  util::OpaquePointer<flightplan_type> curr_fpln =
+      cmd_resources.fpl_sys->get_fpln_ptr(c_idx);
+  std::string from_id, to_id;
+  if (in.size() == 0) {
+    from_id = curr_fpln->get_dep_icao();
+    to_id = curr_fpln->get_arr_icao();
+    if (from_id == "" || to_id == "") {
+      out << "Flight plan has no departure or arrival\n";
+      return;
+    }
+  } else if (in.size() == 2) {
+    from_id = in[0];
+    to_id = in[1];
+  } else {
+    out << "Command expects 0 or 2 arguments: <from> <to>, or: bench "
+        << "[number of runs]\n";
+    return;
+  }
+
+  fms_core::awy_route_t rte;
+  auto start = std::chrono::steady_clock::now();
+  bool found = graph->FindRoute(get_route_end(cmd_resources, from_id),
+                                get_route_end(cmd_resources, to_id), &rte);
+  std::chrono::duration<double, std::micro> dur =
+      std::chrono::steady_clock::now() - start;
+  if (!found) {
+    out << "No airway route from " << from_id << " to " << to_id << "\n";
+    return;
+  }
+
+  for (const auto& i : rte.legs) {
+    out << (i.awy == "" ? "DCT" : i.awy) << " " << i.wpt_id << "\n";
+  }
+  out << rte.dist_nm << " nm, found in " << dur.count() << " us, "
+      << rte.n_expanded << " fixes expanded\n";
+  fms_core::awy_route_ins_t ins = curr_fpln->add_awy_route(rte);
+  for (std::size_t i : ins.dct_legs) {
+    out << "Couldn't join " << rte.legs[i].awy << " to "
+        << rte.legs[i].wpt_id << ", added a direct instead\n";
+  }
+  if (ins.err == fms_core::AwyRouteErr::HAS_ARR) {
+    out << "Flight plan has arrival procedures, remove them before adding "
+        << "a route\n";
+  } else if (ins.err == fms_core::AwyRouteErr::INSERT) {
+    out << "Failed to add " << rte.legs[ins.n_legs_added].wpt_id
+        << ", only the first " << ins.n_legs_added << " of "
+        << rte.legs.size() << " legs were added\n";
+  }
+}
+
 void help(command_res_t cmd_resources, std::vector<std::string>& in) {
-  UNUSED(cmd_resources);
+  std::ostream& out = get_out(cmd_resources);
 
   if (in.size() != 0) {
-    std::cout << "Command expects 0 arguments\n";
+    out << "Command expects 0 arguments\n";
     return;
   }
 
   for (auto i : glob_cmd_map) {
-    std::cout << i.first << "\n";
+    out << i.first << "\n";
   }
 }
 }  // namespace fms_commands
\ No newline at end of file
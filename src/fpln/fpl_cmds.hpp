@@ -14,21 +14,44 @@
 
 #pragma once
 
+#include <cstddef>
+
+#include <functional>
 #include <memory>
+#include <optional>
+#include <ostream>
 #include <string>
+#include <vector>
 
+#include <libnav/navaid_db.hpp>
 #include <libnav/str_utils.hpp>
+#include <util/latency_hist.hpp>
 
 #include "environment.hpp"
 #include "fpln_sys.hpp"
 
 #define UNUSED(x) (void)(x)
 
+namespace fms_environment {
+class StateBridge;
+}  // namespace fms_environment
+
 namespace fms_commands {
 
+// Picks one of several waypoints with the same name. Returns an index into
+// wpts or nullopt to cancel the command.
+using wpt_select_t = std::function<std::optional<std::size_t>(
+    const std::string& name,
+    const std::vector<libnav::waypoint_entry_t>& wpts)>;
+
 struct command_res_t {
   fms_core::FPLSys* fpl_sys;
   fms_environment::EnvDataRefMap* env_map;
+  util::input_latency_t* input_lat;  // May be nullptr
+  const fms_environment::StateBridge* state_bridge = nullptr;
+  std::ostream* out = nullptr;  // Replies go to std::cout if nullptr
+  // If nullptr, the user is asked on stdin
+  const wpt_select_t* select_wpt = nullptr;
 };
 
 typedef void (*cmd_t)(command_res_t, std::vector<std::string>&);
@@ -48,6 +71,10 @@ void load_fpln(command_res_t cmd_resources, std::vector<std::string>& in);
 
 void save_fpln(command_res_t cmd_resources, std::vector<std::string>& in);
 
+void load_fpln_bin(command_res_t cmd_resources, std::vector<std::string>& in);
+
+void save_fpln_bin(command_res_t cmd_resources, std::vector<std::string>& in);
+
 void set_filter(command_res_t cmd_resources, std::vector<std::string>& in);
 
 void fplinfo(command_res_t cmd_resources, std::vector<std::string>& in);
@@ -86,5 +113,23 @@ void print_seg(command_res_t cmd_resources, std::vector<std::string>& in);
 
 void print_refs(command_res_t cmd_resources, std::vector<std::string>& in);
 
+void latstats(command_res_t cmd_resources, std::vector<std::string>& in);
+
+void trace(command_res_t cmd_resources, std::vector<std::string>& in);
+
+void allocstats(command_res_t cmd_resources, std::vector<std::string>& in);
+
+void lockstats(command_res_t cmd_resources, std::vector<std::string>& in);
+
+void awystats(command_res_t cmd_resources, std::vector<std::string>& in);
+
+void bridgestats(command_res_t cmd_resources, std::vector<std::string>& in);
+
+void check_fpls(command_res_t cmd_resources, std::vector<std::string>& in);
+
+void autoroute(command_res_t cmd_resources, std::vector<std::string>& in);
+
+void find_co_rte(command_res_t cmd_resources, std::vector<std::string>& in);
+
 void help(command_res_t cmd_resources, std::vector<std::string>& in);
 }  // namespace fms_commands
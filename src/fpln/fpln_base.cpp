@@ -458,6 +458,32 @@ void FlightPlanBase::add_direct_leg(leg_t leg, leg_list_node_t* next_leg) {
   }
 }
 
+seg_list_node_t* FlightPlanBase::insert_segment(const fpl_seg_t& seg,
+                                                const leg_list_data_t* legs,
+                                                std::size_t n_legs,
+                                                seg_list_node_t* next) {
+  if (seg_stack_.ptr_stack.empty() ||
+      leg_data_stack_.ptr_stack.size() < n_legs) {
+    return nullptr;
+  }
+  leg_list_node_t* next_leg = next->prev->data.end->next;
+
+  seg_list_node_t* seg_add = seg_stack_.get_new();
+  seg_add->data = seg;
+
+  for (std::size_t i = 0; i < n_legs; i++) {
+    leg_list_data_t c_data = legs[i];
+    c_data.seg = seg_add;
+    add_singl_leg(next_leg, c_data);
+  }
+
+  seg_add->data.end = next_leg->prev;
+  seg_list_.insert_before(next, seg_add);
+
+  update_id();
+  return seg_add;
+}
+
 bool FlightPlanBase::delete_singl_leg(
     leg_list_node_t* leg)  // leg before/after discontinuity
 {
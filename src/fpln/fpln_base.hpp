@@ -278,6 +278,22 @@ class FlightPlanBase {
 
   void add_direct_leg(leg_t leg, leg_list_node_t* next);
 
+  /*
+      Function: insert_segment
+      Description:
+      Inserts a segment before next exactly as it's given. Unlike
+      add_segment, it doesn't merge segments or update refs.
+      @param seg: segment data. Its end is set by the function
+      @param legs: pointer to the legs of the segment
+      @param n_legs: number of legs
+      @param next: segment before which the new one is inserted
+      @return: pointer to the new segment, nullptr if there are no free nodes
+  */
+
+  seg_list_node_t* insert_segment(const fpl_seg_t& seg,
+                                  const leg_list_data_t* legs,
+                                  std::size_t n_legs, seg_list_node_t* next);
+
   bool delete_singl_leg(leg_list_node_t* leg);
 
   void reset_fpln(bool leave_dep_rwy = false);
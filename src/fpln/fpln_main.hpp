@@ -11,13 +11,14 @@
 
 #include "fpln_base.hpp"
 #include "flightpln_int.hpp"
+#include <util/instr_mutex.hpp>
 #include <util/pathlib.hpp>
 #include <util/util.hpp>
 
 namespace fms_core {
 
 class FlightPlan final {
-  mutable std::shared_mutex main_mutex_;
+  mutable util::InstrSharedMutex main_mutex_{"FlightPlan"};
   FplnInt fpln_;
 public:
   FlightPlan(util::OpaquePointer<libnav::ArptDB> apt_db,
@@ -55,12 +56,22 @@ public:
 
   libnav::DbErr load_from_fms(const std::string& file_nm, bool set_arpts = true);
 
+  dfms_err_t get_dfms_err() const noexcept;
+
   // Export to .fms file:
 
-  void save_to_fms(const std::string& file_nm, bool save_sid_star = true) const;
+  bool save_to_fms(const std::string& file_nm, bool save_sid_star = true) const;
+
+  std::string get_fms_str(bool save_sid_star = true) const;
 
   std::string get_co_rte_nm() const noexcept;
 
+  // Export to/import from the native binary format:
+
+  bool save_to_bin(const std::string& file_nm) const;
+
+  libnav::DbErr load_from_bin(const std::string& file_nm);
+
   // Airport functions:
 
   libnav::DbErr set_dep(std::string icao);
@@ -118,6 +129,8 @@ public:
 
   bool awy_insert(timed_ptr_t<seg_list_node_t> next, libnav::waypoint_t end);
 
+  awy_route_ins_t add_awy_route(const awy_route_t& route);
+
   bool delete_via(timed_ptr_t<seg_list_node_t> next);
 
   bool delete_seg_end(timed_ptr_t<seg_list_node_t> next);
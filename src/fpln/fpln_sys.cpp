@@ -23,6 +23,8 @@
 #include <shared_mutex>
 
 #include "environment.hpp"
+#include <util/alloc_stats.hpp>
+#include <util/trace.hpp>
 #include <util/util.hpp>
 
 namespace {
@@ -47,10 +49,13 @@ FPLSys::FPLSys(util::OpaquePointer<libnav::ArptDB> arpt_db,
                util::OpaquePointer<libnav::AwyDB> awy_db, 
                util::OpaquePointer<fms_environment::EnvDataRefMap> env_map,
                path_type cifp_path,
-               path_type fpl_path) : arpt_db_ptr_{arpt_db}, 
+               path_type fpl_path,
+               std::size_t n_rte_threads) : arpt_db_ptr_{arpt_db}, 
                navaid_db_ptr_{navaid_db}, awy_db_ptr_{awy_db},
                env_map_ptr_{env_map}, cifp_dir_path_{cifp_path},
-               fpl_dir_{fpl_path} {
+               fpl_dir_{fpl_path},
+               rte_pool_{std::make_unique<util::ThreadPool>(n_rte_threads)},
+               io_worker_{std::make_unique<util::IoWorker>()} {
 
   cifp_dir_path_ = cifp_path;
   fpl_dir_ = fpl_path;
@@ -77,28 +82,42 @@ FPLSys::FPLSys(util::OpaquePointer<libnav::ArptDB> arpt_db,
   nd_modes_ = std::vector<NDMode>(N_INTFCS, fms_core::NDMode::MAX);
   cdu_sel_fpl_ = std::vector<size_t>(N_INTFCS);
 
-  double_values_ = position_.get_val_pointers();
+  for (auto [name, ptr] : position_.get_val_pointers()) {
+    hot_var_keys_.push_back(name);
+    hot_var_ptrs_.push_back(ptr);
+  }
 
   update_hot_env_vars();
 }
 
 void FPLSys::set_aircraft_info(const aircraft_info_t& a_inf) noexcept {
-  std::unique_lock lk(main_mutex_);
+  MY_LOCK_EXCL(main_mutex_);
   aircraft_info_ = a_inf;
 }
 
 aircraft_info_t FPLSys::get_aircraft_info() const noexcept {
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   return aircraft_info_;
 }
 
+void FPLSys::set_awy_graph(
+    util::OpaquePointer<const AwyGraph> graph) noexcept {
+  MY_LOCK_EXCL(main_mutex_);
+  awy_graph_ptr_ = graph;
+}
+
+util::OpaquePointer<const AwyGraph> FPLSys::get_awy_graph() const noexcept {
+  MY_LOCK_SHARED(main_mutex_);
+  return awy_graph_ptr_;
+}
+
 std::size_t FPLSys::get_cnt_flplns() const noexcept { 
   return MY_ARRAY_SIZE(fpl_vec_); 
 }
 
 util::OpaquePointer<FPLSys::flightplan_type> FPLSys::get_fpln_ptr(
     std::size_t fpln_idx) const noexcept {
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   assert(fpln_idx < MY_ARRAY_SIZE(fpl_vec_));
   return util::OpaquePointer{fpl_vec_[fpln_idx]};
 }
@@ -117,8 +136,23 @@ util::OpaquePointer<libnav::NavaidDB> FPLSys::get_navaid_db_ptr() const noexcept
 
 FPLSys::path_type FPLSys::get_fpln_dir() const noexcept { return fpl_dir_; }
 
+void FPLSys::set_rte_catalog(
+    util::OpaquePointer<RteCatalog> catalog) noexcept {
+  MY_LOCK_EXCL(main_mutex_);
+  rte_catalog_ptr_ = catalog;
+}
+
+util::OpaquePointer<RteCatalog> FPLSys::get_rte_catalog() const noexcept {
+  MY_LOCK_SHARED(main_mutex_);
+  return rte_catalog_ptr_;
+}
+
+FPLSys::path_type FPLSys::get_cifp_dir() const noexcept {
+  return cifp_dir_path_;
+}
+
 std::pair<std::size_t, double> FPLSys::get_sel_leg(bool rt) const noexcept {
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   if (rt) {
     return leg_sel_cdu_r_;
   }
@@ -126,7 +160,7 @@ std::pair<std::size_t, double> FPLSys::get_sel_leg(bool rt) const noexcept {
 }
 
 void FPLSys::set_sel_leg(std::pair<std::size_t, double> val, bool rt) noexcept {
-  std::unique_lock lk(main_mutex_);
+  MY_LOCK_EXCL(main_mutex_);
   if (rt) {
     leg_sel_cdu_r_ = val;
   }
@@ -134,19 +168,19 @@ void FPLSys::set_sel_leg(std::pair<std::size_t, double> val, bool rt) noexcept {
 }
 
 bool FPLSys::get_exec() const noexcept { 
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   return execute_status_; 
 }
 
 size_t FPLSys::get_act_idx() const noexcept { 
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   return act_rte_idx_; 
 }
 
 std::vector<list_node_ref_t<fpl_seg_t>> FPLSys::get_seg_list(
   std::size_t* sz, std::size_t idx) const noexcept {
-  std::shared_lock lk(main_mutex_);
   assert(idx < fpl_datas_.size());
+  MY_LOCK_SHARED(rte_mutexes_[idx]);
 
   *sz = fpl_datas_[idx].seg_list.size();
   return fpl_datas_[idx].seg_list;
@@ -154,8 +188,8 @@ std::vector<list_node_ref_t<fpl_seg_t>> FPLSys::get_seg_list(
 
 std::vector<list_node_ref_t<leg_list_data_t>> FPLSys::get_leg_list(
   std::size_t* sz, std::size_t idx) const noexcept {
-  std::shared_lock lk(main_mutex_);
   assert(idx < N_FPL_SYS_RTES);
+  MY_LOCK_SHARED(rte_mutexes_[idx]);
 
   *sz = fpl_datas_[idx].leg_list.size();
   return fpl_datas_[idx].leg_list;
@@ -163,8 +197,8 @@ std::vector<list_node_ref_t<leg_list_data_t>> FPLSys::get_leg_list(
 
 std::size_t FPLSys::get_nd_seg(nd_leg_data_t* out, std::size_t n_max, 
   std::size_t idx) const noexcept {
-  std::shared_lock lk(main_mutex_);
   assert(idx < N_FPL_SYS_RTES);
+  MY_LOCK_SHARED(rte_mutexes_[idx]);
 
   if (fpl_datas_[idx].leg_list.size() == 0) return 0;
   std::size_t n_written = 0;
@@ -191,8 +225,8 @@ std::size_t FPLSys::get_nd_seg(nd_leg_data_t* out, std::size_t n_max,
 }
 
 int FPLSys::get_act_leg_idx(std::size_t idx) const noexcept {
-  std::shared_lock lk(main_mutex_);
   assert(idx < N_FPL_SYS_RTES);
+  MY_LOCK_SHARED(rte_mutexes_[idx]);
 
   if (fpl_datas_[idx].act_leg_idx == -1) return -1;
   return 1;
@@ -201,31 +235,31 @@ int FPLSys::get_act_leg_idx(std::size_t idx) const noexcept {
 void FPLSys::set_cdu_sel_fpl_idx(
   std::size_t src, std::size_t sd_idx) {
   assert(sd_idx < cdu_sel_fpl_.size());
-  std::unique_lock lk(main_mutex_);
+  MY_LOCK_EXCL(main_mutex_);
   cdu_sel_fpl_[sd_idx] = src;
 }
 
 std::size_t FPLSys::get_cdu_sel_fpl_idx(std::size_t sd_idx) const noexcept {
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   assert(sd_idx < cdu_sel_fpl_.size());
   return cdu_sel_fpl_[sd_idx];
 }
 
 void FPLSys::set_nd_mode(NDMode src, std::size_t sd_idx) {
-  std::unique_lock lk(main_mutex_);
+  MY_LOCK_EXCL(main_mutex_);
   assert(sd_idx < nd_modes_.size());
   nd_modes_[sd_idx] = src;
 }
 
 NDMode FPLSys::get_nd_mode(std::size_t sd_idx) const noexcept {
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   assert(sd_idx < nd_modes_.size());
   return nd_modes_[sd_idx];
 }
 
 bool FPLSys::get_ctr(geo::point* out, std::size_t sd_idx) const noexcept {
-  std::shared_lock lk(main_mutex_);
-  std::size_t idx = cdu_sel_fpl_[sd_idx];
+  std::size_t idx = get_cdu_sel_fpl_idx(sd_idx);
+  MY_LOCK_SHARED(rte_mutexes_[idx]);
   std::size_t curr_idx = fpl_datas_[idx].map_ctr_idx[sd_idx];
 
   if (curr_idx + 1 < fpl_datas_[idx].leg_list.size()) {
@@ -241,18 +275,19 @@ bool FPLSys::get_ctr(geo::point* out, std::size_t sd_idx) const noexcept {
 }
 
 double FPLSys::get_rte_id(std::size_t sd_idx) const noexcept {
-  std::shared_lock lk(main_mutex_);
+  assert(sd_idx < N_FPL_SYS_RTES);
+  MY_LOCK_SHARED(rte_mutexes_[sd_idx]);
   return rte_ids_[sd_idx];
 }
 
 geo::point FPLSys::get_ac_pos() const noexcept {
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   return {position_.ac_lat_deg * geo::DEG_TO_RAD, 
     position_.ac_lon_deg * geo::DEG_TO_RAD};
 }
 
 hdg_info_t FPLSys::get_hdg_info() const noexcept {
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   hdg_info_t out = {};
   out.brng_tru_rad = position_.ac_brng_deg * geo::DEG_TO_RAD;
   out.slip_rad = position_.ac_slip_deg * geo::DEG_TO_RAD;
@@ -261,7 +296,7 @@ hdg_info_t FPLSys::get_hdg_info() const noexcept {
 }
 
 spd_info_t FPLSys::get_spd_info() const noexcept {
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   spd_info_t out = {};
   out.gs_kts = position_.ac_gs_kts;
   out.tas_kts = position_.ac_tas_kts;
@@ -270,8 +305,9 @@ spd_info_t FPLSys::get_spd_info() const noexcept {
 }
 
 act_leg_info_t FPLSys::get_act_leg_info(std::size_t idx) const noexcept {
-  std::shared_lock lk(main_mutex_);
   assert(idx < N_FPL_SYS_RTES);
+  geo::point curr_pos = get_ac_pos();
+  MY_LOCK_SHARED(rte_mutexes_[idx]);
 
   act_leg_info_t out = {};
   out.dist_nm = "----";
@@ -280,8 +316,6 @@ act_leg_info_t FPLSys::get_act_leg_info(std::size_t idx) const noexcept {
   if (fpl_datas_[idx].act_leg_idx != -1) {
     leg_seg_t act_seg =
         fpl_datas_[idx].leg_list[fpl_datas_[idx].act_leg_idx].data.misc_data;
-    geo::point curr_pos = {position_.ac_lat_deg * geo::DEG_TO_RAD,
-                           position_.ac_lon_deg * geo::DEG_TO_RAD};
 
     out.name = act_seg.calc_wpt.id;
     out.dist_sz = DIST_FONT_SZ_DD;
@@ -302,7 +336,8 @@ act_leg_info_t FPLSys::get_act_leg_info(std::size_t idx) const noexcept {
 }
 
 fpln_info_t FPLSys::get_fpl_info(size_t idx) const noexcept {
-  std::shared_lock lk(main_mutex_);
+  assert(idx < N_FPL_SYS_RTES);
+  MY_LOCK_SHARED(rte_mutexes_[idx]);
   fpln_info_t out;
   out.leg_list_id = fpl_datas_[idx].leg_list_id;
   out.seg_list_id = fpl_datas_[idx].seg_list_id;
@@ -317,8 +352,8 @@ fpln_info_t FPLSys::get_fpl_info(size_t idx) const noexcept {
 }
 
 void FPLSys::step_ctr(bool bwd, std::size_t sd_idx) {
-  std::unique_lock lk(main_mutex_);
-  std::size_t idx = cdu_sel_fpl_[sd_idx];
+  std::size_t idx = get_cdu_sel_fpl_idx(sd_idx);
+  MY_LOCK_EXCL(rte_mutexes_[idx]);
   if (!fpl_datas_[idx].leg_list.size()) return;
 
   std::size_t* curr_idx = &fpl_datas_[idx].map_ctr_idx[sd_idx];
@@ -357,8 +392,8 @@ void FPLSys::step_ctr(bool bwd, std::size_t sd_idx) {
 }
 
 void FPLSys::reset_ctr(std::size_t sd_idx) {
-  std::unique_lock lk(main_mutex_);
-  std::size_t idx = cdu_sel_fpl_[sd_idx];
+  std::size_t idx = get_cdu_sel_fpl_idx(sd_idx);
+  MY_LOCK_EXCL(rte_mutexes_[idx]);
   if (!fpl_datas_[idx].leg_list.size()) return;
 
   std::size_t* curr_idx = &fpl_datas_[idx].map_ctr_idx[sd_idx];
@@ -372,20 +407,23 @@ void FPLSys::reset_ctr(std::size_t sd_idx) {
 
 void FPLSys::rte_activate(size_t idx) {
   assert(idx && idx < N_FPL_SYS_RTES);
-  std::unique_lock lk(main_mutex_);
+  MY_LOCK_EXCL(main_mutex_);
   if (!fpl_vec_[idx]->can_activate()) return;
   act_rte_idx_ = idx;
 }
 
-void FPLSys::set_flt_nbr(std::string str) { flight_ident_ = str; }
+void FPLSys::set_flt_nbr(std::string str) {
+  MY_LOCK_EXCL(main_mutex_);
+  flight_ident_ = str;
+}
 
 std::string FPLSys::get_flt_nbr() const noexcept { 
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   return flight_ident_; 
 }
 
 RTECopySts FPLSys::act_can_copy() const noexcept {
-  std::shared_lock lk(main_mutex_);
+  MY_LOCK_SHARED(main_mutex_);
   if (act_rte_idx_ != N_FPL_SYS_RTES && !execute_status_) {
     double id1 = fpl_vec_[RTE1_IDX]->get_id();
     double id2 = fpl_vec_[RTE2_IDX]->get_id();
@@ -396,7 +434,7 @@ RTECopySts FPLSys::act_can_copy() const noexcept {
 }
 
 void FPLSys::copy_act() {
-  std::unique_lock lk(main_mutex_);
+  MY_LOCK_EXCL(main_mutex_);
   if (act_rte_idx_ != N_FPL_SYS_RTES && !execute_status_) {
     size_t tgt_idx = RTE2_IDX;
     if (act_rte_idx_ == RTE2_IDX) tgt_idx = RTE1_IDX;
@@ -410,7 +448,7 @@ void FPLSys::copy_act() {
 }
 
 void FPLSys::execute() {
-  std::unique_lock lk(main_mutex_);
+  MY_LOCK_EXCL(main_mutex_);
   if (execute_status_) {
     fpl_vec_[0]->copy_from_other(*fpl_vec_[act_rte_idx_]);
     execute_status_ = false;
@@ -419,7 +457,7 @@ void FPLSys::execute() {
 }
 
 void FPLSys::erase() {
-  std::unique_lock lk(main_mutex_);
+  MY_LOCK_EXCL(main_mutex_);
   if (execute_status_) {
     execute_status_ = false;
     if (act_rte_id_ == -1) {
@@ -431,10 +469,74 @@ void FPLSys::erase() {
   }
 }
 
+bool FPLSys::save_fpln_async(std::size_t idx, const std::string& file_nm,
+                             save_done_fn_t done) {
+  // Only the snapshot is taken under the route lock
+  std::string data = get_fpln_ptr(idx)->get_fms_str();
+  if (data == "") {
+    return false;
+  }
+  // Routes saved to the flight plan directory go into the catalog right
+  // away, without waiting for the directory watcher.
+  std::string rte_nm =
+      file_nm.substr(file_nm.rfind(fpl_dir_.GetSeparator()) + 1);
+  RteCatalog* catalog = nullptr;
+  if ((fpl_dir_ + rte_nm).Get() == file_nm) {
+    catalog = get_rte_catalog().get();
+  }
+  io_worker_->Post([path = file_nm + DFMS_FILE_POSTFIX, data = std::move(data),
+                    rte_nm = std::move(rte_nm), catalog,
+                    done = std::move(done)]() {
+    bool saved = util::WriteFileAtomic(path, data);
+    if (saved && catalog != nullptr) {
+      catalog->Update(rte_nm);
+    }
+    if (done) {
+      done(saved);
+    }
+  });
+  return true;
+}
+
+bool FPLSys::start_shm_export(const std::string& name) {
+  auto shm_export = std::make_unique<ShmExport>(name);
+  if (!shm_export->Open()) {
+    return false;
+  }
+  MY_LOCK_EXCL(main_mutex_);
+  shm_export_ = std::move(shm_export);
+  shm_rte_id_ = -1;
+  return true;
+}
+
+void FPLSys::set_export_nd_config(const shm_nd_global_t& glob,
+  const shm_nd_local_t (&loc)[SHM_EXPORT_N_ND]) noexcept {
+  MY_LOCK_EXCL(main_mutex_);
+  shm_nd_global_ = glob;
+  std::copy(loc, loc + SHM_EXPORT_N_ND, shm_nd_local_);
+}
+
 void FPLSys::update() {
-  std::unique_lock lk(main_mutex_);
-  update_hot_env_vars();
-  update_flight_plans();
+  MY_TRACE_SCOPE("FPLSys::update");
+  MY_ALLOC_SCOPE("FPLSys::update");
+  double slip_rad;
+  {
+    MY_LOCK_EXCL(main_mutex_);
+    update_hot_env_vars();
+    // Done under the lock, so that execute, erase and rte_activate can't
+    // change the active route in between.
+    update_act_status();
+    slip_rad = position_.ac_slip_deg * geo::DEG_TO_RAD;
+  }
+  // Routes are recomputed in parallel without holding main_mutex_. Each one
+  // only locks its own state while the new lists are swapped in.
+  update_flight_plans(slip_rad);
+
+  MY_LOCK_EXCL(main_mutex_);
+  update_sys_state();
+  if (shm_export_) {
+    update_shm_export();
+  }
 }
 
 FPLSys::~FPLSys() {
@@ -458,20 +560,35 @@ std::unordered_map<FPLSys::pos_data_t::str_type, double*>
   return res;
 }
 
-void FPLSys::update_flight_plans() noexcept {
-  for (size_t i = 0; i < N_FPL_SYS_RTES; i++) {
+void FPLSys::update_act_status() noexcept {
+  if (execute_status_) {
+    return;
+  }
+  for (std::size_t i = 0; i < N_FPL_SYS_RTES; i++) {
     bool cr_is_act = fpl_vec_[i]->is_active();
-    if (!execute_status_) {
-      if ((i == act_rte_idx_ || i == 0) && !cr_is_act)
-        fpl_vec_[i]->activate();
-      else if ((i != act_rte_idx_ && i) && cr_is_act)
-        fpl_vec_[i]->deactivate();
-    }
-    fpl_vec_[i]->update(position_.ac_slip_deg * geo::DEG_TO_RAD);
-    update_lists(i);
+    if ((i == act_rte_idx_ || i == 0) && !cr_is_act)
+      fpl_vec_[i]->activate();
+    else if ((i != act_rte_idx_ && i) && cr_is_act)
+      fpl_vec_[i]->deactivate();
+  }
+}
+
+void FPLSys::update_flight_plans(double slip_rad) noexcept {
+  rte_pool_->ParallelFor(N_FPL_SYS_RTES, [&](std::size_t i) {
+    update_route(i, slip_rad);
+  });
+}
 
+void FPLSys::update_route(std::size_t idx, double slip_rad) noexcept {
+  assert(idx < N_FPL_SYS_RTES);
+
+  fpl_vec_[idx]->update(slip_rad);
+  update_lists(idx);
+}
+
+void FPLSys::update_sys_state() noexcept {
+  for (size_t i = 0; i < N_FPL_SYS_RTES; i++) {
     update_flt_nbr(i);
-    rte_ids_[i] = fpl_vec_[i]->get_id();
   }
 
   if (act_rte_idx_ < N_FPL_SYS_RTES &&
@@ -486,39 +603,104 @@ void FPLSys::update_flight_plans() noexcept {
   }
 }
 
-void FPLSys::update_seg_list(std::size_t idx) {
-  assert(idx < N_FPL_SYS_RTES);
-
-  std::size_t sz = fpl_vec_[idx]->get_seg_list_sz();
-  fpl_datas_[idx].seg_list_id =
-      fpl_vec_[idx]->get_sl_seg(0, sz, &fpl_datas_[idx].seg_list);
-}
-
-void FPLSys::update_leg_list(std::size_t idx) {
-  assert(idx < N_FPL_SYS_RTES);
-
-  size_t sz = fpl_vec_[idx]->get_leg_list_sz();
-  fpl_datas_[idx].leg_list_id = fpl_vec_[idx]->get_ll_seg(
-      0, sz, &fpl_datas_[idx].leg_list, &fpl_datas_[idx].act_leg_idx);
-
-  for(std::size_t i = 0; i < N_INTFCS; ++i) {
-    if (fpl_datas_[idx].map_ctr_idx[i] >= fpl_datas_[idx].leg_list.size() &&
-        fpl_datas_[idx].leg_list.size() != 0) {
-      fpl_datas_[idx].map_ctr_idx[i] = fpl_datas_[idx].leg_list.size() - 1;
+void FPLSys::update_shm_export() noexcept {
+  static_assert(SHM_EXPORT_N_ND == N_INTFCS);
+  static_assert(N_FPL_SYS_RTES <= 8, "Runway masks are 8 bits wide");
+
+  // Locked before the write starts, so that readers don't retry while
+  // this waits for the route.
+  MY_LOCK_SHARED(rte_mutexes_[ACT_RTE_IDX]);
+  const fpln_data_t& data = fpl_datas_[ACT_RTE_IDX];
+  double rte_id = rte_ids_[ACT_RTE_IDX];
+
+  shm_export_t* out = shm_export_->BeginWrite();
+  out->ac_state = {position_.ac_lat_deg, position_.ac_lon_deg,
+                   position_.ac_brng_deg, position_.ac_slip_deg,
+                   position_.ac_magvar_deg, position_.ac_gs_kts,
+                   position_.ac_tas_kts};
+  out->nd_global = shm_nd_global_;
+  std::copy(shm_nd_local_, shm_nd_local_ + SHM_EXPORT_N_ND, out->nd_local);
+
+  // The legs only change along with the route id. The first and the last
+  // entries of the leg list aren't legs, so they're left out.
+  if (rte_id != shm_rte_id_) {
+    std::size_t n_legs = 0;
+    for (std::size_t i = 1; i + 1 < data.leg_list.size(); i++) {
+      if (n_legs == SHM_EXPORT_N_LEGS_MAX) {
+        break;
+      }
+      const leg_list_data_t& leg = data.leg_list[i].data;
+      const leg_seg_t& seg = leg.misc_data;
+      shm_leg_t& curr = out->legs[n_legs++];
+      curr.start_lat_rad = seg.start.lat_rad;
+      curr.start_lon_rad = seg.start.lon_rad;
+      curr.end_lat_rad = seg.end.lat_rad;
+      curr.end_lon_rad = seg.end.lon_rad;
+      curr.arc_ctr_lat_rad = leg.leg.center_fix.data.pos.lat_rad;
+      curr.arc_ctr_lon_rad = leg.leg.center_fix.data.pos.lon_rad;
+      curr.turn_rad_nm = seg.turn_rad_nm;
+      curr.true_trk_deg = seg.true_trk_deg;
+      auto flag = [](bool is_set, ShmLegFlags f) {
+        return is_set ? std::uint32_t(f) : 0u;
+      };
+      curr.flags = flag(seg.is_arc, SHM_LEG_IS_ARC) |
+                   flag(seg.is_finite, SHM_LEG_IS_FINITE) |
+                   flag(seg.is_rwy, SHM_LEG_IS_RWY) |
+                   flag(seg.is_bypassed, SHM_LEG_IS_BYPASSED) |
+                   flag(seg.is_to_inhibited, SHM_LEG_IS_TO_INHIBITED) |
+                   flag(seg.has_disc, SHM_LEG_HAS_DISC) |
+                   flag(leg.is_discon, SHM_LEG_IS_DISCON);
+    }
+    out->n_legs = std::uint32_t(n_legs);
+    out->n_legs_total = data.leg_list.size() > 2 ?
+      std::uint32_t(data.leg_list.size() - 2) : 0;
+    out->act_leg_idx = -1;
+    if (data.act_leg_idx > 0 && std::size_t(data.act_leg_idx) <= n_legs) {
+      out->act_leg_idx = data.act_leg_idx - 1;
     }
+    out->rte_id = rte_id;
+    shm_rte_id_ = rte_id;
   }
+  shm_export_->EndWrite();
 }
 
 void FPLSys::update_lists(std::size_t idx) {
   assert(idx < N_FPL_SYS_RTES);
 
+  // fpl_id_last is only written here and calls to update don't overlap, so
+  // reading it doesn't need the lock.
   double fpl_id_curr = fpl_vec_[idx]->get_id();
-  if (fpl_id_curr != fpl_datas_[idx].fpl_id_last) {
-    update_seg_list(idx);
-    update_leg_list(idx);
+  if (fpl_id_curr == fpl_datas_[idx].fpl_id_last) {
+    return;
   }
 
-  fpl_datas_[idx].fpl_id_last = fpl_id_curr;
+  // The lists are copied out of the flight plan first, so that readers of
+  // this route only wait for the swap.
+  std::vector<list_node_ref_t<fpl_seg_t>> seg_list;
+  std::vector<list_node_ref_t<leg_list_data_t>> leg_list;
+  int act_leg_idx = -1;
+  std::size_t seg_sz = fpl_vec_[idx]->get_seg_list_sz();
+  double seg_list_id = fpl_vec_[idx]->get_sl_seg(0, seg_sz, &seg_list);
+  std::size_t leg_sz = fpl_vec_[idx]->get_leg_list_sz();
+  double leg_list_id = fpl_vec_[idx]->get_ll_seg(0, leg_sz, &leg_list,
+                                                 &act_leg_idx);
+
+  MY_LOCK_EXCL(rte_mutexes_[idx]);
+  fpln_data_t& data = fpl_datas_[idx];
+  data.seg_list.swap(seg_list);
+  data.seg_list_id = seg_list_id;
+  data.leg_list.swap(leg_list);
+  data.leg_list_id = leg_list_id;
+  data.act_leg_idx = act_leg_idx;
+
+  for(std::size_t i = 0; i < N_INTFCS; ++i) {
+    if (data.map_ctr_idx[i] >= data.leg_list.size() &&
+        data.leg_list.size() != 0) {
+      data.map_ctr_idx[i] = data.leg_list.size() - 1;
+    }
+  }
+  data.fpl_id_last = fpl_id_curr;
+  rte_ids_[idx] = fpl_id_curr;
 }
 
 void FPLSys::update_flt_nbr(size_t idx) {
@@ -533,11 +715,9 @@ void FPLSys::update_flt_nbr(size_t idx) {
 }
 
 void FPLSys::update_hot_env_vars() {
-  for(auto [name, ptr]: double_values_) {
-    auto resp = env_map_ptr_->Get<double>(name);
-    if(resp) {
-      *ptr = *resp;
-    }
-  }
+  // The state bridge sets a whole packet with SetBatch, so the variables
+  // are read under one lock as well.
+  env_map_ptr_->GetBatch(hot_var_keys_.data(), hot_var_ptrs_.data(),
+                         hot_var_keys_.size());
 }
 }  // namespace test
@@ -14,16 +14,24 @@
 
 #pragma once
 
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <shared_mutex>
 #include <string>
 #include <unordered_map>
 
+#include "awy_graph.hpp"
 #include "environment.hpp"
 #include "fpln_main.hpp"
+#include "rte_catalog.hpp"
+#include "shm_export.hpp"
+#include <util/instr_mutex.hpp>
+#include <util/io_worker.hpp>
 #include <util/pathlib.hpp>
+#include <util/thread_pool.hpp>
 #include <util/util.hpp>
 
 namespace fms_core {
@@ -39,6 +47,8 @@ constexpr size_t N_FPL_SYS_RTES = 3;
 constexpr size_t ACT_RTE_IDX = 0;
 constexpr size_t RTE1_IDX = 1;
 constexpr size_t RTE2_IDX = 2;
+// The caller of FPLSys::update recomputes one of the routes itself
+constexpr size_t N_DFLT_RTE_THREADS = N_FPL_SYS_RTES - 1;
 constexpr size_t N_INTFCS = 2;  // Number of interfaces(interface is a CDU+ND)
 
 constexpr double DIST_FONT_SZ_DD = 21;  // Double digits;
@@ -82,18 +92,26 @@ class FPLSys final {
  public:
   using path_type = pathlib::Path;
   using flightplan_type = FlightPlan;
+  using save_done_fn_t = std::function<void(bool)>;
 
   FPLSys(util::OpaquePointer<libnav::ArptDB> arpt_db,
          util::OpaquePointer<libnav::NavaidDB> navaid_db,
          util::OpaquePointer<libnav::AwyDB> awy_db, 
          util::OpaquePointer<fms_environment::EnvDataRefMap> env_map,
          path_type cifp_path,
-         path_type fpl_path);
+         path_type fpl_path,
+         std::size_t n_rte_threads = N_DFLT_RTE_THREADS);
 
   void set_aircraft_info(const aircraft_info_t& a_inf) noexcept;
 
   aircraft_info_t get_aircraft_info() const noexcept;
 
+  // The graph is owned by the caller and must outlive this object
+  void set_awy_graph(util::OpaquePointer<const AwyGraph> graph) noexcept;
+
+  // Null until set_awy_graph is called
+  util::OpaquePointer<const AwyGraph> get_awy_graph() const noexcept;
+
   std::size_t get_cnt_flplns() const noexcept;
 
   util::OpaquePointer<flightplan_type> get_fpln_ptr(std::size_t fpln_idx) const noexcept;
@@ -106,6 +124,16 @@ class FPLSys final {
 
   path_type get_fpln_dir() const noexcept;
 
+  // The catalog is owned by the caller and must outlive this object. One
+  // catalog is meant to be shared by everyone using the same directory.
+  void set_rte_catalog(util::OpaquePointer<RteCatalog> catalog) noexcept;
+
+  // Index of the company routes in the flight plan directory. Null until
+  // set_rte_catalog is called.
+  util::OpaquePointer<RteCatalog> get_rte_catalog() const noexcept;
+
+  path_type get_cifp_dir() const noexcept;
+
   std::pair<std::size_t, double> get_sel_leg(bool rt) const noexcept;
 
   void set_sel_leg(std::pair<std::size_t, double> val, bool rt) noexcept;
@@ -165,6 +193,23 @@ class FPLSys final {
 
   void erase();
 
+  // Takes a snapshot of route idx in .fms format and writes it to file_nm
+  // on the I/O worker, so the caller never waits for the disk. done is
+  // called on the worker thread once the file was replaced or the write
+  // failed. Returns false if the route has no airports, nothing is written
+  // then.
+  bool save_fpln_async(std::size_t idx, const std::string& file_nm,
+                       save_done_fn_t done);
+
+  // Exports the active route, the aircraft state and the ND configuration
+  // to the shared memory segment called name on every update. Returns false
+  // if the segment couldn't be created.
+  bool start_shm_export(const std::string& name);
+
+  // ND configuration that is exported by the next update
+  void set_export_nd_config(const shm_nd_global_t& glob,
+    const shm_nd_local_t (&loc)[SHM_EXPORT_N_ND]) noexcept;
+
   void update();
 
   ~FPLSys();
@@ -189,12 +234,17 @@ class FPLSys final {
 
   aircraft_info_t aircraft_info_;
 
-  std::unordered_map<fms_environment::val_ref_t, double*> double_values_;
+  // Variables read from the environment on every update, along with
+  // where they're stored
+  std::vector<fms_environment::val_ref_t> hot_var_keys_;
+  std::vector<double*> hot_var_ptrs_;
 
   util::OpaquePointer<libnav::ArptDB> arpt_db_ptr_;
   util::OpaquePointer<libnav::NavaidDB> navaid_db_ptr_;
   util::OpaquePointer<libnav::AwyDB> awy_db_ptr_;
   util::OpaquePointer<fms_environment::EnvDataRefMap> env_map_ptr_;
+  util::OpaquePointer<const AwyGraph> awy_graph_ptr_;
+  util::OpaquePointer<RteCatalog> rte_catalog_ptr_;
 
   flightplan_type* fpl_vec_[N_FPL_SYS_RTES];
 
@@ -204,7 +254,16 @@ class FPLSys final {
   path_type cifp_dir_path_;
   path_type fpl_dir_;
 
-  mutable std::shared_mutex main_mutex_;
+  // main_mutex_ guards the system state. Per-route state, i.e.
+  // fpl_datas_[i] and rte_ids_[i], is guarded by rte_mutexes_[i], so that
+  // readers of one route don't wait while another one is recomputed.
+  // A route mutex may be taken while holding main_mutex_, never the other
+  // way around.
+  mutable util::InstrSharedMutex main_mutex_{"FPLSys"};
+  mutable util::InstrSharedMutex rte_mutexes_[N_FPL_SYS_RTES] = {
+      util::InstrSharedMutex{"FPLSys ACT"},
+      util::InstrSharedMutex{"FPLSys RTE1"},
+      util::InstrSharedMutex{"FPLSys RTE2"}};
 
   pos_data_t position_;
   std::vector<fpln_data_t> fpl_datas_;
@@ -221,11 +280,28 @@ class FPLSys final {
 
   bool execute_status_ = false;
 
-  void update_flight_plans() noexcept;
+  std::unique_ptr<util::ThreadPool> rte_pool_;
+
+  // Writes route files, see save_fpln_async
+  std::unique_ptr<util::IoWorker> io_worker_;
+
+  std::unique_ptr<ShmExport> shm_export_;
+  // Route id the exported legs were taken from
+  double shm_rte_id_ = -1;
+  shm_nd_global_t shm_nd_global_ = {};
+  shm_nd_local_t shm_nd_local_[SHM_EXPORT_N_ND] = {};
+
+  // Activates the active route and deactivates the others. Has to be
+  // called with main_mutex_ held.
+  void update_act_status() noexcept;
+
+  void update_flight_plans(double slip_rad) noexcept;
+
+  void update_route(std::size_t idx, double slip_rad) noexcept;
 
-  void update_seg_list(std::size_t idx = 0);
+  void update_sys_state() noexcept;
 
-  void update_leg_list(std::size_t idx = 0);
+  void update_shm_export() noexcept;
 
   void update_lists(std::size_t idx = 0);
 
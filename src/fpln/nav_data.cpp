@@ -0,0 +1,62 @@
+/*
+        This project is licensed under
+        Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+   Public License (CC BY-NC-SA 4.0).
+
+        A SUMMARY OF THIS LICENSE CAN BE FOUND HERE:
+   https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+        Author: discord/bruh4096#4512
+
+        This file contains definitions of member functions for NavData class.
+*/
+
+#include "nav_data.hpp"
+
+#include <iostream>
+#include <memory>
+
+namespace fms_core {
+
+NavData::NavData(const nav_data_paths_t& paths)
+    : arpt_db_{std::make_unique<libnav::ArptDB>(paths.apt_dat.Get(),
+                                                paths.custom_apt.Get(),
+                                                paths.custom_rnw.Get())},
+      navaid_db_{std::make_unique<libnav::NavaidDB>(paths.fix_data.Get(),
+                                                    paths.navaid_data.Get())},
+      awy_db_{std::make_unique<libnav::AwyDB>(paths.awy_data.Get())},
+      hold_db_{std::make_unique<libnav::HoldDB>(paths.hold_data.Get())},
+      awy_graph_{std::make_unique<AwyGraph>(
+          paths.awy_data,
+          util::OpaquePointer<libnav::NavaidDB>{navaid_db_.get()})},
+      cifp_dir_{paths.cifp_dir} {}
+
+void NavData::print_info() const {
+  std::cout << navaid_db_->get_wpt_cycle() << " "
+            << navaid_db_->get_navaid_cycle() << " " << awy_db_->get_airac()
+            << " " << hold_db_->get_airac() << "\n";
+
+  std::cout << "Fix data base version: " << navaid_db_->get_wpt_version()
+            << "\n";
+  std::cout << "Navaid data base version: "
+            << navaid_db_->get_navaid_version() << "\n";
+
+  if (arpt_db_->get_err() != libnav::DbErr::SUCCESS) {
+    std::cout << "Unable to load airport database\n";
+  }
+  if (navaid_db_->get_wpt_err() != libnav::DbErr::SUCCESS) {
+    std::cout << "Unable to load waypoint database\n";
+  }
+  if (navaid_db_->get_navaid_err() != libnav::DbErr::SUCCESS) {
+    std::cout << "Unable to load navaid database\n";
+  }
+  if (awy_db_->get_err() != libnav::DbErr::SUCCESS) {
+    std::cout << "Unable to load airway database\n";
+  }
+  if (hold_db_->get_err() != libnav::DbErr::SUCCESS) {
+    std::cout << "Unable to load hold database\n";
+  }
+  std::cout << "Airway graph: " << awy_graph_->GetNodeCount() << " fixes, "
+            << awy_graph_->GetEdgeCount() << " segments\n";
+}
+}  // namespace fms_core
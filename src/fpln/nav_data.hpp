@@ -0,0 +1,70 @@
+/*
+        This project is licensed under
+        Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+   Public License (CC BY-NC-SA 4.0).
+
+        A SUMMARY OF THIS LICENSE CAN BE FOUND HERE:
+   https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+        Author: discord/bruh4096#4512
+
+        This file contains declarations of the NavData class. NavData loads
+    the navigation data bases once, so that any number of FPLSys instances
+    can share them read-only.
+*/
+
+#pragma once
+
+#include <memory>
+
+#include <libnav/arpt_db.hpp>
+#include <libnav/awy_db.hpp>
+#include <libnav/hold_db.hpp>
+#include <libnav/navaid_db.hpp>
+
+#include <util/pathlib.hpp>
+
+#include "awy_graph.hpp"
+
+namespace fms_core {
+
+struct nav_data_paths_t {
+  pathlib::Path apt_dat, custom_apt, custom_rnw;
+  pathlib::Path fix_data, navaid_data, awy_data, hold_data;
+  pathlib::Path cifp_dir;
+};
+
+class NavData final {
+ public:
+  explicit NavData(const nav_data_paths_t& paths);
+
+  NavData(const NavData& other) = delete;
+
+  NavData& operator=(const NavData& other) = delete;
+
+  // Prints the AIRAC cycles and reports every data base that failed to load
+  void print_info() const;
+
+  libnav::ArptDB* get_arpt_db() const noexcept { return arpt_db_.get(); }
+
+  libnav::NavaidDB* get_navaid_db() const noexcept {
+    return navaid_db_.get();
+  }
+
+  libnav::AwyDB* get_awy_db() const noexcept { return awy_db_.get(); }
+
+  libnav::HoldDB* get_hold_db() const noexcept { return hold_db_.get(); }
+
+  const AwyGraph* get_awy_graph() const noexcept { return awy_graph_.get(); }
+
+  const pathlib::Path& get_cifp_dir() const noexcept { return cifp_dir_; }
+
+ private:
+  std::unique_ptr<libnav::ArptDB> arpt_db_;
+  std::unique_ptr<libnav::NavaidDB> navaid_db_;
+  std::unique_ptr<libnav::AwyDB> awy_db_;
+  std::unique_ptr<libnav::HoldDB> hold_db_;
+  std::unique_ptr<AwyGraph> awy_graph_;  // Built from awy_data
+  pathlib::Path cifp_dir_;
+};
+}  // namespace fms_core
@@ -0,0 +1,279 @@
+/*
+        This project is licensed under
+        Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+   Public License (CC BY-NC-SA 4.0).
+
+        A SUMMARY OF THIS LICENSE CAN BE FOUND HERE:
+   https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+        Author: discord/bruh4096#4512
+
+        This file contains definitions of member functions for RteCatalog
+    class.
+*/
+
+#include "rte_catalog.hpp"
+
+#ifdef __linux__
+#include <errno.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <cstdint>
+#include <filesystem>
+#include <system_error>
+#include <unordered_set>
+#include <utility>
+
+#include <util/mapped_file.hpp>
+#include <util/trace.hpp>
+
+#include "flightpln_int.hpp"
+
+namespace fms_core {
+
+namespace {
+
+// Returns the name of the route if file_nm is a .fms file, "" otherwise
+std::string get_rte_name(const std::string& file_nm) {
+  std::size_t sz = DFMS_FILE_POSTFIX.size();
+  if (file_nm.size() <= sz ||
+      file_nm.compare(file_nm.size() - sz, sz, DFMS_FILE_POSTFIX) != 0) {
+    return "";
+  }
+  return file_nm.substr(0, file_nm.size() - sz);
+}
+
+#ifdef __linux__
+constexpr std::uint32_t INOTIFY_MASK = IN_CLOSE_WRITE | IN_MOVED_TO |
+                                       IN_DELETE | IN_MOVED_FROM |
+                                       IN_DELETE_SELF | IN_MOVE_SELF |
+                                       IN_ONLYDIR;
+constexpr std::size_t INOTIFY_BUF_SZ = 4096;
+#endif
+}  // namespace
+
+RteCatalog::RteCatalog(pathlib::Path fpl_dir) : fpl_dir_{std::move(fpl_dir)} {
+#ifdef __linux__
+  // The watch is added before the scan, so files written during the scan
+  // aren't missed.
+  inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotify_fd_ >= 0 &&
+      inotify_add_watch(inotify_fd_, fpl_dir_.Get().c_str(), INOTIFY_MASK) <
+          0) {
+    close(inotify_fd_);
+    inotify_fd_ = -1;
+  }
+  if (inotify_fd_ >= 0) {
+    stop_fd_ = eventfd(0, EFD_CLOEXEC);
+  }
+#endif
+  thread_ = std::thread(&RteCatalog::watcher_main, this);
+}
+
+bool RteCatalog::IsReady() const noexcept {
+  return is_ready_.load(std::memory_order_acquire);
+}
+
+std::size_t RteCatalog::GetSize() const {
+  MY_LOCK_SHARED(mtx_);
+  return entries_.size();
+}
+
+std::optional<rte_catalog_entry_t> RteCatalog::Find(
+    const std::string& name) const {
+  MY_LOCK_SHARED(mtx_);
+  auto it = entries_.find(name);
+  if (it == entries_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+std::vector<rte_catalog_entry_t> RteCatalog::FindByCityPair(
+    const std::string& dep_icao, const std::string& arr_icao) const {
+  std::vector<rte_catalog_entry_t> out;
+  MY_LOCK_SHARED(mtx_);
+  auto it = city_pairs_.find(dep_icao + arr_icao);
+  if (it == city_pairs_.end()) {
+    return out;
+  }
+  out.reserve(it->second.size());
+  for (const auto& i : it->second) {
+    out.push_back(entries_.at(i));
+  }
+  return out;
+}
+
+std::vector<rte_catalog_entry_t> RteCatalog::FindByPrefix(
+    const std::string& prefix) const {
+  std::vector<rte_catalog_entry_t> out;
+  MY_LOCK_SHARED(mtx_);
+  for (auto it = entries_.lower_bound(prefix);
+       it != entries_.end() && it->first.compare(0, prefix.size(), prefix) == 0;
+       it++) {
+    out.push_back(it->second);
+  }
+  return out;
+}
+
+bool RteCatalog::Update(const std::string& name) {
+  rte_catalog_entry_t entry;
+  entry.name = name;
+  dfms_summary_t summary;
+  util::MappedFile file;
+  bool is_valid = file.Open((fpl_dir_ + (name + DFMS_FILE_POSTFIX)).Get()) &&
+                  read_dfms_summary(file.GetView(), &summary);
+  file.Close();
+
+  MY_LOCK_EXCL(mtx_);
+  remove_locked(name);
+  if (is_valid) {
+    entry.dep_icao = std::move(summary.dep_icao);
+    entry.arr_icao = std::move(summary.arr_icao);
+    entry.n_wpts = summary.n_wpts;
+    entry.airac_cycle = summary.airac_cycle;
+    insert_locked(std::move(entry));
+  }
+  return is_valid;
+}
+
+void RteCatalog::Remove(const std::string& name) {
+  MY_LOCK_EXCL(mtx_);
+  remove_locked(name);
+}
+
+RteCatalog::~RteCatalog() {
+#ifdef __linux__
+  if (stop_fd_ >= 0) {
+    std::uint64_t val = 1;
+    [[maybe_unused]] ssize_t n = write(stop_fd_, &val, sizeof(val));
+  }
+#endif
+  thread_.join();
+#ifdef __linux__
+  if (stop_fd_ >= 0) {
+    close(stop_fd_);
+  }
+  if (inotify_fd_ >= 0) {
+    close(inotify_fd_);
+  }
+#endif
+}
+
+// Private functions:
+
+void RteCatalog::watcher_main() {
+  scan_dir();
+  is_ready_.store(true, std::memory_order_release);
+
+#ifdef __linux__
+  if (inotify_fd_ < 0 || stop_fd_ < 0) {
+    return;
+  }
+  pollfd fds[2] = {{inotify_fd_, POLLIN, 0}, {stop_fd_, POLLIN, 0}};
+  while (true) {
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+    if (fds[1].revents) {
+      return;
+    }
+    if (fds[0].revents && !read_events()) {
+      return;
+    }
+  }
+#endif
+}
+
+void RteCatalog::scan_dir() {
+  MY_TRACE_SCOPE("RteCatalog::scan_dir");
+  std::vector<std::string> names;
+  std::error_code ec;
+  for (const auto& i :
+       std::filesystem::directory_iterator(fpl_dir_.Get(), ec)) {
+    std::string name = get_rte_name(i.path().filename().string());
+    if (name != "" && i.is_regular_file(ec)) {
+      names.push_back(std::move(name));
+    }
+  }
+
+  // Drops files that were removed while events were lost
+  std::unordered_set<std::string> found(names.begin(), names.end());
+  {
+    MY_LOCK_EXCL(mtx_);
+    for (auto it = entries_.begin(); it != entries_.end();) {
+      auto curr = it++;
+      if (!found.count(curr->first)) {
+        remove_locked(curr->first);
+      }
+    }
+  }
+
+  for (const auto& i : names) {
+    Update(i);
+  }
+}
+
+bool RteCatalog::read_events() {
+#ifdef __linux__
+  alignas(inotify_event) char buf[INOTIFY_BUF_SZ];
+  while (true) {
+    ssize_t len = read(inotify_fd_, buf, sizeof(buf));
+    if (len < 0) {
+      return errno == EAGAIN || errno == EINTR;
+    }
+    for (ssize_t i = 0; i < len;) {
+      const inotify_event* ev = reinterpret_cast<const inotify_event*>(buf + i);
+      i += ssize_t(sizeof(inotify_event) + ev->len);
+
+      if (ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+        return false;
+      }
+      if (ev->mask & IN_Q_OVERFLOW) {
+        scan_dir();
+        continue;
+      }
+      std::string name = ev->len ? get_rte_name(ev->name) : "";
+      if (name == "") {
+        continue;
+      }
+      if (ev->mask & (IN_DELETE | IN_MOVED_FROM)) {
+        Remove(name);
+      } else {
+        Update(name);
+      }
+    }
+  }
+#else
+  return false;
+#endif
+}
+
+void RteCatalog::insert_locked(rte_catalog_entry_t entry) {
+  std::string name = entry.name;
+  city_pairs_[entry.dep_icao + entry.arr_icao].insert(name);
+  entries_.emplace(std::move(name), std::move(entry));
+}
+
+void RteCatalog::remove_locked(const std::string& name) {
+  auto it = entries_.find(name);
+  if (it == entries_.end()) {
+    return;
+  }
+  auto pair_it = city_pairs_.find(it->second.dep_icao + it->second.arr_icao);
+  if (pair_it != city_pairs_.end()) {
+    pair_it->second.erase(name);
+    if (pair_it->second.empty()) {
+      city_pairs_.erase(pair_it);
+    }
+  }
+  entries_.erase(it);
+}
+}  // namespace fms_core
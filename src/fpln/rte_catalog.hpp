@@ -0,0 +1,100 @@
+/*
+        This project is licensed under
+        Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+   Public License (CC BY-NC-SA 4.0).
+
+        A SUMMARY OF THIS LICENSE CAN BE FOUND HERE:
+   https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+        Author: discord/bruh4096#4512
+
+        This file contains declarations of the RteCatalog class. It keeps an
+    index of the company routes(.fms files) in the flight plan directory, so
+    that routes can be looked up by city pair or by name without going to the
+    disk.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <util/instr_mutex.hpp>
+#include <util/pathlib.hpp>
+
+namespace fms_core {
+
+struct rte_catalog_entry_t {
+  std::string name;  // File name without the .fms extension
+  std::string dep_icao, arr_icao;
+  std::size_t n_wpts = 0;
+  int airac_cycle = 0;
+};
+
+class RteCatalog final {
+ public:
+  // Starts a thread that scans fpl_dir and then watches it for changes.
+  // Watching is only done on linux, elsewhere the catalog only changes
+  // through Update and Remove.
+  explicit RteCatalog(pathlib::Path fpl_dir);
+
+  RteCatalog(const RteCatalog& other) = delete;
+
+  RteCatalog& operator=(const RteCatalog& other) = delete;
+
+  // False until the first scan is done. Queries made before that only see
+  // the files that were scanned so far.
+  bool IsReady() const noexcept;
+
+  std::size_t GetSize() const;
+
+  std::optional<rte_catalog_entry_t> Find(const std::string& name) const;
+
+  // Both return entries sorted by name
+  std::vector<rte_catalog_entry_t> FindByCityPair(
+      const std::string& dep_icao, const std::string& arr_icao) const;
+
+  std::vector<rte_catalog_entry_t> FindByPrefix(
+      const std::string& prefix) const;
+
+  // Reads the header of fpl_dir/name.fms again. The entry is removed if the
+  // file can't be read. Returns true if it could.
+  bool Update(const std::string& name);
+
+  void Remove(const std::string& name);
+
+  ~RteCatalog();
+
+ private:
+  pathlib::Path fpl_dir_;
+
+  mutable util::InstrSharedMutex mtx_{"RteCatalog"};
+  std::map<std::string, rte_catalog_entry_t> entries_;  // By name
+  // dep icao + arr icao -> names
+  std::unordered_map<std::string, std::set<std::string>> city_pairs_;
+
+  std::atomic<bool> is_ready_{false};
+  int inotify_fd_ = -1;
+  int stop_fd_ = -1;  // Written to by the destructor to wake the watcher
+  std::thread thread_;
+
+  void watcher_main();
+
+  void scan_dir();
+
+  // Handles the inotify events that are queued. Returns false if the
+  // watch is gone.
+  bool read_events();
+
+  void insert_locked(rte_catalog_entry_t entry);
+
+  void remove_locked(const std::string& name);
+};
+}  // namespace fms_core
@@ -0,0 +1,92 @@
+/*
+        This project is licensed under
+        Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+   Public License (CC BY-NC-SA 4.0).
+
+        A SUMMARY OF THIS LICENSE CAN BE FOUND HERE:
+   https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+        Author: discord/bruh4096#4512
+
+        This file contains definitions of member functions for ShmExport
+    class.
+*/
+
+#include "shm_export.hpp"
+
+#include <cassert>
+#include <new>
+#include <utility>
+
+namespace fms_core {
+
+ShmExport::ShmExport(std::string name) : name_{std::move(name)} {}
+
+bool ShmExport::Open() {
+  if (data_ != nullptr) {
+    return true;
+  }
+#ifdef _WIN32
+  return false;
+#else
+  // A segment left behind by a previous run may have an older layout
+  shm_unlink(name_.c_str());
+  int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR,
+                    S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+  if (fd < 0) {
+    return false;
+  }
+  if (ftruncate(fd, sizeof(shm_export_t)) != 0) {
+    close(fd);
+    shm_unlink(name_.c_str());
+    return false;
+  }
+  void* ptr = mmap(nullptr, sizeof(shm_export_t), PROT_READ | PROT_WRITE,
+                   MAP_SHARED, fd, 0);
+  close(fd);
+  if (ptr == MAP_FAILED) {
+    shm_unlink(name_.c_str());
+    return false;
+  }
+
+  // magic is written last: readers check it before anything else
+  data_ = new (ptr) shm_export_t{};
+  data_->version = SHM_EXPORT_VERSION;
+  data_->act_leg_idx = -1;
+  data_->seq.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  data_->magic = SHM_EXPORT_MAGIC;
+  return true;
+#endif
+}
+
+shm_export_t* ShmExport::BeginWrite() noexcept {
+  assert(data_ != nullptr);
+  std::uint64_t seq = data_->seq.load(std::memory_order_relaxed);
+  assert(!(seq & 1));
+  data_->seq.store(seq + 1, std::memory_order_relaxed);
+  // Keeps the stores to the segment from moving above the odd seq
+  std::atomic_thread_fence(std::memory_order_release);
+  return data_;
+}
+
+void ShmExport::EndWrite() noexcept {
+  data_->n_updates++;
+  data_->seq.fetch_add(1, std::memory_order_release);
+}
+
+void ShmExport::Close() {
+  if (data_ == nullptr) {
+    return;
+  }
+#ifndef _WIN32
+  munmap(data_, sizeof(shm_export_t));
+  data_ = nullptr;
+  shm_unlink(name_.c_str());
+#endif
+}
+
+ShmExport::~ShmExport() {
+  Close();
+}
+}  // namespace fms_core
@@ -0,0 +1,52 @@
+/*
+        This project is licensed under
+        Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+   Public License (CC BY-NC-SA 4.0).
+
+        A SUMMARY OF THIS LICENSE CAN BE FOUND HERE:
+   https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+        Author: discord/bruh4096#4512
+
+        This file contains declarations of the ShmExport class, which creates
+    the shared memory segment described in shm_layout.hpp and writes to it.
+*/
+
+#pragma once
+
+#include <string>
+
+#include "shm_layout.hpp"
+
+namespace fms_core {
+
+class ShmExport final {
+ public:
+  // name must start with a slash, see shm_open
+  explicit ShmExport(std::string name);
+
+  ShmExport(const ShmExport& other) = delete;
+
+  ShmExport& operator=(const ShmExport& other) = delete;
+
+  // Creates and maps the segment. Returns false if that failed or there's
+  // no POSIX shared memory.
+  bool Open();
+
+  // Returns the segment to write to. Readers retry until EndWrite is
+  // called, so keep the time in between short. There must be only one
+  // writer at a time.
+  shm_export_t* BeginWrite() noexcept;
+
+  void EndWrite() noexcept;
+
+  // Unmaps and removes the segment
+  void Close();
+
+  ~ShmExport();
+
+ private:
+  std::string name_;
+  shm_export_t* data_ = nullptr;
+};
+}  // namespace fms_core
@@ -0,0 +1,193 @@
+/*
+        This project is licensed under
+        Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+   Public License (CC BY-NC-SA 4.0).
+
+        A SUMMARY OF THIS LICENSE CAN BE FOUND HERE:
+   https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+        Author: discord/bruh4096#4512
+
+        This file contains the layout of the shared memory segment that FPLSys
+    exports the active route, the aircraft state and the ND configuration to,
+    along with ShmExportView, which external displays use to read it. It has
+    no dependencies besides the standard library and POSIX, so that readers
+    can include it on its own. Without POSIX only the layout is declared.
+
+        The segment is guarded by a sequence lock. The writer makes seq odd
+    before it changes anything and even again once it's done, so readers
+    never block it. A reader that sees seq change while it was reading
+    simply tries again.
+*/
+
+#pragma once
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace fms_core {
+
+constexpr std::uint32_t SHM_EXPORT_MAGIC = 0x46504c58;  // "FPLX"
+// Increment on every change to the structures below
+constexpr std::uint32_t SHM_EXPORT_VERSION = 1;
+constexpr std::size_t SHM_EXPORT_N_LEGS_MAX = 256;
+constexpr std::size_t SHM_EXPORT_N_ND = 2;
+constexpr int SHM_EXPORT_N_READ_TRIES = 64;
+
+enum ShmLegFlags : std::uint32_t {
+  SHM_LEG_IS_ARC = 1 << 0,
+  SHM_LEG_IS_FINITE = 1 << 1,
+  SHM_LEG_IS_RWY = 1 << 2,
+  SHM_LEG_IS_BYPASSED = 1 << 3,
+  SHM_LEG_IS_TO_INHIBITED = 1 << 4,
+  SHM_LEG_HAS_DISC = 1 << 5,
+  SHM_LEG_IS_DISCON = 1 << 6
+};
+
+// Geometry of one leg, see leg_seg_t
+struct shm_leg_t {
+  double start_lat_rad, start_lon_rad;
+  double end_lat_rad, end_lon_rad;
+  double arc_ctr_lat_rad, arc_ctr_lon_rad;
+  double turn_rad_nm, true_trk_deg;
+  std::uint32_t flags;  // ShmLegFlags
+  std::uint32_t reserved;
+};
+
+struct shm_ac_state_t {
+  double lat_deg, lon_deg;
+  double brng_tru_deg, slip_deg, magvar_deg;
+  double gs_kts, tas_kts;
+};
+
+// See fms_displays::nd_global_config_t. Bit i of the runway masks is set
+// if route i has that runway.
+struct shm_nd_global_t {
+  std::uint8_t is_track_up;
+  std::uint8_t hdg_ref_true;
+  std::uint8_t hdg_sel_is_trk;
+  std::uint8_t has_dep_rwy_mask;
+  std::uint8_t has_arr_rwy_mask;
+  std::uint8_t reserved[3];
+  std::int64_t hdg_sel_deg;
+  double nm_mcp_alt_to_go;
+  double rot_quantum_deg;
+};
+
+// See fms_displays::nd_local_config_t
+struct shm_nd_local_t {
+  std::uint8_t efis_airport_on;
+  std::uint8_t efis_station_on;
+  std::uint8_t efis_waypoint_on;
+  std::uint8_t mode_is_ctr;
+  std::int32_t mode;  // fms_core::NDMode
+  std::uint64_t range_idx;
+};
+
+struct shm_export_t {
+  // Set once, when the segment is created
+  std::uint32_t magic;
+  std::uint32_t version;
+
+  std::atomic<std::uint64_t> seq;
+
+  std::uint64_t n_updates;
+  double rte_id;  // Changes whenever the legs do
+  // Index into legs, -1 if there's no active leg
+  std::int32_t act_leg_idx;
+  std::uint32_t n_legs;
+  // May be greater than n_legs if the route didn't fit
+  std::uint32_t n_legs_total;
+  std::uint32_t reserved;
+  shm_ac_state_t ac_state;
+  shm_nd_global_t nd_global;
+  shm_nd_local_t nd_local[SHM_EXPORT_N_ND];
+  shm_leg_t legs[SHM_EXPORT_N_LEGS_MAX];
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "seq has to be usable across processes");
+
+#ifndef _WIN32
+// Read-only mapping of an exported segment. Nothing is copied out of it,
+// Read hands the mapped segment itself to the caller.
+class ShmExportView final {
+ public:
+  ShmExportView() = default;
+
+  ShmExportView(const ShmExportView& other) = delete;
+
+  ShmExportView& operator=(const ShmExportView& other) = delete;
+
+  // Returns false if the segment doesn't exist or has another version
+  bool Open(const std::string& name) {
+    Close();
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+      return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || std::size_t(st.st_size) < sizeof(shm_export_t)) {
+      close(fd);
+      return false;
+    }
+    void* ptr = mmap(nullptr, sizeof(shm_export_t), PROT_READ, MAP_SHARED, fd,
+                     0);
+    close(fd);
+    if (ptr == MAP_FAILED) {
+      return false;
+    }
+    data_ = static_cast<const shm_export_t*>(ptr);
+    if (data_->magic != SHM_EXPORT_MAGIC ||
+        data_->version != SHM_EXPORT_VERSION) {
+      Close();
+      return false;
+    }
+    return true;
+  }
+
+  // Calls fn(const shm_export_t&) until it sees a consistent snapshot.
+  // fn may be called more than once and must not keep references into the
+  // segment. Returns false if the writer kept changing the segment.
+  template <typename F>
+  bool Read(F&& fn) const {
+    if (data_ == nullptr) {
+      return false;
+    }
+    for (int i = 0; i < SHM_EXPORT_N_READ_TRIES; i++) {
+      std::uint64_t seq_start = data_->seq.load(std::memory_order_acquire);
+      if (seq_start & 1) {
+        continue;
+      }
+      fn(*data_);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (data_->seq.load(std::memory_order_relaxed) == seq_start) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void Close() {
+    if (data_ != nullptr) {
+      munmap(const_cast<shm_export_t*>(data_), sizeof(shm_export_t));
+      data_ = nullptr;
+    }
+  }
+
+  ~ShmExportView() { Close(); }
+
+ private:
+  const shm_export_t* data_ = nullptr;
+};
+#endif
+}  // namespace fms_core
@@ -0,0 +1,174 @@
+/*
+        This project is licensed under
+        Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+   Public License (CC BY-NC-SA 4.0).
+
+        A SUMMARY OF THIS LICENSE CAN BE FOUND HERE:
+   https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+        Author: discord/bruh4096#4512
+
+        This file contains definitions of member functions for StateBridge
+    class.
+*/
+
+#include "state_bridge.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+namespace {
+
+constexpr int POLL_TIMEOUT_MS = 200;
+constexpr int RECV_BUF_BYTES = 1 << 18;
+// A packet this far behind the last one means the sender has restarted
+// rather than that the packet arrived late.
+constexpr std::int32_t SEQ_RESTART_WINDOW = 1024;
+constexpr std::size_t N_STATE_VARS = 8;
+
+// Same order as the doubles in state_packet_t
+const std::string STATE_VAR_KEYS[N_STATE_VARS] = {
+    fms_environment::AC_LAT_DEG_VAR,      fms_environment::AC_LON_DEG_VAR,
+    fms_environment::AC_BRNG_TRU_DEG_VAR, fms_environment::AC_SLIP_DEG_VAR,
+    fms_environment::AC_MAGVAR_DEG_VAR,   fms_environment::AC_GS_KTS_VAR,
+    fms_environment::AC_TAS_KTS_VAR,      fms_environment::AC_STATE_TIME_S_VAR};
+}  // namespace
+
+namespace fms_environment {
+
+StateBridge::StateBridge(util::OpaquePointer<EnvDataRefMap> env_map)
+    : env_map_{env_map} {}
+
+bool StateBridge::Start(const std::string& addr, std::uint16_t port) {
+  if (is_running_) {
+    return true;
+  }
+  sockaddr_in sa = {};
+  sa.sin_family = AF_INET;
+  sa.sin_port = htons(port);
+  if (inet_pton(AF_INET, addr.c_str(), &sa.sin_addr) != 1) {
+    return false;
+  }
+
+  fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  if (fd_ < 0) {
+    return false;
+  }
+  // Bursts at high rates shouldn't overflow the default buffer while the
+  // environment is locked by a reader.
+  int buf_sz = RECV_BUF_BYTES;
+  setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &buf_sz, sizeof(buf_sz));
+  if (bind(fd_, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) != 0) {
+    close(fd_);
+    fd_ = -1;
+    return false;
+  }
+
+  has_seq_ = false;
+  is_running_ = true;
+  thr_ = std::thread(&StateBridge::recv_main, this);
+  return true;
+}
+
+void StateBridge::Stop() {
+  if (!is_running_) {
+    return;
+  }
+  is_running_ = false;
+  thr_.join();
+  close(fd_);
+  fd_ = -1;
+}
+
+state_bridge_stats_t StateBridge::GetStats() const noexcept {
+  return {n_recv_.load(std::memory_order_relaxed),
+          n_applied_.load(std::memory_order_relaxed),
+          n_lost_.load(std::memory_order_relaxed),
+          n_stale_.load(std::memory_order_relaxed),
+          n_bad_.load(std::memory_order_relaxed)};
+}
+
+StateBridge::~StateBridge() {
+  Stop();
+}
+
+// Private member functions:
+
+void StateBridge::recv_main() {
+  // One byte more than a packet, so that longer datagrams are detected
+  // rather than truncated to the right size.
+  char buf[sizeof(state_packet_t) + 1];
+  while (is_running_) {
+    pollfd pfd{fd_, POLLIN, 0};
+    int ret = poll(&pfd, 1, POLL_TIMEOUT_MS);
+    if (ret <= 0) {
+      continue;
+    }
+
+    // Only the newest packet of everything that is queued is written to
+    // the environment. Older ones would be overwritten right away anyway.
+    state_packet_t newest;
+    bool has_newest = false;
+    while (true) {
+      ssize_t n = recv(fd_, buf, sizeof(buf), MSG_DONTWAIT);
+      if (n < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        break;
+      }
+      n_recv_.fetch_add(1, std::memory_order_relaxed);
+      state_packet_t pkt;
+      if (std::size_t(n) != sizeof(pkt)) {
+        n_bad_.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      std::memcpy(&pkt, buf, sizeof(pkt));
+      if (pkt.magic != STATE_PKT_MAGIC) {
+        n_bad_.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      if (accept_seq(pkt.seq)) {
+        newest = pkt;
+        has_newest = true;
+      }
+    }
+    if (has_newest) {
+      apply(newest);
+    }
+  }
+}
+
+bool StateBridge::accept_seq(std::uint32_t seq) noexcept {
+  if (!has_seq_) {
+    has_seq_ = true;
+    last_seq_ = seq;
+    return true;
+  }
+  // Wraps around along with the sequence numbers
+  std::int32_t diff = std::int32_t(seq - last_seq_);
+  if (diff > 0) {
+    n_lost_.fetch_add(std::uint64_t(diff - 1), std::memory_order_relaxed);
+  } else if (diff > -SEQ_RESTART_WINDOW) {
+    n_stale_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  last_seq_ = seq;
+  return true;
+}
+
+void StateBridge::apply(const state_packet_t& pkt) noexcept {
+  double vals[N_STATE_VARS] = {pkt.lat_deg,      pkt.lon_deg,
+                               pkt.brng_tru_deg, pkt.slip_deg,
+                               pkt.magvar_deg,   pkt.gs_kts,
+                               pkt.tas_kts,      pkt.timestamp_s};
+  env_map_->SetBatch(STATE_VAR_KEYS, vals, N_STATE_VARS);
+  n_applied_.fetch_add(1, std::memory_order_relaxed);
+}
+}  // namespace fms_environment
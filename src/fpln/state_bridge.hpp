@@ -0,0 +1,78 @@
+/*
+        This project is licensed under
+        Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+   Public License (CC BY-NC-SA 4.0).
+
+        A SUMMARY OF THIS LICENSE CAN BE FOUND HERE:
+   https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+        Author: discord/bruh4096#4512
+
+        This file contains declarations of the StateBridge class. The bridge
+    receives binary state packets over UDP on a thread of its own and writes
+    each one into EnvDataRefMap in a single batch.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "environment.hpp"
+#include "state_packet.hpp"
+#include <util/util.hpp>
+
+namespace fms_environment {
+
+struct state_bridge_stats_t {
+  std::uint64_t n_recv;     // Datagrams received
+  std::uint64_t n_applied;  // Packets written to the environment
+  std::uint64_t n_lost;     // Gaps in the sequence numbers
+  std::uint64_t n_stale;    // Reordered or duplicate packets that were dropped
+  std::uint64_t n_bad;      // Wrong size or magic
+};
+
+class StateBridge final {
+ public:
+  explicit StateBridge(util::OpaquePointer<EnvDataRefMap> env_map);
+
+  StateBridge(const StateBridge& other) = delete;
+
+  StateBridge& operator=(const StateBridge& other) = delete;
+
+  // Binds to addr:port and starts receiving. Returns false if the socket
+  // couldn't be set up.
+  bool Start(const std::string& addr, std::uint16_t port);
+
+  void Stop();
+
+  state_bridge_stats_t GetStats() const noexcept;
+
+  ~StateBridge();
+
+ private:
+  util::OpaquePointer<EnvDataRefMap> env_map_;
+  int fd_ = -1;
+  std::atomic<bool> is_running_{false};
+  std::thread thr_;
+
+  bool has_seq_ = false;
+  std::uint32_t last_seq_ = 0;
+
+  std::atomic<std::uint64_t> n_recv_{0};
+  std::atomic<std::uint64_t> n_applied_{0};
+  std::atomic<std::uint64_t> n_lost_{0};
+  std::atomic<std::uint64_t> n_stale_{0};
+  std::atomic<std::uint64_t> n_bad_{0};
+
+  void recv_main();
+
+  // Returns true if the packet is newer than the last one accepted
+  bool accept_seq(std::uint32_t seq) noexcept;
+
+  void apply(const state_packet_t& pkt) noexcept;
+};
+}  // namespace fms_environment
@@ -0,0 +1,41 @@
+/*
+        This project is licensed under
+        Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+   Public License (CC BY-NC-SA 4.0).
+
+        A SUMMARY OF THIS LICENSE CAN BE FOUND HERE:
+   https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+        Author: discord/bruh4096#4512
+
+        This file contains the layout of the binary aircraft state packet,
+    which the state bridge receives over UDP. It has no dependencies, so
+    that senders can include it on its own.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace fms_environment {
+
+constexpr std::uint32_t STATE_PKT_MAGIC = 0x46504c53;  // "FPLS"
+
+// All fields are in host byte order, i.e. little endian on every platform
+// the app runs on. seq is incremented by one for every packet sent and may
+// wrap around.
+struct state_packet_t {
+  std::uint32_t magic;
+  std::uint32_t seq;
+  double lat_deg;
+  double lon_deg;
+  double brng_tru_deg;
+  double slip_deg;
+  double magvar_deg;
+  double gs_kts;
+  double tas_kts;
+  double timestamp_s;
+};
+
+static_assert(sizeof(state_packet_t) == 72, "state_packet_t has padding");
+}  // namespace fms_environment
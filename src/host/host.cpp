@@ -0,0 +1,201 @@
+/*
+        This project is licensed under
+        Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+   Public License (CC BY-NC-SA 4.0).
+
+        A SUMMARY OF THIS LICENSE CAN BE FOUND HERE:
+   https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+        Author: discord/bruh4096#4512
+
+        This file contains definitions of member functions of the headless
+    host.
+*/
+
+#include "host.hpp"
+
+#include <cassert>
+#include <cstddef>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <libnav/str_utils.hpp>
+
+#include <fpln/fpl_cmds.hpp>
+#include <util/trace.hpp>
+
+namespace {
+
+// set only writes to the environment of its own aircraft. It makes up most
+// of a stream, so it's run without glob_cmd_mtx.
+const std::string SET_CMD = "set";
+
+// Commands keep some of their settings in globals, so commands of different
+// aircraft are run one at a time. They are rare next to updates.
+std::mutex glob_cmd_mtx;
+
+// Nobody can answer a prompt in a stream, so out of several waypoints with
+// the same name the first one is always used.
+const fms_commands::wpt_select_t SELECT_FIRST_WPT =
+    [](const std::string&, const std::vector<libnav::waypoint_entry_t>&)
+    -> std::optional<std::size_t> { return 0; };
+
+void execute_line(const std::string& in_raw,
+                  fms_commands::command_res_t cmd_resources) {
+  std::string in_proc = strutils::strip(in_raw, ' ');
+
+  std::vector<std::string> line_split = strutils::str_split(in_proc, ' ');
+  if (line_split.size()) {
+    std::string cmd_name = line_split[0];
+    std::vector<std::string> args =
+        std::vector<std::string>(line_split.begin() + 1, line_split.end());
+
+    std::unique_lock lk(glob_cmd_mtx, std::defer_lock);
+    if (cmd_name != SET_CMD) {
+      lk.lock();
+    }
+    if (!fms_commands::invoke(cmd_name, cmd_resources, args)) {
+      std::cout << "Invalid command name: " << cmd_name << "\n";
+    }
+  }
+}
+}  // namespace
+
+namespace fms_host {
+
+// Aircraft member function definitions:
+
+Aircraft::Aircraft(std::shared_ptr<fms_core::NavData> nav_data,
+                   pathlib::Path fpl_dir,
+                   util::OpaquePointer<fms_core::RteCatalog> rte_catalog)
+    : nav_data_{nav_data} {
+  env_map_ = std::make_unique<fms_environment::EnvDataRefMap>(
+      fms_environment::kBaseVariables);
+  // The host already runs aircraft in parallel, so routes are updated inline
+  fpl_sys_ = std::make_unique<fms_core::FPLSys>(
+      util::OpaquePointer<libnav::ArptDB>{nav_data_->get_arpt_db()},
+      util::OpaquePointer<libnav::NavaidDB>{nav_data_->get_navaid_db()},
+      util::OpaquePointer<libnav::AwyDB>{nav_data_->get_awy_db()},
+      util::OpaquePointer{env_map_.get()}, nav_data_->get_cifp_dir(), fpl_dir,
+      0);
+  fpl_sys_->set_awy_graph(util::OpaquePointer<const fms_core::AwyGraph>{
+      nav_data_->get_awy_graph()});
+  fpl_sys_->set_rte_catalog(rte_catalog);
+}
+
+void Aircraft::PushLine(std::string line) {
+  std::lock_guard lk(queue_mtx_);
+  queue_.push_back(std::move(line));
+}
+
+void Aircraft::Update() {
+  MY_TRACE_SCOPE("Aircraft::Update");
+  {
+    std::lock_guard lk(queue_mtx_);
+    curr_lines_.swap(queue_);
+  }
+  fms_commands::command_res_t cmd_resources{
+    .fpl_sys=fpl_sys_.get(), .env_map=env_map_.get(), .input_lat=nullptr,
+    .select_wpt=&SELECT_FIRST_WPT};
+  for (const auto& i : curr_lines_) {
+    execute_line(i, cmd_resources);
+  }
+  curr_lines_.clear();
+
+  fpl_sys_->update();
+}
+
+// Host member function definitions:
+
+Host::Host(std::shared_ptr<fms_core::NavData> nav_data, pathlib::Path fpl_dir,
+           std::size_t n_aircraft, std::size_t n_threads)
+    : nav_data_{nav_data},
+      rte_catalog_{std::make_unique<fms_core::RteCatalog>(fpl_dir)},
+      streams_(n_aircraft), stream_pos_(n_aircraft, 0),
+      pool_{n_threads ? n_threads - 1 : 0} {
+  aircraft_.reserve(n_aircraft);
+  for (std::size_t i = 0; i < n_aircraft; i++) {
+    aircraft_.push_back(std::make_unique<Aircraft>(
+        nav_data_, fpl_dir, util::OpaquePointer{rte_catalog_.get()}));
+  }
+}
+
+Aircraft& Host::GetAircraft(std::size_t idx) noexcept {
+  assert(idx < aircraft_.size());
+  return *aircraft_[idx];
+}
+
+bool Host::LoadStream(std::size_t ac_idx, const pathlib::Path& path) {
+  assert(ac_idx < streams_.size());
+  std::ifstream file(path.Get());
+  if (!file) {
+    return false;
+  }
+
+  std::vector<timed_line_t> out;
+  std::string line;
+  while (std::getline(file, line)) {
+    line = strutils::strip(line);
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::vector<std::string> split = strutils::str_split(line, ' ', 1);
+    if (split.size() != 2) {
+      continue;
+    }
+    std::size_t tick;
+    auto res = std::from_chars(split[0].data(),
+                               split[0].data() + split[0].size(), tick);
+    if (res.ec != std::errc{} || res.ptr != split[0].data() + split[0].size()) {
+      std::cout << "Invalid tick in " << path.Get() << ": " << line << "\n";
+      continue;
+    }
+    out.push_back({tick, split[1]});
+  }
+  std::stable_sort(out.begin(), out.end(), [](const timed_line_t& a,
+    const timed_line_t& b) { return a.tick < b.tick; });
+
+  streams_[ac_idx] = std::move(out);
+  stream_pos_[ac_idx] = 0;
+  return true;
+}
+
+void Host::Tick() {
+  MY_TRACE_SCOPE("Host::Tick");
+  for (std::size_t i = 0; i < aircraft_.size(); i++) {
+    std::size_t& pos = stream_pos_[i];
+    while (pos < streams_[i].size() && streams_[i][pos].tick <= curr_tick_) {
+      aircraft_[i]->PushLine(streams_[i][pos].line);
+      pos++;
+    }
+  }
+
+  pool_.ParallelFor(aircraft_.size(), [this](std::size_t i) {
+    aircraft_[i]->Update();
+  });
+  curr_tick_++;
+}
+
+double Host::Measure(std::size_t n_ticks) {
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < n_ticks; i++) {
+    Tick();
+  }
+  std::chrono::duration<double> dur = std::chrono::steady_clock::now() - start;
+  if (dur.count() <= 0) {
+    return 0;
+  }
+  return double(n_ticks * aircraft_.size()) / dur.count();
+}
+}  // namespace fms_host
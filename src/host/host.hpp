@@ -0,0 +1,113 @@
+/*
+        This project is licensed under
+        Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+   Public License (CC BY-NC-SA 4.0).
+
+        A SUMMARY OF THIS LICENSE CAN BE FOUND HERE:
+   https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+        Author: discord/bruh4096#4512
+
+        This file contains declarations of the headless host. The host runs
+    many independent aircraft, each one with its own FPLSys and environment,
+    on top of one shared set of navigation data bases.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <fpln/environment.hpp>
+#include <fpln/fpln_sys.hpp>
+#include <fpln/nav_data.hpp>
+#include <fpln/rte_catalog.hpp>
+#include <util/pathlib.hpp>
+#include <util/thread_pool.hpp>
+#include <util/util.hpp>
+
+namespace fms_host {
+
+// A line of an aircraft's stream that is due at a given tick
+struct timed_line_t {
+  std::size_t tick;
+  std::string line;
+};
+
+class Aircraft final {
+ public:
+  // rte_catalog must outlive the aircraft
+  Aircraft(std::shared_ptr<fms_core::NavData> nav_data,
+           pathlib::Path fpl_dir,
+           util::OpaquePointer<fms_core::RteCatalog> rte_catalog);
+
+  Aircraft(const Aircraft& other) = delete;
+
+  Aircraft& operator=(const Aircraft& other) = delete;
+
+  fms_core::FPLSys* GetFplSys() const noexcept {
+    return fpl_sys_.get();
+  }
+
+  fms_environment::EnvDataRefMap* GetEnvMap() const noexcept {
+    return env_map_.get();
+  }
+
+  // Queues a command line, e.g. "set ac_lat_deg 47.4" for aircraft state or
+  // "load KSEAKPDX" for the crew. Can be called from any thread.
+  void PushLine(std::string line);
+
+  // Runs the queued lines, then updates the flight plans. Only one thread
+  // may update a given aircraft at a time.
+  void Update();
+
+ private:
+  std::shared_ptr<fms_core::NavData> nav_data_;
+  std::unique_ptr<fms_environment::EnvDataRefMap> env_map_;
+  std::unique_ptr<fms_core::FPLSys> fpl_sys_;
+
+  std::mutex queue_mtx_;
+  std::vector<std::string> queue_;
+  std::vector<std::string> curr_lines_;  // Only used by Update
+};
+
+class Host final {
+ public:
+  // The calling thread of Tick takes part in the work, so n_threads of 1
+  // runs everything on the caller.
+  Host(std::shared_ptr<fms_core::NavData> nav_data, pathlib::Path fpl_dir,
+       std::size_t n_aircraft, std::size_t n_threads);
+
+  std::size_t GetNAircraft() const noexcept {
+    return aircraft_.size();
+  }
+
+  Aircraft& GetAircraft(std::size_t idx) noexcept;
+
+  // Loads "<tick> <command line>" lines from path. Tick feeds each line to
+  // the aircraft once its tick is reached. Returns false if the file
+  // couldn't be opened.
+  bool LoadStream(std::size_t ac_idx, const pathlib::Path& path);
+
+  // Feeds due stream lines and updates every aircraft once
+  void Tick();
+
+  // Runs n_ticks ticks and returns the number of aircraft updates per second
+  double Measure(std::size_t n_ticks);
+
+ private:
+  std::shared_ptr<fms_core::NavData> nav_data_;
+  // Every aircraft uses the same flight plan directory, so they share one
+  // catalog, i.e. one scan and one directory watch.
+  std::unique_ptr<fms_core::RteCatalog> rte_catalog_;
+  std::vector<std::unique_ptr<Aircraft>> aircraft_;
+  std::vector<std::vector<timed_line_t>> streams_;
+  std::vector<std::size_t> stream_pos_;
+  std::size_t curr_tick_ = 0;
+  util::ThreadPool pool_;
+};
+}  // namespace fms_host
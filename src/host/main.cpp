@@ -0,0 +1,140 @@
+/*
+        This project is licensed under
+        Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+   Public License (CC BY-NC-SA 4.0).
+
+        A SUMMARY OF THIS LICENSE CAN BE FOUND HERE:
+   https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+        This is the entry point of the headless host. It loads the navigation
+    data once, then runs the given number of aircraft for the given number
+    of ticks with 1, 2, 4, ... threads, up to the number of cores, and
+    reports aircraft updates per second for each thread count.
+    Usage: fpln_host <n_aircraft> <n_ticks> [stream_dir]
+    If stream_dir is given, ac_<i>.txt in it is the stream of aircraft i.
+    Author: discord/bruh4096#4512(Tim G.)
+*/
+
+#include <cstddef>
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <libnav/common.hpp>
+#include <libnav/str_utils.hpp>
+
+#include <fpln/nav_data.hpp>
+#include <util/pathlib.hpp>
+
+#include "host.hpp"
+
+namespace {
+
+// Same file and keys as the app uses
+const std::string PREFS_FILE_NM = "prefs.txt";
+const std::string PREFS_EARTH_PATH = "EPATH";
+const std::string PREFS_APT_DIR = "APTDIR";
+const std::string PREFS_FPL_DIR = "FPLDIR";
+
+struct host_prefs_t {
+  pathlib::Path earth_nav_path;
+  pathlib::Path apt_dat_dir;
+  pathlib::Path fpl_dir;
+};
+
+bool read_prefs(host_prefs_t* out) {
+  std::ifstream file(PREFS_FILE_NM);
+  if (!file) {
+    return false;
+  }
+
+  std::string line;
+  while (getline(file, line)) {
+    line = strutils::strip(line);
+    if (line.size() && line[0] != '#') {
+      std::vector<std::string> str_split = strutils::str_split(line, ' ', 1);
+
+      if (str_split.size() == 2) {
+        if (str_split[0] == PREFS_EARTH_PATH)
+          out->earth_nav_path = pathlib::Path{str_split[1]};
+        else if (str_split[0] == PREFS_APT_DIR)
+          out->apt_dat_dir = pathlib::Path{str_split[1]};
+        else if (str_split[0] == PREFS_FPL_DIR)
+          out->fpl_dir = pathlib::Path{str_split[1]};
+      }
+    }
+  }
+  return out->earth_nav_path.Get() != "" && out->apt_dat_dir.Get() != "";
+}
+
+bool parse_size(const char* str, std::size_t* out) {
+  std::string s{str};
+  auto res = std::from_chars(s.data(), s.data() + s.size(), *out);
+  return res.ec == std::errc{} && res.ptr == s.data() + s.size() && *out;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::size_t n_aircraft, n_ticks;
+  if ((argc != 3 && argc != 4) || !parse_size(argv[1], &n_aircraft) ||
+      !parse_size(argv[2], &n_ticks)) {
+    std::cout << "Usage: fpln_host <n_aircraft> <n_ticks> [stream_dir]\n";
+    return 1;
+  }
+
+  host_prefs_t prefs;
+  if (!read_prefs(&prefs)) {
+    std::cout << "Run the app once to create " << PREFS_FILE_NM << "\n";
+    return 1;
+  }
+
+  auto nav_data = std::make_shared<fms_core::NavData>(
+      fms_core::nav_data_paths_t{
+          prefs.apt_dat_dir + "apt.dat", pathlib::Path{"777_arpt.dat"},
+          pathlib::Path{"777_rnw.dat"},
+          prefs.earth_nav_path + "earth_fix.dat",
+          prefs.earth_nav_path + "earth_nav.dat",
+          prefs.earth_nav_path + "earth_awy.dat",
+          prefs.earth_nav_path + "earth_hold.dat",
+          prefs.earth_nav_path + "CIFP"});
+  nav_data->print_info();
+
+  std::size_t n_cores = std::max(std::thread::hardware_concurrency(), 1u);
+  std::cout << "threads aircraft-updates/s speedup\n";
+  double base = 0;
+  for (std::size_t n_threads = 1;; n_threads *= 2) {
+    if (n_threads > n_cores) {
+      n_threads = n_cores;
+    }
+    // Every run starts from fresh aircraft, so streams replay the same way
+    fms_host::Host host{nav_data, prefs.fpl_dir, n_aircraft, n_threads};
+    if (argc == 4) {
+      pathlib::Path stream_dir{argv[3]};
+      for (std::size_t i = 0; i < n_aircraft; i++) {
+        std::string nm = "ac_" + std::to_string(i) + ".txt";
+        pathlib::Path path = stream_dir + nm;
+        if (libnav::does_file_exist(path.Get())) {
+          host.LoadStream(i, path);
+        }
+      }
+    }
+
+    double rate = host.Measure(n_ticks);
+    if (n_threads == 1) {
+      base = rate;
+    }
+    std::cout << n_threads << " " << rate << " "
+              << (base > 0 ? rate / base : 0) << "\n";
+    if (n_threads == n_cores) {
+      break;
+    }
+  }
+  return 0;
+}
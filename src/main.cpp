@@ -13,6 +13,7 @@
 #include <gtk/gtk.h>
 
 #include "displays/common/cairo_utils.hpp"
+#include "util/alloc_stats.hpp"
 #include "main_helpers.hpp"
 
 #define UNUSED(x) (void)(x)
@@ -67,6 +68,7 @@ static gboolean on_draw_event(GtkWidget* widget, cairo_t* cr,
 static void do_drawing(cairo_t* cr) {
   cmdint->update();
   cmdint->draw(cr);
+  util::AllocFrameMark();
 }
 
 static gboolean clicked(GtkWidget* widget, GdkEventButton* event,
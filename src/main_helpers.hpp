@@ -30,13 +30,24 @@
 #include <displays/ND/nd.hpp>
 #include <fpln/fpl_cmds.hpp>
 #include <fpln/fpln_sys.hpp>
+#include <fpln/nav_data.hpp>
+#ifndef _WIN32
+#include <fpln/cmd_server.hpp>
+#include <fpln/state_bridge.hpp>
+#endif
+#include <util/alloc_stats.hpp>
 #include <util/json_require.hpp>
 #include <util/pathlib.hpp>
+#include <util/trace.hpp>
 #include <util/util.hpp>
 
 namespace fms_core {
 
 const std::string CMD_FILE_NM = "cmds.txt";
+const std::string CMD_SOCKET_NM = "fpln_cmds.sock";
+const std::string SHM_EXPORT_NM = "/fpln_export";
+const std::string STATE_BRIDGE_ADDR = "127.0.0.1";
+constexpr std::uint16_t STATE_BRIDGE_PORT = 49010;
 const std::string PREFS_FILE_NM = "prefs.txt";
 
 const std::string PREFS_EARTH_PATH = "EPATH";
@@ -60,67 +71,33 @@ constexpr geom::vect2_t CDU_L_SZ = {CDU_WIDTH, WND_HEIGHT};
 
 class Avionics {
  public:
-  libnav::ArptDB* arpt_db_ptr;
-  libnav::NavaidDB* navaid_db_ptr;
-
-  libnav::AwyDB* awy_db;
-  libnav::HoldDB* hold_db;
+  std::shared_ptr<NavData> nav_data;
+  std::unique_ptr<RteCatalog> rte_catalog;
 
   FPLSys* fpl_sys;
   fms_environment::EnvDataRefMap* env_map_ptr_;
 
-  pathlib::Path cifp_dir_path;
-
   Avionics(pathlib::Path apt_dat, pathlib::Path custom_apt, pathlib::Path custom_rnw,
            pathlib::Path fix_data, pathlib::Path navaid_data, pathlib::Path awy_data,
            pathlib::Path hold_data, pathlib::Path cifp_path, pathlib::Path fpl_path) {
-    cifp_dir_path = cifp_path;
-
-    arpt_db_ptr =
-        new libnav::ArptDB{apt_dat.Get(), custom_apt.Get(), custom_rnw.Get()};
-    navaid_db_ptr = new libnav::NavaidDB{fix_data.Get(), navaid_data.Get()};
-    awy_db = new libnav::AwyDB{awy_data.Get()};
-    hold_db = new libnav::HoldDB{hold_data.Get()};
-
-    libnav::DbErr err_arpt = arpt_db_ptr->get_err();
-    libnav::DbErr err_wpt = navaid_db_ptr->get_wpt_err();
-    libnav::DbErr err_nav = navaid_db_ptr->get_navaid_err();
-    libnav::DbErr err_awy = awy_db->get_err();
-    libnav::DbErr err_hold = hold_db->get_err();
-
-    std::cout << navaid_db_ptr->get_wpt_cycle() << " "
-              << navaid_db_ptr->get_navaid_cycle() << " " << awy_db->get_airac()
-              << " " << hold_db->get_airac() << "\n";
-
-    std::cout << "Fix data base version: " << navaid_db_ptr->get_wpt_version()
-              << "\n";
-    std::cout << "Navaid data base version: "
-              << navaid_db_ptr->get_navaid_version() << "\n";
-
-    if (err_arpt != libnav::DbErr::SUCCESS) {
-      std::cout << "Unable to load airport database\n";
-    }
-    if (err_wpt != libnav::DbErr::SUCCESS) {
-      std::cout << "Unable to load waypoint database\n";
-    }
-    if (err_nav != libnav::DbErr::SUCCESS) {
-      std::cout << "Unable to load navaid database\n";
-    }
-    if (err_awy != libnav::DbErr::SUCCESS) {
-      std::cout << "Unable to load airway database\n";
-    }
-    if (err_hold != libnav::DbErr::SUCCESS) {
-      std::cout << "Unable to load hold database\n";
-    }
+    nav_data = std::make_shared<NavData>(nav_data_paths_t{
+        apt_dat, custom_apt, custom_rnw, fix_data, navaid_data, awy_data,
+        hold_data, cifp_path});
+    nav_data->print_info();
 
     env_map_ptr_ = 
       new fms_environment::EnvDataRefMap{fms_environment::kBaseVariables};
 
-    fpl_sys = new FPLSys{util::OpaquePointer<libnav::ArptDB>{arpt_db_ptr}, 
-                        util::OpaquePointer<libnav::NavaidDB>{navaid_db_ptr}, 
-                        util::OpaquePointer<libnav::AwyDB>{awy_db}, 
-                        util::OpaquePointer{env_map_ptr_}, 
-                        cifp_dir_path, fpl_path};
+    fpl_sys = new FPLSys{
+        util::OpaquePointer<libnav::ArptDB>{nav_data->get_arpt_db()}, 
+        util::OpaquePointer<libnav::NavaidDB>{nav_data->get_navaid_db()}, 
+        util::OpaquePointer<libnav::AwyDB>{nav_data->get_awy_db()}, 
+        util::OpaquePointer{env_map_ptr_}, 
+        nav_data->get_cifp_dir(), fpl_path};
+    fpl_sys->set_awy_graph(
+        util::OpaquePointer<const AwyGraph>{nav_data->get_awy_graph()});
+    rte_catalog = std::make_unique<RteCatalog>(fpl_path);
+    fpl_sys->set_rte_catalog(util::OpaquePointer{rte_catalog.get()});
   }
 
   void update() { fpl_sys->update(); }
@@ -128,10 +105,6 @@ class Avionics {
   ~Avionics() {
     delete fpl_sys;
     delete env_map_ptr_;
-    delete hold_db;
-    delete awy_db;
-    delete navaid_db_ptr;
-    delete arpt_db_ptr;
   }
 };
 
@@ -147,6 +120,12 @@ class CMDInterface {
 
   byteutils::bytemap_manager_t byte_mngr;
 
+#ifndef _WIN32
+  std::unique_ptr<fms_environment::StateBridge> state_bridge;
+  // Declared after state_bridge, so it stops before the bridge goes away
+  std::unique_ptr<fms_commands::CommandServer> cmd_server;
+#endif
+
   CMDInterface() {
     FT_Init_FreeType(&lib);
     pre_exec = {};
@@ -176,6 +155,11 @@ class CMDInterface {
     get_pre_exec_cmds();
     create_avionics();
     pre_execute_cmds();
+#ifndef _WIN32
+    // The bridge goes first, so that its stats can be passed to commands
+    start_state_bridge();
+    start_cmd_server();
+#endif
   }
 
   void set_nd_mode(fms_core::NDMode md, std::size_t side_idx) {
@@ -235,7 +219,9 @@ class CMDInterface {
           std::vector<std::string>(line_split.begin() + 1, line_split.end());
 
       fms_commands::command_res_t cmd_resources{
-        .fpl_sys=avncs->fpl_sys, .env_map=avncs->env_map_ptr_};
+        .fpl_sys=avncs->fpl_sys, .env_map=avncs->env_map_ptr_,
+        .input_lat=&cdu_display_l->GetLatencyStats(),
+        .state_bridge=get_state_bridge()};
       if(!fms_commands::invoke(cmd_name, cmd_resources, args)) {
         std::cout << "Invalid command name\n";
       }
@@ -245,28 +231,20 @@ class CMDInterface {
   void on_click(geom::vect2_t pos) { cdu_widget_l->on_click(pos); }
 
   void draw(cairo_t* cr) {
+    MY_TRACE_SCOPE("CMDInterface::draw");
+    MY_ALLOC_SCOPE("CMDInterface::draw");
     nd_display->draw(cr);
     cdu_widget_l->draw(cr);
   }
 
   void update() {
+    MY_TRACE_SCOPE("CMDInterface::update");
+    MY_ALLOC_SCOPE("CMDInterface::update");
     cdu_l->update();
     nd_data->update();
     avncs->update();
   }
 
-  void main_loop() {
-    while (true) {
-      std::string in_raw;
-      std::cout << ">> ";
-      std::getline(std::cin, in_raw);
-
-      execute_cmd(in_raw);
-
-      update();
-    }
-  }
-
  private:
   struct json_data_t {
     nlohmann::json tex_names;
@@ -471,9 +449,50 @@ class CMDInterface {
       util::OpaquePointer{cdu_l}, util::OpaquePointer{cdu_display_l}, 
       util::OpaquePointer{cdu_map}};
 
+#ifndef _WIN32
+    if (!avncs->fpl_sys->start_shm_export(SHM_EXPORT_NM)) {
+      std::cout << "Failed to create the shared memory export "
+                << SHM_EXPORT_NM << "\n";
+    }
+#endif
+
     std::cout << "Avionics loaded\n";
   }
 
+  // The command server and the state bridge use POSIX sockets, so they're
+  // left out of Windows builds.
+  const fms_environment::StateBridge* get_state_bridge() const {
+#ifdef _WIN32
+    return nullptr;
+#else
+    return state_bridge.get();
+#endif
+  }
+
+#ifndef _WIN32
+  void start_cmd_server() {
+    fms_commands::command_res_t cmd_resources{
+      .fpl_sys=avncs->fpl_sys, .env_map=avncs->env_map_ptr_,
+      .input_lat=&cdu_display_l->GetLatencyStats(),
+      .state_bridge=get_state_bridge()};
+    cmd_server = std::make_unique<fms_commands::CommandServer>(
+      cmd_resources, CMD_SOCKET_NM);
+    if (!cmd_server->Start()) {
+      std::cout << "Failed to start the command server on " << CMD_SOCKET_NM
+                << "\n";
+    }
+  }
+
+  void start_state_bridge() {
+    state_bridge = std::make_unique<fms_environment::StateBridge>(
+      util::OpaquePointer{avncs->env_map_ptr_});
+    if (!state_bridge->Start(STATE_BRIDGE_ADDR, STATE_BRIDGE_PORT)) {
+      std::cout << "Failed to start the state bridge on " << STATE_BRIDGE_ADDR
+                << ":" << STATE_BRIDGE_PORT << "\n";
+    }
+  }
+#endif
+
   void pre_execute_cmds() {
     for (size_t i = 0; i < pre_exec.size(); i++) {
       execute_cmd(pre_exec[i]);
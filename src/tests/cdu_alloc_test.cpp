@@ -0,0 +1,95 @@
+/*
+  Checks that generating a CDU screen doesn't touch the heap. Screens are
+  built through the formatting API in displays/CDU/pages/base.hpp the same
+  way the pages build them every frame, and the allocations of this thread
+  are counted with util/alloc_stats. Only built with FPL_ALLOC_STATS, since
+  nothing is counted otherwise.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include <displays/CDU/pages/base.hpp>
+#include <libnav/geo_utils.hpp>
+#include <libnav/str_utils.hpp>
+#include <util/alloc_stats.hpp>
+
+static_assert(util::AllocStatsEnabled(),
+              "cdu_alloc_test needs to be built with FPL_ALLOC_STATS");
+
+namespace {
+
+constexpr std::size_t N_TEST_FRAMES = 1000;
+
+// Same shape as a RTE page: headings, field names and right-aligned data
+void put_test_screen(cdu_pages::cdu_scr_data_t& out, std::size_t frame) {
+  cdu_pages::put_subpage_heading(out.heading_small, unsigned(frame % 10 + 1),
+                                 10);
+  cdu_pages::put_text(out.heading_big, 2, "ACT");
+  cdu_pages::put_text(out.heading_big, 6, "RTE 1");
+  out.push_line(" ORIGIN");
+  cdu_pages::put_text_right(out.last_line(), "DEST");
+  out.push_line("KSEA");
+  cdu_pages::put_text_right(out.last_line(), "KPDX");
+  out.push_line(" POS");
+  out.push_line();
+  geo::point pos;
+  pos.lat_rad = (47.45 + double(frame % 100) * 0.01) * geo::DEG_TO_RAD;
+  pos.lon_rad = -122.3083 * geo::DEG_TO_RAD;
+  cdu_pages::put_pos_right(out.last_line(), pos);
+  out.push_line("<REQUEST");
+  out.pop_line();
+  // Text that runs past the end of a line is cut off
+  std::size_t col = cdu_pages::put_text(out.last_line(), 20, "LONG TEXT");
+  cdu_pages::put_text(out.last_line(), col, "MORE");
+  for (std::size_t i = out.n_lines; i < cdu_pages::N_CDU_SCR_LINES + 2; i++) {
+    out.push_line("<INDEX");
+  }
+}
+
+bool check_pos_format() {
+  cdu_pages::cdu_line_t line;
+  cdu_pages::clear_line(line);
+  geo::point pos;
+  pos.lat_rad = 47.45 * geo::DEG_TO_RAD;
+  pos.lon_rad = -122.3083 * geo::DEG_TO_RAD;
+  cdu_pages::put_pos_right(line, pos);
+
+  std::string expected = "N47 27.0 W122 18.5";
+  expected[3] = strutils::DEGREE_SYMBOL;
+  expected[13] = strutils::DEGREE_SYMBOL;
+  std::string_view got(line.data(), line.size());
+  if (!got.ends_with(expected)) {
+    std::cerr << "Position formatted as \"" << got << "\", expected \""
+              << expected << "\"\n";
+    return false;
+  }
+  return true;
+}
+}  // namespace
+
+int main() {
+  if (!check_pos_format()) {
+    return 1;
+  }
+
+  cdu_pages::cdu_scr_data_t out;
+  cdu_pages::cdu_scr_data_t cached;
+  put_test_screen(cached, 0);
+
+  util::alloc_counts_t start = util::AllocGetThreadCounts();
+  for (std::size_t i = 0; i < N_TEST_FRAMES; i++) {
+    out.clear();
+    put_test_screen(out, i);
+    out = cached;  // Pages that cache their screen copy it out
+  }
+  util::alloc_counts_t end = util::AllocGetThreadCounts();
+
+  std::uint64_t n_allocs = end.n_allocs - start.n_allocs;
+  std::cout << "Allocations over " << N_TEST_FRAMES
+            << " frames: " << n_allocs << "\n";
+  return n_allocs == 0 ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+/*
+  Checks that the RTE, DEP/ARR and LEGS pages don't touch the heap while
+  their screens are generated. The pages are driven through the CDU the way
+  a pilot would, on a route with a SID, airways, a discontinuity and an
+  approach. Only CDU::get_screen_data is counted: CDU::update copies the
+  flight plan and runs once per update of the avionics rather than per
+  frame. Only built with FPL_ALLOC_STATS, since nothing is counted
+  otherwise.
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+#include <displays/CDU/cdu.hpp>
+#include <util/alloc_stats.hpp>
+#include <util/pathlib.hpp>
+#include <util/util.hpp>
+
+#include "fpl_test_env.hpp"
+
+static_assert(util::AllocStatsEnabled(),
+              "cdu_pages_alloc_test needs to be built with FPL_ALLOC_STATS");
+
+namespace {
+
+constexpr std::size_t N_TEST_FRAMES = 200;
+
+struct test_page_t {
+  const char* name;
+  fms_displays::CDUPage face;  // Page key that is pressed first
+  int lsk = 0;  // Then this select key, if any
+};
+
+const test_page_t TEST_PAGES[] = {
+    {"RTE", fms_displays::CDUPage::RTE},
+    {"DEP/ARR", fms_displays::CDUPage::DEP_ARR_INTRO},
+    {"DEP", fms_displays::CDUPage::DEP_ARR_INTRO,
+     fms_displays::CDU_KEY_LSK_TOP},
+    {"ARR", fms_displays::CDUPage::DEP_ARR_INTRO,
+     fms_displays::CDU_KEY_RSK_TOP + 1},
+    {"LEGS", fms_displays::CDUPage::LEGS}};
+
+int get_page_key(fms_displays::CDUPage pg) {
+  auto it = std::find(fms_displays::CDU_PAGE_FACES.begin(),
+                      fms_displays::CDU_PAGE_FACES.end(), pg);
+  return fms_displays::CDU_KEY_INIT_REF +
+         int(it - fms_displays::CDU_PAGE_FACES.begin());
+}
+
+// Returns the number of allocations made while drawing the page
+std::uint64_t count_page_allocs(fms_displays::CDU& cdu,
+                                const test_page_t& page) {
+  std::string s_out;
+  cdu.on_event(get_page_key(page.face), "", &s_out);
+  if (page.lsk) {
+    cdu.on_event(page.lsk, "", &s_out);
+  }
+  int next_key = get_page_key(fms_displays::CDUPage::NEXT_PAGE);
+
+  cdu_pages::cdu_scr_data_t out;
+  // The first screen may fill caches, e.g. the procedure lists
+  cdu.update();
+  cdu.get_screen_data(out);
+
+  std::uint64_t n_allocs = 0;
+  for (std::size_t i = 0; i < N_TEST_FRAMES; i++) {
+    // Every few frames the page is turned, so that all subpages are drawn
+    if (i % 10 == 9) {
+      cdu.on_event(next_key, "", &s_out);
+      cdu.update();
+    }
+    util::alloc_counts_t start = util::AllocGetThreadCounts();
+    cdu.get_screen_data(out);
+    util::alloc_counts_t end = util::AllocGetThreadCounts();
+    n_allocs += end.n_allocs - start.n_allocs;
+  }
+  return n_allocs;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  pathlib::Path earth_nav, apt_dat_dir;
+  if (!fpl_tests::get_test_paths(argc, argv, &earth_nav, &apt_dat_dir)) {
+    return 1;
+  }
+  fpl_tests::FplTestEnv env{earth_nav, apt_dat_dir, "cdu_pages_alloc_test"};
+  if (!env.is_loaded()) {
+    std::cerr << "Failed to load nav data\n";
+    return 1;
+  }
+  if (!env.build_test_route(std::cerr)) {
+    return 1;
+  }
+
+  fms_displays::CDU cdu{util::OpaquePointer{&env.get_fpl_sys()}, 0};
+  bool passed = true;
+  for (const auto& i : TEST_PAGES) {
+    std::uint64_t n_allocs = count_page_allocs(cdu, i);
+    std::cout << i.name << ": " << n_allocs << " allocations over "
+              << N_TEST_FRAMES << " frames\n";
+    passed = passed && n_allocs == 0;
+  }
+  return passed ? 0 : 1;
+}
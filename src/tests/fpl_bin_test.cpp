@@ -0,0 +1,141 @@
+/*
+  Saves a route with a SID, airways, a discontinuity and an approach in the
+  binary format, loads it into the other route and checks that both have
+  the same segments, legs and procedures.
+*/
+
+#include <cstddef>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fpln/fpln_sys.hpp>
+#include <util/pathlib.hpp>
+#include <util/util.hpp>
+
+#include "fpl_test_env.hpp"
+
+namespace {
+
+using fpl_tests::flightplan_type;
+
+bool is_same_wpt(const libnav::waypoint_t& a, const libnav::waypoint_t& b) {
+  return a.id == b.id && a.data.pos.lat_rad == b.data.pos.lat_rad &&
+         a.data.pos.lon_rad == b.data.pos.lon_rad;
+}
+
+bool is_same_leg(const fms_core::leg_list_data_t& a,
+                 const fms_core::leg_list_data_t& b) {
+  if (a.is_discon || b.is_discon) {
+    return a.is_discon == b.is_discon;
+  }
+  return a.leg.leg_type == b.leg.leg_type &&
+         is_same_wpt(a.leg.main_fix, b.leg.main_fix) &&
+         a.leg.alt_desc == b.leg.alt_desc && a.leg.alt1_ft == b.leg.alt1_ft &&
+         a.leg.alt2_ft == b.leg.alt2_ft &&
+         a.leg.speed_desc == b.leg.speed_desc &&
+         a.leg.spd_lim_kias == b.leg.spd_lim_kias &&
+         a.misc_data.is_bypassed == b.misc_data.is_bypassed;
+}
+
+bool is_same_seg(const fms_core::fpl_seg_t& a, const fms_core::fpl_seg_t& b) {
+  bool same_end = (a.end == nullptr) == (b.end == nullptr);
+  if (same_end && a.end != nullptr) {
+    same_end = is_same_leg(a.end->data, b.end->data);
+  }
+  return a.name == b.name && a.seg_type == b.seg_type &&
+         a.is_direct == b.is_direct && a.is_discon == b.is_discon && same_end;
+}
+
+// Prints the first difference between the routes
+bool compare_fpls(flightplan_type& a, flightplan_type& b) {
+  if (a.get_dep_icao() != b.get_dep_icao() ||
+      a.get_arr_icao() != b.get_arr_icao() ||
+      a.get_dep_rwy() != b.get_dep_rwy() ||
+      a.get_arr_rwy() != b.get_arr_rwy()) {
+    std::cerr << "Airports or runways differ\n";
+    return false;
+  }
+  for (auto tp : {fms_core::PROC_TYPE_SID, fms_core::PROC_TYPE_STAR,
+                  fms_core::PROC_TYPE_APPCH}) {
+    if (a.get_curr_proc(tp) != b.get_curr_proc(tp) ||
+        a.get_curr_proc(tp, true) != b.get_curr_proc(tp, true)) {
+      std::cerr << "Procedure " << a.get_curr_proc(tp) << " became "
+                << b.get_curr_proc(tp) << "\n";
+      return false;
+    }
+  }
+
+  std::vector<fms_core::list_node_ref_t<fms_core::fpl_seg_t>> segs_a, segs_b;
+  a.get_sl_seg(0, a.get_seg_list_sz(), &segs_a);
+  b.get_sl_seg(0, b.get_seg_list_sz(), &segs_b);
+  if (segs_a.size() != segs_b.size()) {
+    std::cerr << segs_a.size() << " segments became " << segs_b.size()
+              << "\n";
+    return false;
+  }
+  for (std::size_t i = 0; i < segs_a.size(); i++) {
+    if (!is_same_seg(segs_a[i].data, segs_b[i].data)) {
+      std::cerr << "Segment " << i << " " << segs_a[i].data.name
+                << " became " << segs_b[i].data.name << "\n";
+      return false;
+    }
+  }
+
+  std::vector<fms_core::list_node_ref_t<fms_core::leg_list_data_t>> legs_a,
+      legs_b;
+  int act_idx;
+  a.get_ll_seg(0, a.get_leg_list_sz(), &legs_a, &act_idx);
+  b.get_ll_seg(0, b.get_leg_list_sz(), &legs_b, &act_idx);
+  if (legs_a.size() != legs_b.size()) {
+    std::cerr << legs_a.size() << " legs became " << legs_b.size() << "\n";
+    return false;
+  }
+  for (std::size_t i = 0; i < legs_a.size(); i++) {
+    if (!is_same_leg(legs_a[i].data, legs_b[i].data)) {
+      std::cerr << "Leg " << i << " " << legs_a[i].data.leg.main_fix.id
+                << " became " << legs_b[i].data.leg.main_fix.id << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  pathlib::Path earth_nav, apt_dat_dir;
+  if (!fpl_tests::get_test_paths(argc, argv, &earth_nav, &apt_dat_dir)) {
+    return 1;
+  }
+  fpl_tests::FplTestEnv env{earth_nav, apt_dat_dir, "fpl_bin_test"};
+  if (!env.is_loaded()) {
+    std::cerr << "Failed to load nav data\n";
+    return 1;
+  }
+  if (!env.build_test_route(std::cerr)) {
+    return 1;
+  }
+
+  fms_core::FPLSys& fpl_sys = env.get_fpl_sys();
+  util::OpaquePointer<flightplan_type> src =
+      fpl_sys.get_fpln_ptr(fms_core::RTE1_IDX);
+  util::OpaquePointer<flightplan_type> dst =
+      fpl_sys.get_fpln_ptr(fms_core::RTE2_IDX);
+  std::string file_nm = (env.get_tmp_path() + "round_trip").Get();
+  if (!src->save_to_bin(file_nm)) {
+    std::cerr << "Failed to save " << file_nm << "\n";
+    return 1;
+  }
+  libnav::DbErr err = dst->load_from_bin(file_nm);
+  if (err != libnav::DbErr::SUCCESS) {
+    std::cerr << "Failed to load " << file_nm << "\n";
+    return 1;
+  }
+
+  if (!compare_fpls(*src, *dst)) {
+    return 1;
+  }
+  std::cout << "Route survived a save and a load\n";
+  return 0;
+}
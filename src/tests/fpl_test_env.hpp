@@ -0,0 +1,196 @@
+/*
+  Flight plan system loaded with X-Plane nav data, for tests that need real
+  procedures and airways. The data is found the same way as through
+  prefs.txt: tests take the path of Resources/default data and of the
+  directory containing apt.dat as their arguments. Routes are saved to a
+  temporary directory that is removed afterwards.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <fpln/environment.hpp>
+#include <fpln/fpl_cmds.hpp>
+#include <fpln/fpln_sys.hpp>
+#include <fpln/nav_data.hpp>
+#include <libnav/str_utils.hpp>
+#include <util/pathlib.hpp>
+#include <util/util.hpp>
+
+namespace fpl_tests {
+
+using flightplan_type = fms_core::FPLSys::flightplan_type;
+
+// Airports that have SIDs, approaches and an airway route between them in
+// the default data. The same pair is used by "autoroute bench".
+const std::string TEST_DEP_ICAO = "EGLL";
+const std::string TEST_ARR_ICAO = "LIRF";
+
+class FplTestEnv final {
+ public:
+  FplTestEnv(const pathlib::Path& earth_nav_path,
+             const pathlib::Path& apt_dat_dir, const std::string& test_nm) {
+    tmp_dir_ = std::filesystem::temp_directory_path() /
+               (test_nm + "_" +
+                std::to_string(std::chrono::steady_clock::now()
+                                   .time_since_epoch()
+                                   .count()));
+    std::filesystem::create_directories(tmp_dir_);
+    pathlib::Path tmp_path{tmp_dir_.string()};
+
+    // libnav caches the parsed apt.dat next to these, so they're kept out
+    // of the working directory
+    nav_data_ = std::make_unique<fms_core::NavData>(fms_core::nav_data_paths_t{
+        apt_dat_dir + "apt.dat", tmp_path + "777_arpt.dat",
+        tmp_path + "777_rnw.dat", earth_nav_path + "earth_fix.dat",
+        earth_nav_path + "earth_nav.dat", earth_nav_path + "earth_awy.dat",
+        earth_nav_path + "earth_hold.dat", earth_nav_path + "CIFP"});
+    env_map_ = std::make_unique<fms_environment::EnvDataRefMap>(
+        fms_environment::kBaseVariables);
+    // Routes are updated inline, so tests don't race with worker threads
+    fpl_sys_ = std::make_unique<fms_core::FPLSys>(
+        util::OpaquePointer<libnav::ArptDB>{nav_data_->get_arpt_db()},
+        util::OpaquePointer<libnav::NavaidDB>{nav_data_->get_navaid_db()},
+        util::OpaquePointer<libnav::AwyDB>{nav_data_->get_awy_db()},
+        util::OpaquePointer{env_map_.get()}, nav_data_->get_cifp_dir(),
+        tmp_path, 0);
+    fpl_sys_->set_awy_graph(util::OpaquePointer<const fms_core::AwyGraph>{
+        nav_data_->get_awy_graph()});
+  }
+
+  FplTestEnv(const FplTestEnv& other) = delete;
+
+  FplTestEnv& operator=(const FplTestEnv& other) = delete;
+
+  // False if the data bases couldn't be read, nothing can be tested then
+  bool is_loaded() const {
+    return nav_data_->get_arpt_db()->get_err() == libnav::DbErr::SUCCESS &&
+           nav_data_->get_navaid_db()->get_wpt_err() ==
+               libnav::DbErr::SUCCESS &&
+           nav_data_->get_awy_graph()->GetNodeCount() != 0;
+  }
+
+  fms_core::FPLSys& get_fpl_sys() noexcept { return *fpl_sys_; }
+
+  pathlib::Path get_tmp_path() const { return pathlib::Path{tmp_dir_.string()}; }
+
+  // Runs a command the way the command line does and returns its reply
+  std::string run(const std::string& line) {
+    std::ostringstream out;
+    fms_commands::command_res_t cmd_resources{
+        .fpl_sys = fpl_sys_.get(), .env_map = env_map_.get(),
+        .input_lat = nullptr, .out = &out, .select_wpt = &SELECT_FIRST_WPT};
+    std::vector<std::string> args = strutils::str_split(line, ' ');
+    std::string cmd_name = args[0];
+    args.erase(args.begin());
+    if (!fms_commands::invoke(cmd_name, cmd_resources, args)) {
+      out << "Invalid command name: " << cmd_name << "\n";
+    }
+    return out.str();
+  }
+
+  /*
+    Fills RTE 1 with a SID, an airway route and an approach, in the order
+    a pilot would enter them. The approach isn't joined to the route, so
+    there's a discontinuity in front of it. Returns false and says what's
+    missing if the data doesn't allow for that.
+  */
+  bool build_test_route(std::ostream& err) {
+    util::OpaquePointer<flightplan_type> fpln =
+        fpl_sys_->get_fpln_ptr(fms_core::RTE1_IDX);
+    auto is_set = [](libnav::DbErr e) {
+      return e == libnav::DbErr::SUCCESS || e == libnav::DbErr::PARTIAL_LOAD;
+    };
+    if (!is_set(fpln->set_dep(TEST_DEP_ICAO)) ||
+        !is_set(fpln->set_arr(TEST_ARR_ICAO))) {
+      err << "No " << TEST_DEP_ICAO << " or " << TEST_ARR_ICAO << "\n";
+      return false;
+    }
+
+    std::vector<std::string> sids = fpln->get_arpt_proc(fms_core::PROC_TYPE_SID);
+    if (sids.empty() || !fpln->set_arpt_proc(fms_core::PROC_TYPE_SID, sids[0])) {
+      err << "No SID at " << TEST_DEP_ICAO << "\n";
+      return false;
+    }
+    std::vector<std::string> rwys = fpln->get_dep_rwys(false, true);
+    if (rwys.size()) {
+      fpln->set_dep_rwy(rwys[0]);
+    }
+
+    // Airways can't follow arrival procedures, so the route comes first
+    std::string rte_reply = run("autoroute");
+
+    std::vector<std::string> apprs =
+        fpln->get_arpt_proc(fms_core::PROC_TYPE_APPCH, true);
+    if (apprs.empty() ||
+        !fpln->set_arpt_proc(fms_core::PROC_TYPE_APPCH, apprs[0], true)) {
+      err << "No approach at " << TEST_ARR_ICAO << "\n";
+      return false;
+    }
+    fpl_sys_->update();
+
+    bool has_sid = false, has_awy = false, has_discon = false;
+    bool has_appch = false;
+    std::vector<fms_core::list_node_ref_t<fms_core::fpl_seg_t>> segs;
+    fpln->get_sl_seg(0, fpln->get_seg_list_sz(), &segs);
+    for (const auto& i : segs) {
+      has_sid |= i.data.seg_type == fms_core::FplSegment::SID;
+      has_awy |= i.data.seg_type == fms_core::FplSegment::ENRT &&
+                 !i.data.is_direct && !i.data.is_discon;
+      has_discon |= i.data.is_discon;
+      has_appch |= i.data.seg_type == fms_core::FplSegment::APPCH;
+    }
+    if (!has_sid || !has_awy || !has_discon || !has_appch) {
+      err << "Test route is missing:" << (has_sid ? "" : " SID")
+          << (has_awy ? "" : " airways")
+          << (has_discon ? "" : " discontinuity")
+          << (has_appch ? "" : " approach") << "\nautoroute said:\n"
+          << rte_reply;
+      return false;
+    }
+    return true;
+  }
+
+  ~FplTestEnv() {
+    // The flight plan system goes first, it may still be writing files
+    fpl_sys_.reset();
+    std::error_code ec;
+    std::filesystem::remove_all(tmp_dir_, ec);
+  }
+
+ private:
+  // Nobody answers prompts in tests
+  static inline const fms_commands::wpt_select_t SELECT_FIRST_WPT =
+      [](const std::string&, const std::vector<libnav::waypoint_entry_t>&)
+      -> std::optional<std::size_t> { return 0; };
+
+  std::filesystem::path tmp_dir_;
+  std::unique_ptr<fms_core::NavData> nav_data_;
+  std::unique_ptr<fms_environment::EnvDataRefMap> env_map_;
+  std::unique_ptr<fms_core::FPLSys> fpl_sys_;
+};
+
+// Reads the nav data paths from the arguments of a test
+inline bool get_test_paths(int argc, char** argv, pathlib::Path* earth_nav,
+                           pathlib::Path* apt_dat_dir) {
+  if (argc != 3) {
+    std::cerr << "Usage: " << argv[0] << " <Resources/default data dir> "
+              << "<directory containing apt.dat>\n";
+    return false;
+  }
+  *earth_nav = pathlib::Path{argv[1]};
+  *apt_dat_dir = pathlib::Path{argv[2]};
+  return true;
+}
+}  // namespace fpl_tests
@@ -0,0 +1,95 @@
+/*
+        This project is licensed under
+        Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+   Public License (CC BY-NC-SA 4.0).
+
+        A SUMMARY OF THIS LICENSE CAN BE FOUND HERE:
+   https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+        This is an example reader of the shared memory export. It prints the
+    aircraft state, the ND configuration and the legs of the active route
+    once per second.
+    Usage: shm_dump [segment_name]
+    Author: discord/bruh4096#4512(Tim G.)
+*/
+
+#include <cstdint>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fpln/shm_layout.hpp>
+
+namespace {
+
+const std::string DFLT_SEGMENT_NM = "/fpln_export";
+constexpr double RAD_TO_DEG = 57.29577951308232;
+
+// What gets printed. Copying it out keeps the printing outside of the
+// read, so the reader doesn't have to retry as often.
+struct dump_t {
+  std::uint64_t n_updates;
+  fms_core::shm_ac_state_t ac_state;
+  fms_core::shm_nd_global_t nd_global;
+  fms_core::shm_nd_local_t nd_local[fms_core::SHM_EXPORT_N_ND];
+  std::int32_t act_leg_idx;
+  std::uint32_t n_legs_total;
+  std::vector<fms_core::shm_leg_t> legs;
+};
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string name = argc > 1 ? argv[1] : DFLT_SEGMENT_NM;
+  fms_core::ShmExportView view;
+  if (!view.Open(name)) {
+    std::cout << "Failed to open " << name << "\n";
+    return 1;
+  }
+
+  dump_t dump;
+  dump.legs.reserve(fms_core::SHM_EXPORT_N_LEGS_MAX);
+  while (true) {
+    bool ok = view.Read([&dump](const fms_core::shm_export_t& seg) {
+      dump.n_updates = seg.n_updates;
+      dump.ac_state = seg.ac_state;
+      dump.nd_global = seg.nd_global;
+      for (std::size_t i = 0; i < fms_core::SHM_EXPORT_N_ND; i++) {
+        dump.nd_local[i] = seg.nd_local[i];
+      }
+      dump.act_leg_idx = seg.act_leg_idx;
+      dump.n_legs_total = seg.n_legs_total;
+      std::uint32_t n_legs = seg.n_legs;
+      if (n_legs > fms_core::SHM_EXPORT_N_LEGS_MAX) {
+        n_legs = 0;  // Torn read, it's retried
+      }
+      dump.legs.assign(seg.legs, seg.legs + n_legs);
+    });
+    if (!ok) {
+      std::cout << "The segment changed during every read\n";
+    } else {
+      const auto& ac = dump.ac_state;
+      std::cout << "update " << dump.n_updates << ": pos " << ac.lat_deg
+                << " " << ac.lon_deg << " brng " << ac.brng_tru_deg
+                << " gs " << ac.gs_kts << "\n";
+      for (std::size_t i = 0; i < fms_core::SHM_EXPORT_N_ND; i++) {
+        std::cout << "nd " << i << ": mode " << dump.nd_local[i].mode
+                  << " range_idx " << dump.nd_local[i].range_idx << "\n";
+      }
+      std::cout << dump.legs.size() << "/" << dump.n_legs_total
+                << " legs, active " << dump.act_leg_idx << "\n";
+      for (std::size_t i = 0; i < dump.legs.size(); i++) {
+        const auto& leg = dump.legs[i];
+        std::cout << "  " << i << ": " << leg.start_lat_rad * RAD_TO_DEG
+                  << " " << leg.start_lon_rad * RAD_TO_DEG << " -> "
+                  << leg.end_lat_rad * RAD_TO_DEG << " "
+                  << leg.end_lon_rad * RAD_TO_DEG << " trk "
+                  << leg.true_trk_deg << " flags " << leg.flags << "\n";
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+  }
+  return 0;
+}
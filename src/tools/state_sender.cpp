@@ -0,0 +1,168 @@
+/*
+        This project is licensed under
+        Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International
+   Public License (CC BY-NC-SA 4.0).
+
+        A SUMMARY OF THIS LICENSE CAN BE FOUND HERE:
+   https://creativecommons.org/licenses/by-nc-sa/4.0/
+
+        This is a stand-in for a simulator feed. It flies the aircraft in a
+    circle around the default position and sends a state packet to the state
+    bridge at a fixed rate. Packets can be dropped or swapped with the next
+    one on purpose, to exercise the sequence number handling.
+    Usage: state_sender [-h host] [-p port] [-r rate_hz] [-t duration_s]
+                        [-d drop_every] [-o reorder_every]
+    Author: discord/bruh4096#4512(Tim G.)
+*/
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <fpln/state_packet.hpp>
+
+namespace {
+
+constexpr double CTR_LAT_DEG = 45.588670;
+constexpr double CTR_LON_DEG = -122.598150;
+constexpr double CIRCLE_RAD_DEG = 0.1;
+constexpr double CIRCLE_PERIOD_S = 120;
+constexpr double GS_KTS = 250;
+constexpr double TAS_KTS = 260;
+constexpr double MAGVAR_DEG = 15;
+constexpr double PI = 3.14159265358979323846;
+
+struct sender_opts_t {
+  std::string host = "127.0.0.1";
+  std::uint16_t port = 49010;
+  double rate_hz = 1000;
+  double duration_s = 10;
+  std::uint32_t drop_every = 0;     // 0 means never
+  std::uint32_t reorder_every = 0;  // 0 means never
+};
+
+bool parse_opts(int argc, char** argv, sender_opts_t* out) {
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string flag = argv[i];
+    char* end;
+    double val = std::strtod(argv[i + 1], &end);
+    if (flag == "-h") {
+      out->host = argv[i + 1];
+      continue;
+    }
+    if (*end != '\0' || val < 0) {
+      return false;
+    }
+    if (flag == "-p")
+      out->port = std::uint16_t(val);
+    else if (flag == "-r")
+      out->rate_hz = val;
+    else if (flag == "-t")
+      out->duration_s = val;
+    else if (flag == "-d")
+      out->drop_every = std::uint32_t(val);
+    else if (flag == "-o")
+      out->reorder_every = std::uint32_t(val);
+    else
+      return false;
+  }
+  return argc % 2 == 1 && out->rate_hz > 0;
+}
+
+fms_environment::state_packet_t get_state(std::uint32_t seq, double t_s) {
+  double ang = 2 * PI * t_s / CIRCLE_PERIOD_S;
+  double brng_deg = std::fmod(ang * 180 / PI + 180, 360);
+  return {fms_environment::STATE_PKT_MAGIC,
+          seq,
+          CTR_LAT_DEG + CIRCLE_RAD_DEG * std::sin(ang),
+          CTR_LON_DEG - CIRCLE_RAD_DEG * std::cos(ang),
+          brng_deg,
+          0,
+          MAGVAR_DEG,
+          GS_KTS,
+          TAS_KTS,
+          t_s};
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  sender_opts_t opts;
+  if (!parse_opts(argc, argv, &opts)) {
+    std::cout << "Usage: state_sender [-h host] [-p port] [-r rate_hz] "
+                 "[-t duration_s] [-d drop_every] [-o reorder_every]\n";
+    return 1;
+  }
+
+  sockaddr_in sa = {};
+  sa.sin_family = AF_INET;
+  sa.sin_port = htons(opts.port);
+  if (inet_pton(AF_INET, opts.host.c_str(), &sa.sin_addr) != 1) {
+    std::cout << "Invalid host: " << opts.host << "\n";
+    return 1;
+  }
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0) {
+    std::cout << "Failed to create a socket\n";
+    return 1;
+  }
+
+  using clock = std::chrono::steady_clock;
+  auto period = std::chrono::duration_cast<clock::duration>(
+      std::chrono::duration<double>(1 / opts.rate_hz));
+  std::uint64_t n_pkts = std::uint64_t(opts.duration_s * opts.rate_hz);
+  std::uint64_t n_sent = 0;
+  fms_environment::state_packet_t held;
+  bool has_held = false;
+
+  auto send_pkt = [&](const fms_environment::state_packet_t& pkt) {
+    if (sendto(fd, &pkt, sizeof(pkt), 0, reinterpret_cast<sockaddr*>(&sa),
+               sizeof(sa)) == ssize_t(sizeof(pkt))) {
+      n_sent++;
+    }
+  };
+
+  auto start = clock::now();
+  for (std::uint64_t i = 0; i < n_pkts; i++) {
+    std::this_thread::sleep_until(start + period * i);
+    std::uint32_t seq = std::uint32_t(i);
+    double t_s = double(i) / opts.rate_hz;
+    fms_environment::state_packet_t pkt = get_state(seq, t_s);
+
+    if (opts.drop_every && seq % opts.drop_every == opts.drop_every - 1) {
+      continue;
+    }
+    // The held packet goes out after the one that follows it
+    if (opts.reorder_every && !has_held &&
+        seq % opts.reorder_every == opts.reorder_every - 1) {
+      held = pkt;
+      has_held = true;
+      continue;
+    }
+    send_pkt(pkt);
+    if (has_held) {
+      send_pkt(held);
+      has_held = false;
+    }
+  }
+  if (has_held) {
+    send_pkt(held);
+  }
+
+  double elapsed_s =
+      std::chrono::duration<double>(clock::now() - start).count();
+  std::cout << "Sent " << n_sent << " packets in " << elapsed_s << " s ("
+            << (elapsed_s > 0 ? double(n_sent) / elapsed_s : 0) << " Hz)\n";
+  close(fd);
+  return 0;
+}
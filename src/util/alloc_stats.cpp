@@ -0,0 +1,257 @@
+#include "alloc_stats.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <new>
+#include <ostream>
+
+namespace {
+
+constexpr std::size_t kNFramesKept = 256;
+constexpr std::size_t kMaxScopes = 64;
+
+struct scope_stats_t {
+  const char* name = nullptr;
+  std::uint64_t n_calls = 0;
+  util::alloc_counts_t counts;
+};
+
+// Per-thread counters. Plain integers: only the owning thread writes them.
+thread_local util::alloc_counts_t thread_counts;
+thread_local util::alloc_counts_t thread_frame_start;
+
+// The bookkeeping below doesn't allocate, so it can't recurse into new.
+std::mutex glob_stats_mtx;
+std::array<util::alloc_counts_t, kNFramesKept> glob_frames;
+std::size_t glob_n_frames = 0;  // Total, the ring holds the last kNFramesKept
+std::array<scope_stats_t, kMaxScopes> glob_scopes;
+std::size_t glob_n_scopes = 0;
+
+util::alloc_counts_t get_delta(const util::alloc_counts_t& end,
+                               const util::alloc_counts_t& start) {
+  return {end.n_allocs - start.n_allocs, end.n_bytes - start.n_bytes,
+          end.n_frees - start.n_frees};
+}
+
+#ifdef FPL_ALLOC_STATS
+void* counted_alloc(std::size_t sz, std::size_t align) noexcept {
+  if (sz == 0) {
+    sz = 1;
+  }
+  void* out;
+  if (align > alignof(std::max_align_t)) {
+    // aligned_alloc wants the size to be a multiple of the alignment
+    out = std::aligned_alloc(align, (sz + align - 1) / align * align);
+  } else {
+    out = std::malloc(sz);
+  }
+  if (out != nullptr) {
+    thread_counts.n_allocs++;
+    thread_counts.n_bytes += sz;
+  }
+  return out;
+}
+
+void* counted_alloc_or_throw(std::size_t sz, std::size_t align) {
+  void* out = counted_alloc(sz, align);
+  while (out == nullptr) {
+    std::new_handler handler = std::get_new_handler();
+    if (handler == nullptr) {
+      throw std::bad_alloc{};
+    }
+    handler();
+    out = counted_alloc(sz, align);
+  }
+  return out;
+}
+
+void counted_free(void* ptr) noexcept {
+  if (ptr != nullptr) {
+    thread_counts.n_frees++;
+    std::free(ptr);
+  }
+}
+#endif
+}  // namespace
+
+#ifdef FPL_ALLOC_STATS
+void* operator new(std::size_t sz) {
+  return counted_alloc_or_throw(sz, 0);
+}
+
+void* operator new[](std::size_t sz) {
+  return counted_alloc_or_throw(sz, 0);
+}
+
+void* operator new(std::size_t sz, std::align_val_t al) {
+  return counted_alloc_or_throw(sz, std::size_t(al));
+}
+
+void* operator new[](std::size_t sz, std::align_val_t al) {
+  return counted_alloc_or_throw(sz, std::size_t(al));
+}
+
+void* operator new(std::size_t sz, const std::nothrow_t&) noexcept {
+  return counted_alloc(sz, 0);
+}
+
+void* operator new[](std::size_t sz, const std::nothrow_t&) noexcept {
+  return counted_alloc(sz, 0);
+}
+
+void* operator new(std::size_t sz, std::align_val_t al,
+                   const std::nothrow_t&) noexcept {
+  return counted_alloc(sz, std::size_t(al));
+}
+
+void* operator new[](std::size_t sz, std::align_val_t al,
+                     const std::nothrow_t&) noexcept {
+  return counted_alloc(sz, std::size_t(al));
+}
+
+void operator delete(void* ptr) noexcept {
+  counted_free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  counted_free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+  counted_free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+  counted_free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+  counted_free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+  counted_free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+  counted_free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept {
+  counted_free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+  counted_free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+  counted_free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t,
+                     const std::nothrow_t&) noexcept {
+  counted_free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t,
+                       const std::nothrow_t&) noexcept {
+  counted_free(ptr);
+}
+#endif
+
+namespace util {
+
+alloc_counts_t AllocGetThreadCounts() noexcept {
+  return thread_counts;
+}
+
+void AllocFrameMark() noexcept {
+  alloc_counts_t curr = thread_counts;
+  alloc_counts_t delta = get_delta(curr, thread_frame_start);
+  thread_frame_start = curr;
+
+  std::lock_guard lk(glob_stats_mtx);
+  glob_frames[glob_n_frames % kNFramesKept] = delta;
+  glob_n_frames++;
+}
+
+void AllocReset() noexcept {
+  thread_frame_start = thread_counts;
+
+  std::lock_guard lk(glob_stats_mtx);
+  glob_n_frames = 0;
+  glob_n_scopes = 0;
+  glob_scopes.fill({});
+}
+
+void AllocPrintReport(std::ostream& out) {
+  if (!AllocStatsEnabled()) {
+    out << "Allocation accounting is off. Build with FPL_ALLOC_STATS\n";
+    return;
+  }
+
+  std::lock_guard lk(glob_stats_mtx);
+  // The first frame after a reset starts mid-frame, so it's skipped.
+  std::size_t n_frames = std::min(glob_n_frames, kNFramesKept);
+  if (glob_n_frames <= kNFramesKept && n_frames) {
+    n_frames--;
+  }
+  if (n_frames) {
+    std::array<std::uint64_t, kNFramesKept> allocs, bytes;
+    for (std::size_t i = 0; i < n_frames; i++) {
+      const alloc_counts_t& fr =
+          glob_frames[(glob_n_frames - 1 - i) % kNFramesKept];
+      allocs[i] = fr.n_allocs;
+      bytes[i] = fr.n_bytes;
+    }
+    std::sort(allocs.begin(), allocs.begin() + std::ptrdiff_t(n_frames));
+    std::sort(bytes.begin(), bytes.begin() + std::ptrdiff_t(n_frames));
+    out << "Allocations per frame over the last " << n_frames
+        << " frames (min/median/max):\n";
+    out << "count: " << allocs[0] << " " << allocs[n_frames / 2] << " "
+        << allocs[n_frames - 1] << "\n";
+    out << "bytes: " << bytes[0] << " " << bytes[n_frames / 2] << " "
+        << bytes[n_frames - 1] << "\n";
+  } else {
+    out << "No frames recorded\n";
+  }
+
+  out << "Scopes (calls/allocs/bytes/allocs per call):\n";
+  for (std::size_t i = 0; i < glob_n_scopes; i++) {
+    const scope_stats_t& sc = glob_scopes[i];
+    out << sc.name << ": " << sc.n_calls << " " << sc.counts.n_allocs << " "
+        << sc.counts.n_bytes << " "
+        << double(sc.counts.n_allocs) / double(std::max(sc.n_calls,
+                                                         std::uint64_t(1)))
+        << "\n";
+  }
+}
+
+AllocScope::~AllocScope() {
+  alloc_counts_t delta = get_delta(AllocGetThreadCounts(), start_);
+
+  std::lock_guard lk(glob_stats_mtx);
+  std::size_t idx = 0;
+  while (idx < glob_n_scopes && glob_scopes[idx].name != name_) {
+    idx++;
+  }
+  if (idx == glob_n_scopes) {
+    if (glob_n_scopes == kMaxScopes) {
+      return;
+    }
+    glob_scopes[idx].name = name_;
+    glob_n_scopes++;
+  }
+  scope_stats_t& sc = glob_scopes[idx];
+  sc.n_calls++;
+  sc.counts.n_allocs += delta.n_allocs;
+  sc.counts.n_bytes += delta.n_bytes;
+  sc.counts.n_frees += delta.n_frees;
+}
+} // namespace util
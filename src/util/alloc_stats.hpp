@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+
+#include <ostream>
+
+#include "util.hpp"
+
+namespace util {
+
+/*
+  Heap allocation accounting. When built with FPL_ALLOC_STATS, global
+  operator new and delete are replaced with versions that count allocations
+  and bytes per thread. AllocFrameMark closes a frame of the calling thread
+  and MY_ALLOC_SCOPE attributes allocations to a named scope. Without
+  FPL_ALLOC_STATS all of this compiles to nothing and reports zeros.
+*/
+
+struct alloc_counts_t {
+  std::uint64_t n_allocs = 0;
+  std::uint64_t n_bytes = 0;
+  std::uint64_t n_frees = 0;
+};
+
+constexpr bool AllocStatsEnabled() noexcept {
+#ifdef FPL_ALLOC_STATS
+  return true;
+#else
+  return false;
+#endif
+}
+
+// Counts of the calling thread since it started
+alloc_counts_t AllocGetThreadCounts() noexcept;
+
+// Records the allocations made by the calling thread since the last mark as
+// one frame. Meant to be called once per frame by the drawing thread.
+void AllocFrameMark() noexcept;
+
+void AllocReset() noexcept;
+
+// Allocations per frame over recent frames and totals of every scope
+void AllocPrintReport(std::ostream& out);
+
+class AllocScope final {
+public:
+  explicit AllocScope(const char* name) noexcept
+      : name_{name}, start_{AllocGetThreadCounts()} {}
+
+  AllocScope(const AllocScope& other) = delete;
+
+  AllocScope& operator=(const AllocScope& other) = delete;
+
+  ~AllocScope();
+
+private:
+  const char* name_;
+  alloc_counts_t start_;
+};
+
+#ifdef FPL_ALLOC_STATS
+#define MY_ALLOC_SCOPE(name) \
+  ::util::AllocScope MY_MAKE_NAME_UNIQUE(alloc_scope_, __LINE__)(name)
+#else
+#define MY_ALLOC_SCOPE(name)
+#endif
+} // namespace util
@@ -10,6 +10,7 @@
 #include <variant>
 #include <vector>
 
+#include <util/instr_mutex.hpp>
 #include <util/util.hpp>
 
 namespace fms_environment {
@@ -27,7 +28,7 @@ class EnvVarMap {
 
 protected:
   std::unordered_map<Key, std::variant<VarTypes...>> values_;
-  mutable std::shared_mutex mtx_;
+  mutable util::InstrSharedMutex mtx_{"EnvVarMap"};
 
 public:
   using value_type = std::variant<VarTypes...>;
@@ -42,7 +43,7 @@ public:
 
   template<typename T>
   std::optional<T> Get(const Key& key) const noexcept {
-    std::shared_lock cr_lock(mtx_);
+    MY_LOCK_SHARED(mtx_);
     auto it = values_.find(key);
     if(it == values_.end()) {
       return std::nullopt;
@@ -60,7 +61,7 @@ public:
 
   template<typename T>
   bool Set(const Key& key, const T& value) noexcept {
-    std::unique_lock cr_lock(mtx_);
+    MY_LOCK_EXCL(mtx_);
     auto it = values_.find(key);
     if(it == values_.end()) {
       return false;
@@ -77,8 +78,43 @@ public:
     return Set<T>(GetArrayKey(key, idx), value);
   }
 
+  // Sets n values under one lock. Returns the number of values that were
+  // set, keys that are missing or hold another type are skipped.
+  template<typename T>
+  std::size_t SetBatch(const Key* keys, const T* values,
+    std::size_t n) noexcept {
+    MY_LOCK_EXCL(mtx_);
+    std::size_t n_set = 0;
+    for(std::size_t i = 0; i < n; ++i) {
+      auto it = values_.find(keys[i]);
+      if(it != values_.end() && std::holds_alternative<T>(it->second)) {
+        it->second = values[i];
+        n_set++;
+      }
+    }
+    return n_set;
+  }
+
+  // Reads n values under one lock, so that values set by one SetBatch are
+  // never seen half updated. Value i goes to *out[i]. Returns the number of
+  // values that were read, for the others *out[i] is left as is.
+  template<typename T>
+  std::size_t GetBatch(const Key* keys, T* const* out,
+    std::size_t n) const noexcept {
+    MY_LOCK_SHARED(mtx_);
+    std::size_t n_read = 0;
+    for(std::size_t i = 0; i < n; ++i) {
+      auto it = values_.find(keys[i]);
+      if(it != values_.end() && std::holds_alternative<T>(it->second)) {
+        *out[i] = std::get<T>(it->second);
+        n_read++;
+      }
+    }
+    return n_read;
+  }
+
   bool HasKey(const Key& key) {
-    std::unique_lock cr_lock(mtx_);
+    MY_LOCK_EXCL(mtx_);
     auto it = values_.find(key);
     if(it == values_.end()) {
       return false;
@@ -0,0 +1,113 @@
+#include "instr_mutex.hpp"
+
+#include <cstdint>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <vector>
+
+namespace {
+
+constexpr double NS_TO_MS = 1e-6;
+constexpr double NS_TO_US = 1e-3;
+
+// Sites are static objects that never go away, so they are only ever pushed
+// to the front of this list.
+std::atomic<util::LockSite*> glob_sites{nullptr};
+
+std::uint64_t get_ns(util::LockSite::duration_t dur) noexcept {
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(dur).count();
+  return ns > 0 ? std::uint64_t(ns) : 0;
+}
+
+void update_max(std::atomic<std::uint64_t>& max, std::uint64_t val) noexcept {
+  std::uint64_t prev = max.load(std::memory_order_relaxed);
+  while (val > prev && !max.compare_exchange_weak(prev, val,
+    std::memory_order_relaxed)) {}
+}
+}  // namespace
+
+namespace util {
+
+void LockStatsSetOn(bool is_on) noexcept {
+  lock_stats_is_on.store(is_on, std::memory_order_relaxed);
+}
+
+void LockStatsReset() noexcept {
+  for (LockSite* i = glob_sites.load(std::memory_order_acquire); i != nullptr;
+       i = i->next_) {
+    i->n_acq_.store(0, std::memory_order_relaxed);
+    i->n_contended_.store(0, std::memory_order_relaxed);
+    i->wait_ns_.store(0, std::memory_order_relaxed);
+    i->max_wait_ns_.store(0, std::memory_order_relaxed);
+    i->hold_ns_.store(0, std::memory_order_relaxed);
+    i->max_hold_ns_.store(0, std::memory_order_relaxed);
+  }
+}
+
+void LockStatsPrintReport(std::ostream& out) {
+  std::vector<const LockSite*> sites;
+  for (LockSite* i = glob_sites.load(std::memory_order_acquire); i != nullptr;
+       i = i->next_) {
+    if (i->n_acq_.load(std::memory_order_relaxed)) {
+      sites.push_back(i);
+    }
+  }
+  std::sort(sites.begin(), sites.end(), [](const LockSite* a,
+    const LockSite* b) {
+    return a->wait_ns_.load(std::memory_order_relaxed) >
+           b->wait_ns_.load(std::memory_order_relaxed);
+  });
+
+  if (!LockStatsIsOn()) {
+    out << "Lock statistics are off, use lockstats on\n";
+  }
+  if (sites.empty()) {
+    out << "No locks recorded\n";
+    return;
+  }
+  out << "mutex mode site: acquired contended wait(total ms/max us) "
+         "hold(total ms/max us)\n";
+  for (const LockSite* i : sites) {
+    const char* mtx_name = i->mtx_name_.load(std::memory_order_relaxed);
+    out << (mtx_name != nullptr ? mtx_name : "?") << " "
+        << (i->is_shared_ ? "shared" : "excl") << " "
+        << i->loc_.function_name() << " " << i->loc_.file_name() << ":"
+        << i->loc_.line() << ": " << i->n_acq_.load(std::memory_order_relaxed)
+        << " " << i->n_contended_.load(std::memory_order_relaxed) << " "
+        << double(i->wait_ns_.load(std::memory_order_relaxed)) * NS_TO_MS
+        << "/"
+        << double(i->max_wait_ns_.load(std::memory_order_relaxed)) * NS_TO_US
+        << " "
+        << double(i->hold_ns_.load(std::memory_order_relaxed)) * NS_TO_MS
+        << "/"
+        << double(i->max_hold_ns_.load(std::memory_order_relaxed)) * NS_TO_US
+        << "\n";
+  }
+}
+
+LockSite::LockSite(const std::source_location& loc, bool is_shared) noexcept
+    : loc_{loc}, is_shared_{is_shared},
+      next_{glob_sites.load(std::memory_order_relaxed)} {
+  while (!glob_sites.compare_exchange_weak(next_, this,
+    std::memory_order_release, std::memory_order_relaxed)) {}
+}
+
+void LockSite::Record(const char* mtx_name, bool is_contended, duration_t wait,
+                      duration_t hold) noexcept {
+  std::uint64_t wait_ns = get_ns(wait);
+  std::uint64_t hold_ns = get_ns(hold);
+
+  mtx_name_.store(mtx_name, std::memory_order_relaxed);
+  n_acq_.fetch_add(1, std::memory_order_relaxed);
+  if (is_contended) {
+    n_contended_.fetch_add(1, std::memory_order_relaxed);
+  }
+  wait_ns_.fetch_add(wait_ns, std::memory_order_relaxed);
+  hold_ns_.fetch_add(hold_ns, std::memory_order_relaxed);
+  update_max(max_wait_ns_, wait_ns);
+  update_max(max_hold_ns_, hold_ns);
+}
+} // namespace util
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <cstdint>
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <shared_mutex>
+#include <source_location>
+
+#include "util.hpp"
+
+namespace util {
+
+/*
+  Shared mutex with lock contention statistics. Every MY_LOCK_EXCL or
+  MY_LOCK_SHARED owns a static LockSite, which counts acquisitions and sums
+  the wait and hold time of that call site. A lock is counted as contended
+  if try_lock failed and the thread had to block. Recording is off by
+  default, while it's off a lock costs one relaxed atomic load on top of
+  the plain std::shared_mutex.
+*/
+
+inline std::atomic<bool> lock_stats_is_on{false};
+
+inline bool LockStatsIsOn() noexcept {
+  return lock_stats_is_on.load(std::memory_order_relaxed);
+}
+
+void LockStatsSetOn(bool is_on) noexcept;
+
+// Zeroes the counters of every site
+void LockStatsReset() noexcept;
+
+// One line per call site that was hit, sorted by total wait time
+void LockStatsPrintReport(std::ostream& out);
+
+class InstrSharedMutex final {
+public:
+  // name must be a string literal
+  explicit InstrSharedMutex(const char* name) noexcept : name_{name} {}
+
+  InstrSharedMutex(const InstrSharedMutex& other) = delete;
+
+  InstrSharedMutex& operator=(const InstrSharedMutex& other) = delete;
+
+  const char* GetName() const noexcept {
+    return name_;
+  }
+
+  // SharedMutex requirements, so std::unique_lock and std::shared_lock
+  // still work. Locks taken this way aren't counted.
+
+  void lock() {
+    mtx_.lock();
+  }
+
+  bool try_lock() {
+    return mtx_.try_lock();
+  }
+
+  void unlock() {
+    mtx_.unlock();
+  }
+
+  void lock_shared() {
+    mtx_.lock_shared();
+  }
+
+  bool try_lock_shared() {
+    return mtx_.try_lock_shared();
+  }
+
+  void unlock_shared() {
+    mtx_.unlock_shared();
+  }
+
+private:
+  const char* name_;
+  std::shared_mutex mtx_;
+};
+
+class LockSite final {
+public:
+  using duration_t = std::chrono::steady_clock::duration;
+
+  LockSite(const std::source_location& loc, bool is_shared) noexcept;
+
+  LockSite(const LockSite& other) = delete;
+
+  LockSite& operator=(const LockSite& other) = delete;
+
+  void Record(const char* mtx_name, bool is_contended, duration_t wait,
+              duration_t hold) noexcept;
+
+private:
+  friend void LockStatsReset() noexcept;
+  friend void LockStatsPrintReport(std::ostream& out);
+
+  std::source_location loc_;
+  bool is_shared_;
+  std::atomic<const char*> mtx_name_{nullptr};
+  std::atomic<std::uint64_t> n_acq_{0};
+  std::atomic<std::uint64_t> n_contended_{0};
+  std::atomic<std::uint64_t> wait_ns_{0};
+  std::atomic<std::uint64_t> max_wait_ns_{0};
+  std::atomic<std::uint64_t> hold_ns_{0};
+  std::atomic<std::uint64_t> max_hold_ns_{0};
+  LockSite* next_;  // Intrusive list of all sites, see instr_mutex.cpp
+};
+
+template<bool is_shared>
+class InstrLock final {
+public:
+  InstrLock(InstrSharedMutex& mtx, LockSite& site)
+      : mtx_{mtx}, site_{site}, is_on_{LockStatsIsOn()} {
+    if (!is_on_) {
+      lock();
+      return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    is_contended_ = !try_lock();
+    if (is_contended_) {
+      lock();
+    }
+    acq_tp_ = std::chrono::steady_clock::now();
+    wait_ = acq_tp_ - start;
+  }
+
+  InstrLock(const InstrLock& other) = delete;
+
+  InstrLock& operator=(const InstrLock& other) = delete;
+
+  ~InstrLock() {
+    if (!is_on_) {
+      unlock();
+      return;
+    }
+    auto hold = std::chrono::steady_clock::now() - acq_tp_;
+    unlock();
+    site_.Record(mtx_.GetName(), is_contended_, wait_, hold);
+  }
+
+private:
+  InstrSharedMutex& mtx_;
+  LockSite& site_;
+  bool is_on_;
+  bool is_contended_ = false;
+  LockSite::duration_t wait_{};
+  std::chrono::steady_clock::time_point acq_tp_;
+
+  void lock() {
+    if constexpr (is_shared) {
+      mtx_.lock_shared();
+    } else {
+      mtx_.lock();
+    }
+  }
+
+  bool try_lock() {
+    if constexpr (is_shared) {
+      return mtx_.try_lock_shared();
+    } else {
+      return mtx_.try_lock();
+    }
+  }
+
+  void unlock() {
+    if constexpr (is_shared) {
+      mtx_.unlock_shared();
+    } else {
+      mtx_.unlock();
+    }
+  }
+};
+
+#define MY_INSTR_LOCK_IMPL(mtx, is_shared) \
+  static ::util::LockSite MY_MAKE_NAME_UNIQUE(lock_site_, __LINE__)( \
+      std::source_location::current(), is_shared); \
+  ::util::InstrLock<is_shared> MY_MAKE_NAME_UNIQUE(instr_lock_, __LINE__)( \
+      mtx, MY_MAKE_NAME_UNIQUE(lock_site_, __LINE__))
+
+#define MY_LOCK_EXCL(mtx) MY_INSTR_LOCK_IMPL(mtx, false)
+
+#define MY_LOCK_SHARED(mtx) MY_INSTR_LOCK_IMPL(mtx, true)
+
+// Same as MY_MUTEX_WRAPPER_FUNC_BODY, for an InstrSharedMutex
+#define MY_INSTR_MUTEX_WRAPPER_FUNC_BODY(obj, obj_type, func, mtx, ...) \
+  MY_INSTR_LOCK_IMPL(mtx, obj_type::MY_MAKE_TEST_ATTR_SHARED(func)()); \
+  return obj.func(__VA_ARGS__);
+} // namespace util
@@ -0,0 +1,153 @@
+#include "io_worker.hpp"
+
+#ifdef _WIN32
+#include <process.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <system_error>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <utility>
+
+namespace util {
+
+namespace {
+
+// Several writers may save the same file at once, e.g. the aircraft of
+// fpln_host sharing one fpl_dir, so each one gets its own temporary file.
+const std::string TMP_FILE_POSTFIX = ".tmp.";
+
+#ifdef _WIN32
+std::atomic<std::uint64_t> glob_tmp_file_cnt{0};
+
+std::string get_tmp_path(const std::string& path) {
+  std::size_t tid = std::hash<std::thread::id>{}(std::this_thread::get_id());
+  return path + TMP_FILE_POSTFIX + std::to_string(_getpid()) + "." +
+         std::to_string(tid) + "." +
+         std::to_string(glob_tmp_file_cnt.fetch_add(1));
+}
+#endif
+
+#ifndef _WIN32
+bool write_all(int fd, std::string_view data) {
+  while (!data.empty()) {
+    ssize_t n = write(fd, data.data(), data.size());
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data.remove_prefix(std::size_t(n));
+  }
+  return true;
+}
+
+// Best effort: the new file is already in place if this fails
+void sync_parent_dir(const std::string& path) {
+  std::size_t pos = path.rfind('/');
+  std::string dir = ".";
+  if (pos == 0) {
+    dir = "/";
+  } else if (pos != std::string::npos) {
+    dir = path.substr(0, pos);
+  }
+  int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd >= 0) {
+    fsync(fd);
+    close(fd);
+  }
+}
+#endif
+}  // namespace
+
+IoWorker::IoWorker() {
+  thread_ = std::thread(&IoWorker::worker_main, this);
+}
+
+void IoWorker::Post(job_fn_t fn) {
+  {
+    std::lock_guard lk(mtx_);
+    jobs_.push_back(std::move(fn));
+  }
+  cv_.notify_one();
+}
+
+IoWorker::~IoWorker() {
+  {
+    std::lock_guard lk(mtx_);
+    is_stopping_ = true;
+  }
+  cv_.notify_one();
+  thread_.join();
+}
+
+void IoWorker::worker_main() {
+  std::unique_lock lk(mtx_);
+  while (true) {
+    cv_.wait(lk, [this]() { return is_stopping_ || !jobs_.empty(); });
+    if (jobs_.empty()) {
+      return;
+    }
+    job_fn_t fn = std::move(jobs_.front());
+    jobs_.pop_front();
+    lk.unlock();
+    fn();
+    lk.lock();
+  }
+}
+
+#ifdef _WIN32
+// No fsync here, so this only guards against a partly written file, not
+// against losing power.
+bool WriteFileAtomic(const std::string& path, std::string_view data) {
+  std::string tmp_path = get_tmp_path(path);
+  std::FILE* file = std::fopen(tmp_path.c_str(), "wb");
+  if (file == nullptr) {
+    return false;
+  }
+  bool ok = std::fwrite(data.data(), 1, data.size(), file) == data.size() &&
+            std::fflush(file) == 0;
+  ok = std::fclose(file) == 0 && ok;
+  std::error_code ec;
+  if (ok) {
+    // Replaces path if it exists, unlike std::rename on Windows
+    std::filesystem::rename(tmp_path, path, ec);
+  }
+  if (!ok || ec) {
+    std::filesystem::remove(tmp_path, ec);
+    return false;
+  }
+  return true;
+}
+#else
+bool WriteFileAtomic(const std::string& path, std::string_view data) {
+  std::string tmp_path = path + TMP_FILE_POSTFIX + "XXXXXX";
+  int fd = mkstemp(tmp_path.data());
+  if (fd < 0) {
+    return false;
+  }
+  fcntl(fd, F_SETFD, FD_CLOEXEC);
+  // mkstemp creates the file as 0600
+  bool ok = fchmod(fd, 0644) == 0 && write_all(fd, data) && fsync(fd) == 0;
+  ok = close(fd) == 0 && ok;
+  if (!ok || rename(tmp_path.c_str(), path.c_str()) != 0) {
+    unlink(tmp_path.c_str());
+    return false;
+  }
+  sync_parent_dir(path);
+  return true;
+}
+#endif
+}  // namespace util
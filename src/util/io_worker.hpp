@@ -0,0 +1,50 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace util {
+
+/*
+  Single background thread for file I/O. Jobs run one at a time, in the
+  order they were posted, so that callers on the UI or update path never
+  wait for the disk.
+*/
+
+class IoWorker final {
+public:
+  using job_fn_t = std::function<void()>;
+
+  IoWorker();
+
+  IoWorker(const IoWorker& other) = delete;
+
+  IoWorker& operator=(const IoWorker& other) = delete;
+
+  // fn must not throw
+  void Post(job_fn_t fn);
+
+  // Runs the jobs that are still queued before returning
+  ~IoWorker();
+
+private:
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  std::deque<job_fn_t> jobs_;
+  bool is_stopping_ = false;
+  std::thread thread_;
+
+  void worker_main();
+};
+
+// Writes data to a temporary file next to path, flushes it to disk and
+// renames it over path. path therefore holds either the old or the new
+// contents, never a partial file. Returns false on failure, path is left
+// as it was then.
+bool WriteFileAtomic(const std::string& path, std::string_view data);
+}  // namespace util
@@ -0,0 +1,94 @@
+#include "latency_hist.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include <bit>
+#include <chrono>
+
+namespace {
+constexpr double US_TO_MS = 0.001;
+}  // namespace
+
+namespace util {
+
+LatencyHistogram::LatencyHistogram() {
+  Reset();
+}
+
+void LatencyHistogram::Record(duration_t dur) noexcept {
+  auto us_cnt =
+      std::chrono::duration_cast<std::chrono::microseconds>(dur).count();
+  std::uint64_t us = us_cnt > 0 ? std::uint64_t(us_cnt) : 0;
+
+  buckets_[get_bucket(us)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  std::uint64_t prev_max = max_us_.load(std::memory_order_relaxed);
+  while (us > prev_max && !max_us_.compare_exchange_weak(prev_max, us,
+    std::memory_order_relaxed)) {}
+}
+
+std::uint64_t LatencyHistogram::GetCount() const noexcept {
+  return count_.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::GetPercentileMs(double p) const noexcept {
+  std::uint64_t cnt = GetCount();
+  if (cnt == 0) {
+    return 0;
+  }
+  if (p < 0) {
+    p = 0;
+  } else if (p > 100) {
+    p = 100;
+  }
+  std::uint64_t rank = std::uint64_t(std::ceil(double(cnt) * p / 100.0));
+  if (rank == 0) {
+    rank = 1;
+  }
+
+  std::uint64_t seen = 0;
+  for (std::size_t i = 0; i < N_BUCKETS; i++) {
+    seen += buckets_[i].load(std::memory_order_relaxed);
+    if (seen >= rank) {
+      return double(get_bucket_upper_us(i)) * US_TO_MS;
+    }
+  }
+  return GetMaxMs();
+}
+
+double LatencyHistogram::GetMaxMs() const noexcept {
+  return double(max_us_.load(std::memory_order_relaxed)) * US_TO_MS;
+}
+
+void LatencyHistogram::Reset() noexcept {
+  for (auto& i : buckets_) {
+    i.store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  max_us_.store(0, std::memory_order_relaxed);
+}
+
+// Private member functions:
+
+std::size_t LatencyHistogram::get_bucket(std::uint64_t us) noexcept {
+  if (us < N_LINEAR_BUCKETS) {
+    return std::size_t(us);
+  }
+  // msb is at least 4 here, so the 3 bits below it select the sub-bucket
+  std::size_t msb = std::size_t(std::bit_width(us)) - 1;
+  std::size_t sub = std::size_t(us >> (msb - 3)) & (N_SUB_BUCKETS - 1);
+  return N_LINEAR_BUCKETS + (msb - 4) * N_SUB_BUCKETS + sub;
+}
+
+std::uint64_t LatencyHistogram::get_bucket_upper_us(std::size_t idx) noexcept {
+  if (idx < N_LINEAR_BUCKETS) {
+    return std::uint64_t(idx);
+  }
+  std::size_t msb = (idx - N_LINEAR_BUCKETS) / N_SUB_BUCKETS + 4;
+  std::uint64_t sub = (idx - N_LINEAR_BUCKETS) % N_SUB_BUCKETS;
+  std::uint64_t width = std::uint64_t(1) << (msb - 3);
+  return (N_SUB_BUCKETS + sub) * width + width - 1;
+}
+} // namespace util
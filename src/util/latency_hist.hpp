@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+
+namespace util {
+
+/*
+  Histogram of durations with log-linear buckets: values below 16us get a
+  bucket each, and every power of 2 above that is split into 8 buckets, so
+  percentiles are accurate to within 12.5%. Record may be called from one
+  thread while others read. Readers may see a sample that is only half
+  counted, which is fine for statistics.
+*/
+class LatencyHistogram final {
+public:
+  using duration_t = std::chrono::steady_clock::duration;
+
+  LatencyHistogram();
+
+  void Record(duration_t dur) noexcept;
+
+  std::uint64_t GetCount() const noexcept;
+
+  // Upper bound of the bucket holding the p-th percentile, in milliseconds.
+  // p is in [0, 100]. Returns 0 if nothing was recorded.
+  double GetPercentileMs(double p) const noexcept;
+
+  double GetMaxMs() const noexcept;
+
+  void Reset() noexcept;
+
+private:
+  static constexpr std::size_t N_LINEAR_BUCKETS = 16;
+  static constexpr std::size_t N_SUB_BUCKETS = 8;
+  static constexpr std::size_t N_BUCKETS =
+      N_LINEAR_BUCKETS + (64 - 4) * N_SUB_BUCKETS;
+
+  std::array<std::atomic<std::uint64_t>, N_BUCKETS> buckets_;
+  std::atomic<std::uint64_t> count_;
+  std::atomic<std::uint64_t> max_us_;
+
+  static std::size_t get_bucket(std::uint64_t us) noexcept;
+
+  static std::uint64_t get_bucket_upper_us(std::size_t idx) noexcept;
+};
+
+// Latency of CDU key events, from the key press to the frame showing it
+struct input_latency_t {
+  LatencyHistogram queue_wait;  // Press until the event is dequeued
+  LatencyHistogram handling;    // Time spent in CDU::on_event
+  LatencyHistogram total;       // Press until a drawn frame shows the result
+  std::atomic<bool> show_overlay{false};
+};
+} // namespace util
@@ -0,0 +1,83 @@
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace util {
+
+#ifdef _WIN32
+bool MappedFile::Open(const std::string& path) {
+  Close();
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    return false;
+  }
+  buf_.assign(std::istreambuf_iterator<char>(file),
+              std::istreambuf_iterator<char>());
+  if (file.bad()) {
+    buf_.clear();
+    return false;
+  }
+  data_ = buf_.data();
+  size_ = buf_.size();
+  return true;
+}
+#else
+bool MappedFile::Open(const std::string& path) {
+  Close();
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return false;
+  }
+  size_ = std::size_t(st.st_size);
+  if (size_ == 0) {
+    // mmap doesn't take 0 bytes
+    close(fd);
+    return true;
+  }
+  void* ptr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (ptr == MAP_FAILED) {
+    size_ = 0;
+    return false;
+  }
+  // Files are parsed front to back
+  madvise(ptr, size_, MADV_SEQUENTIAL);
+  data_ = static_cast<const char*>(ptr);
+  return true;
+}
+#endif
+
+std::string_view MappedFile::GetView() const noexcept {
+  return {data_, size_};
+}
+
+void MappedFile::Close() noexcept {
+#ifdef _WIN32
+  buf_.clear();
+  data_ = nullptr;
+#else
+  if (data_ != nullptr) {
+    munmap(const_cast<char*>(data_), size_);
+    data_ = nullptr;
+  }
+#endif
+  size_ = 0;
+}
+
+MappedFile::~MappedFile() {
+  Close();
+}
+}  // namespace util
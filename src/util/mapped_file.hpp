@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+
+#include <string>
+#include <string_view>
+
+namespace util {
+
+/*
+  Read-only memory mapping of a whole file. The contents stay valid until
+  the file is closed, so parsers can hand out string_views into them instead
+  of copying lines. Where there's no mmap, the file is read into a buffer
+  that the view points into instead.
+*/
+
+class MappedFile final {
+public:
+  MappedFile() = default;
+
+  MappedFile(const MappedFile& other) = delete;
+
+  MappedFile& operator=(const MappedFile& other) = delete;
+
+  // Returns false if the file couldn't be opened or mapped. An empty file
+  // opens fine and has an empty view.
+  bool Open(const std::string& path);
+
+  std::string_view GetView() const noexcept;
+
+  void Close() noexcept;
+
+  ~MappedFile();
+
+private:
+  const char* data_ = nullptr;
+  std::size_t size_ = 0;
+#ifdef _WIN32
+  std::string buf_;
+#endif
+};
+}  // namespace util
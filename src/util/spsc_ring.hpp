@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <array>
+#include <atomic>
+#include <type_traits>
+
+namespace util {
+
+constexpr std::size_t CACHE_LINE_SZ = 64;
+
+/*
+  Bounded lock-free queue for exactly one producer thread and one consumer
+  thread. N must be a power of 2. Pushing into a full ring fails, and the
+  failure is counted, so that the producer never waits for the consumer.
+*/
+template <class T, std::size_t N>
+class SPSCRing final {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "N must be a power of 2");
+  static_assert(std::is_trivially_copyable_v<T>,
+                "T must be trivially copyable");
+
+public:
+  SPSCRing() = default;
+
+  SPSCRing(const SPSCRing& other) = delete;
+
+  SPSCRing& operator=(const SPSCRing& other) = delete;
+
+  // Producer side. Returns false if the ring is full.
+  bool TryPush(const T& val) noexcept {
+    std::size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_cache_ == N) {
+      head_cache_ = head_.load(std::memory_order_acquire);
+      if (tail - head_cache_ == N) {
+        n_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+    }
+    buf_[tail & (N - 1)] = val;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side. Returns false if the ring is empty.
+  bool TryPop(T& out) noexcept {
+    std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_cache_) {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+      if (head == tail_cache_) {
+        return false;
+      }
+    }
+    out = buf_[head & (N - 1)];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Number of pushes that failed because the ring was full
+  std::uint64_t GetDropped() const noexcept {
+    return n_dropped_.load(std::memory_order_relaxed);
+  }
+
+  static constexpr std::size_t GetCapacity() noexcept {
+    return N;
+  }
+
+private:
+  // The indices only grow. Each side keeps a copy of the other side's index
+  // so that it touches the other side's cache line only when it has to.
+  alignas(CACHE_LINE_SZ) std::atomic<std::size_t> head_{0};
+  std::size_t tail_cache_ = 0;
+  alignas(CACHE_LINE_SZ) std::atomic<std::size_t> tail_{0};
+  std::size_t head_cache_ = 0;
+  alignas(CACHE_LINE_SZ) std::atomic<std::uint64_t> n_dropped_{0};
+  std::array<T, N> buf_;
+};
+} // namespace util
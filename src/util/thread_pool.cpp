@@ -0,0 +1,106 @@
+#include "thread_pool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+#include <mutex>
+
+namespace util {
+
+ThreadPool::ThreadPool(std::size_t n_threads) {
+  workers_.reserve(n_threads);
+  for (std::size_t i = 0; i < n_threads; i++) {
+    workers_.emplace_back(&ThreadPool::worker_main, this);
+  }
+}
+
+void ThreadPool::ParallelFor(std::size_t n, const job_fn_t& fn) {
+  if (n == 0) {
+    return;
+  }
+  if (workers_.empty() || n == 1) {
+    for (std::size_t i = 0; i < n; i++) {
+      fn(i);
+    }
+    return;
+  }
+
+  std::lock_guard job_lk(job_mtx_);
+  {
+    std::lock_guard lk(mtx_);
+    job_fn_ = &fn;
+    job_sz_ = n;
+    next_idx_.store(0, std::memory_order_relaxed);
+    n_done_ = 0;
+    job_gen_++;
+  }
+  job_cv_.notify_all();
+
+  std::size_t n_run = run_job(fn, n);
+
+  // Workers still inside run_job would pick up indices of the next job,
+  // so wait for them to leave as well.
+  std::unique_lock lk(mtx_);
+  n_done_ += n_run;
+  done_cv_.wait(lk, [this]() {
+    return n_done_ == job_sz_ && n_active_ == 0;
+  });
+  job_fn_ = nullptr;
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard lk(mtx_);
+    is_stopping_ = true;
+  }
+  job_cv_.notify_all();
+  for (auto& i : workers_) {
+    i.join();
+  }
+}
+
+// Private member functions:
+
+void ThreadPool::worker_main() {
+  std::uint64_t last_gen = 0;
+  while (true) {
+    const job_fn_t* fn;
+    std::size_t sz;
+    {
+      std::unique_lock lk(mtx_);
+      job_cv_.wait(lk, [this, last_gen]() {
+        return is_stopping_ || (job_gen_ != last_gen && job_fn_ != nullptr);
+      });
+      if (is_stopping_) {
+        return;
+      }
+      last_gen = job_gen_;
+      fn = job_fn_;
+      sz = job_sz_;
+      n_active_++;
+    }
+
+    std::size_t n_run = run_job(*fn, sz);
+
+    std::lock_guard lk(mtx_);
+    n_done_ += n_run;
+    n_active_--;
+    if (n_done_ == job_sz_ && n_active_ == 0) {
+      done_cv_.notify_one();
+    }
+  }
+}
+
+std::size_t ThreadPool::run_job(const job_fn_t& fn, std::size_t sz) noexcept {
+  std::size_t n_run = 0;
+  while (true) {
+    std::size_t idx = next_idx_.fetch_add(1, std::memory_order_relaxed);
+    if (idx >= sz) {
+      return n_run;
+    }
+    fn(idx);
+    n_run++;
+  }
+}
+} // namespace util
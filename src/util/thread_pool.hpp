@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace util {
+
+/*
+  Fixed set of worker threads for fork-join work. ParallelFor hands out the
+  indices of one job to the workers and to the calling thread, and returns
+  once all of them are done. Jobs from several callers run one after another.
+  A pool with 0 threads runs everything on the caller.
+*/
+
+class ThreadPool final {
+public:
+  using job_fn_t = std::function<void(std::size_t)>;
+
+  explicit ThreadPool(std::size_t n_threads);
+
+  ThreadPool(const ThreadPool& other) = delete;
+
+  ThreadPool& operator=(const ThreadPool& other) = delete;
+
+  std::size_t GetNThreads() const noexcept {
+    return workers_.size();
+  }
+
+  // Calls fn(i) for every i in [0, n). fn must not throw.
+  void ParallelFor(std::size_t n, const job_fn_t& fn);
+
+  ~ThreadPool();
+
+private:
+  std::vector<std::thread> workers_;
+
+  std::mutex job_mtx_;  // Held by the caller for the whole job
+  std::mutex mtx_;
+  std::condition_variable job_cv_;
+  std::condition_variable done_cv_;
+  std::uint64_t job_gen_ = 0;
+  bool is_stopping_ = false;
+
+  const job_fn_t* job_fn_ = nullptr;
+  std::size_t job_sz_ = 0;
+  std::atomic<std::size_t> next_idx_{0};
+  std::size_t n_done_ = 0;  // Guarded by mtx_
+  std::size_t n_active_ = 0;  // Workers inside run_job, guarded by mtx_
+
+  void worker_main();
+
+  // Runs indices of the current job until there are none left. Returns the
+  // number of indices that were run.
+  std::size_t run_job(const job_fn_t& fn, std::size_t sz) noexcept;
+};
+} // namespace util
@@ -0,0 +1,111 @@
+#include "trace.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Events past this are dropped, so that a forgotten trace can't eat all
+// of the memory.
+constexpr std::size_t kMaxEventsPerThread = std::size_t(1) << 20;
+
+struct trace_event_t {
+  const char* name;
+  std::chrono::steady_clock::time_point tp;
+  bool is_begin;
+};
+
+struct thread_buf_t {
+  std::mutex mtx;  // Only contended while a trace is written out
+  std::vector<trace_event_t> events;
+  std::uint64_t n_dropped = 0;
+  std::uint32_t tid;
+};
+
+std::mutex glob_bufs_mtx;
+std::vector<std::shared_ptr<thread_buf_t>> glob_bufs;
+std::chrono::steady_clock::time_point glob_trace_start;
+
+thread_local std::shared_ptr<thread_buf_t> thread_buf;
+
+thread_buf_t& get_thread_buf() {
+  if (thread_buf == nullptr) {
+    thread_buf = std::make_shared<thread_buf_t>();
+    std::lock_guard lk(glob_bufs_mtx);
+    thread_buf->tid = std::uint32_t(glob_bufs.size() + 1);
+    glob_bufs.push_back(thread_buf);
+  }
+  return *thread_buf;
+}
+}  // namespace
+
+namespace util {
+
+void TraceStart() noexcept {
+  std::lock_guard lk(glob_bufs_mtx);
+  for (auto& i : glob_bufs) {
+    std::lock_guard buf_lk(i->mtx);
+    i->events.clear();
+    i->n_dropped = 0;
+  }
+  glob_trace_start = std::chrono::steady_clock::now();
+  trace_is_on.store(true, std::memory_order_relaxed);
+}
+
+bool TraceStop(const std::string& path) {
+  trace_is_on.store(false, std::memory_order_relaxed);
+
+  std::ofstream out(path, std::ofstream::out);
+  if (!out) {
+    return false;
+  }
+
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool is_first = true;
+  std::lock_guard lk(glob_bufs_mtx);
+  for (auto& i : glob_bufs) {
+    std::lock_guard buf_lk(i->mtx);
+    for (const trace_event_t& ev : i->events) {
+      std::chrono::duration<double, std::micro> ts = ev.tp - glob_trace_start;
+      if (!is_first) {
+        out << ",";
+      }
+      is_first = false;
+      out << "\n{\"name\":\"" << ev.name << "\",\"ph\":\""
+          << (ev.is_begin ? 'B' : 'E') << "\",\"ts\":" << ts.count()
+          << ",\"pid\":1,\"tid\":" << i->tid << "}";
+    }
+    if (i->n_dropped) {
+      if (!is_first) {
+        out << ",";
+      }
+      is_first = false;
+      out << "\n{\"name\":\"dropped " << i->n_dropped
+          << " events\",\"ph\":\"i\",\"s\":\"t\",\"ts\":0,\"pid\":1,\"tid\":"
+          << i->tid << "}";
+    }
+  }
+  out << "\n]}\n";
+
+  return bool(out);
+}
+
+void TraceRecord(const char* name, bool is_begin) {
+  auto tp = std::chrono::steady_clock::now();
+  thread_buf_t& buf = get_thread_buf();
+  std::lock_guard lk(buf.mtx);
+  if (buf.events.size() >= kMaxEventsPerThread) {
+    buf.n_dropped++;
+    return;
+  }
+  buf.events.push_back({name, tp, is_begin});
+}
+} // namespace util
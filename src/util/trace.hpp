@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+
+#include "util.hpp"
+
+namespace util {
+
+/*
+  Scoped-timer tracing. While a trace is running, every MY_TRACE_SCOPE
+  records a begin and an end event into a buffer of the current thread.
+  TraceStop writes everything in the Chrome trace event format, which
+  chrome://tracing and Perfetto can open. While no trace is running, a scope
+  costs one relaxed atomic load.
+*/
+
+inline std::atomic<bool> trace_is_on{false};
+
+inline bool TraceIsOn() noexcept {
+  return trace_is_on.load(std::memory_order_relaxed);
+}
+
+// Drops events of the previous trace and starts recording
+void TraceStart() noexcept;
+
+// Stops recording and writes the trace to path. Returns false if the file
+// couldn't be written.
+bool TraceStop(const std::string& path);
+
+// name must outlive the trace, i.e. be a string literal
+void TraceRecord(const char* name, bool is_begin);
+
+class TraceScope final {
+public:
+  explicit TraceScope(const char* name)
+      : name_{name}, is_on_{TraceIsOn()} {
+    if (is_on_) {
+      TraceRecord(name_, true);
+    }
+  }
+
+  TraceScope(const TraceScope& other) = delete;
+
+  TraceScope& operator=(const TraceScope& other) = delete;
+
+  ~TraceScope() {
+    if (is_on_) {
+      TraceRecord(name_, false);
+    }
+  }
+
+private:
+  const char* name_;
+  bool is_on_;
+};
+
+#define MY_TRACE_SCOPE(name) \
+  ::util::TraceScope MY_MAKE_NAME_UNIQUE(trace_scope_, __LINE__)(name)
+} // namespace util